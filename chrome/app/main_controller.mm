@@ -152,6 +152,11 @@ namespace {
 const base::Feature kFastApplicationWillTerminate{
     "FastApplicationWillTerminate", base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Creates the main URLRequestContext once the first window is shown, instead
+// of on the first network request.
+const base::Feature kPrewarmURLRequestContext{
+    "PrewarmURLRequestContext", base::FEATURE_ENABLED_BY_DEFAULT};
+
 // Constants for deferring resetting the startup attempt count (to give the app
 // a little while to make sure it says alive).
 NSString* const kStartupAttemptReset = @"StartupAttemptReset";
@@ -596,6 +601,11 @@ void MainControllerAuthenticationServiceDelegate::ClearBrowsingData(
 
   [self scheduleTasksRequiringBVCWithBrowserState];
 
+  // The context is created on the IO thread and background sequences, off the
+  // critical path of the UI thread.
+  if (base::FeatureList::IsEnabled(kPrewarmURLRequestContext))
+    self.appState.mainBrowserState->PrewarmRequestContext();
+
   CustomizeUIAppearance();
 
   [self scheduleStartupCleanupTasks];
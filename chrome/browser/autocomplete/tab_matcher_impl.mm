@@ -4,13 +4,9 @@
 
 #include "ios/chrome/browser/autocomplete/tab_matcher_impl.h"
 
-#include <set>
-
 #include "ios/chrome/browser/browser_state/chrome_browser_state.h"
-#import "ios/chrome/browser/main/browser.h"
-#import "ios/chrome/browser/main/browser_list.h"
-#import "ios/chrome/browser/main/browser_list_factory.h"
-#import "ios/chrome/browser/web_state_list/web_state_list.h"
+#import "ios/chrome/browser/main/tab_registry.h"
+#import "ios/chrome/browser/main/tab_registry_factory.h"
 
 TabMatcherImpl::TabMatcherImpl(ChromeBrowserState* browser_state)
     : browser_state_{browser_state} {
@@ -19,16 +15,6 @@ TabMatcherImpl::TabMatcherImpl(ChromeBrowserState* browser_state)
 
 bool TabMatcherImpl::IsTabOpenWithURL(const GURL& url,
                                       const AutocompleteInput* input) const {
-  BrowserList* browser_list =
-      BrowserListFactory::GetForBrowserState(browser_state_);
-  std::set<Browser*> browsers = browser_state_->IsOffTheRecord()
-                                    ? browser_list->AllIncognitoBrowsers()
-                                    : browser_list->AllRegularBrowsers();
-  for (Browser* browser : browsers) {
-    if (browser->GetWebStateList()->GetIndexOfInactiveWebStateWithURL(url) !=
-        WebStateList::kInvalidIndex) {
-      return true;
-    }
-  }
-  return false;
+  return TabRegistryFactory::GetForBrowserState(browser_state_)
+      ->HasInactiveTabWithURL(url, browser_state_->IsOffTheRecord());
 }
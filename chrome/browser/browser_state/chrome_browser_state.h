@@ -118,6 +118,11 @@ class ChromeBrowserState : public web::BrowserState {
   // access to the the proxy configuration possibly defined by preferences.
   virtual PrefProxyConfigTracker* GetProxyConfigTracker() = 0;
 
+  // Creates the main URLRequestContext on the IO thread, along with its disk
+  // cache backend, so that the first network request doesn't wait for them.
+  // Must be called on the UI thread.
+  void PrewarmRequestContext();
+
   // Creates the main net::URLRequestContextGetter that will be returned by
   // GetRequestContext(). Should only be called once.
   virtual net::URLRequestContextGetter* CreateRequestContext(
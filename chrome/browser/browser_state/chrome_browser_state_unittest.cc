@@ -4,15 +4,56 @@
 
 #include "ios/chrome/browser/browser_state/chrome_browser_state.h"
 
+#include "base/callback_helpers.h"
+#include "base/run_loop.h"
 #include "components/variations/net/variations_http_headers.h"
 #include "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
 #include "ios/web/public/test/web_task_environment.h"
+#include "ios/web/public/thread/web_task_traits.h"
+#include "ios/web/public/thread/web_thread.h"
+#include "net/url_request/url_request_test_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
 namespace ios {
 namespace {
 
+// URLRequestContextGetter recording the thread on which its context is
+// created.
+class ThreadCheckingContextGetter : public net::URLRequestContextGetter {
+ public:
+  ThreadCheckingContextGetter()
+      : getter_(base::MakeRefCounted<net::TestURLRequestContextGetter>(
+            web::GetIOThreadTaskRunner({}))) {}
+
+  ThreadCheckingContextGetter(const ThreadCheckingContextGetter&) = delete;
+  ThreadCheckingContextGetter& operator=(const ThreadCheckingContextGetter&) =
+      delete;
+
+  bool created() const { return created_; }
+  bool created_on_io_thread() const { return created_on_io_thread_; }
+
+  // URLRequestContextGetter implementation:
+  net::URLRequestContext* GetURLRequestContext() override {
+    if (!created_) {
+      created_ = true;
+      created_on_io_thread_ = web::WebThread::CurrentlyOn(web::WebThread::IO);
+    }
+    return getter_->GetURLRequestContext();
+  }
+  scoped_refptr<base::SingleThreadTaskRunner> GetNetworkTaskRunner()
+      const override {
+    return getter_->GetNetworkTaskRunner();
+  }
+
+ private:
+  ~ThreadCheckingContextGetter() override = default;
+
+  scoped_refptr<net::TestURLRequestContextGetter> getter_;
+  bool created_ = false;
+  bool created_on_io_thread_ = false;
+};
+
 using ChromeBrowserStateTest = PlatformTest;
 
 // Tests that ChromeBrowserState implements UpdateCorsExemptHeader correctly.
@@ -37,5 +78,27 @@ TEST_F(ChromeBrowserStateTest, CorsExemptHeader) {
   }
 }
 
+// Tests that PrewarmRequestContext creates the URLRequestContext on the IO
+// thread.
+TEST_F(ChromeBrowserStateTest, PrewarmRequestContextOnIOThread) {
+  web::WebTaskEnvironment task_environment(
+      web::WebTaskEnvironment::Options::REAL_IO_THREAD);
+  std::unique_ptr<TestChromeBrowserState> browser_state =
+      TestChromeBrowserState::Builder().Build();
+  auto getter = base::MakeRefCounted<ThreadCheckingContextGetter>();
+  browser_state->SetURLRequestContextGetter(getter);
+
+  browser_state->PrewarmRequestContext();
+
+  // Wait for the IO thread to run the tasks posted before this one.
+  base::RunLoop run_loop;
+  web::GetIOThreadTaskRunner({})->PostTaskAndReply(
+      FROM_HERE, base::DoNothing(), run_loop.QuitClosure());
+  run_loop.Run();
+
+  EXPECT_TRUE(getter->created());
+  EXPECT_TRUE(getter->created_on_io_thread());
+}
+
 }  // namespace
 }  // namespace ios
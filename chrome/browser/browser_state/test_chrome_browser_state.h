@@ -97,6 +97,11 @@ class TestChromeBrowserState final : public ChromeBrowserState {
   void SetSharedURLLoaderFactory(
       scoped_refptr<network::SharedURLLoaderFactory> shared_url_loader_factory);
 
+  // Sets the URLRequestContextGetter returned by CreateRequestContext() for
+  // test. Must be called before the first call to GetRequestContext().
+  void SetURLRequestContextGetter(
+      scoped_refptr<net::URLRequestContextGetter> request_context_getter);
+
   // Helper class that allows for parameterizing the building
   // of TestChromeBrowserStates.
   class Builder {
@@ -190,6 +195,9 @@ class TestChromeBrowserState final : public ChromeBrowserState {
   scoped_refptr<network::SharedURLLoaderFactory>
       test_shared_url_loader_factory_;
 
+  // A URLRequestContextGetter for test.
+  scoped_refptr<net::URLRequestContextGetter> test_request_context_getter_;
+
   // The incognito ChromeBrowserState instance that is associated with this
   // non-incognito ChromeBrowserState instance.
   std::unique_ptr<TestChromeBrowserState> otr_browser_state_;
@@ -249,6 +249,8 @@ void TestChromeBrowserState::ClearNetworkingHistorySince(
 
 net::URLRequestContextGetter* TestChromeBrowserState::CreateRequestContext(
     ProtocolHandlerMap* protocol_handlers) {
+  if (test_request_context_getter_)
+    return test_request_context_getter_.get();
   return new net::TestURLRequestContextGetter(web::GetIOThreadTaskRunner({}));
 }
 
@@ -338,3 +340,8 @@ void TestChromeBrowserState::SetSharedURLLoaderFactory(
     scoped_refptr<network::SharedURLLoaderFactory> shared_url_loader_factory) {
   test_shared_url_loader_factory_ = std::move(shared_url_loader_factory);
 }
+
+void TestChromeBrowserState::SetURLRequestContextGetter(
+    scoped_refptr<net::URLRequestContextGetter> request_context_getter) {
+  test_request_context_getter_ = std::move(request_context_getter);
+}
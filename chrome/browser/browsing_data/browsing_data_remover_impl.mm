@@ -45,6 +45,8 @@
 #include "ios/chrome/browser/crash_report/crash_helper.h"
 #include "ios/chrome/browser/external_files/external_file_remover.h"
 #include "ios/chrome/browser/external_files/external_file_remover_factory.h"
+#include "ios/chrome/browser/favicon/ios_chrome_large_icon_cache_factory.h"
+#include "ios/chrome/browser/favicon/large_icon_cache.h"
 #include "ios/chrome/browser/history/history_service_factory.h"
 #include "ios/chrome/browser/history/web_history_service_factory.h"
 #import "ios/chrome/browser/https_upgrades/https_upgrade_service_factory.h"
@@ -392,6 +394,13 @@ void BrowsingDataRemoverImpl::RemoveImpl(base::Time delete_begin,
       tab_service->DeleteLastSession();
     }
 
+    // The large icon cache persists the icons of the most recently visited
+    // pages, along with their URLs.
+    LargeIconCache* large_icon_cache =
+        IOSChromeLargeIconCacheFactory::GetForBrowserState(browser_state_);
+    if (large_icon_cache)
+      large_icon_cache->Clear(CreatePendingTaskCompletionClosure());
+
     // The saved Autofill profiles and credit cards can include the origin from
     // which these profiles and credit cards were learned.  These are a form of
     // history, so clear them as well.
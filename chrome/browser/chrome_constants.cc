@@ -13,5 +13,7 @@ const base::FilePath::CharType kIOSChromeCookieFilename[] =
     FILE_PATH_LITERAL("Cookies");
 const base::FilePath::CharType kIOSChromeCRLSetFilename[] =
     FILE_PATH_LITERAL("Certificate Revocation Lists");
+const base::FilePath::CharType kIOSChromeLargeIconCacheFilename[] =
+    FILE_PATH_LITERAL("Large Icon Cache");
 const base::FilePath::CharType kIOSChromeNetworkPersistentStateFilename[] =
     FILE_PATH_LITERAL("Network Persistent State");
@@ -15,6 +15,7 @@ extern const char kIOSChromeMultiBrowserStatePrefix[];
 extern const base::FilePath::CharType kIOSChromeCacheDirname[];
 extern const base::FilePath::CharType kIOSChromeCookieFilename[];
 extern const base::FilePath::CharType kIOSChromeCRLSetFilename[];
+extern const base::FilePath::CharType kIOSChromeLargeIconCacheFilename[];
 extern const base::FilePath::CharType
     kIOSChromeNetworkPersistentStateFilename[];
 
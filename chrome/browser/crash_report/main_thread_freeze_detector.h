@@ -24,6 +24,14 @@
 // checking the new preferences values. This is necessary to detect freezes
 // during applicationDidFinishLaunching.
 + (instancetype)sharedInstance;
+// Creates a detector considering the main thread frozen after |delay| seconds
+// and sampling a freeze every |hangSampleInterval| seconds. Instead of
+// capturing dumps, it calls |hangSampleHandler| on a background queue with the
+// ID of the freeze and the index of the sample. For testing.
+- (instancetype)initWithDelay:(NSTimeInterval)delay
+           hangSampleInterval:(NSTimeInterval)hangSampleInterval
+            hangSampleHandler:
+                (void (^)(NSString* hangID, int sample))hangSampleHandler;
 // The result of the previous session. If this is true, the last time the
 // application was terminated, main thread was not responding.
 @property(nonatomic, readonly) BOOL lastSessionEndedFrozen;
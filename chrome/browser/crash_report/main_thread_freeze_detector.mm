@@ -4,9 +4,14 @@
 
 #include "ios/chrome/browser/crash_report/main_thread_freeze_detector.h"
 
+#include <atomic>
+
 #include "base/debug/debugger.h"
 #import "base/files/file_util.h"
+#include "base/mac/scoped_cftyperef.h"
+#include "base/memory/ref_counted.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/time/time.h"
 #include "components/crash/core/app/crashpad.h"
@@ -31,6 +36,78 @@ NSString* const kLastSessionExitedCleanly = @"LastSessionExitedCleanly";
 
 const NSTimeInterval kFreezeDetectionDelay = 9;
 
+// Interval at which the freeze detection queue checks the main thread.
+const int64_t kFreezeDetectionIntervalNanoseconds = 0.5 * NSEC_PER_SEC;
+
+// Number of dumps captured during a freeze, to sample the main thread stack
+// as the freeze goes on, and interval between them.
+const int kHangSampleCount = 3;
+const NSTimeInterval kHangSampleInterval = 2;
+
+// Value of the main thread heartbeat while its run loop waits for events. The
+// main thread is idle, hence not frozen, while waiting.
+const int64_t kMainThreadWaiting = 0;
+
+// Returns the heartbeat value for the current time.
+int64_t CurrentHeartbeat() {
+  return base::TimeTicks::Now().since_origin().InMicroseconds();
+}
+
+// Returns the time of |heartbeat|.
+base::TimeTicks HeartbeatTime(int64_t heartbeat) {
+  return base::TimeTicks() + base::Microseconds(heartbeat);
+}
+
+// The main thread heartbeat, shared by the main run loop observer and the
+// freeze detection queue. It is owned by the observer, which may outlive the
+// MainThreadFreezeDetector.
+struct MainThreadHeartbeat
+    : public base::RefCountedThreadSafe<MainThreadHeartbeat> {
+  // The time in microseconds at which the main run loop was last seen running,
+  // or kMainThreadWaiting while it waits for events. Written by the main
+  // thread, read by the freeze detection queue.
+  std::atomic<int64_t> value{kMainThreadWaiting};
+  // Whether a hang report was generated and waits for the main thread to
+  // recover. The freeze detection is paused meanwhile.
+  std::atomic<bool> report_pending{false};
+  // Called on the main thread on its first run loop activity after a hang
+  // report, with the heartbeat of the freeze.
+  void (^recovery_handler)(int64_t freeze_heartbeat);
+
+ private:
+  friend class base::RefCountedThreadSafe<MainThreadHeartbeat>;
+  ~MainThreadHeartbeat() = default;
+};
+
+const void* RetainHeartbeat(const void* info) {
+  static_cast<const MainThreadHeartbeat*>(info)->AddRef();
+  return info;
+}
+
+void ReleaseHeartbeat(const void* info) {
+  static_cast<const MainThreadHeartbeat*>(info)->Release();
+}
+
+// Called by the main run loop observer on each |activity| of the run loop.
+// This runs several times per run loop iteration, so it only stores the
+// heartbeat unless a hang report waits for the recovery.
+void OnMainRunLoopActivity(CFRunLoopObserverRef observer,
+                           CFRunLoopActivity activity,
+                           void* info) {
+  MainThreadHeartbeat* heartbeat = static_cast<MainThreadHeartbeat*>(info);
+  // Only the main thread writes the heartbeat.
+  const int64_t freeze_heartbeat =
+      heartbeat->value.load(std::memory_order_relaxed);
+  heartbeat->value.store(activity == kCFRunLoopBeforeWaiting
+                             ? kMainThreadWaiting
+                             : CurrentHeartbeat(),
+                         std::memory_order_relaxed);
+  if (heartbeat->report_pending.load(std::memory_order_relaxed) &&
+      heartbeat->report_pending.exchange(false)) {
+    heartbeat->recovery_handler(freeze_heartbeat);
+  }
+}
+
 void LogRecoveryTime(base::TimeDelta time) {
   UMA_HISTOGRAM_TIMES("IOS.MainThreadFreezeDetection.RecoveredAfter", time);
 }
@@ -67,26 +144,34 @@ bool IsMetricKitReport(crash_reporter::Report report) {
 }  // namespace
 
 @interface MainThreadFreezeDetector ()
-// The callback that is called regularly on main thread.
-- (void)runInMainLoop;
+// Called on the main thread when it runs again after a hang report for the
+// freeze which started after |freezeHeartbeat|.
+- (void)mainThreadRecoveredFromHeartbeat:(int64_t)freezeHeartbeat;
 // The callback that is called regularly on watchdog thread.
 - (void)runInFreezeDetectionQueue;
-// These 4 properties will be accessed from both thread. Make them atomic.
-// The date at which |runInMainLoop| was last called.
-@property(atomic) NSDate* lastSeenMainThread;
+// These 2 properties will be accessed from both thread. Make them atomic.
 // Whether the watchdog should continue running.
 @property(atomic) BOOL running;
-// Whether a report has been generated. When this is true, the
-// FreezeDetectionQueue does not run.
-@property(atomic) BOOL reportGenerated;
 // The delay in seconds after which main thread will be considered frozen.
-@property(atomic) NSInteger delay;
+@property(atomic) NSTimeInterval delay;
 @end
 
 @implementation MainThreadFreezeDetector {
   dispatch_queue_t _freezeDetectionQueue;
   BOOL _enabled;
 
+  // The main thread heartbeat.
+  scoped_refptr<MainThreadHeartbeat> _heartbeat;
+  // The observer of the main run loop updating |_heartbeat|. Unlike a repeating
+  // task, it doesn't wake up the main thread while it is idle. It is only
+  // added to and removed from the run loop modes on |_freezeDetectionQueue|.
+  base::ScopedCFTypeRef<CFRunLoopObserverRef> _heartbeatObserver;
+
+  // Interval between the samples of a freeze.
+  NSTimeInterval _hangSampleInterval;
+  // Called instead of capturing the samples of a freeze, for tests.
+  void (^_hangSampleHandler)(NSString* hangID, int sample);
+
   // The information on the UTE report that was created on last session.
   // Contains 3 fields:
   // "dump": the file name of the .dmp file in |_UTEDirectory|,
@@ -133,6 +218,21 @@ bool IsMetricKitReport(crash_reporter::Report report) {
     _lastSessionEndedFrozen = _lastSessionFreezeInfo != nil;
     [defaults removeObjectForKey:@(kNsUserDefaultKeyLastSessionInfo)];
     _delay = kFreezeDetectionDelay;
+    _hangSampleInterval = kHangSampleInterval;
+
+    _heartbeat = base::MakeRefCounted<MainThreadHeartbeat>();
+    __weak MainThreadFreezeDetector* weakSelf = self;
+    _heartbeat->recovery_handler = ^(int64_t freezeHeartbeat) {
+      [weakSelf mainThreadRecoveredFromHeartbeat:freezeHeartbeat];
+    };
+    CFRunLoopObserverContext context = {0, _heartbeat.get(), &RetainHeartbeat,
+                                        &ReleaseHeartbeat, nullptr};
+    _heartbeatObserver.reset(CFRunLoopObserverCreate(
+        kCFAllocatorDefault,
+        kCFRunLoopAfterWaiting | kCFRunLoopBeforeTimers |
+            kCFRunLoopBeforeSources | kCFRunLoopBeforeWaiting,
+        /*repeats=*/true, /*order=*/0, &OnMainRunLoopActivity, &context));
+
     _freezeDetectionQueue = dispatch_queue_create(
         "org.chromium.freeze_detection", DISPATCH_QUEUE_SERIAL);
     NSString* cacheDirectory = NSSearchPathForDirectoriesInDomains(
@@ -159,6 +259,24 @@ bool IsMetricKitReport(crash_reporter::Report report) {
   return self;
 }
 
+- (instancetype)initWithDelay:(NSTimeInterval)delay
+           hangSampleInterval:(NSTimeInterval)hangSampleInterval
+            hangSampleHandler:
+                (void (^)(NSString* hangID, int sample))hangSampleHandler {
+  self = [self init];
+  if (self) {
+    _delay = delay;
+    _hangSampleInterval = hangSampleInterval;
+    _hangSampleHandler = hangSampleHandler;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  // The observer owns the heartbeat, so this is safe on any thread.
+  CFRunLoopObserverInvalidate(_heartbeatObserver);
+}
+
 - (void)setEnabled:(BOOL)enabled {
   static dispatch_once_t onceToken;
   dispatch_once(&onceToken, ^{
@@ -186,39 +304,67 @@ bool IsMetricKitReport(crash_reporter::Report report) {
     return;
   }
   self.running = YES;
-  [self runInMainLoop];
+  _heartbeat->value.store(CurrentHeartbeat(), std::memory_order_relaxed);
   dispatch_async(_freezeDetectionQueue, ^{
+    CFRunLoopAddObserver(CFRunLoopGetMain(), self->_heartbeatObserver,
+                         kCFRunLoopCommonModes);
     [self runInFreezeDetectionQueue];
   });
 }
 
 - (void)stop {
   self.running = NO;
+  dispatch_async(_freezeDetectionQueue, ^{
+    // While a hang report is pending, the observer is kept so that the
+    // recovery is logged. It is removed after the recovery.
+    if (!self.running &&
+        !self->_heartbeat->report_pending.load(std::memory_order_relaxed)) {
+      [self removeHeartbeatObserver];
+    }
+  });
 }
 
-- (void)runInMainLoop {
-  NSDate* oldLastSeenMainThread = self.lastSeenMainThread;
-  self.lastSeenMainThread = [NSDate date];
-  if (self.reportGenerated) {
-    self.reportGenerated = NO;
-    // Remove information about the last session info.
-    [[NSUserDefaults standardUserDefaults]
-        removeObjectForKey:@(kNsUserDefaultKeyLastSessionInfo)];
-    LogRecoveryTime(base::Seconds(
-        [[NSDate date] timeIntervalSinceDate:oldLastSeenMainThread]));
-    // Restart the freeze detection.
-    dispatch_async(_freezeDetectionQueue, ^{
-      [self cleanAndRunInFreezeDetectionQueue];
-    });
+- (void)mainThreadRecoveredFromHeartbeat:(int64_t)freezeHeartbeat {
+  // Remove information about the last session info.
+  [[NSUserDefaults standardUserDefaults]
+      removeObjectForKey:@(kNsUserDefaultKeyLastSessionInfo)];
+  LogRecoveryTime(base::TimeTicks::Now() - HeartbeatTime(freezeHeartbeat));
+  // Restart the freeze detection.
+  dispatch_async(_freezeDetectionQueue, ^{
+    [self cleanAndRunInFreezeDetectionQueue];
+  });
+}
+
+// Removes the heartbeat observer from all the modes of the main run loop.
+- (void)removeHeartbeatObserver {
+  CFRunLoopRef mainRunLoop = CFRunLoopGetMain();
+  CFRunLoopRemoveObserver(mainRunLoop, _heartbeatObserver,
+                          kCFRunLoopCommonModes);
+  base::ScopedCFTypeRef<CFArrayRef> modes(CFRunLoopCopyAllModes(mainRunLoop));
+  for (CFIndex i = 0; i < CFArrayGetCount(modes); ++i) {
+    CFRunLoopRemoveObserver(
+        mainRunLoop, _heartbeatObserver,
+        static_cast<CFRunLoopMode>(CFArrayGetValueAtIndex(modes, i)));
   }
-  if (!self.running) {
-    return;
+}
+
+// Adds the heartbeat observer to the mode the main run loop currently runs in,
+// if it is not observed yet. Returns whether it was added. A nested run loop in
+// a mode which is not one of the common modes, e.g. run by a system modal
+// API, would otherwise look like a freeze.
+- (BOOL)observeCurrentMainRunLoopMode {
+  CFRunLoopRef mainRunLoop = CFRunLoopGetMain();
+  base::ScopedCFTypeRef<CFRunLoopMode> mode(
+      CFRunLoopCopyCurrentMode(mainRunLoop));
+  if (!mode ||
+      CFRunLoopContainsObserver(mainRunLoop, _heartbeatObserver, mode)) {
+    return NO;
   }
-  dispatch_after(
-      dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.1 * NSEC_PER_SEC)),
-      dispatch_get_main_queue(), ^{
-        [self runInMainLoop];
-      });
+  CFRunLoopAddObserver(mainRunLoop, _heartbeatObserver, mode);
+  // The activities of the nested run loop were not observed so far, give it
+  // the whole delay.
+  _heartbeat->value.store(CurrentHeartbeat(), std::memory_order_relaxed);
+  return YES;
 }
 
 - (void)cleanAndRunInFreezeDetectionQueue {
@@ -228,6 +374,11 @@ bool IsMetricKitReport(crash_reporter::Report report) {
          withIntermediateDirectories:NO
                           attributes:nil
                                error:nil];
+  // The detection was stopped during the freeze.
+  if (!self.running) {
+    [self removeHeartbeatObserver];
+    return;
+  }
   [self runInFreezeDetectionQueue];
 }
 
@@ -235,16 +386,16 @@ bool IsMetricKitReport(crash_reporter::Report report) {
   if (!self.running) {
     return;
   }
-  if ([[NSDate date] timeIntervalSinceDate:self.lastSeenMainThread] >
-      self.delay) {
-    if (crash_reporter::IsCrashpadRunning()) {
+  const int64_t heartbeat = _heartbeat->value.load(std::memory_order_relaxed);
+  if (heartbeat != kMainThreadWaiting &&
+      base::TimeTicks::Now() - HeartbeatTime(heartbeat) >
+          base::Seconds(self.delay) &&
+      ![self observeCurrentMainRunLoopMode]) {
+    if (_hangSampleHandler || crash_reporter::IsCrashpadRunning()) {
       const base::TimeTicks start = base::TimeTicks::Now();
-      static crash_reporter::CrashKeyString<4> key("hang-report");
-      crash_reporter::ScopedCrashKeyString auto_clear(&key, "yes");
-      NSString* intermediate_dump = [_UTEDirectory
-          stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
-      base::FilePath path(base::SysNSStringToUTF8(intermediate_dump));
-      crash_reporter::DumpWithoutCrashAndDeferProcessingAtPath(path);
+      [self recordHangSample:0
+                   ofHangID:[[NSUUID UUID] UUIDString]
+                  heartbeat:heartbeat];
       if (!self.running) {
         UMA_HISTOGRAM_ENUMERATION(
             kUMAMainThreadFreezeDetectionNotRunningAfterReport,
@@ -256,7 +407,7 @@ bool IsMetricKitReport(crash_reporter::Report report) {
       [[NSUserDefaults standardUserDefaults]
           setObject:@{@"dump" : @"", @"config" : @"", @"date" : [NSDate date]}
              forKey:@(kNsUserDefaultKeyLastSessionInfo)];
-      self.reportGenerated = YES;
+      _heartbeat->report_pending.store(true);
       LogRecordHangGenerationTime(start);
       return;
     }
@@ -271,12 +422,56 @@ bool IsMetricKitReport(crash_reporter::Report report) {
   }
 
   dispatch_after(
-      dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)),
+      dispatch_time(DISPATCH_TIME_NOW, kFreezeDetectionIntervalNanoseconds),
       _freezeDetectionQueue, ^{
         [self runInFreezeDetectionQueue];
       });
 }
 
+// Captures the dump |sample| of the freeze |hangID|, which started after the
+// main thread |heartbeat|, then schedules the next sample as long as the main
+// thread doesn't recover. All the dumps of a freeze have the same "hang-id"
+// crash key, so that their main thread stacks are attached to the same report.
+- (void)recordHangSample:(int)sample
+                ofHangID:(NSString*)hangID
+               heartbeat:(int64_t)heartbeat {
+  if (_hangSampleHandler) {
+    _hangSampleHandler(hangID, sample);
+  } else {
+    [self captureHangSample:sample ofHangID:hangID];
+  }
+
+  if (sample + 1 >= kHangSampleCount)
+    return;
+  dispatch_after(
+      dispatch_time(DISPATCH_TIME_NOW,
+                    static_cast<int64_t>(_hangSampleInterval * NSEC_PER_SEC)),
+      _freezeDetectionQueue, ^{
+        // The freeze is over once the main thread heartbeat changed.
+        if (!self.running || self->_heartbeat->value.load(
+                                 std::memory_order_relaxed) != heartbeat) {
+          return;
+        }
+        [self recordHangSample:sample + 1 ofHangID:hangID heartbeat:heartbeat];
+      });
+}
+
+// Captures the dump |sample| of the freeze |hangID|.
+- (void)captureHangSample:(int)sample ofHangID:(NSString*)hangID {
+  static crash_reporter::CrashKeyString<4> key("hang-report");
+  static crash_reporter::CrashKeyString<40> hangIDKey("hang-id");
+  static crash_reporter::CrashKeyString<4> sampleKey("hang-sample");
+  crash_reporter::ScopedCrashKeyString auto_clear(&key, "yes");
+  crash_reporter::ScopedCrashKeyString auto_clear_hang_id(
+      &hangIDKey, base::SysNSStringToUTF8(hangID));
+  crash_reporter::ScopedCrashKeyString auto_clear_sample(
+      &sampleKey, base::NumberToString(sample));
+  NSString* intermediate_dump = [_UTEDirectory
+      stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  base::FilePath path(base::SysNSStringToUTF8(intermediate_dump));
+  crash_reporter::DumpWithoutCrashAndDeferProcessingAtPath(path);
+}
+
 - (void)recordHangWithBreakpadRef:(BreakpadRef)breakpadRef {
   if (!self.running) {
     UMA_HISTOGRAM_ENUMERATION(
@@ -322,7 +517,7 @@ bool IsMetricKitReport(crash_reporter::Report report) {
         @"date" : [NSDate date]
       }
          forKey:@(kNsUserDefaultKeyLastSessionInfo)];
-  self.reportGenerated = YES;
+  _heartbeat->report_pending.store(true);
 }
 
 - (void)processIntermediateDumps {
@@ -373,16 +568,23 @@ bool IsMetricKitReport(crash_reporter::Report report) {
   if (crash_reporter::IsCrashpadRunning()) {
     NSArray<NSString*>* UTEDirectoryContents =
         [fileManager contentsOfDirectoryAtPath:_UTEDirectory error:NULL];
-    if (UTEDirectoryContents.count != 1)
+    // The directory holds the samples of a single freeze.
+    if (!UTEDirectoryContents.count ||
+        UTEDirectoryContents.count > kHangSampleCount) {
       return;
+    }
 
-    // Backup hang_report to a new location. See -processIntermediateDumps for
-    // why this is necessary.
-    NSString* hang_report =
-        [_UTEDirectory stringByAppendingPathComponent:UTEDirectoryContents[0]];
-    NSString* save_hang_report = [_UTEPendingCrashpadDirectory
-        stringByAppendingPathComponent:UTEDirectoryContents[0]];
-    [fileManager moveItemAtPath:hang_report toPath:save_hang_report error:nil];
+    // Backup the hang reports to a new location. See -processIntermediateDumps
+    // for why this is necessary.
+    for (NSString* file in UTEDirectoryContents) {
+      NSString* hang_report =
+          [_UTEDirectory stringByAppendingPathComponent:file];
+      NSString* save_hang_report =
+          [_UTEPendingCrashpadDirectory stringByAppendingPathComponent:file];
+      [fileManager moveItemAtPath:hang_report
+                           toPath:save_hang_report
+                            error:nil];
+    }
     return;
   }
 
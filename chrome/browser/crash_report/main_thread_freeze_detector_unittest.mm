@@ -2,9 +2,15 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#import "ios/chrome/browser/crash_report/main_thread_freeze_detector.h"
+
 #import <Foundation/Foundation.h>
+#include <unistd.h>
 
+#include "base/mac/scoped_cftyperef.h"
 #import "base/test/ios/wait_util.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/time/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -14,7 +20,137 @@
 
 namespace {
 
-using MainThreadFreezeDetectorTest = PlatformTest;
+// Delay after which the main thread is considered frozen, and interval between
+// the samples of a freeze.
+const NSTimeInterval kFreezeDelay = 0.3;
+const NSTimeInterval kHangSampleInterval = 0.1;
+
+// Maximum duration of the freezes of the main thread in the tests.
+const base::TimeDelta kMaxFreezeDuration = base::Seconds(5);
+
+// Name of the histogram logged when the main thread recovers.
+const char kRecoveredAfterHistogram[] =
+    "IOS.MainThreadFreezeDetection.RecoveredAfter";
+
+class MainThreadFreezeDetectorTest : public PlatformTest {
+ protected:
+  MainThreadFreezeDetectorTest() : samples_([NSMutableArray array]) {
+    NSMutableArray* samples = samples_;
+    detector_ = [[MainThreadFreezeDetector alloc]
+             initWithDelay:kFreezeDelay
+        hangSampleInterval:kHangSampleInterval
+         hangSampleHandler:^(NSString* hangID, int sample) {
+           @synchronized(samples) {
+             [samples addObject:@[ hangID, @(sample) ]];
+           }
+         }];
+  }
+
+  ~MainThreadFreezeDetectorTest() override { [detector_ stop]; }
+
+  // Starts the detector and lets it observe the main run loop.
+  void StartDetector() {
+    [detector_ start];
+    base::test::ios::SpinRunLoopWithMinDelay(base::Milliseconds(50));
+  }
+
+  // Returns the hang samples reported so far, as [hang ID, sample index].
+  NSArray* Samples() {
+    @synchronized(samples_) {
+      return [samples_ copy];
+    }
+  }
+
+  // Blocks the main thread without running its run loop, until |count|
+  // samples were reported or for at most |kMaxFreezeDuration|.
+  void FreezeMainThreadUntilSampleCount(NSUInteger count) {
+    const base::TimeTicks end = base::TimeTicks::Now() + kMaxFreezeDuration;
+    while (Samples().count < count && base::TimeTicks::Now() < end)
+      usleep(10000);
+  }
+
+  // Runs the main run loop until the recovery of the main thread is logged.
+  bool WaitForRecovery() {
+    return base::test::ios::WaitUntilConditionOrTimeout(
+        base::test::ios::kWaitForActionTimeout, ^bool() {
+          return histogram_tester_.GetAllSamples(kRecoveredAfterHistogram)
+                     .size() > 0;
+        });
+  }
+
+  base::HistogramTester histogram_tester_;
+  NSMutableArray* samples_;
+  MainThreadFreezeDetector* detector_;
+};
+
+// Tests that a main thread which keeps running its run loop, while busy or
+// idle, is not considered frozen.
+TEST_F(MainThreadFreezeDetectorTest, HeartbeatWhileRunning) {
+  StartDetector();
+
+  const base::TimeTicks end =
+      base::TimeTicks::Now() + base::Seconds(4 * kFreezeDelay);
+  while (base::TimeTicks::Now() < end) {
+    // Busy for less than the delay between two run loop iterations.
+    usleep(static_cast<useconds_t>(kFreezeDelay *
+                                   base::Time::kMicrosecondsPerSecond / 3));
+    base::test::ios::SpinRunLoopWithMaxDelay(base::Milliseconds(1));
+  }
+  // Idle.
+  base::test::ios::SpinRunLoopWithMinDelay(base::Seconds(4 * kFreezeDelay));
+
+  EXPECT_EQ(0u, Samples().count);
+}
+
+// Tests that a freeze is sampled several times with the same hang ID, and that
+// the recovery is logged.
+TEST_F(MainThreadFreezeDetectorTest, SamplesShareHangID) {
+  StartDetector();
+
+  FreezeMainThreadUntilSampleCount(3);
+  NSArray* samples = Samples();
+  ASSERT_EQ(3u, samples.count);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NSEQ(samples[0][0], samples[i][0]);
+    EXPECT_NSEQ(@(i), samples[i][1]);
+  }
+
+  EXPECT_TRUE(WaitForRecovery());
+  histogram_tester_.ExpectTotalCount(kRecoveredAfterHistogram, 1);
+}
+
+// Tests that the recovery is logged if the detector is stopped during the
+// freeze.
+TEST_F(MainThreadFreezeDetectorTest, RecoveryAfterStop) {
+  StartDetector();
+
+  // The second sample is taken after the report is generated.
+  FreezeMainThreadUntilSampleCount(2);
+  ASSERT_LE(2u, Samples().count);
+  [detector_ stop];
+
+  EXPECT_TRUE(WaitForRecovery());
+  histogram_tester_.ExpectTotalCount(kRecoveredAfterHistogram, 1);
+}
+
+// Tests that a nested run loop in a mode which is not one of the common modes
+// is not considered frozen.
+TEST_F(MainThreadFreezeDetectorTest, NestedRunLoopInCustomMode) {
+  StartDetector();
+
+  CFStringRef mode = CFSTR("MainThreadFreezeDetectorTestMode");
+  base::ScopedCFTypeRef<CFRunLoopTimerRef> timer(
+      CFRunLoopTimerCreateWithHandler(
+          kCFAllocatorDefault, CFAbsoluteTimeGetCurrent(), /*interval=*/0.01,
+          /*flags=*/0, /*order=*/0, ^(CFRunLoopTimerRef) {
+          }));
+  CFRunLoopAddTimer(CFRunLoopGetMain(), timer, mode);
+  CFRunLoopRunInMode(mode, 4 * kFreezeDelay,
+                     /*returnAfterSourceHandled=*/false);
+  CFRunLoopTimerInvalidate(timer);
+
+  EXPECT_EQ(0u, Samples().count);
+}
 
 // Tests that moving a file preserves the NSFileModificationDate.
 TEST_F(MainThreadFreezeDetectorTest, FileMoveSameModificationDate) {
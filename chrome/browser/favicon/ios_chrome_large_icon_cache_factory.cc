@@ -4,11 +4,12 @@
 
 #include "ios/chrome/browser/favicon/ios_chrome_large_icon_cache_factory.h"
 
-#include "base/memory/ptr_util.h"
+#include "base/files/file_path.h"
 #include "base/no_destructor.h"
 #include "components/keyed_service/ios/browser_state_dependency_manager.h"
 #include "ios/chrome/browser/browser_state/browser_state_otr_helper.h"
 #include "ios/chrome/browser/browser_state/chrome_browser_state.h"
+#include "ios/chrome/browser/chrome_constants.h"
 #include "ios/chrome/browser/favicon/large_icon_cache.h"
 
 // static
@@ -34,7 +35,22 @@ IOSChromeLargeIconCacheFactory::~IOSChromeLargeIconCacheFactory() {}
 std::unique_ptr<KeyedService>
 IOSChromeLargeIconCacheFactory::BuildServiceInstanceFor(
     web::BrowserState* context) const {
-  return base::WrapUnique(new LargeIconCache);
+  ChromeBrowserState* browser_state =
+      ChromeBrowserState::FromBrowserState(context);
+  // The icons of the off-the-record browser state are not persisted.
+  base::FilePath store_path;
+  if (!browser_state->IsOffTheRecord()) {
+    store_path =
+        browser_state->GetStatePath().Append(kIOSChromeLargeIconCacheFilename);
+  }
+  return std::make_unique<LargeIconCache>(store_path,
+                                          LargeIconCache::kDefaultMaxBytes);
+}
+
+bool IOSChromeLargeIconCacheFactory::ServiceIsCreatedWithBrowserState() const {
+  // Created early so that the persisted icons are loaded before the NTP is
+  // displayed.
+  return true;
 }
 
 web::BrowserState* IOSChromeLargeIconCacheFactory::GetBrowserStateToUse(
@@ -4,56 +4,297 @@
 
 #include "ios/chrome/browser/favicon/large_icon_cache.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/pickle.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/thread_pool.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "components/favicon_base/fallback_icon_style.h"
 #include "components/favicon_base/favicon_types.h"
-#include "url/gurl.h"
 
 namespace {
 
-const int kMaxCacheSize = 12;
+// Version of the store format, to be incremented when it changes.
+const int kStoreVersion = 1;
+
+// Maximum number of entries written to the store, enough for the most
+// visited tiles of the NTP.
+const size_t kMaxPersistedEntries = 12;
+
+// Delay before the store is written after the cache changed.
+constexpr base::TimeDelta kWriteDelay = base::Seconds(10);
+
+// Returns the content of the store at |path|, or an empty string if there is
+// no store.
+std::string ReadStore(const base::FilePath& path) {
+  std::string data;
+  if (!base::ReadFileToString(path, &data))
+    return std::string();
+  return data;
+}
+
+// Writes |data| to the store at |path|.
+void WriteStoreData(const base::FilePath& path, const std::string& data) {
+  base::ImportantFileWriter::WriteFileAtomically(path, data);
+}
+
+// Returns the number of bytes used by |result|.
+size_t GetResultByteSize(const favicon_base::LargeIconResult& result) {
+  size_t byte_size = sizeof(result);
+  if (result.bitmap.bitmap_data)
+    byte_size += result.bitmap.bitmap_data->size();
+  if (result.fallback_icon_style)
+    byte_size += sizeof(*result.fallback_icon_style);
+  return byte_size;
+}
+
+// Writes |result| cached for |url| to |pickle|.
+void WriteResult(const GURL& url,
+                 const favicon_base::LargeIconResult& result,
+                 base::Pickle* pickle) {
+  pickle->WriteString(url.spec());
+  const bool has_bitmap = result.bitmap.is_valid();
+  pickle->WriteBool(has_bitmap);
+  if (has_bitmap) {
+    pickle->WriteString(result.bitmap.icon_url.spec());
+    pickle->WriteInt(static_cast<int>(result.bitmap.icon_type));
+    pickle->WriteInt(result.bitmap.pixel_size.width());
+    pickle->WriteInt(result.bitmap.pixel_size.height());
+    pickle->WriteData(result.bitmap.bitmap_data->front_as<char>(),
+                      result.bitmap.bitmap_data->size());
+  } else {
+    pickle->WriteUInt32(result.fallback_icon_style->background_color);
+    pickle->WriteUInt32(result.fallback_icon_style->text_color);
+    pickle->WriteBool(result.fallback_icon_style->is_default_background_color);
+  }
+}
+
+// Reads a result written by WriteResult() from |iterator|, and sets |url| to
+// the URL it was cached for. Returns null if the data is invalid.
+std::unique_ptr<favicon_base::LargeIconResult> ReadResult(
+    base::PickleIterator* iterator,
+    GURL* url) {
+  std::string url_spec;
+  bool has_bitmap = false;
+  if (!iterator->ReadString(&url_spec) || !iterator->ReadBool(&has_bitmap))
+    return nullptr;
+  *url = GURL(url_spec);
+
+  if (!has_bitmap) {
+    auto style = std::make_unique<favicon_base::FallbackIconStyle>();
+    if (!iterator->ReadUInt32(&style->background_color) ||
+        !iterator->ReadUInt32(&style->text_color) ||
+        !iterator->ReadBool(&style->is_default_background_color)) {
+      return nullptr;
+    }
+    return std::make_unique<favicon_base::LargeIconResult>(style.release());
+  }
+
+  std::string icon_url_spec;
+  int icon_type = 0;
+  int width = 0;
+  int height = 0;
+  const char* data = nullptr;
+  size_t length = 0;
+  if (!iterator->ReadString(&icon_url_spec) || !iterator->ReadInt(&icon_type) ||
+      !iterator->ReadInt(&width) || !iterator->ReadInt(&height) ||
+      !iterator->ReadData(&data, &length)) {
+    return nullptr;
+  }
+  if (icon_type < 0 ||
+      icon_type > static_cast<int>(favicon_base::IconType::kMax)) {
+    return nullptr;
+  }
+
+  favicon_base::FaviconRawBitmapResult bitmap;
+  bitmap.bitmap_data = base::MakeRefCounted<base::RefCountedBytes>(
+      reinterpret_cast<const unsigned char*>(data), length);
+  bitmap.pixel_size = gfx::Size(width, height);
+  bitmap.icon_url = GURL(icon_url_spec);
+  bitmap.icon_type = static_cast<favicon_base::IconType>(icon_type);
+  if (!url->is_valid() || !bitmap.is_valid())
+    return nullptr;
+  return std::make_unique<favicon_base::LargeIconResult>(bitmap);
+}
 
 }  // namespace
 
 struct LargeIconCacheEntry {
-  LargeIconCacheEntry() {}
+  explicit LargeIconCacheEntry(
+      std::unique_ptr<favicon_base::LargeIconResult> result)
+      : result(std::move(result)),
+        byte_size(GetResultByteSize(*this->result)) {}
   ~LargeIconCacheEntry() {}
 
   std::unique_ptr<favicon_base::LargeIconResult> result;
+  // Number of bytes used by |result|.
+  size_t byte_size;
 };
 
-LargeIconCache::LargeIconCache() : cache_(kMaxCacheSize) {}
+LargeIconCache::LargeIconCache()
+    : LargeIconCache(base::FilePath(), kDefaultMaxBytes) {}
+
+LargeIconCache::LargeIconCache(const base::FilePath& store_path,
+                               size_t max_bytes)
+    : cache_(Cache::NO_AUTO_EVICT),
+      max_bytes_(max_bytes),
+      store_path_(store_path) {
+  if (store_path_.empty())
+    return;
+
+  // The store is read as soon as the cache is created, so that the icons are
+  // available when the NTP is first displayed.
+  store_task_runner_ = base::ThreadPool::CreateSequencedTaskRunner(
+      {base::MayBlock(), base::TaskPriority::USER_BLOCKING,
+       base::TaskShutdownBehavior::BLOCK_SHUTDOWN});
+  store_task_runner_->PostTaskAndReplyWithResult(
+      FROM_HERE, base::BindOnce(&ReadStore, store_path_),
+      base::BindOnce(&LargeIconCache::OnStoreLoaded,
+                     weak_ptr_factory_.GetWeakPtr()));
+}
 
 LargeIconCache::~LargeIconCache() {}
 
+void LargeIconCache::Shutdown() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (write_timer_.IsRunning()) {
+    write_timer_.Stop();
+    WriteStore();
+  }
+}
+
 void LargeIconCache::SetCachedResult(
     const GURL& url,
     const favicon_base::LargeIconResult& result) {
-  std::unique_ptr<LargeIconCacheEntry> entry(new LargeIconCacheEntry);
-  entry->result = CloneLargeIconResult(result);
-  cache_.Put(url, std::move(entry));
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::unique_ptr<favicon_base::LargeIconResult> copy;
+  if (result.bitmap.is_valid()) {
+    // The bitmap data is shared with |result|, not copied.
+    copy = std::make_unique<favicon_base::LargeIconResult>(result.bitmap);
+  } else {
+    copy = std::make_unique<favicon_base::LargeIconResult>(
+        new favicon_base::FallbackIconStyle(*result.fallback_icon_style));
+  }
+  PutEntry(url, std::make_unique<LargeIconCacheEntry>(std::move(copy)));
+
+  if (!store_path_.empty()) {
+    write_timer_.Start(FROM_HERE, kWriteDelay,
+                       base::BindOnce(&LargeIconCache::WriteStore,
+                                      base::Unretained(this)));
+  }
 }
 
-std::unique_ptr<favicon_base::LargeIconResult> LargeIconCache::GetCachedResult(
+void LargeIconCache::Clear(base::OnceClosure callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  cache_.Clear();
+  byte_size_ = 0;
+  if (store_path_.empty()) {
+    base::SequencedTaskRunnerHandle::Get()->PostTask(FROM_HERE,
+                                                     std::move(callback));
+    return;
+  }
+
+  // Drop the pending write, and the store being loaded if any, so that the
+  // cleared icons are not restored.
+  write_timer_.Stop();
+  weak_ptr_factory_.InvalidateWeakPtrs();
+  // The deletion is sequenced after the writes already posted.
+  store_task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::BindOnce(base::IgnoreResult(&base::DeleteFile), store_path_),
+      std::move(callback));
+}
+
+const favicon_base::LargeIconResult* LargeIconCache::GetCachedResult(
     const GURL& url) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   auto iter = cache_.Get(url);
+  if (iter == cache_.end())
+    return nullptr;
+  DCHECK(iter->second->result);
+  return iter->second->result.get();
+}
+
+void LargeIconCache::PutEntry(const GURL& url,
+                              std::unique_ptr<LargeIconCacheEntry> entry) {
+  auto iter = cache_.Peek(url);
   if (iter != cache_.end()) {
-    DCHECK(iter->second->result);
-    return CloneLargeIconResult(*iter->second->result.get());
+    byte_size_ -= iter->second->byte_size;
+    cache_.Erase(iter);
   }
 
-  return nullptr;
+  // An icon larger than the whole budget is not cached.
+  if (entry->byte_size > max_bytes_)
+    return;
+
+  byte_size_ += entry->byte_size;
+  cache_.Put(url, std::move(entry));
+  while (byte_size_ > max_bytes_) {
+    auto oldest = cache_.rbegin();
+    byte_size_ -= oldest->second->byte_size;
+    cache_.Erase(oldest);
+  }
 }
 
-std::unique_ptr<favicon_base::LargeIconResult>
-LargeIconCache::CloneLargeIconResult(
-    const favicon_base::LargeIconResult& large_icon_result) {
-  std::unique_ptr<favicon_base::LargeIconResult> clone;
-  if (large_icon_result.bitmap.is_valid()) {
-    clone.reset(new favicon_base::LargeIconResult(large_icon_result.bitmap));
-  } else {
-    clone.reset(
-        new favicon_base::LargeIconResult(new favicon_base::FallbackIconStyle(
-            *large_icon_result.fallback_icon_style.get())));
+void LargeIconCache::OnStoreLoaded(std::string data) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (data.empty())
+    return;
+
+  base::Pickle pickle(data.data(), data.size());
+  base::PickleIterator iterator(pickle);
+  int version = 0;
+  int count = 0;
+  if (!iterator.ReadInt(&version) || version != kStoreVersion ||
+      !iterator.ReadInt(&count) || count < 0) {
+    return;
+  }
+
+  std::vector<std::pair<GURL, std::unique_ptr<favicon_base::LargeIconResult>>>
+      entries;
+  for (int i = 0; i < count; ++i) {
+    GURL url;
+    std::unique_ptr<favicon_base::LargeIconResult> result =
+        ReadResult(&iterator, &url);
+    if (!result)
+      break;
+    entries.emplace_back(url, std::move(result));
   }
-  return clone;
+
+  // The entries are stored from the most recently used, and are inserted in
+  // reverse order to keep that order. The icons set since the cache was
+  // created are fresher and are kept.
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    if (cache_.Peek(it->first) != cache_.end())
+      continue;
+    PutEntry(it->first,
+             std::make_unique<LargeIconCacheEntry>(std::move(it->second)));
+  }
+}
+
+void LargeIconCache::WriteStore() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!store_path_.empty());
+  const size_t count = std::min(cache_.size(), kMaxPersistedEntries);
+
+  base::Pickle pickle;
+  pickle.WriteInt(kStoreVersion);
+  pickle.WriteInt(static_cast<int>(count));
+  size_t written = 0;
+  for (auto iter = cache_.begin(); written < count; ++iter, ++written)
+    WriteResult(iter->first, *iter->second->result, &pickle);
+
+  store_task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WriteStoreData, store_path_,
+                     std::string(static_cast<const char*>(pickle.data()),
+                                 pickle.size())));
 }
@@ -5,50 +5,108 @@
 #ifndef IOS_CHROME_BROWSER_FAVICON_LARGE_ICON_CACHE_H_
 #define IOS_CHROME_BROWSER_FAVICON_LARGE_ICON_CACHE_H_
 
+#include <stddef.h>
+
 #include <memory>
+#include <string>
 
+#include "base/callback_forward.h"
 #include "base/containers/lru_cache.h"
+#include "base/files/file_path.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/timer/timer.h"
 #include "components/keyed_service/core/keyed_service.h"
+#include "url/gurl.h"
 
-class GURL;
 struct LargeIconCacheEntry;
 
+namespace base {
+class SequencedTaskRunner;
+}
+
 namespace favicon_base {
 struct LargeIconResult;
 }
 
-// Provides a cache of most recently used LargeIconResult.
+// Provides a cache of most recently used LargeIconResult, bounded by the
+// memory used by the cached icons. When created with a store path, the most
+// recently used icons are also persisted to disk, and loaded back on the next
+// launch, so that they are available before LargeIconService replies.
 //
 // Example usage:
 //   LargeIconCache* large_icon_cache =
 //       IOSChromeLargeIconServiceFactory::GetForBrowserState(browser_state);
-//   std::unique_ptr<favicon_base::LargeIconResult> icon =
+//   const favicon_base::LargeIconResult* icon =
 //       large_icon_cache->GetCachedResult(...);
 //
 class LargeIconCache : public KeyedService {
  public:
+  // Default number of bytes used by the cached icons.
+  static constexpr size_t kDefaultMaxBytes = 1024 * 1024;
+
+  // Creates an in-memory cache using at most kDefaultMaxBytes.
   LargeIconCache();
 
+  // Creates a cache using at most |max_bytes|, persisted to |store_path| if it
+  // is not empty.
+  LargeIconCache(const base::FilePath& store_path, size_t max_bytes);
+
   LargeIconCache(const LargeIconCache&) = delete;
   LargeIconCache& operator=(const LargeIconCache&) = delete;
 
   ~LargeIconCache() override;
 
+  // KeyedService implementation.
+  void Shutdown() override;
+
   // |LargeIconService| does everything on callbacks, and iOS needs to load the
   // icons immediately on page load. This caches the LargeIconResult so we can
-  // immediately load.
+  // immediately load.
   void SetCachedResult(const GURL& url, const favicon_base::LargeIconResult&);
 
-  // Returns a cached LargeIconResult.
-  std::unique_ptr<favicon_base::LargeIconResult> GetCachedResult(
-      const GURL& url);
+  // Returns the cached LargeIconResult, or null. The result is not copied and
+  // its bitmap data is shared, so it must not be modified, nor kept after the
+  // cache changes.
+  const favicon_base::LargeIconResult* GetCachedResult(const GURL& url);
+
+  // Removes all the cached icons, and deletes the store since it records the
+  // URLs of recently visited pages. Calls |callback| once done.
+  void Clear(base::OnceClosure callback);
+
+  // Returns the number of bytes used by the cached icons.
+  size_t byte_size() const { return byte_size_; }
 
  private:
-  // Clones a LargeIconResult.
-  std::unique_ptr<favicon_base::LargeIconResult> CloneLargeIconResult(
-      const favicon_base::LargeIconResult& large_icon_result);
+  // Caches |entry| for |url|, and evicts the least recently used entries over
+  // the byte budget.
+  void PutEntry(const GURL& url, std::unique_ptr<LargeIconCacheEntry> entry);
+
+  // Called with the content of the store once it has been read.
+  void OnStoreLoaded(std::string data);
+
+  // Writes the most recently used entries to the store.
+  void WriteStore();
+
+  using Cache = base::LRUCache<GURL, std::unique_ptr<LargeIconCacheEntry>>;
+  Cache cache_;
+
+  const size_t max_bytes_;
+  size_t byte_size_ = 0;
+
+  // Store of the most recently used entries, empty if the cache is not
+  // persisted.
+  const base::FilePath store_path_;
+  scoped_refptr<base::SequencedTaskRunner> store_task_runner_;
+
+  // Delays the writes of the store, so that consecutive changes are written
+  // at once.
+  base::OneShotTimer write_timer_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
 
-  base::LRUCache<GURL, std::unique_ptr<LargeIconCacheEntry>> cache_;
+  base::WeakPtrFactory<LargeIconCache> weak_ptr_factory_{this};
 };
 
 #endif  // IOS_CHROME_BROWSER_FAVICON_LARGE_ICON_CACHE_H_
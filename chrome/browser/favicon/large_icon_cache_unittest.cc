@@ -4,6 +4,11 @@
 
 #include "ios/chrome/browser/favicon/large_icon_cache.h"
 
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
 #include "components/favicon_base/fallback_icon_style.h"
 #include "components/favicon_base/favicon_types.h"
 #include "skia/ext/skia_utils_ios.h"
@@ -15,6 +20,7 @@ namespace {
 
 const char kDummyUrl[] = "http://www.example.com";
 const char kDummyUrl2[] = "http://www.example2.com";
+const char kDummyUrl3[] = "http://www.example3.com";
 const SkColor kTestColor = SK_ColorRED;
 
 favicon_base::FaviconRawBitmapResult CreateTestBitmap(int w,
@@ -54,6 +60,7 @@ class LargeIconCacheTest : public PlatformTest {
   ~LargeIconCacheTest() override {}
 
  protected:
+  base::test::TaskEnvironment task_environment_;
   std::unique_ptr<LargeIconCache> large_icon_cache_;
   favicon_base::FaviconRawBitmapResult expected_bitmap_;
   std::unique_ptr<favicon_base::FallbackIconStyle>
@@ -77,12 +84,14 @@ TEST_F(LargeIconCacheTest, RetreiveItem) {
   large_icon_cache_->SetCachedResult(GURL(kDummyUrl), *expected_result1);
   large_icon_cache_->SetCachedResult(GURL(kDummyUrl2), *expected_result2);
 
-  std::unique_ptr<favicon_base::LargeIconResult> result1 =
+  const favicon_base::LargeIconResult* result1 =
       large_icon_cache_->GetCachedResult(GURL(kDummyUrl));
   EXPECT_EQ(true, result1->bitmap.is_valid());
   EXPECT_EQ(expected_result1->bitmap.pixel_size, result1->bitmap.pixel_size);
+  // The bitmap data is shared with the cached result.
+  EXPECT_EQ(expected_bitmap_.bitmap_data, result1->bitmap.bitmap_data);
 
-  std::unique_ptr<favicon_base::LargeIconResult> result2 =
+  const favicon_base::LargeIconResult* result2 =
       large_icon_cache_->GetCachedResult(GURL(kDummyUrl2));
   EXPECT_EQ(false, result2->bitmap.is_valid());
   EXPECT_EQ(expected_result2->fallback_icon_style->background_color,
@@ -91,7 +100,7 @@ TEST_F(LargeIconCacheTest, RetreiveItem) {
 
   // Test overwriting kDummyUrl.
   large_icon_cache_->SetCachedResult(GURL(kDummyUrl), *expected_result2);
-  std::unique_ptr<favicon_base::LargeIconResult> result3 =
+  const favicon_base::LargeIconResult* result3 =
       large_icon_cache_->GetCachedResult(GURL(kDummyUrl2));
   EXPECT_EQ(false, result3->bitmap.is_valid());
   EXPECT_EQ(expected_result2->fallback_icon_style->background_color,
@@ -99,4 +108,135 @@ TEST_F(LargeIconCacheTest, RetreiveItem) {
   EXPECT_FALSE(result2->fallback_icon_style->is_default_background_color);
 }
 
+// Tests that the least recently used icons are evicted once the cached icons
+// use more than the byte budget.
+TEST_F(LargeIconCacheTest, EvictOverByteBudget) {
+  favicon_base::LargeIconResult result(expected_bitmap_);
+  LargeIconCache large_icon_cache(base::FilePath(), 1);
+  large_icon_cache.SetCachedResult(GURL(kDummyUrl), result);
+  EXPECT_FALSE(large_icon_cache.GetCachedResult(GURL(kDummyUrl)));
+  EXPECT_EQ(0u, large_icon_cache.byte_size());
+
+  // Computes the size of an entry in a cache large enough.
+  large_icon_cache_->SetCachedResult(GURL(kDummyUrl), result);
+  const size_t entry_size = large_icon_cache_->byte_size();
+  ASSERT_LT(expected_bitmap_.bitmap_data->size(), entry_size);
+
+  LargeIconCache small_cache(base::FilePath(), 2 * entry_size);
+  small_cache.SetCachedResult(GURL(kDummyUrl), result);
+  small_cache.SetCachedResult(GURL(kDummyUrl2), result);
+  EXPECT_TRUE(small_cache.GetCachedResult(GURL(kDummyUrl)));
+  small_cache.SetCachedResult(GURL(kDummyUrl3), result);
+  EXPECT_EQ(2 * entry_size, small_cache.byte_size());
+  EXPECT_TRUE(small_cache.GetCachedResult(GURL(kDummyUrl)));
+  EXPECT_FALSE(small_cache.GetCachedResult(GURL(kDummyUrl2)));
+  EXPECT_TRUE(small_cache.GetCachedResult(GURL(kDummyUrl3)));
+
+  // Replacing an icon does not count it twice.
+  small_cache.SetCachedResult(GURL(kDummyUrl), result);
+  EXPECT_EQ(2 * entry_size, small_cache.byte_size());
+}
+
+// Tests that the cached icons are loaded back from the store.
+TEST_F(LargeIconCacheTest, Persistence) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath store_path = temp_dir.GetPath().AppendASCII("Store");
+
+  LargeIconCache writing_cache(store_path, LargeIconCache::kDefaultMaxBytes);
+  task_environment_.RunUntilIdle();
+  writing_cache.SetCachedResult(
+      GURL(kDummyUrl), favicon_base::LargeIconResult(expected_bitmap_));
+  writing_cache.SetCachedResult(
+      GURL(kDummyUrl2),
+      favicon_base::LargeIconResult(
+          new favicon_base::FallbackIconStyle(*expected_fallback_icon_style_)));
+  writing_cache.Shutdown();
+  task_environment_.RunUntilIdle();
+
+  LargeIconCache reading_cache(store_path, LargeIconCache::kDefaultMaxBytes);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(writing_cache.byte_size(), reading_cache.byte_size());
+
+  const favicon_base::LargeIconResult* result1 =
+      reading_cache.GetCachedResult(GURL(kDummyUrl));
+  ASSERT_TRUE(result1);
+  ASSERT_TRUE(result1->bitmap.is_valid());
+  EXPECT_EQ(expected_bitmap_.pixel_size, result1->bitmap.pixel_size);
+  EXPECT_EQ(expected_bitmap_.icon_url, result1->bitmap.icon_url);
+  EXPECT_EQ(expected_bitmap_.icon_type, result1->bitmap.icon_type);
+  EXPECT_TRUE(expected_bitmap_.bitmap_data->Equals(
+      result1->bitmap.bitmap_data));
+
+  const favicon_base::LargeIconResult* result2 =
+      reading_cache.GetCachedResult(GURL(kDummyUrl2));
+  ASSERT_TRUE(result2);
+  EXPECT_FALSE(result2->bitmap.is_valid());
+  ASSERT_TRUE(result2->fallback_icon_style);
+  EXPECT_EQ(kTestColor, result2->fallback_icon_style->background_color);
+  EXPECT_FALSE(result2->fallback_icon_style->is_default_background_color);
+}
+
+// Tests that the icons set before the store is loaded are not replaced by the
+// persisted ones.
+TEST_F(LargeIconCacheTest, PersistenceKeepsFreshIcons) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath store_path = temp_dir.GetPath().AppendASCII("Store");
+
+  LargeIconCache writing_cache(store_path, LargeIconCache::kDefaultMaxBytes);
+  task_environment_.RunUntilIdle();
+  writing_cache.SetCachedResult(
+      GURL(kDummyUrl), favicon_base::LargeIconResult(expected_bitmap_));
+  writing_cache.Shutdown();
+  task_environment_.RunUntilIdle();
+
+  LargeIconCache reading_cache(store_path, LargeIconCache::kDefaultMaxBytes);
+  reading_cache.SetCachedResult(
+      GURL(kDummyUrl),
+      favicon_base::LargeIconResult(
+          new favicon_base::FallbackIconStyle(*expected_fallback_icon_style_)));
+  task_environment_.RunUntilIdle();
+
+  const favicon_base::LargeIconResult* result =
+      reading_cache.GetCachedResult(GURL(kDummyUrl));
+  ASSERT_TRUE(result);
+  EXPECT_FALSE(result->bitmap.is_valid());
+}
+
+// Tests that clearing the cache removes the cached icons and deletes the
+// store, so that the icons are not loaded back.
+TEST_F(LargeIconCacheTest, Clear) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath store_path = temp_dir.GetPath().AppendASCII("Store");
+
+  LargeIconCache writing_cache(store_path, LargeIconCache::kDefaultMaxBytes);
+  task_environment_.RunUntilIdle();
+  writing_cache.SetCachedResult(
+      GURL(kDummyUrl), favicon_base::LargeIconResult(expected_bitmap_));
+  writing_cache.Shutdown();
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(base::PathExists(store_path));
+
+  LargeIconCache cache(store_path, LargeIconCache::kDefaultMaxBytes);
+  task_environment_.RunUntilIdle();
+  cache.SetCachedResult(GURL(kDummyUrl2),
+                        favicon_base::LargeIconResult(expected_bitmap_));
+  ASSERT_TRUE(cache.GetCachedResult(GURL(kDummyUrl)));
+
+  base::RunLoop run_loop;
+  cache.Clear(run_loop.QuitClosure());
+  EXPECT_FALSE(cache.GetCachedResult(GURL(kDummyUrl)));
+  EXPECT_FALSE(cache.GetCachedResult(GURL(kDummyUrl2)));
+  EXPECT_EQ(0u, cache.byte_size());
+  run_loop.Run();
+  EXPECT_FALSE(base::PathExists(store_path));
+
+  // The icon set before the clear is not written back.
+  cache.Shutdown();
+  task_environment_.RunUntilIdle();
+  EXPECT_FALSE(base::PathExists(store_path));
+}
+
 }  // namespace
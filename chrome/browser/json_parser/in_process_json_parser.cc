@@ -4,14 +4,78 @@
 
 #include "ios/chrome/browser/json_parser/in_process_json_parser.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/json/json_reader.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/task/thread_pool.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/values.h"
 
 namespace {
+
+// Returns the message reported to the error callback for |error|.
+std::string FormatError(const base::JSONReader::Error& error) {
+  return base::StringPrintf("%s (%d:%d)", error.message.c_str(), error.line,
+                            error.column);
+}
+
+// Returns the position of the first character of |json| after |position|
+// which is not a whitespace.
+size_t SkipWhitespace(base::StringPiece json, size_t position) {
+  while (position < json.size() && base::IsAsciiWhitespace(json[position]))
+    ++position;
+  return position;
+}
+
+// Returns the position of the ',' or ']' which ends the array element starting
+// at |begin| in |json|, or base::StringPiece::npos if the array is not
+// terminated. Only the nesting of the element is followed; its syntax is
+// checked when it is parsed.
+size_t FindElementEnd(base::StringPiece json, size_t begin) {
+  int depth = 0;
+  bool in_string = false;
+  bool escaped = false;
+  for (size_t position = begin; position < json.size(); ++position) {
+    const char c = json[position];
+    if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (c == '\\') {
+        escaped = true;
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+    switch (c) {
+      case '"':
+        in_string = true;
+        break;
+      case '[':
+      case '{':
+        ++depth;
+        break;
+      case ']':
+      case '}':
+        if (depth == 0)
+          return c == ']' ? position : base::StringPiece::npos;
+        --depth;
+        break;
+      case ',':
+        if (depth == 0)
+          return position;
+        break;
+    }
+  }
+  return base::StringPiece::npos;
+}
+
 void ParseJsonOnBackgroundThread(
     scoped_refptr<base::TaskRunner> task_runner,
     const std::string& unsafe_json,
@@ -27,22 +91,170 @@ void ParseJsonOnBackgroundThread(
   } else {
     task_runner->PostTask(
         FROM_HERE, base::BindOnce(std::move(error_callback),
-                                  base::StringPrintf(
-                                      "%s (%d:%d)",
-                                      value_with_error.error().message.c_str(),
-                                      value_with_error.error().line,
-                                      value_with_error.error().column)));
+                                  FormatError(value_with_error.error())));
+  }
+}
+
+// Maximum number of elements parsed by a single task of
+// InProcessJsonParser::ParseArrayElements().
+constexpr size_t kMaxBatchElements = 64;
+
+// Size of the JSON after which a task of
+// InProcessJsonParser::ParseArrayElements() stops parsing elements. The
+// element crossing that size is still part of the batch.
+constexpr size_t kMaxBatchBytes = 64 * 1024;
+
+// State of the parsing of the elements of an array. It is moved between the
+// thread pool, which parses a batch of elements, and the calling thread, which
+// runs the element callback with each of them and only then asks for the next
+// batch.
+struct ArrayElementsParse {
+  std::string unsafe_json;
+  base::TaskPriority priority = base::TaskPriority::BEST_EFFORT;
+  scoped_refptr<base::TaskRunner> task_runner;
+  InProcessJsonParser::ElementCallback element_callback;
+  base::OnceClosure completion_callback;
+  InProcessJsonParser::ErrorCallback error_callback;
+
+  // Position of the next element in |unsafe_json|, or 0 before the opening
+  // '['.
+  size_t position = 0;
+  // Whether the closing ']' was reached.
+  bool terminated = false;
+};
+
+// Runs the error callback of |parse| on the calling thread.
+void PostArrayElementsError(std::unique_ptr<ArrayElementsParse> parse,
+                            const std::string& error) {
+  parse->task_runner->PostTask(
+      FROM_HERE, base::BindOnce(std::move(parse->error_callback), error));
+}
+
+void ParseNextArrayElementsOnBackgroundThread(
+    std::unique_ptr<ArrayElementsParse> parse);
+
+// Runs the element callback of |parse| with each of |elements| on the calling
+// thread, then parses the next batch.
+void RunArrayElementCallback(std::unique_ptr<ArrayElementsParse> parse,
+                             std::vector<base::Value> elements) {
+  for (base::Value& element : elements)
+    parse->element_callback.Run(std::move(element));
+  elements.clear();
+  const base::TaskPriority priority = parse->priority;
+  base::ThreadPool::PostTask(
+      FROM_HERE, {base::MayBlock(), priority},
+      base::BindOnce(&ParseNextArrayElementsOnBackgroundThread,
+                     std::move(parse)));
+}
+
+void ParseNextArrayElementsOnBackgroundThread(
+    std::unique_ptr<ArrayElementsParse> parse) {
+  DCHECK(parse->task_runner);
+  base::StringPiece json(parse->unsafe_json);
+  size_t position = parse->position;
+  if (!position) {
+    position = SkipWhitespace(json, 0);
+    if (position == json.size() || json[position] != '[') {
+      PostArrayElementsError(std::move(parse), "Expected an array");
+      return;
+    }
+    position = SkipWhitespace(json, position + 1);
+    if (position < json.size() && json[position] == ']') {
+      parse->terminated = true;
+      ++position;
+    }
+  }
+
+  if (parse->terminated) {
+    if (SkipWhitespace(json, position) != json.size()) {
+      PostArrayElementsError(std::move(parse),
+                             "Unexpected data after the array");
+      return;
+    }
+    parse->task_runner->PostTask(FROM_HERE,
+                                 std::move(parse->completion_callback));
+    return;
+  }
+
+  // The elements are parsed one by one, and handed to the calling thread in
+  // batches bounded both in count and in size. The next batch is only parsed
+  // once the calling thread handled the previous one. An error or the end of
+  // the array ends the batch; they are reported by the next task, after the
+  // elements before them.
+  std::vector<base::Value> elements;
+  const size_t batch_begin = position;
+  while (!parse->terminated && elements.size() < kMaxBatchElements &&
+         position - batch_begin < kMaxBatchBytes) {
+    const size_t end = FindElementEnd(json, position);
+    if (end == base::StringPiece::npos) {
+      if (elements.empty()) {
+        PostArrayElementsError(std::move(parse), "Unterminated array");
+        return;
+      }
+      break;
+    }
+
+    auto value_with_error = base::JSONReader::ReadAndReturnValueWithError(
+        json.substr(position, end - position), base::JSON_PARSE_RFC);
+    if (!value_with_error.has_value()) {
+      if (elements.empty()) {
+        PostArrayElementsError(std::move(parse),
+                               FormatError(value_with_error.error()));
+        return;
+      }
+      break;
+    }
+    elements.push_back(std::move(*value_with_error));
+    parse->terminated = json[end] == ']';
+    position = end + 1;
   }
+  parse->position = position;
+
+  scoped_refptr<base::TaskRunner> task_runner = parse->task_runner;
+  task_runner->PostTask(
+      FROM_HERE, base::BindOnce(&RunArrayElementCallback, std::move(parse),
+                                std::move(elements)));
 }
+
 }  // namespace
 
 // static
 void InProcessJsonParser::Parse(const std::string& unsafe_json,
                                 SuccessCallback success_callback,
                                 ErrorCallback error_callback) {
+  ParseWithPriority(unsafe_json, base::TaskPriority::BEST_EFFORT,
+                    std::move(success_callback), std::move(error_callback));
+}
+
+// static
+void InProcessJsonParser::ParseWithPriority(std::string unsafe_json,
+                                            base::TaskPriority priority,
+                                            SuccessCallback success_callback,
+                                            ErrorCallback error_callback) {
   base::ThreadPool::PostTask(
-      FROM_HERE, {base::MayBlock(), base::TaskPriority::BEST_EFFORT},
+      FROM_HERE, {base::MayBlock(), priority},
       base::BindOnce(&ParseJsonOnBackgroundThread,
-                     base::ThreadTaskRunnerHandle::Get(), unsafe_json,
-                     std::move(success_callback), std::move(error_callback)));
+                     base::ThreadTaskRunnerHandle::Get(),
+                     std::move(unsafe_json), std::move(success_callback),
+                     std::move(error_callback)));
+}
+
+// static
+void InProcessJsonParser::ParseArrayElements(
+    std::string unsafe_json,
+    base::TaskPriority priority,
+    ElementCallback element_callback,
+    base::OnceClosure completion_callback,
+    ErrorCallback error_callback) {
+  auto parse = std::make_unique<ArrayElementsParse>();
+  parse->unsafe_json = std::move(unsafe_json);
+  parse->priority = priority;
+  parse->task_runner = base::ThreadTaskRunnerHandle::Get();
+  parse->element_callback = std::move(element_callback);
+  parse->completion_callback = std::move(completion_callback);
+  parse->error_callback = std::move(error_callback);
+  base::ThreadPool::PostTask(
+      FROM_HERE, {base::MayBlock(), priority},
+      base::BindOnce(&ParseNextArrayElementsOnBackgroundThread,
+                     std::move(parse)));
 }
@@ -9,6 +9,7 @@
 #include <string>
 
 #include "base/callback.h"
+#include "base/task/task_traits.h"
 
 namespace base {
 class Value;
@@ -26,13 +27,38 @@ class InProcessJsonParser {
  public:
   using SuccessCallback = base::OnceCallback<void(base::Value)>;
   using ErrorCallback = base::OnceCallback<void(const std::string&)>;
+  using ElementCallback = base::RepeatingCallback<void(base::Value)>;
 
   // As with SafeJsonParser, runs either |success_callback| or |error_callback|
-  // on the calling thread, but not before the call returns.
+  // on the calling thread, but not before the call returns. |unsafe_json| is
+  // copied, and parsed with a BEST_EFFORT priority.
   static void Parse(const std::string& unsafe_json,
                     SuccessCallback success_callback,
                     ErrorCallback error_callback);
 
+  // Same as Parse(), but takes ownership of |unsafe_json| instead of copying
+  // it, and parses it with |priority|.
+  static void ParseWithPriority(std::string unsafe_json,
+                                base::TaskPriority priority,
+                                SuccessCallback success_callback,
+                                ErrorCallback error_callback);
+
+  // Parses |unsafe_json|, which must hold a JSON array, in small batches of
+  // elements, with |priority|. Runs |element_callback| with each element of
+  // the array, in order. The next batch is only parsed after
+  // |element_callback| returned for all the elements of the previous one, so
+  // at most one batch of parsed elements waits for the calling thread and no
+  // base::Value holds the whole array. |unsafe_json| itself is kept until the
+  // end of the parse. Then runs either |completion_callback|, or
+  // |error_callback| if |unsafe_json| is not a valid array. The elements
+  // before the error are still passed to |element_callback|. All the callbacks
+  // are run on the calling thread, but not before the call returns.
+  static void ParseArrayElements(std::string unsafe_json,
+                                 base::TaskPriority priority,
+                                 ElementCallback element_callback,
+                                 base::OnceClosure completion_callback,
+                                 ErrorCallback error_callback);
+
   InProcessJsonParser() = delete;
 };
 
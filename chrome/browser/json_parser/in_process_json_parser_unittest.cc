@@ -4,11 +4,20 @@
 
 #include "ios/chrome/browser/json_parser/in_process_json_parser.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/run_loop.h"
 #include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
 
 TEST(InProcessJsonParserTest, TestSuccess) {
   base::test::TaskEnvironment environment;
@@ -53,3 +62,237 @@ TEST(InProcessJsonParserTest, TestFailure) {
           run_loop.QuitClosure()));
   run_loop.Run();
 }
+
+TEST(InProcessJsonParserTest, TestParseWithPriority) {
+  base::test::TaskEnvironment environment;
+
+  base::RunLoop run_loop;
+  InProcessJsonParser::ParseWithPriority(
+      R"json({"key": 1})json", base::TaskPriority::USER_VISIBLE,
+      base::BindOnce(
+          [](base::OnceClosure quit_closure, base::Value value) {
+            ASSERT_TRUE(value.is_dict());
+            ASSERT_TRUE(value.FindIntKey("key"));
+            EXPECT_EQ(1, *value.FindIntKey("key"));
+            std::move(quit_closure).Run();
+          },
+          run_loop.QuitClosure()),
+      base::BindOnce(
+          [](base::OnceClosure quit_closure, const std::string& error) {
+            EXPECT_FALSE(true) << "unexpected json parse error: " << error;
+            std::move(quit_closure).Run();
+          },
+          run_loop.QuitClosure()));
+  run_loop.Run();
+}
+
+namespace {
+
+// Result of InProcessJsonParser::ParseArrayElements().
+struct ArrayElementsResult {
+  std::vector<base::Value> elements;
+  bool completed = false;
+  std::string error;
+};
+
+// Parses |unsafe_json| with InProcessJsonParser::ParseArrayElements() and
+// returns the result.
+ArrayElementsResult ParseArrayElements(const std::string& unsafe_json) {
+  ArrayElementsResult result;
+  base::RunLoop run_loop;
+  InProcessJsonParser::ParseArrayElements(
+      unsafe_json, base::TaskPriority::USER_VISIBLE,
+      base::BindRepeating(
+          [](ArrayElementsResult* result, base::Value value) {
+            EXPECT_FALSE(result->completed);
+            result->elements.push_back(std::move(value));
+          },
+          &result),
+      base::BindOnce(
+          [](base::OnceClosure quit_closure, ArrayElementsResult* result) {
+            result->completed = true;
+            std::move(quit_closure).Run();
+          },
+          run_loop.QuitClosure(), &result),
+      base::BindOnce(
+          [](base::OnceClosure quit_closure, ArrayElementsResult* result,
+             const std::string& error) {
+            result->error = error;
+            std::move(quit_closure).Run();
+          },
+          run_loop.QuitClosure(), &result));
+  run_loop.Run();
+  return result;
+}
+
+}  // namespace
+
+TEST(InProcessJsonParserTest, TestParseArrayElements) {
+  base::test::TaskEnvironment environment;
+
+  ArrayElementsResult result = ParseArrayElements(
+      R"json( [1, "a,]\"}", {"key": [2, 3]}, [], null] )json");
+  EXPECT_TRUE(result.completed);
+  EXPECT_TRUE(result.error.empty());
+  ASSERT_EQ(5u, result.elements.size());
+  EXPECT_EQ(base::Value(1), result.elements[0]);
+  EXPECT_EQ(base::Value("a,]\"}"), result.elements[1]);
+  ASSERT_TRUE(result.elements[2].is_dict());
+  const base::Value* list = result.elements[2].FindListKey("key");
+  ASSERT_TRUE(list);
+  EXPECT_EQ(2u, list->GetList().size());
+  EXPECT_TRUE(result.elements[3].is_list());
+  EXPECT_TRUE(result.elements[4].is_none());
+}
+
+TEST(InProcessJsonParserTest, TestParseEmptyArrayElements) {
+  base::test::TaskEnvironment environment;
+
+  ArrayElementsResult result = ParseArrayElements(" [ ] ");
+  EXPECT_TRUE(result.completed);
+  EXPECT_TRUE(result.error.empty());
+  EXPECT_TRUE(result.elements.empty());
+}
+
+TEST(InProcessJsonParserTest, TestParseArrayElementsFailure) {
+  base::test::TaskEnvironment environment;
+
+  // The elements before the invalid one are still returned.
+  ArrayElementsResult result = ParseArrayElements("[1, 2, invalid, 3]");
+  EXPECT_FALSE(result.completed);
+  EXPECT_FALSE(result.error.empty());
+  EXPECT_EQ(2u, result.elements.size());
+
+  for (const char* unsafe_json :
+       {"", R"json({"key": 1})json", "[1, 2", "[1, 2,]", "[1, {]", "[1] 2"}) {
+    result = ParseArrayElements(unsafe_json);
+    EXPECT_FALSE(result.completed) << unsafe_json;
+    EXPECT_FALSE(result.error.empty()) << unsafe_json;
+  }
+}
+
+namespace {
+
+// Returns a JSON array of |count| small dictionaries.
+std::string CreateLargeArray(size_t count) {
+  std::string unsafe_json = "[";
+  for (size_t i = 0; i < count; ++i) {
+    if (i)
+      unsafe_json += ",";
+    unsafe_json += R"json({"id": "element", "values": [1, 2, 3]})json";
+  }
+  unsafe_json += "]";
+  return unsafe_json;
+}
+
+}  // namespace
+
+// Checks that a large array is returned element by element.
+TEST(InProcessJsonParserTest, TestParseLargeArrayElements) {
+  base::test::TaskEnvironment environment;
+
+  const size_t kElementCount = 10000;
+  ArrayElementsResult result =
+      ParseArrayElements(CreateLargeArray(kElementCount));
+  EXPECT_TRUE(result.completed);
+  EXPECT_EQ(kElementCount, result.elements.size());
+}
+
+// Checks that an error far in a large array is reported after all the
+// elements before it.
+TEST(InProcessJsonParserTest, TestParseLargeArrayElementsFailure) {
+  base::test::TaskEnvironment environment;
+
+  const size_t kElementCount = 1000;
+  std::string unsafe_json = CreateLargeArray(kElementCount);
+  unsafe_json.insert(unsafe_json.size() - 1, ", invalid");
+  ArrayElementsResult result = ParseArrayElements(unsafe_json);
+  EXPECT_FALSE(result.completed);
+  EXPECT_FALSE(result.error.empty());
+  EXPECT_EQ(kElementCount, result.elements.size());
+}
+
+// Compares the latency and the peak memory used by the parsed values when a
+// large array is parsed at once, and element by element.
+TEST(InProcessJsonParserTest, ParseArrayElementsPerformance) {
+  base::test::TaskEnvironment environment;
+
+  const size_t kElementCount = 50000;
+  const std::string unsafe_json = CreateLargeArray(kElementCount);
+
+  // Parse the whole array at once. All the parsed values are held together.
+  size_t whole_array_bytes = 0;
+  base::ElapsedTimer whole_array_timer;
+  {
+    base::RunLoop run_loop;
+    InProcessJsonParser::ParseWithPriority(
+        unsafe_json, base::TaskPriority::USER_VISIBLE,
+        base::BindOnce(
+            [](base::OnceClosure quit_closure, size_t* bytes,
+               base::Value value) {
+              *bytes = value.EstimateMemoryUsage();
+              std::move(quit_closure).Run();
+            },
+            run_loop.QuitClosure(), &whole_array_bytes),
+        base::BindOnce([](const std::string& error) {
+          ADD_FAILURE() << "unexpected json parse error: " << error;
+        }));
+    run_loop.Run();
+  }
+  const base::TimeDelta whole_array_time = whole_array_timer.Elapsed();
+
+  // Parse the array element by element. The elements of a batch are handed to
+  // the calling thread by a single task, so the values held at once are the
+  // ones received before a task posted with the first of them runs.
+  struct BatchMemory {
+    size_t batch_bytes = 0;
+    size_t peak_bytes = 0;
+    size_t element_count = 0;
+  } batch_memory;
+  base::ElapsedTimer elements_timer;
+  {
+    base::RunLoop run_loop;
+    InProcessJsonParser::ParseArrayElements(
+        unsafe_json, base::TaskPriority::USER_VISIBLE,
+        base::BindRepeating(
+            [](BatchMemory* memory, base::Value value) {
+              if (!memory->batch_bytes) {
+                base::ThreadTaskRunnerHandle::Get()->PostTask(
+                    FROM_HERE, base::BindOnce(
+                                   [](BatchMemory* memory) {
+                                     memory->peak_bytes =
+                                         std::max(memory->peak_bytes,
+                                                  memory->batch_bytes);
+                                     memory->batch_bytes = 0;
+                                   },
+                                   memory));
+              }
+              memory->batch_bytes += value.EstimateMemoryUsage();
+              ++memory->element_count;
+            },
+            &batch_memory),
+        run_loop.QuitClosure(),
+        base::BindOnce([](const std::string& error) {
+          ADD_FAILURE() << "unexpected json parse error: " << error;
+        }));
+    run_loop.Run();
+  }
+  const base::TimeDelta elements_time = elements_timer.Elapsed();
+  EXPECT_EQ(kElementCount, batch_memory.element_count);
+  EXPECT_LT(batch_memory.peak_bytes, whole_array_bytes);
+
+  // Log the results for performance tracking.
+  perf_test::PrintResult("InProcessJsonParser", "", "50000 elements, whole",
+                         whole_array_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+  perf_test::PrintResult("InProcessJsonParser", "", "50000 elements, batches",
+                         elements_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+  perf_test::PrintResult("InProcessJsonParser", "",
+                         "50000 elements, whole, peak values",
+                         whole_array_bytes, "bytes", true /* "important" */);
+  perf_test::PrintResult("InProcessJsonParser", "",
+                         "50000 elements, batches, peak values",
+                         batch_memory.peak_bytes, "bytes",
+                         true /* "important" */);
+}
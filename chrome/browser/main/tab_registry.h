@@ -0,0 +1,140 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_MAIN_TAB_REGISTRY_H_
+#define IOS_CHROME_BROWSER_MAIN_TAB_REGISTRY_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/scoped_multi_source_observation.h"
+#include "base/scoped_observation.h"
+#include "base/time/time.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "ios/chrome/browser/main/browser_list.h"
+#include "ios/chrome/browser/main/browser_list_observer.h"
+#include "ios/chrome/browser/web_state_list/web_state_list.h"
+#include "ios/chrome/browser/web_state_list/web_state_list_observer.h"
+#include "ios/web/public/web_state.h"
+#include "ios/web/public/web_state_observer.h"
+
+class GURL;
+
+// TabRegistry keeps indexes of the tabs of all the Browsers of a BrowserList,
+// so that questions about all the open tabs can be answered without visiting
+// every WebStateList. Tabs are indexed by visible URL, and regular tabs by
+// last active time.
+class TabRegistry : public KeyedService,
+                    public BrowserListObserver,
+                    public WebStateListObserver,
+                    public web::WebStateObserver {
+ public:
+  explicit TabRegistry(BrowserList* browser_list);
+
+  TabRegistry(const TabRegistry&) = delete;
+  TabRegistry& operator=(const TabRegistry&) = delete;
+
+  ~TabRegistry() override;
+
+  // Returns whether a tab of the regular Browsers, or of the incognito
+  // Browsers if |incognito| is true, has |url| as visible URL and is not the
+  // active tab of its Browser.
+  bool HasInactiveTabWithURL(const GURL& url, bool incognito) const;
+
+  // Returns the tabs of the regular Browsers which were last active at or
+  // after |time|, most recently active first.
+  std::vector<web::WebState*> GetRegularTabsActiveSince(base::Time time) const;
+
+  // KeyedService:
+  void Shutdown() override;
+
+  // BrowserListObserver:
+  void OnBrowserAdded(const BrowserList* browser_list,
+                      Browser* browser) override;
+  void OnIncognitoBrowserAdded(const BrowserList* browser_list,
+                               Browser* browser) override;
+  void OnBrowserRemoved(const BrowserList* browser_list,
+                        Browser* browser) override;
+  void OnIncognitoBrowserRemoved(const BrowserList* browser_list,
+                                 Browser* browser) override;
+  void OnBrowserListShutdown(BrowserList* browser_list) override;
+
+  // WebStateListObserver:
+  void WebStateInsertedAt(WebStateList* web_state_list,
+                          web::WebState* web_state,
+                          int index,
+                          bool activating) override;
+  void WebStateReplacedAt(WebStateList* web_state_list,
+                          web::WebState* old_web_state,
+                          web::WebState* new_web_state,
+                          int index) override;
+  void WebStateDetachedAt(WebStateList* web_state_list,
+                          web::WebState* web_state,
+                          int index) override;
+
+  // web::WebStateObserver:
+  void WasShown(web::WebState* web_state) override;
+  void DidStartNavigation(web::WebState* web_state,
+                          web::NavigationContext* navigation_context) override;
+  void DidRedirectNavigation(
+      web::WebState* web_state,
+      web::NavigationContext* navigation_context) override;
+  void DidFinishNavigation(web::WebState* web_state,
+                           web::NavigationContext* navigation_context) override;
+  void WebStateDestroyed(web::WebState* web_state) override;
+
+ private:
+  // A registered tab, with the values it is indexed by.
+  struct Entry {
+    WebStateList* web_state_list = nullptr;
+    bool incognito = false;
+    std::string visible_url;
+    base::Time last_active_time;
+  };
+
+  // Starts or stops following the WebStateList of |browser| and its tabs.
+  void AddBrowser(Browser* browser, bool incognito);
+  void RemoveBrowser(Browser* browser);
+
+  // Starts or stops following |web_state|.
+  void AddWebState(web::WebState* web_state, WebStateList* web_state_list);
+  void RemoveWebState(web::WebState* web_state);
+
+  // Adds |entry| of |web_state| to the indexes, or removes it.
+  void Index(web::WebState* web_state, const Entry& entry);
+  void Unindex(web::WebState* web_state, const Entry& entry);
+
+  // Updates the indexes after a change of |web_state|.
+  void Update(web::WebState* web_state);
+
+  // Stops all the observations and forgets about all the tabs.
+  void Reset();
+
+  base::ScopedObservation<BrowserList, BrowserListObserver>
+      browser_list_observation_{this};
+  base::ScopedMultiSourceObservation<WebStateList, WebStateListObserver>
+      web_state_list_observations_{this};
+  base::ScopedMultiSourceObservation<web::WebState, web::WebStateObserver>
+      web_state_observations_{this};
+
+  // Followed WebStateLists, and whether they belong to incognito Browsers.
+  std::map<WebStateList*, bool> web_state_lists_;
+
+  // Registered tabs.
+  std::map<web::WebState*, Entry> entries_;
+
+  // Tabs by visible URL spec.
+  std::unordered_map<std::string, std::set<web::WebState*>>
+      web_states_by_url_;
+
+  // Regular tabs ordered by last active time.
+  std::set<std::pair<base::Time, web::WebState*>>
+      regular_web_states_by_last_active_time_;
+};
+
+#endif  // IOS_CHROME_BROWSER_MAIN_TAB_REGISTRY_H_
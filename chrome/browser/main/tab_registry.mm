@@ -0,0 +1,226 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/main/tab_registry.h"
+
+#import "ios/chrome/browser/main/browser.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+TabRegistry::TabRegistry(BrowserList* browser_list) {
+  DCHECK(browser_list);
+  browser_list_observation_.Observe(browser_list);
+  for (Browser* browser : browser_list->AllRegularBrowsers())
+    AddBrowser(browser, /*incognito=*/false);
+  for (Browser* browser : browser_list->AllIncognitoBrowsers())
+    AddBrowser(browser, /*incognito=*/true);
+}
+
+TabRegistry::~TabRegistry() = default;
+
+bool TabRegistry::HasInactiveTabWithURL(const GURL& url,
+                                        bool incognito) const {
+  auto it = web_states_by_url_.find(url.possibly_invalid_spec());
+  if (it == web_states_by_url_.end())
+    return false;
+
+  for (web::WebState* web_state : it->second) {
+    const Entry& entry = entries_.at(web_state);
+    if (entry.incognito == incognito &&
+        entry.web_state_list->GetActiveWebState() != web_state) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<web::WebState*> TabRegistry::GetRegularTabsActiveSince(
+    base::Time time) const {
+  std::vector<web::WebState*> web_states;
+  for (auto it = regular_web_states_by_last_active_time_.rbegin();
+       it != regular_web_states_by_last_active_time_.rend() &&
+       it->first >= time;
+       ++it) {
+    web_states.push_back(it->second);
+  }
+  return web_states;
+}
+
+#pragma mark - KeyedService
+
+void TabRegistry::Shutdown() {
+  Reset();
+}
+
+#pragma mark - BrowserListObserver
+
+void TabRegistry::OnBrowserAdded(const BrowserList* browser_list,
+                                 Browser* browser) {
+  AddBrowser(browser, /*incognito=*/false);
+}
+
+void TabRegistry::OnIncognitoBrowserAdded(const BrowserList* browser_list,
+                                          Browser* browser) {
+  AddBrowser(browser, /*incognito=*/true);
+}
+
+void TabRegistry::OnBrowserRemoved(const BrowserList* browser_list,
+                                   Browser* browser) {
+  RemoveBrowser(browser);
+}
+
+void TabRegistry::OnIncognitoBrowserRemoved(const BrowserList* browser_list,
+                                            Browser* browser) {
+  RemoveBrowser(browser);
+}
+
+void TabRegistry::OnBrowserListShutdown(BrowserList* browser_list) {
+  Reset();
+}
+
+#pragma mark - WebStateListObserver
+
+void TabRegistry::WebStateInsertedAt(WebStateList* web_state_list,
+                                     web::WebState* web_state,
+                                     int index,
+                                     bool activating) {
+  AddWebState(web_state, web_state_list);
+}
+
+void TabRegistry::WebStateReplacedAt(WebStateList* web_state_list,
+                                     web::WebState* old_web_state,
+                                     web::WebState* new_web_state,
+                                     int index) {
+  RemoveWebState(old_web_state);
+  AddWebState(new_web_state, web_state_list);
+}
+
+void TabRegistry::WebStateDetachedAt(WebStateList* web_state_list,
+                                     web::WebState* web_state,
+                                     int index) {
+  RemoveWebState(web_state);
+}
+
+#pragma mark - web::WebStateObserver
+
+void TabRegistry::WasShown(web::WebState* web_state) {
+  Update(web_state);
+}
+
+void TabRegistry::DidStartNavigation(
+    web::WebState* web_state,
+    web::NavigationContext* navigation_context) {
+  Update(web_state);
+}
+
+void TabRegistry::DidRedirectNavigation(
+    web::WebState* web_state,
+    web::NavigationContext* navigation_context) {
+  Update(web_state);
+}
+
+void TabRegistry::DidFinishNavigation(
+    web::WebState* web_state,
+    web::NavigationContext* navigation_context) {
+  Update(web_state);
+}
+
+void TabRegistry::WebStateDestroyed(web::WebState* web_state) {
+  RemoveWebState(web_state);
+}
+
+#pragma mark - Private
+
+void TabRegistry::AddBrowser(Browser* browser, bool incognito) {
+  WebStateList* web_state_list = browser->GetWebStateList();
+  if (!web_state_lists_.emplace(web_state_list, incognito).second)
+    return;
+  web_state_list_observations_.AddObservation(web_state_list);
+  for (int index = 0; index < web_state_list->count(); ++index)
+    AddWebState(web_state_list->GetWebStateAt(index), web_state_list);
+}
+
+void TabRegistry::RemoveBrowser(Browser* browser) {
+  WebStateList* web_state_list = browser->GetWebStateList();
+  if (!web_state_lists_.erase(web_state_list))
+    return;
+  web_state_list_observations_.RemoveObservation(web_state_list);
+  for (int index = 0; index < web_state_list->count(); ++index)
+    RemoveWebState(web_state_list->GetWebStateAt(index));
+}
+
+void TabRegistry::AddWebState(web::WebState* web_state,
+                              WebStateList* web_state_list) {
+  DCHECK(web_state_lists_.count(web_state_list));
+  RemoveWebState(web_state);
+
+  Entry entry;
+  entry.web_state_list = web_state_list;
+  entry.incognito = web_state_lists_[web_state_list];
+  entry.visible_url = web_state->GetVisibleURL().possibly_invalid_spec();
+  entry.last_active_time = web_state->GetLastActiveTime();
+  Index(web_state, entry);
+  entries_[web_state] = std::move(entry);
+  web_state_observations_.AddObservation(web_state);
+}
+
+void TabRegistry::RemoveWebState(web::WebState* web_state) {
+  auto it = entries_.find(web_state);
+  if (it == entries_.end())
+    return;
+  Unindex(web_state, it->second);
+  entries_.erase(it);
+  web_state_observations_.RemoveObservation(web_state);
+}
+
+void TabRegistry::Index(web::WebState* web_state, const Entry& entry) {
+  web_states_by_url_[entry.visible_url].insert(web_state);
+  if (!entry.incognito && !entry.last_active_time.is_null()) {
+    regular_web_states_by_last_active_time_.emplace(entry.last_active_time,
+                                                    web_state);
+  }
+}
+
+void TabRegistry::Unindex(web::WebState* web_state, const Entry& entry) {
+  auto it = web_states_by_url_.find(entry.visible_url);
+  DCHECK(it != web_states_by_url_.end());
+  it->second.erase(web_state);
+  if (it->second.empty())
+    web_states_by_url_.erase(it);
+  regular_web_states_by_last_active_time_.erase(
+      {entry.last_active_time, web_state});
+}
+
+void TabRegistry::Update(web::WebState* web_state) {
+  auto it = entries_.find(web_state);
+  if (it == entries_.end())
+    return;
+
+  Entry& entry = it->second;
+  std::string visible_url = web_state->GetVisibleURL().possibly_invalid_spec();
+  const base::Time last_active_time = web_state->GetLastActiveTime();
+  if (entry.visible_url == visible_url &&
+      entry.last_active_time == last_active_time) {
+    return;
+  }
+
+  Unindex(web_state, entry);
+  entry.visible_url = std::move(visible_url);
+  entry.last_active_time = last_active_time;
+  Index(web_state, entry);
+}
+
+void TabRegistry::Reset() {
+  web_state_observations_.RemoveAllObservations();
+  web_state_list_observations_.RemoveAllObservations();
+  browser_list_observation_.Reset();
+
+  web_state_lists_.clear();
+  entries_.clear();
+  web_states_by_url_.clear();
+  regular_web_states_by_last_active_time_.clear();
+}
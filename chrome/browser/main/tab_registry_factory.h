@@ -0,0 +1,40 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_MAIN_TAB_REGISTRY_FACTORY_H_
+#define IOS_CHROME_BROWSER_MAIN_TAB_REGISTRY_FACTORY_H_
+
+#include "base/no_destructor.h"
+#include "components/keyed_service/ios/browser_state_keyed_service_factory.h"
+
+class ChromeBrowserState;
+class TabRegistry;
+
+// Keyed service factory for TabRegistry.
+// Like the BrowserList, the same instance is returned for regular and OTR
+// browser states.
+class TabRegistryFactory : public BrowserStateKeyedServiceFactory {
+ public:
+  // Convenience getter that typecasts the value returned to a TabRegistry.
+  static TabRegistry* GetForBrowserState(ChromeBrowserState* browser_state);
+  // Getter for singleton instance.
+  static TabRegistryFactory* GetInstance();
+
+  // Not copyable or moveable.
+  TabRegistryFactory(const TabRegistryFactory&) = delete;
+  TabRegistryFactory& operator=(const TabRegistryFactory&) = delete;
+
+ private:
+  friend class base::NoDestructor<TabRegistryFactory>;
+
+  TabRegistryFactory();
+
+  // BrowserStateKeyedServiceFactory:
+  std::unique_ptr<KeyedService> BuildServiceInstanceFor(
+      web::BrowserState* context) const override;
+  web::BrowserState* GetBrowserStateToUse(
+      web::BrowserState* context) const override;
+};
+
+#endif  // IOS_CHROME_BROWSER_MAIN_TAB_REGISTRY_FACTORY_H_
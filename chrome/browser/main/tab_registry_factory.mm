@@ -0,0 +1,53 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/main/tab_registry_factory.h"
+
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "components/keyed_service/ios/browser_state_dependency_manager.h"
+#include "ios/chrome/browser/browser_state/browser_state_otr_helper.h"
+#include "ios/chrome/browser/browser_state/chrome_browser_state.h"
+#import "ios/chrome/browser/main/browser_list_factory.h"
+#import "ios/chrome/browser/main/tab_registry.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+// static
+TabRegistry* TabRegistryFactory::GetForBrowserState(
+    ChromeBrowserState* browser_state) {
+  return static_cast<TabRegistry*>(
+      GetInstance()->GetServiceForBrowserState(browser_state, true));
+}
+
+// static
+TabRegistryFactory* TabRegistryFactory::GetInstance() {
+  static base::NoDestructor<TabRegistryFactory> instance;
+  return instance.get();
+}
+
+TabRegistryFactory::TabRegistryFactory()
+    : BrowserStateKeyedServiceFactory(
+          "TabRegistry",
+          BrowserStateDependencyManager::GetInstance()) {
+  DependsOn(BrowserListFactory::GetInstance());
+}
+
+std::unique_ptr<KeyedService> TabRegistryFactory::BuildServiceInstanceFor(
+    web::BrowserState* context) const {
+  ChromeBrowserState* browser_state =
+      ChromeBrowserState::FromBrowserState(context);
+  return std::make_unique<TabRegistry>(
+      BrowserListFactory::GetForBrowserState(browser_state));
+}
+
+web::BrowserState* TabRegistryFactory::GetBrowserStateToUse(
+    web::BrowserState* context) const {
+  // Incognito browser states use the same service as regular browser states,
+  // as they share the BrowserList.
+  return GetBrowserStateRedirectedInIncognito(context);
+}
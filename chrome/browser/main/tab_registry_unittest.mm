@@ -0,0 +1,130 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/main/tab_registry.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/test/task_environment.h"
+#include "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
+#import "ios/chrome/browser/main/browser_list.h"
+#import "ios/chrome/browser/main/browser_list_factory.h"
+#import "ios/chrome/browser/main/tab_registry_factory.h"
+#import "ios/chrome/browser/main/test_browser.h"
+#import "ios/chrome/browser/web_state_list/web_state_list.h"
+#import "ios/chrome/browser/web_state_list/web_state_opener.h"
+#import "ios/web/public/test/fakes/fake_navigation_context.h"
+#import "ios/web/public/test/fakes/fake_web_state.h"
+#include "testing/platform_test.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+const char kURL0[] = "https://www.example.com/0000";
+const char kURL1[] = "https://www.example.com/1111";
+
+}  // namespace
+
+class TabRegistryTest : public PlatformTest {
+ protected:
+  TabRegistryTest() {
+    TestChromeBrowserState::Builder test_cbs_builder;
+    chrome_browser_state_ = test_cbs_builder.Build();
+
+    browser_list_ =
+        BrowserListFactory::GetForBrowserState(chrome_browser_state_.get());
+    browser_ = std::make_unique<TestBrowser>(chrome_browser_state_.get());
+    browser_list_->AddBrowser(browser_.get());
+    incognito_browser_ = std::make_unique<TestBrowser>(
+        chrome_browser_state_->GetOffTheRecordChromeBrowserState());
+    browser_list_->AddIncognitoBrowser(incognito_browser_.get());
+  }
+
+  TabRegistry* registry() {
+    return TabRegistryFactory::GetForBrowserState(chrome_browser_state_.get());
+  }
+
+  web::FakeWebState* AppendNewWebState(Browser* browser,
+                                       const GURL& url,
+                                       base::Time last_active_time) {
+    auto fake_web_state = std::make_unique<web::FakeWebState>();
+    fake_web_state->SetVisibleURL(url);
+    fake_web_state->SetLastActiveTime(last_active_time);
+    web::FakeWebState* inserted_web_state = fake_web_state.get();
+    browser->GetWebStateList()->InsertWebState(
+        WebStateList::kInvalidIndex, std::move(fake_web_state),
+        WebStateList::INSERT_NO_FLAGS, WebStateOpener());
+    return inserted_web_state;
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  std::unique_ptr<TestChromeBrowserState> chrome_browser_state_;
+  std::unique_ptr<Browser> browser_;
+  std::unique_ptr<Browser> incognito_browser_;
+  BrowserList* browser_list_;
+};
+
+// Tests that only inactive tabs of the requested kind are found by URL.
+TEST_F(TabRegistryTest, InactiveTabWithURL) {
+  const base::Time now = base::Time::Now();
+  AppendNewWebState(browser_.get(), GURL(kURL0), now);
+  EXPECT_TRUE(registry()->HasInactiveTabWithURL(GURL(kURL0), false));
+  EXPECT_FALSE(registry()->HasInactiveTabWithURL(GURL(kURL0), true));
+  EXPECT_FALSE(registry()->HasInactiveTabWithURL(GURL(kURL1), false));
+
+  browser_->GetWebStateList()->ActivateWebStateAt(0);
+  EXPECT_FALSE(registry()->HasInactiveTabWithURL(GURL(kURL0), false));
+
+  AppendNewWebState(incognito_browser_.get(), GURL(kURL1), now);
+  EXPECT_TRUE(registry()->HasInactiveTabWithURL(GURL(kURL1), true));
+  EXPECT_FALSE(registry()->HasInactiveTabWithURL(GURL(kURL1), false));
+}
+
+// Tests that the URL index follows navigations and closed tabs.
+TEST_F(TabRegistryTest, FollowsNavigations) {
+  web::FakeWebState* web_state =
+      AppendNewWebState(browser_.get(), GURL(kURL0), base::Time::Now());
+  web_state->SetVisibleURL(GURL(kURL1));
+  web::FakeNavigationContext context;
+  web_state->OnNavigationFinished(&context);
+  EXPECT_FALSE(registry()->HasInactiveTabWithURL(GURL(kURL0), false));
+  EXPECT_TRUE(registry()->HasInactiveTabWithURL(GURL(kURL1), false));
+
+  browser_->GetWebStateList()->CloseWebStateAt(0, WebStateList::CLOSE_NO_FLAGS);
+  EXPECT_FALSE(registry()->HasInactiveTabWithURL(GURL(kURL1), false));
+}
+
+// Tests that regular tabs are returned by recency, including tabs of Browsers
+// added after the registry was created.
+TEST_F(TabRegistryTest, RegularTabsActiveSince) {
+  const base::Time now = base::Time::Now();
+  web::WebState* recent =
+      AppendNewWebState(browser_.get(), GURL(kURL0), now - base::Seconds(1));
+  web::FakeWebState* old =
+      AppendNewWebState(browser_.get(), GURL(kURL1), now - base::Hours(2));
+  AppendNewWebState(incognito_browser_.get(), GURL(kURL0), now);
+  EXPECT_EQ(std::vector<web::WebState*>({recent}),
+            registry()->GetRegularTabsActiveSince(now - base::Hours(1)));
+
+  TestBrowser other_browser(chrome_browser_state_.get());
+  web::WebState* other =
+      AppendNewWebState(&other_browser, GURL(kURL1), now - base::Minutes(1));
+  browser_list_->AddBrowser(&other_browser);
+  EXPECT_EQ(std::vector<web::WebState*>({recent, other}),
+            registry()->GetRegularTabsActiveSince(now - base::Hours(1)));
+
+  // Showing a tab makes it the most recent.
+  old->WasShown();
+  EXPECT_EQ(std::vector<web::WebState*>({old, recent, other}),
+            registry()->GetRegularTabsActiveSince(now - base::Hours(1)));
+
+  browser_list_->RemoveBrowser(&other_browser);
+  EXPECT_EQ(std::vector<web::WebState*>({old, recent}),
+            registry()->GetRegularTabsActiveSince(now - base::Hours(1)));
+}
@@ -6,6 +6,8 @@
 
 #include "base/bind.h"
 #include "base/compiler_specific.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/time/time.h"
 #include "ios/chrome/browser/browser_state/chrome_browser_state_io_data.h"
 #include "ios/chrome/browser/ios_chrome_io_thread.h"
 #include "ios/web/public/thread/web_task_traits.h"
@@ -79,8 +81,11 @@ IOSChromeURLRequestContextGetter::GetURLRequestContext() {
 
   if (factory_.get()) {
     DCHECK(!url_request_context_);
+    const base::TimeTicks start_time = base::TimeTicks::Now();
     url_request_context_ = factory_->Create();
     factory_.reset();
+    UMA_HISTOGRAM_TIMES("IOS.URLRequestContext.CreationTime",
+                        base::TimeTicks::Now() - start_time);
   }
 
   return url_request_context_;
@@ -37,10 +37,10 @@ class PredictionManager;
 class HintsManager;
 }  // namespace optimization_guide
 
-class BrowserList;
 class OptimizationGuideLogger;
 class OptimizationGuideNavigationData;
 class PrefService;
+class TabRegistry;
 
 namespace web {
 class BrowserState;
@@ -73,7 +73,7 @@ class OptimizationGuideService
       base::WeakPtr<optimization_guide::OptimizationGuideStore>
           prediction_model_and_features_store,
       PrefService* pref_service,
-      BrowserList* browser_list,
+      TabRegistry* tab_registry,
       scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory,
       BackgroundDownloadServiceProvider background_download_service_provider);
   ~OptimizationGuideService() override;
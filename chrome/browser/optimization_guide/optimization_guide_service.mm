@@ -72,7 +72,7 @@ OptimizationGuideService::OptimizationGuideService(
     base::WeakPtr<optimization_guide::OptimizationGuideStore>
         prediction_model_and_features_store,
     PrefService* pref_service,
-    BrowserList* browser_list,
+    TabRegistry* tab_registry,
     scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory,
     BackgroundDownloadServiceProvider background_download_service_provider)
     : pref_service_(pref_service), off_the_record_(off_the_record) {
@@ -89,7 +89,7 @@ OptimizationGuideService::OptimizationGuideService(
     top_host_provider_ =
         optimization_guide::CommandLineTopHostProvider::CreateIfEnabled();
     tab_url_provider_ = std::make_unique<TabUrlProviderImpl>(
-        browser_list, base::DefaultClock::GetInstance());
+        tab_registry, base::DefaultClock::GetInstance());
     hint_store_ =
         optimization_guide::features::ShouldPersistHintsToDisk()
             ? std::make_unique<optimization_guide::OptimizationGuideStore>(
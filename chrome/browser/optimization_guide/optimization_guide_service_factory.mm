@@ -12,7 +12,7 @@
 #import "ios/chrome/browser/application_context.h"
 #include "ios/chrome/browser/browser_state/browser_state_otr_helper.h"
 #import "ios/chrome/browser/browser_state/chrome_browser_state.h"
-#import "ios/chrome/browser/main/browser_list_factory.h"
+#import "ios/chrome/browser/main/tab_registry_factory.h"
 #include "ios/chrome/browser/optimization_guide/ios_chrome_hints_manager.h"
 #import "ios/chrome/browser/optimization_guide/optimization_guide_service.h"
 #import "services/network/public/cpp/shared_url_loader_factory.h"
@@ -54,7 +54,7 @@ std::unique_ptr<KeyedService> BuildOptimizationGuideService(
       proto_db_provider, profile_path, chrome_browser_state->IsOffTheRecord(),
       GetApplicationContext()->GetApplicationLocale(), hint_store,
       prediction_model_and_features_store, chrome_browser_state->GetPrefs(),
-      BrowserListFactory::GetForBrowserState(chrome_browser_state),
+      TabRegistryFactory::GetForBrowserState(chrome_browser_state),
       chrome_browser_state->GetSharedURLLoaderFactory(),
       base::BindOnce(
           [](ChromeBrowserState* browser_state) {
@@ -90,7 +90,7 @@ OptimizationGuideServiceFactory::OptimizationGuideServiceFactory()
           "OptimizationGuideService",
           BrowserStateDependencyManager::GetInstance()) {
   DependsOn(BackgroundDownloadServiceFactory::GetInstance());
-  DependsOn(BrowserListFactory::GetInstance());
+  DependsOn(TabRegistryFactory::GetInstance());
 }
 
 OptimizationGuideServiceFactory::~OptimizationGuideServiceFactory() = default;
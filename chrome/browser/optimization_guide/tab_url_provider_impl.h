@@ -14,13 +14,13 @@ class Clock;
 class TimeDelta;
 }  // namespace base
 
-class BrowserList;
 class GURL;
+class TabRegistry;
 
 // optimization_guide::TabUrlProvider implementation for iOS.
 class TabUrlProviderImpl : public optimization_guide::TabUrlProvider {
  public:
-  TabUrlProviderImpl(BrowserList* browser_list, base::Clock* clock);
+  TabUrlProviderImpl(TabRegistry* tab_registry, base::Clock* clock);
   ~TabUrlProviderImpl() override;
 
  private:
@@ -29,7 +29,7 @@ class TabUrlProviderImpl : public optimization_guide::TabUrlProvider {
       const base::TimeDelta& duration_since_last_shown) override;
 
   // Used to get the URLs in all active tabs. Must out live this class.
-  BrowserList* browser_list_;
+  TabRegistry* tab_registry_;
 
   base::Clock* clock_;
 };
@@ -12,6 +12,7 @@
 #import "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
 #import "ios/chrome/browser/main/browser_list.h"
 #import "ios/chrome/browser/main/browser_list_factory.h"
+#import "ios/chrome/browser/main/tab_registry_factory.h"
 #import "ios/chrome/browser/main/test_browser.h"
 #import "ios/chrome/browser/web_state_list/web_state_list.h"
 #import "ios/chrome/browser/web_state_list/web_state_opener.h"
@@ -51,8 +52,8 @@ class TabUrlProviderImplTest : public PlatformTest {
     browser_list_->AddBrowser(other_browser_.get());
     browser_list_->AddIncognitoBrowser(incognito_browser_.get());
 
-    tab_url_provider_ =
-        std::make_unique<TabUrlProviderImpl>(browser_list_, &clock_);
+    tab_url_provider_ = std::make_unique<TabUrlProviderImpl>(
+        TabRegistryFactory::GetForBrowserState(browser_state_.get()), &clock_);
   }
 
   // Add a fake web state with certain URL and timestamp to be the last
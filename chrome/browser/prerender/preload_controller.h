@@ -65,6 +65,10 @@ class WebState;
 // Cancels any outstanding prerender requests and destroys any prerendered Tabs.
 - (void)cancelPrerender;
 
+// Same as |cancelPrerender|, called when the user navigated to a URL other
+// than the prerendered one, so that the prerender is recorded as wasted.
+- (void)cancelPrerenderAfterNavigationElsewhere;
+
 // Returns whether |webState| is the WebState used for pre-rendering.
 - (BOOL)isWebStatePrerendered:(web::WebState*)webState;
 
@@ -11,6 +11,7 @@
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/sys_string_conversions.h"
+#include "base/time/default_tick_clock.h"
 #include "base/time/time.h"
 #import "components/prefs/ios/pref_observer_bridge.h"
 #include "components/prefs/pref_service.h"
@@ -24,6 +25,7 @@
 #include "ios/chrome/browser/pref_names.h"
 #include "ios/chrome/browser/prerender/preload_controller_delegate.h"
 #import "ios/chrome/browser/prerender/prerender_pref.h"
+#include "ios/chrome/browser/prerender/prerender_scheduler.h"
 #import "ios/chrome/browser/signin/account_consistency_service_factory.h"
 #import "ios/chrome/browser/tabs/tab_helper_util.h"
 #import "ios/web/public/navigation/navigation_item.h"
@@ -42,6 +44,7 @@
 #endif
 
 using web::WebStatePolicyDecider;
+using WasteReason = PrerenderScheduler::WasteReason;
 
 // Protocol used to cancel a scheduled preload request.
 @protocol PreloadCancelling <NSObject>
@@ -63,9 +66,6 @@ enum PrerenderFinalStatus {
   PRERENDER_FINAL_STATUS_MAX = 52,
 };
 
-// Delay before starting to prerender a URL.
-const NSTimeInterval kPrerenderDelay = 0.5;
-
 // The finch experiment to turn off prerendering as a field trial.
 const char kTabEvictionFieldTrialName[] = "TabEviction";
 // The associated group.
@@ -255,6 +255,13 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
   web::WebState* _webStateToReplace;
 
   std::unique_ptr<PreloadManageAccountsDelegate> _manageAccountsDelegate;
+
+  // Decides whether and when to prerender, from the use of the previous
+  // prerenders.
+  std::unique_ptr<PrerenderScheduler> _scheduler;
+
+  // The transition of the request of the current prerender.
+  ui::PageTransition _prerenderedTransition;
 }
 
 // The ChromeBrowserState passed on initialization.
@@ -302,6 +309,9 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
 // Destroys the preview Tab and resets |prerenderURL_| to the empty URL.
 - (void)destroyPreviewContents;
 
+// Records the loaded prerender, if any, as wasted for |reason|.
+- (void)recordPrerenderWastedForReason:(WasteReason)reason;
+
 // Removes any scheduled prerender requests and resets |scheduledURL| to the
 // empty URL.
 - (void)removeScheduledPrerenderRequests;
@@ -341,11 +351,20 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
           std::make_unique<ConnectionTypeObserverBridge>(self);
     }
     _webStateToReplace = nullptr;
+    _scheduler = std::make_unique<PrerenderScheduler>(
+        base::DefaultTickClock::GetInstance());
+    _prerenderedTransition = ui::PAGE_TRANSITION_LINK;
+    [self updateThermalPressure];
     [[NSNotificationCenter defaultCenter]
         addObserver:self
            selector:@selector(didReceiveMemoryWarning)
                name:UIApplicationDidReceiveMemoryWarningNotification
              object:nil];
+    [[NSNotificationCenter defaultCenter]
+        addObserver:self
+           selector:@selector(thermalStateDidChange)
+               name:NSProcessInfoThermalStateDidChangeNotification
+             object:nil];
   }
   return self;
 }
@@ -426,6 +445,16 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
   }
 
   [self removeScheduledPrerenderRequests];
+  absl::optional<base::TimeDelta> delay =
+      _scheduler->GetPrerenderDelay(url, transition, immediately);
+  if (!delay) {
+    // The user is now heading to |url|, so the current prerender is no longer
+    // useful even though |url| is not prerendered in its place.
+    [self recordPrerenderWastedForReason:WasteReason::kReplaced];
+    [self cancelPrerender];
+    return;
+  }
+
   _webStateToReplace = currentWebState;
   // Observing the |_webStateToReplace| to make sure that if it's destructed
   // the pre-rendering will be canceled.
@@ -435,16 +464,20 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
   _scheduledRequest =
       std::make_unique<PrerenderRequest>(url, transition, referrer);
 
-  NSTimeInterval delay = immediately ? 0.0 : kPrerenderDelay;
   [self performSelector:@selector(startPrerender)
              withObject:nil
-             afterDelay:delay];
+             afterDelay:delay->InSecondsF()];
 }
 
 - (void)cancelPrerender {
   [self cancelPrerenderForReason:PRERENDER_FINAL_STATUS_CANCELLED];
 }
 
+- (void)cancelPrerenderAfterNavigationElsewhere {
+  [self recordPrerenderWastedForReason:WasteReason::kNavigatedElsewhere];
+  [self cancelPrerender];
+}
+
 - (void)cancelPrerenderForReason:(PrerenderFinalStatus)reason {
   [self removeScheduledPrerenderRequests];
   [self destroyPreviewContentsForReason:reason];
@@ -679,9 +712,12 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
 
 - (void)startPrerender {
   // Destroy any existing prerenders before starting a new one.
+  [self recordPrerenderWastedForReason:WasteReason::kReplaced];
   [self destroyPreviewContents];
   self.prerenderedURL = self.scheduledURL;
   std::unique_ptr<PrerenderRequest> request = std::move(_scheduledRequest);
+  if (request)
+    _prerenderedTransition = request->transition();
   // No need to observer the destruction of the |_webStateToReplace| anymore
   // as it will be used here.
   if (_webStateToReplace) {
@@ -771,9 +807,27 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
 #pragma mark - Notification Helpers
 
 - (void)didReceiveMemoryWarning {
+  _scheduler->OnMemoryPressure();
   [self cancelPrerenderForReason:PRERENDER_FINAL_STATUS_MEMORY_LIMIT_EXCEEDED];
 }
 
+- (void)thermalStateDidChange {
+  // The notification may be posted on any thread.
+  __weak PreloadController* weakSelf = self;
+  dispatch_async(dispatch_get_main_queue(), ^{
+    [weakSelf updateThermalPressure];
+  });
+}
+
+// Throttles prerendering while the device is under thermal pressure.
+- (void)updateThermalPressure {
+  BOOL thermalPressure = [NSProcessInfo processInfo].thermalState >=
+                         NSProcessInfoThermalStateSerious;
+  _scheduler->SetThermalPressure(thermalPressure);
+  if (thermalPressure)
+    [self cancelPrerender];
+}
+
 #pragma mark - Metrics Helpers
 
 - (void)recordReleaseMetrics {
@@ -783,14 +837,24 @@ void DestroyPrerenderingWebState(std::unique_ptr<web::WebState> web_state) {
 
   UMA_HISTOGRAM_BOOLEAN(kPrerenderLoadComplete, self.loadCompleted);
 
+  base::TimeDelta timeSaved;
   if (self.loadCompleted) {
     DCHECK_NE(base::TimeDelta(), self.completionTime);
-    UMA_HISTOGRAM_TIMES(kPrerenderPrerenderTimeSaved, self.completionTime);
+    timeSaved = self.completionTime;
   } else {
     DCHECK_NE(base::TimeTicks(), self.startTime);
-    UMA_HISTOGRAM_TIMES(kPrerenderPrerenderTimeSaved,
-                        base::TimeTicks::Now() - self.startTime);
+    timeSaved = base::TimeTicks::Now() - self.startTime;
   }
+  UMA_HISTOGRAM_TIMES(kPrerenderPrerenderTimeSaved, timeSaved);
+  _scheduler->RecordPrerenderUsed(self.prerenderedURL, _prerenderedTransition);
+}
+
+- (void)recordPrerenderWastedForReason:(WasteReason)reason {
+  if (!_webState || self.startTime.is_null())
+    return;
+  _scheduler->RecordPrerenderWasted(self.prerenderedURL, _prerenderedTransition,
+                                    reason,
+                                    base::TimeTicks::Now() - self.startTime);
 }
 
 @end
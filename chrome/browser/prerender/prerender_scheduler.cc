@@ -0,0 +1,144 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/prerender/prerender_scheduler.h"
+
+#include "base/check.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/time/tick_clock.h"
+#include "url/gurl.h"
+
+namespace {
+
+// Delays before starting to prerender a URL, for prerenders which are always
+// and never used. The delay of a source or host without stats, which is
+// assumed to be used half of the time, is halfway.
+constexpr base::TimeDelta kMinPrerenderDelay = base::Milliseconds(250);
+constexpr base::TimeDelta kMaxPrerenderDelay = base::Milliseconds(750);
+
+// Number of recorded prerenders after which the stats of a source or host are
+// used to decide whether to prerender.
+const double kMinPrerendersForStats = 4;
+
+// Hit rate under which prerenders are not started.
+const double kMinHitRate = 0.2;
+
+// Number of consecutive prerenders skipped because of a low hit rate after
+// which one is started anyway, so that the stats can recover.
+const int kMaxSkippedPrerenders = 10;
+
+// Weight kept by the previous prerenders when recording one, so that the
+// stats follow the recent behaviour of the user.
+const double kStatsDecay = 0.9;
+
+// Maximum number of hosts with stats.
+const size_t kMaxTrackedHosts = 64;
+
+// Time during which prerenders are not started after a memory pressure.
+constexpr base::TimeDelta kMemoryPressureThrottleDelay = base::Seconds(60);
+
+void RecordDecision(PrerenderSchedulerDecision decision) {
+  base::UmaHistogramEnumeration("Prerender.SchedulerDecision", decision);
+}
+
+}  // namespace
+
+double PrerenderScheduler::HitStats::GetHitRate() const {
+  // Smoothed, so that sources and hosts without stats have a rate of 0.5.
+  return (hits + 1) / (total + 2);
+}
+
+void PrerenderScheduler::HitStats::Record(bool hit) {
+  hits = hits * kStatsDecay + (hit ? 1 : 0);
+  total = total * kStatsDecay + 1;
+}
+
+PrerenderScheduler::PrerenderScheduler(const base::TickClock* clock)
+    : clock_(clock), host_stats_(kMaxTrackedHosts) {
+  DCHECK(clock_);
+}
+
+PrerenderScheduler::~PrerenderScheduler() {}
+
+absl::optional<base::TimeDelta> PrerenderScheduler::GetPrerenderDelay(
+    const GURL& url,
+    ui::PageTransition transition,
+    bool immediately) {
+  if (thermal_pressure_) {
+    RecordDecision(PrerenderSchedulerDecision::kSkippedThermalPressure);
+    return absl::nullopt;
+  }
+  if (!last_memory_pressure_time_.is_null() &&
+      clock_->NowTicks() - last_memory_pressure_time_ <
+          kMemoryPressureThrottleDelay) {
+    RecordDecision(PrerenderSchedulerDecision::kSkippedMemoryPressure);
+    return absl::nullopt;
+  }
+
+  HitStats* stats = GetStats(url, transition);
+  const double hit_rate = stats ? stats->GetHitRate() : HitStats().GetHitRate();
+  if (stats && stats->total >= kMinPrerendersForStats &&
+      hit_rate < kMinHitRate &&
+      ++stats->skipped_prerenders < kMaxSkippedPrerenders) {
+    RecordDecision(PrerenderSchedulerDecision::kSkippedLowHitRate);
+    return absl::nullopt;
+  }
+  if (stats)
+    stats->skipped_prerenders = 0;
+
+  RecordDecision(PrerenderSchedulerDecision::kPrerender);
+  if (immediately)
+    return base::TimeDelta();
+  return kMinPrerenderDelay +
+         (kMaxPrerenderDelay - kMinPrerenderDelay) * (1 - hit_rate);
+}
+
+void PrerenderScheduler::RecordPrerenderUsed(const GURL& url,
+                                             ui::PageTransition transition) {
+  Record(url, transition, /*hit=*/true);
+}
+
+void PrerenderScheduler::RecordPrerenderWasted(const GURL& url,
+                                               ui::PageTransition transition,
+                                               WasteReason reason,
+                                               base::TimeDelta wasted_time) {
+  Record(url, transition, /*hit=*/false);
+  base::UmaHistogramEnumeration("Prerender.SchedulerWasteReason", reason);
+  base::UmaHistogramTimes("Prerender.SchedulerWastedTime", wasted_time);
+}
+
+void PrerenderScheduler::OnMemoryPressure() {
+  last_memory_pressure_time_ = clock_->NowTicks();
+}
+
+void PrerenderScheduler::SetThermalPressure(bool thermal_pressure) {
+  thermal_pressure_ = thermal_pressure;
+}
+
+void PrerenderScheduler::Record(const GURL& url,
+                                ui::PageTransition transition,
+                                bool hit) {
+  source_stats_[ui::PageTransitionStripQualifier(transition)].Record(hit);
+
+  auto it = host_stats_.Get(url.host());
+  if (it == host_stats_.end())
+    it = host_stats_.Put(url.host(), HitStats());
+  it->second.Record(hit);
+}
+
+PrerenderScheduler::HitStats* PrerenderScheduler::GetStats(
+    const GURL& url,
+    ui::PageTransition transition) {
+  auto host_it = host_stats_.Get(url.host());
+  if (host_it != host_stats_.end() &&
+      host_it->second.total >= kMinPrerendersForStats) {
+    return &host_it->second;
+  }
+
+  auto source_it =
+      source_stats_.find(ui::PageTransitionStripQualifier(transition));
+  if (source_it != source_stats_.end())
+    return &source_it->second;
+  return host_it != host_stats_.end() ? &host_it->second : nullptr;
+}
@@ -0,0 +1,125 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_PRERENDER_PRERENDER_SCHEDULER_H_
+#define IOS_CHROME_BROWSER_PRERENDER_PRERENDER_SCHEDULER_H_
+
+#include <map>
+#include <string>
+
+#include "base/containers/lru_cache.h"
+#include "base/time/time.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "ui/base/page_transition_types.h"
+
+class GURL;
+
+namespace base {
+class TickClock;
+}
+
+// PrerenderSchedulerDecision values are used in the
+// "Prerender.SchedulerDecision" histogram. Entries should not be renumbered
+// and numeric values should never be reused.
+enum class PrerenderSchedulerDecision {
+  kPrerender = 0,
+  kSkippedLowHitRate = 1,
+  kSkippedThermalPressure = 2,
+  kSkippedMemoryPressure = 3,
+  kMaxValue = kSkippedMemoryPressure,
+};
+
+// Decides whether and when PreloadController prerenders a URL, from how often
+// the previous prerenders were used. The prerenders are tracked per source,
+// i.e. per core page transition, and per destination host. Prerenders with a
+// high hit rate start sooner, and prerenders which are rarely used are not
+// started at all. Prerendering is also throttled under thermal or memory
+// pressure.
+class PrerenderScheduler {
+ public:
+  // Why a prerender was discarded without being used. Values are used in the
+  // "Prerender.SchedulerWasteReason" histogram. Entries should not be
+  // renumbered and numeric values should never be reused.
+  enum class WasteReason {
+    // Another prerender was started.
+    kReplaced = 0,
+    // The user navigated to another URL.
+    kNavigatedElsewhere = 1,
+    kMaxValue = kNavigatedElsewhere,
+  };
+
+  // Uses |clock| to throttle the prerenders after memory pressure.
+  explicit PrerenderScheduler(const base::TickClock* clock);
+
+  PrerenderScheduler(const PrerenderScheduler&) = delete;
+  PrerenderScheduler& operator=(const PrerenderScheduler&) = delete;
+
+  ~PrerenderScheduler();
+
+  // Returns the delay after which |url|, requested by |transition|, should be
+  // prerendered, or nullopt if it should not be prerendered. |immediately| is
+  // whether the requester has a very high confidence that |url| will be
+  // navigated to.
+  absl::optional<base::TimeDelta> GetPrerenderDelay(
+      const GURL& url,
+      ui::PageTransition transition,
+      bool immediately);
+
+  // Records that the prerender of |url| requested by |transition| was used.
+  void RecordPrerenderUsed(const GURL& url, ui::PageTransition transition);
+
+  // Records that the prerender of |url| requested by |transition| was
+  // discarded for |reason| after loading for |wasted_time|. Prerenders
+  // cancelled for other reasons, e.g. memory or thermal pressure, say nothing
+  // about whether they would have been used and are not recorded.
+  void RecordPrerenderWasted(const GURL& url,
+                             ui::PageTransition transition,
+                             WasteReason reason,
+                             base::TimeDelta wasted_time);
+
+  // Throttles the prerenders for a while after a memory pressure.
+  void OnMemoryPressure();
+
+  // Sets whether the device is under thermal pressure. Prerenders are not
+  // started while it is.
+  void SetThermalPressure(bool thermal_pressure);
+
+ private:
+  // Decayed counts of the prerenders of a source or host.
+  struct HitStats {
+    // Returns the ratio of the prerenders which were used.
+    double GetHitRate() const;
+
+    // Records a prerender, which was used if |hit| is true.
+    void Record(bool hit);
+
+    double hits = 0;
+    double total = 0;
+    // Number of consecutive prerenders skipped because of a low hit rate.
+    int skipped_prerenders = 0;
+  };
+
+  // Records a prerender of |url| requested by |transition|.
+  void Record(const GURL& url, ui::PageTransition transition, bool hit);
+
+  // Returns the stats of the prerenders of |url| requested by |transition|,
+  // preferring the stats of its host once enough of its prerenders were
+  // recorded.
+  HitStats* GetStats(const GURL& url, ui::PageTransition transition);
+
+  const base::TickClock* clock_;
+
+  // Stats by core page transition.
+  std::map<ui::PageTransition, HitStats> source_stats_;
+
+  // Stats by host, for the most recently prerendered hosts.
+  base::LRUCache<std::string, HitStats> host_stats_;
+
+  // Time of the last memory pressure.
+  base::TimeTicks last_memory_pressure_time_;
+
+  bool thermal_pressure_ = false;
+};
+
+#endif  // IOS_CHROME_BROWSER_PRERENDER_PRERENDER_SCHEDULER_H_
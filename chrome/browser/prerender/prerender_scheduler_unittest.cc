@@ -0,0 +1,138 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/prerender/prerender_scheduler.h"
+
+#include "base/test/metrics/histogram_tester.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+#include "url/gurl.h"
+
+namespace {
+
+const char kUrl[] = "https://www.example.com/page";
+const char kOtherHostUrl[] = "https://www.other.com/page";
+
+class PrerenderSchedulerTest : public PlatformTest {
+ protected:
+  PrerenderSchedulerTest() : scheduler_(&clock_) {
+    clock_.Advance(base::Hours(1));
+  }
+
+  // Records |count| prerenders of |url| from the omnibox.
+  void RecordPrerenders(const GURL& url, int count, bool used) {
+    for (int i = 0; i < count; ++i) {
+      if (used) {
+        scheduler_.RecordPrerenderUsed(url, ui::PAGE_TRANSITION_TYPED);
+      } else {
+        scheduler_.RecordPrerenderWasted(
+            url, ui::PAGE_TRANSITION_TYPED,
+            PrerenderScheduler::WasteReason::kReplaced,
+            base::Milliseconds(300));
+      }
+    }
+  }
+
+  absl::optional<base::TimeDelta> GetDelay(const GURL& url) {
+    return scheduler_.GetPrerenderDelay(url, ui::PAGE_TRANSITION_TYPED,
+                                        /*immediately=*/false);
+  }
+
+  base::SimpleTestTickClock clock_;
+  PrerenderScheduler scheduler_;
+};
+
+// Tests the delay of a prerender without stats.
+TEST_F(PrerenderSchedulerTest, DefaultDelay) {
+  base::HistogramTester histogram_tester;
+  EXPECT_EQ(base::Milliseconds(500), GetDelay(GURL(kUrl)));
+  EXPECT_EQ(base::TimeDelta(),
+            scheduler_.GetPrerenderDelay(GURL(kUrl), ui::PAGE_TRANSITION_TYPED,
+                                         /*immediately=*/true));
+  histogram_tester.ExpectUniqueSample("Prerender.SchedulerDecision",
+                                     PrerenderSchedulerDecision::kPrerender, 2);
+}
+
+// Tests that prerenders which are used start sooner.
+TEST_F(PrerenderSchedulerTest, UsedPrerendersStartSooner) {
+  RecordPrerenders(GURL(kUrl), 5, /*used=*/true);
+  absl::optional<base::TimeDelta> delay = GetDelay(GURL(kUrl));
+  ASSERT_TRUE(delay);
+  EXPECT_LT(*delay, base::Milliseconds(500));
+}
+
+// Tests that the prerenders of a host which are never used are skipped, and
+// that the stats of the other hosts come from the source until they have
+// their own.
+TEST_F(PrerenderSchedulerTest, WastedPrerendersAreSkipped) {
+  base::HistogramTester histogram_tester;
+  RecordPrerenders(GURL(kUrl), 5, /*used=*/false);
+  histogram_tester.ExpectTotalCount("Prerender.SchedulerWastedTime", 5);
+  histogram_tester.ExpectUniqueSample(
+      "Prerender.SchedulerWasteReason",
+      PrerenderScheduler::WasteReason::kReplaced, 5);
+  EXPECT_FALSE(GetDelay(GURL(kUrl)));
+  EXPECT_FALSE(GetDelay(GURL(kOtherHostUrl)));
+  histogram_tester.ExpectUniqueSample(
+      "Prerender.SchedulerDecision",
+      PrerenderSchedulerDecision::kSkippedLowHitRate, 2);
+
+  // A host with its own stats is not affected by the source.
+  RecordPrerenders(GURL(kOtherHostUrl), 5, /*used=*/true);
+  EXPECT_TRUE(GetDelay(GURL(kOtherHostUrl)));
+  EXPECT_FALSE(GetDelay(GURL(kUrl)));
+}
+
+// Tests that the reason of a wasted prerender is recorded.
+TEST_F(PrerenderSchedulerTest, WasteReason) {
+  base::HistogramTester histogram_tester;
+  scheduler_.RecordPrerenderWasted(
+      GURL(kUrl), ui::PAGE_TRANSITION_TYPED,
+      PrerenderScheduler::WasteReason::kNavigatedElsewhere,
+      base::Milliseconds(300));
+  histogram_tester.ExpectUniqueSample(
+      "Prerender.SchedulerWasteReason",
+      PrerenderScheduler::WasteReason::kNavigatedElsewhere, 1);
+}
+
+// Tests that a skipped host is still prerendered from time to time, so that
+// its stats can recover.
+TEST_F(PrerenderSchedulerTest, SkippedPrerendersRecover) {
+  RecordPrerenders(GURL(kUrl), 5, /*used=*/false);
+  int prerenders = 0;
+  for (int i = 0; i < 20; ++i) {
+    if (GetDelay(GURL(kUrl)))
+      ++prerenders;
+  }
+  EXPECT_EQ(2, prerenders);
+}
+
+// Tests that prerenders are throttled after a memory pressure.
+TEST_F(PrerenderSchedulerTest, MemoryPressure) {
+  base::HistogramTester histogram_tester;
+  scheduler_.OnMemoryPressure();
+  EXPECT_FALSE(GetDelay(GURL(kUrl)));
+  histogram_tester.ExpectUniqueSample(
+      "Prerender.SchedulerDecision",
+      PrerenderSchedulerDecision::kSkippedMemoryPressure, 1);
+
+  clock_.Advance(base::Minutes(2));
+  EXPECT_TRUE(GetDelay(GURL(kUrl)));
+}
+
+// Tests that prerenders are not started under thermal pressure.
+TEST_F(PrerenderSchedulerTest, ThermalPressure) {
+  base::HistogramTester histogram_tester;
+  scheduler_.SetThermalPressure(true);
+  EXPECT_FALSE(GetDelay(GURL(kUrl)));
+  histogram_tester.ExpectUniqueSample(
+      "Prerender.SchedulerDecision",
+      PrerenderSchedulerDecision::kSkippedThermalPressure, 1);
+
+  scheduler_.SetThermalPressure(false);
+  EXPECT_TRUE(GetDelay(GURL(kUrl)));
+}
+
+}  // namespace
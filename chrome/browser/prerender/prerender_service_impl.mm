@@ -52,7 +52,7 @@ bool PrerenderServiceImpl::MaybeLoadPrerenderedURL(
     ui::PageTransition transition,
     Browser* browser) {
   if (!HasPrerenderForUrl(url)) {
-    CancelPrerender();
+    [controller_ cancelPrerenderAfterNavigationElsewhere];
     return false;
   }
 
@@ -0,0 +1,100 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SCHEDULER_H_
+#define IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SCHEDULER_H_
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/time/time.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "url/gurl.h"
+
+// Schedules the downloads of reading list entries on a fixed number of
+// download slots so that several entries can be distilled concurrently.
+// Pending entries are dispatched most recently added first. Two entries that
+// resolve to the same canonical URL (same URL without reference fragment, or
+// same redirection target as a previously downloaded entry) are never
+// downloaded at the same time; the second one waits for the first to finish.
+// The scheduler can be paused, in which case running downloads are allowed to
+// complete but no new download is started.
+class ReadingListDownloadScheduler {
+ public:
+  // Callback invoked to start the download of |url| on download slot |slot|.
+  using StartDownloadCallback =
+      base::RepeatingCallback<void(size_t slot, const GURL& url)>;
+
+  ReadingListDownloadScheduler(size_t max_concurrent_downloads,
+                               const StartDownloadCallback& start_download);
+
+  ReadingListDownloadScheduler(const ReadingListDownloadScheduler&) = delete;
+  ReadingListDownloadScheduler& operator=(const ReadingListDownloadScheduler&) =
+      delete;
+
+  ~ReadingListDownloadScheduler();
+
+  // Adds |url| to the pending downloads. |creation_time| is the time the entry
+  // was added to the reading list and is used to prioritize the downloads.
+  // Does nothing if |url| is already pending or being downloaded.
+  void Enqueue(const GURL& url, int64_t creation_time);
+
+  // Removes |url| from the pending downloads. Running downloads are not
+  // affected.
+  void Cancel(const GURL& url);
+
+  // Must be called when the download of |url| started on a slot ends.
+  // |distilled_url| is the URL of the page after redirections and is used to
+  // deduplicate later downloads.
+  void OnDownloadFinished(const GURL& url, const GURL& distilled_url);
+
+  // Pauses or resumes the dispatch of pending downloads.
+  void SetPaused(bool paused);
+  bool paused() const { return paused_; }
+
+  // Returns the slot on which |url| is currently downloaded, if any.
+  absl::optional<size_t> SlotForURL(const GURL& url) const;
+
+  size_t pending_count() const { return pending_.size(); }
+  size_t active_count() const { return active_count_; }
+
+ private:
+  // A pending download, ordered by decreasing creation time.
+  struct PendingDownload {
+    int64_t creation_time;
+    GURL url;
+
+    bool operator<(const PendingDownload& other) const;
+  };
+
+  // Starts as many pending downloads as there are free slots.
+  void Dispatch();
+
+  // Returns the key used to deduplicate downloads of |url|.
+  GURL CanonicalURL(const GURL& url) const;
+
+  // Records the queue drain time if all downloads are done.
+  void MaybeRecordDrainTime();
+
+  const StartDownloadCallback start_download_;
+  bool paused_ = false;
+
+  // Pending downloads and the creation times used to order them.
+  std::set<PendingDownload> pending_;
+  std::map<GURL, int64_t> pending_creation_times_;
+
+  // URL downloaded on each slot, empty if the slot is free.
+  std::vector<GURL> slots_;
+  size_t active_count_ = 0;
+
+  // Canonical redirection targets learned from finished downloads.
+  std::map<GURL, GURL> redirections_;
+
+  // Time at which the queue started to be non-empty.
+  base::TimeTicks drain_start_time_;
+};
+
+#endif  // IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SCHEDULER_H_
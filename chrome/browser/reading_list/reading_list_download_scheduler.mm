@@ -0,0 +1,138 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/reading_list/reading_list_download_scheduler.h"
+
+#include "base/check_op.h"
+#include "base/containers/contains.h"
+#include "base/metrics/histogram_macros.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+bool ReadingListDownloadScheduler::PendingDownload::operator<(
+    const PendingDownload& other) const {
+  if (creation_time != other.creation_time)
+    return creation_time > other.creation_time;
+  return url < other.url;
+}
+
+ReadingListDownloadScheduler::ReadingListDownloadScheduler(
+    size_t max_concurrent_downloads,
+    const StartDownloadCallback& start_download)
+    : start_download_(start_download), slots_(max_concurrent_downloads) {
+  DCHECK_GT(max_concurrent_downloads, 0u);
+}
+
+ReadingListDownloadScheduler::~ReadingListDownloadScheduler() = default;
+
+void ReadingListDownloadScheduler::Enqueue(const GURL& url,
+                                           int64_t creation_time) {
+  if (base::Contains(pending_creation_times_, url) || SlotForURL(url))
+    return;
+
+  if (pending_.empty() && active_count_ == 0)
+    drain_start_time_ = base::TimeTicks::Now();
+
+  pending_.insert({creation_time, url});
+  pending_creation_times_[url] = creation_time;
+  UMA_HISTOGRAM_COUNTS_1000("IOS.ReadingList.Download.QueueSize",
+                            pending_.size());
+  Dispatch();
+}
+
+void ReadingListDownloadScheduler::Cancel(const GURL& url) {
+  auto it = pending_creation_times_.find(url);
+  if (it == pending_creation_times_.end())
+    return;
+  pending_.erase({it->second, url});
+  pending_creation_times_.erase(it);
+  MaybeRecordDrainTime();
+}
+
+void ReadingListDownloadScheduler::OnDownloadFinished(
+    const GURL& url,
+    const GURL& distilled_url) {
+  absl::optional<size_t> slot = SlotForURL(url);
+  if (!slot)
+    return;
+
+  if (distilled_url.is_valid()) {
+    GURL canonical_url = url.GetWithoutRef();
+    GURL canonical_distilled_url = distilled_url.GetWithoutRef();
+    if (canonical_url != canonical_distilled_url)
+      redirections_[canonical_url] = canonical_distilled_url;
+  }
+
+  slots_[*slot] = GURL();
+  --active_count_;
+  Dispatch();
+  MaybeRecordDrainTime();
+}
+
+void ReadingListDownloadScheduler::SetPaused(bool paused) {
+  if (paused_ == paused)
+    return;
+  paused_ = paused;
+  Dispatch();
+}
+
+absl::optional<size_t> ReadingListDownloadScheduler::SlotForURL(
+    const GURL& url) const {
+  for (size_t slot = 0; slot < slots_.size(); ++slot) {
+    if (slots_[slot] == url)
+      return slot;
+  }
+  return absl::nullopt;
+}
+
+void ReadingListDownloadScheduler::Dispatch() {
+  if (paused_)
+    return;
+
+  std::set<GURL> active_canonical_urls;
+  for (const GURL& slot_url : slots_) {
+    if (!slot_url.is_empty())
+      active_canonical_urls.insert(CanonicalURL(slot_url));
+  }
+
+  auto it = pending_.begin();
+  while (active_count_ < slots_.size() && it != pending_.end()) {
+    GURL canonical_url = CanonicalURL(it->url);
+    if (base::Contains(active_canonical_urls, canonical_url)) {
+      // Another entry resolving to the same page is being downloaded. Keep
+      // this one pending, it will likely be served from the cache later.
+      ++it;
+      continue;
+    }
+
+    GURL url = it->url;
+    pending_creation_times_.erase(url);
+    it = pending_.erase(it);
+
+    absl::optional<size_t> free_slot = SlotForURL(GURL());
+    DCHECK(free_slot);
+    slots_[*free_slot] = url;
+    ++active_count_;
+    active_canonical_urls.insert(canonical_url);
+    start_download_.Run(*free_slot, url);
+  }
+}
+
+GURL ReadingListDownloadScheduler::CanonicalURL(const GURL& url) const {
+  GURL canonical_url = url.GetWithoutRef();
+  auto it = redirections_.find(canonical_url);
+  if (it != redirections_.end())
+    return it->second;
+  return canonical_url;
+}
+
+void ReadingListDownloadScheduler::MaybeRecordDrainTime() {
+  if (!pending_.empty() || active_count_ != 0 || drain_start_time_.is_null())
+    return;
+  UMA_HISTOGRAM_LONG_TIMES("IOS.ReadingList.Download.QueueDrainTime",
+                           base::TimeTicks::Now() - drain_start_time_);
+  drain_start_time_ = base::TimeTicks();
+}
@@ -0,0 +1,102 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/reading_list/reading_list_download_scheduler.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+class ReadingListDownloadSchedulerTest : public PlatformTest {
+ protected:
+  ReadingListDownloadSchedulerTest()
+      : scheduler_(2,
+                   base::BindRepeating(
+                       &ReadingListDownloadSchedulerTest::OnStartDownload,
+                       base::Unretained(this))) {}
+
+  void OnStartDownload(size_t slot, const GURL& url) {
+    started_.push_back(std::make_pair(slot, url));
+  }
+
+  ReadingListDownloadScheduler scheduler_;
+  std::vector<std::pair<size_t, GURL>> started_;
+};
+
+// Tests that downloads run concurrently up to the number of slots.
+TEST_F(ReadingListDownloadSchedulerTest, RunsConcurrently) {
+  scheduler_.Enqueue(GURL("http://a.com/"), 1);
+  scheduler_.Enqueue(GURL("http://b.com/"), 2);
+  scheduler_.Enqueue(GURL("http://c.com/"), 3);
+
+  ASSERT_EQ(2u, started_.size());
+  EXPECT_EQ(2u, scheduler_.active_count());
+  EXPECT_EQ(1u, scheduler_.pending_count());
+  EXPECT_NE(started_[0].first, started_[1].first);
+
+  scheduler_.OnDownloadFinished(started_[0].second, GURL());
+  ASSERT_EQ(3u, started_.size());
+  EXPECT_EQ(started_[0].first, started_[2].first);
+  EXPECT_EQ(0u, scheduler_.pending_count());
+}
+
+// Tests that the most recently added entries are downloaded first.
+TEST_F(ReadingListDownloadSchedulerTest, MostRecentFirst) {
+  scheduler_.SetPaused(true);
+  scheduler_.Enqueue(GURL("http://old.com/"), 1);
+  scheduler_.Enqueue(GURL("http://new.com/"), 3);
+  scheduler_.Enqueue(GURL("http://middle.com/"), 2);
+  EXPECT_TRUE(started_.empty());
+
+  scheduler_.SetPaused(false);
+  ASSERT_EQ(2u, started_.size());
+  EXPECT_EQ(GURL("http://new.com/"), started_[0].second);
+  EXPECT_EQ(GURL("http://middle.com/"), started_[1].second);
+}
+
+// Tests that cancelled and duplicate entries are not downloaded.
+TEST_F(ReadingListDownloadSchedulerTest, CancelAndDuplicates) {
+  scheduler_.SetPaused(true);
+  scheduler_.Enqueue(GURL("http://a.com/"), 1);
+  scheduler_.Enqueue(GURL("http://a.com/"), 1);
+  scheduler_.Enqueue(GURL("http://b.com/"), 2);
+  EXPECT_EQ(2u, scheduler_.pending_count());
+
+  scheduler_.Cancel(GURL("http://b.com/"));
+  scheduler_.SetPaused(false);
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(GURL("http://a.com/"), started_[0].second);
+  EXPECT_EQ(0u, scheduler_.SlotForURL(GURL("http://a.com/")));
+}
+
+// Tests that entries resolving to the same canonical URL are not downloaded
+// concurrently.
+TEST_F(ReadingListDownloadSchedulerTest, DeduplicatesCanonicalURLs) {
+  scheduler_.Enqueue(GURL("http://a.com/#one"), 2);
+  scheduler_.Enqueue(GURL("http://a.com/#two"), 1);
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(1u, scheduler_.pending_count());
+
+  scheduler_.OnDownloadFinished(GURL("http://a.com/#one"), GURL());
+  ASSERT_EQ(2u, started_.size());
+
+  // Learn that http://b.com/ redirects to http://c.com/.
+  scheduler_.Enqueue(GURL("http://b.com/"), 3);
+  ASSERT_EQ(3u, started_.size());
+  scheduler_.OnDownloadFinished(GURL("http://b.com/"), GURL("http://c.com/"));
+  scheduler_.OnDownloadFinished(GURL("http://a.com/#two"), GURL());
+
+  scheduler_.Enqueue(GURL("http://c.com/"), 4);
+  scheduler_.Enqueue(GURL("http://b.com/"), 3);
+  EXPECT_EQ(4u, started_.size());
+  EXPECT_EQ(1u, scheduler_.pending_count());
+}
@@ -6,9 +6,13 @@
 #define IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SERVICE_H_
 
 #include <string>
+#include <vector>
 
+#include "base/memory/memory_pressure_listener.h"
+#include "base/timer/timer.h"
 #include "components/keyed_service/core/keyed_service.h"
 #include "components/reading_list/core/reading_list_model_observer.h"
+#include "ios/chrome/browser/reading_list/reading_list_download_scheduler.h"
 #include "ios/chrome/browser/reading_list/url_downloader.h"
 #include "services/network/public/cpp/network_connection_tracker.h"
 
@@ -27,6 +31,9 @@ class ReadingListDistillerPageFactory;
 // Any calls made to DownloadEntry before the model is loaded will be ignored.
 // When the model is loaded, offline directory is automatically synced with the
 // entries in the model.
+// Several entries are downloaded concurrently, most recently added first. New
+// downloads are paused while the device is under memory pressure or in low
+// power mode.
 class ReadingListDownloadService
     : public KeyedService,
       public ReadingListModelObserver,
@@ -101,12 +108,28 @@ class ReadingListDownloadService
   // Callback for entry deletion.
   void OnDeleteEnd(const GURL& url, bool success);
 
+  // Starts the download of |url| on the URLDownloader at |slot|.
+  void StartDownload(size_t slot, const GURL& url);
+
+  // Called on memory pressure. Pauses the downloads for a while.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+  // Pauses or resumes the downloads depending on memory pressure and low power
+  // mode state.
+  void UpdateDownloadsPauseState();
+
   // network::NetworkConnectionTracker::NetworkConnectionObserver:
   void OnConnectionChanged(network::mojom::ConnectionType type) override;
 
   ReadingListModel* reading_list_model_;
   base::FilePath chrome_profile_path_;
-  std::unique_ptr<URLDownloader> url_downloader_;
+  // One URLDownloader per concurrent download slot.
+  std::vector<std::unique_ptr<URLDownloader>> url_downloaders_;
+  std::unique_ptr<ReadingListDownloadScheduler> download_scheduler_;
+  std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+  base::OneShotTimer memory_pressure_pause_timer_;
+  // Observer for low power mode changes.
+  __strong id<NSObject> low_power_mode_observer_ = nil;
   std::vector<GURL> url_to_download_cellular_;
   std::vector<GURL> url_to_download_wifi_;
   bool had_connection_;
@@ -4,6 +4,8 @@
 
 #include "ios/chrome/browser/reading_list/reading_list_download_service.h"
 
+#import <Foundation/Foundation.h>
+
 #include <memory>
 #include <utility>
 
@@ -47,6 +49,12 @@ const int kNumberOfFailsBeforeWifiOnly = 5;
 // it.
 const int kNumberOfFailsBeforeStop = 7;
 
+// Number of entries that are downloaded concurrently.
+const size_t kMaxConcurrentDownloads = 3;
+
+// Delay during which new downloads are not started after a memory warning.
+constexpr base::TimeDelta kMemoryPressurePauseDelay = base::Seconds(30);
+
 // Scans |root| directory and deletes all subdirectories not listed
 // in |directories_to_keep|.
 // Must be called on File thread.
@@ -81,20 +89,45 @@ ReadingListDownloadService::ReadingListDownloadService(
       weak_ptr_factory_(this) {
   DCHECK(reading_list_model);
 
-  url_downloader_ = std::make_unique<URLDownloader>(
-      distiller_factory_.get(), distiller_page_factory_.get(), prefs,
-      chrome_profile_path, url_loader_factory,
-      base::BindRepeating(&ReadingListDownloadService::OnDownloadEnd,
-                          base::Unretained(this)),
-      base::BindRepeating(&ReadingListDownloadService::OnDeleteEnd,
+  for (size_t slot = 0; slot < kMaxConcurrentDownloads; ++slot) {
+    url_downloaders_.push_back(std::make_unique<URLDownloader>(
+        distiller_factory_.get(), distiller_page_factory_.get(), prefs,
+        chrome_profile_path, url_loader_factory,
+        base::BindRepeating(&ReadingListDownloadService::OnDownloadEnd,
+                            base::Unretained(this)),
+        base::BindRepeating(&ReadingListDownloadService::OnDeleteEnd,
+                            base::Unretained(this))));
+  }
+  download_scheduler_ = std::make_unique<ReadingListDownloadScheduler>(
+      kMaxConcurrentDownloads,
+      base::BindRepeating(&ReadingListDownloadService::StartDownload,
+                          base::Unretained(this)));
+
+  memory_pressure_listener_ = std::make_unique<base::MemoryPressureListener>(
+      FROM_HERE,
+      base::BindRepeating(&ReadingListDownloadService::OnMemoryPressure,
                           base::Unretained(this)));
 
+  base::WeakPtr<ReadingListDownloadService> weak_this =
+      weak_ptr_factory_.GetWeakPtr();
+  low_power_mode_observer_ = [[NSNotificationCenter defaultCenter]
+      addObserverForName:NSProcessInfoPowerStateDidChangeNotification
+                  object:nil
+                   queue:[NSOperationQueue mainQueue]
+              usingBlock:^(NSNotification*) {
+                if (weak_this)
+                  weak_this->UpdateDownloadsPauseState();
+              }];
+  UpdateDownloadsPauseState();
+
   GetApplicationContext()
       ->GetNetworkConnectionTracker()
       ->AddNetworkConnectionObserver(this);
 }
 
 ReadingListDownloadService::~ReadingListDownloadService() {
+  [[NSNotificationCenter defaultCenter]
+      removeObserver:low_power_mode_observer_];
   GetApplicationContext()
       ->GetNetworkConnectionTracker()
       ->RemoveNetworkConnectionObserver(this);
@@ -148,7 +181,7 @@ void ReadingListDownloadService::Clear() {
 void ReadingListDownloadService::ProcessNewEntry(const GURL& url) {
   const ReadingListEntry* entry = reading_list_model_->GetEntryByURL(url);
   if (!entry || entry->IsRead()) {
-    url_downloader_->CancelDownloadOfflineURL(url);
+    download_scheduler_->Cancel(url);
   } else {
     ScheduleDownloadEntry(url);
   }
@@ -227,7 +260,7 @@ void ReadingListDownloadService::DownloadEntry(const GURL& url) {
     // Try to download the page, whatever the connection.
     reading_list_model_->SetEntryDistilledState(entry->URL(),
                                                 ReadingListEntry::PROCESSING);
-    url_downloader_->DownloadOfflineURL(entry->URL());
+    download_scheduler_->Enqueue(entry->URL(), entry->CreationTime());
 
   } else if (entry->FailedDownloadCounter() < kNumberOfFailsBeforeStop) {
     // Try to download the page only if the connection is wifi.
@@ -243,7 +276,7 @@ void ReadingListDownloadService::DownloadEntry(const GURL& url) {
       // The connection is wifi, download the page.
       reading_list_model_->SetEntryDistilledState(entry->URL(),
                                                   ReadingListEntry::PROCESSING);
-      url_downloader_->DownloadOfflineURL(entry->URL());
+      download_scheduler_->Enqueue(entry->URL(), entry->CreationTime());
 
     } else {
       // The connection is not wifi, save it for download when the connection
@@ -255,7 +288,31 @@ void ReadingListDownloadService::DownloadEntry(const GURL& url) {
 
 void ReadingListDownloadService::RemoveDownloadedEntry(const GURL& url) {
   DCHECK(reading_list_model_->loaded());
-  url_downloader_->RemoveOfflineURL(url);
+  download_scheduler_->Cancel(url);
+  // If |url| is being downloaded, the deletion must be queued on the same
+  // URLDownloader so that it happens after the download ends. Otherwise it is
+  // queued on the least busy URLDownloader so that it does not wait behind an
+  // unrelated download.
+  absl::optional<size_t> slot = download_scheduler_->SlotForURL(url);
+  if (!slot) {
+    slot = 0;
+    for (size_t i = 1; i < url_downloaders_.size(); ++i) {
+      if (url_downloaders_[i]->PendingTaskCount() <
+          url_downloaders_[*slot]->PendingTaskCount()) {
+        slot = i;
+      }
+    }
+  }
+  if (url_downloaders_[*slot]->RemoveOfflineURL(url)) {
+    // The download of |url| was still queued behind other tasks. It is
+    // cancelled and will never end, so its download slot must be freed here.
+    download_scheduler_->OnDownloadFinished(url, GURL());
+  }
+}
+
+void ReadingListDownloadService::StartDownload(size_t slot, const GURL& url) {
+  DCHECK_LT(slot, url_downloaders_.size());
+  url_downloaders_[slot]->DownloadOfflineURL(url);
 }
 
 void ReadingListDownloadService::OnDownloadEnd(
@@ -266,6 +323,7 @@ void ReadingListDownloadService::OnDownloadEnd(
     int64_t size,
     const std::string& title) {
   DCHECK(reading_list_model_->loaded());
+  download_scheduler_->OnDownloadFinished(url, distilled_url);
   URLDownloader::SuccessState real_success_value = success;
   if (distilled_path.empty()) {
     real_success_value = URLDownloader::ERROR;
@@ -314,6 +372,27 @@ void ReadingListDownloadService::OnDeleteEnd(const GURL& url, bool success) {
   // Nothing to update as this is only called when deleting reading list entries
 }
 
+void ReadingListDownloadService::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  if (memory_pressure_level ==
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+    return;
+  }
+  // iOS does not report the end of memory pressure, so pause for a fixed
+  // delay, restarted on each warning.
+  memory_pressure_pause_timer_.Start(
+      FROM_HERE, kMemoryPressurePauseDelay,
+      base::BindOnce(&ReadingListDownloadService::UpdateDownloadsPauseState,
+                     base::Unretained(this)));
+  UpdateDownloadsPauseState();
+}
+
+void ReadingListDownloadService::UpdateDownloadsPauseState() {
+  bool paused = memory_pressure_pause_timer_.IsRunning() ||
+                [[NSProcessInfo processInfo] isLowPowerModeEnabled];
+  download_scheduler_->SetPaused(paused);
+}
+
 void ReadingListDownloadService::OnConnectionChanged(
     network::mojom::ConnectionType type) {
   if (type == network::mojom::ConnectionType::CONNECTION_NONE) {
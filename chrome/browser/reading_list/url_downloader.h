@@ -97,11 +97,14 @@ class URLDownloader : reading_list::ReadingListDistillerPageDelegate {
   // Asynchronously download an offline version of the URL.
   void DownloadOfflineURL(const GURL& url);
 
-  // Cancels the download job an offline version of the URL.
-  void CancelDownloadOfflineURL(const GURL& url);
+  // Cancels the download job an offline version of the URL. Returns whether a
+  // queued download was cancelled, in which case the download completion
+  // callback is not called for it.
+  bool CancelDownloadOfflineURL(const GURL& url);
 
-  // Asynchronously remove the offline version of the URL if it exists.
-  void RemoveOfflineURL(const GURL& url);
+  // Asynchronously remove the offline version of the URL if it exists. Returns
+  // whether a queued download of the URL was cancelled.
+  bool RemoveOfflineURL(const GURL& url);
 
   // URL loader completion callback.
   void OnURLLoadComplete(const GURL& original_url,
@@ -110,6 +113,9 @@ class URLDownloader : reading_list::ReadingListDistillerPageDelegate {
   // Cancels the current download task.
   void CancelTask();
 
+  // Returns the number of tasks queued or being handled.
+  size_t PendingTaskCount() const;
+
  private:
   enum TaskType { DELETE, DOWNLOAD };
   using Task = std::pair<TaskType, GURL>;
@@ -110,11 +110,12 @@ void URLDownloader::OfflinePathExists(const base::FilePath& path,
       std::move(callback));
 }
 
-void URLDownloader::RemoveOfflineURL(const GURL& url) {
+bool URLDownloader::RemoveOfflineURL(const GURL& url) {
   // Remove all download tasks for this url as it would be pointless work.
-  CancelDownloadOfflineURL(url);
+  bool cancelled_download = CancelDownloadOfflineURL(url);
   tasks_.push_back(std::make_pair(DELETE, url));
   HandleNextTask();
+  return cancelled_download;
 }
 
 void URLDownloader::DownloadOfflineURL(const GURL& url) {
@@ -124,10 +125,16 @@ void URLDownloader::DownloadOfflineURL(const GURL& url) {
   }
 }
 
-void URLDownloader::CancelDownloadOfflineURL(const GURL& url) {
-  tasks_.erase(
-      std::remove(tasks_.begin(), tasks_.end(), std::make_pair(DOWNLOAD, url)),
-      tasks_.end());
+size_t URLDownloader::PendingTaskCount() const {
+  return tasks_.size() + (working_ ? 1 : 0);
+}
+
+bool URLDownloader::CancelDownloadOfflineURL(const GURL& url) {
+  auto it =
+      std::remove(tasks_.begin(), tasks_.end(), std::make_pair(DOWNLOAD, url));
+  const bool cancelled_download = it != tasks_.end();
+  tasks_.erase(it, tasks_.end());
+  return cancelled_download;
 }
 
 void URLDownloader::DownloadCompletionHandler(
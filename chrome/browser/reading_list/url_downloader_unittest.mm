@@ -306,4 +306,25 @@ TEST_F(URLDownloaderTest, DownloadAndRemoveAndRedownload) {
   ASSERT_TRUE(downloader_->CheckExistenceOfOfflineURLPagePath(url));
 }
 
+// Tests that removing a URL whose download is queued behind another task
+// cancels the download and reports it, as its completion callback is never
+// called.
+TEST_F(URLDownloaderTest, RemoveQueuedDownload) {
+  GURL url = GURL("http://test.com");
+  GURL url2 = GURL("http://test2.com");
+  downloader_->FakeWorking();
+  EXPECT_FALSE(downloader_->RemoveOfflineURL(url2));
+  downloader_->DownloadOfflineURL(url);
+  EXPECT_TRUE(downloader_->RemoveOfflineURL(url));
+  EXPECT_FALSE(downloader_->RemoveOfflineURL(url));
+  downloader_->FakeEndWorking();
+
+  // Wait for all asynchronous tasks to complete.
+  task_environment_.RunUntilIdle();
+
+  EXPECT_TRUE(downloader_->downloaded_files_.empty());
+  EXPECT_EQ(3ul, downloader_->removed_files_.size());
+  EXPECT_FALSE(downloader_->CheckExistenceOfOfflineURLPagePath(url));
+}
+
 }  // namespace
@@ -309,7 +309,7 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
 
     base::UmaHistogramCounts100000(
         "Session.WebStates.AllSerializedCertPolicyCachesSize",
-        web::GetCertPolicyBytesEncoded() - previous_cert_policy_bytes / 1024);
+        (web::GetCertPolicyBytesEncoded() - previous_cert_policy_bytes) / 1024);
 
     base::UmaHistogramCounts100000("Session.WebStates.SerializedSize",
                                    sessionData.length / 1024);
@@ -14,6 +14,10 @@ class Time;
 
 @protocol SnapshotCacheObserver;
 
+// Callback receiving the thumbnails of snapshots, keyed by snapshot ID.
+typedef void (^SnapshotCacheThumbnailsCallback)(
+    NSDictionary<NSString*, UIImage*>* thumbnails);
+
 // A class providing an in-memory and on-disk cache of tab snapshots.
 // A snapshot is a full-screen image of the contents of the page at the current
 // scroll offset and zoom level, used to stand in for the WKWebView if it has
@@ -48,6 +52,16 @@ class Time;
 - (void)retrieveGreyImageForSnapshotID:(NSString*)snapshotID
                               callback:(void (^)(UIImage*))callback;
 
+// Retrieve the thumbnails of |snapshotIDs| and return them via the callback,
+// keyed by snapshot ID. Thumbnails are downscaled copies of the top of the
+// snapshots, all read from a single memory mapped file, so this is much
+// cheaper than retrieving the snapshots. Snapshot IDs without thumbnail are
+// not present in the result. The callback is always called asynchronously,
+// unless the cache is shut down.
+- (void)retrieveThumbnailsForSnapshotIDs:(NSArray<NSString*>*)snapshotIDs
+                                callback:
+                                    (SnapshotCacheThumbnailsCallback)callback;
+
 - (void)setImage:(UIImage*)image withSnapshotID:(NSString*)snapshotID;
 
 // Removes the image from both the LRU and disk.
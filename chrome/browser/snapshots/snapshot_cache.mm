@@ -7,6 +7,8 @@
 
 #import <UIKit/UIKit.h>
 
+#include <cmath>
+#include <memory>
 #include <set>
 
 #include "base/base_paths.h"
@@ -19,6 +21,7 @@
 #include "base/logging.h"
 #import "base/mac/backup_util.h"
 #include "base/metrics/histogram_functions.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/path_service.h"
 #include "base/sequence_checker.h"
 #include "base/strings/sys_string_conversions.h"
@@ -28,8 +31,9 @@
 #include "base/threading/scoped_blocking_call.h"
 #include "base/time/time.h"
 #import "ios/chrome/browser/snapshots/snapshot_cache_observer.h"
+#import "ios/chrome/browser/snapshots/snapshot_grey_image.h"
 #import "ios/chrome/browser/snapshots/snapshot_lru_cache.h"
-#import "ios/chrome/browser/ui/util/uikit_ui_util.h"
+#import "ios/chrome/browser/snapshots/snapshot_thumbnail_store.h"
 #include "ui/base/device_form_factor.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
@@ -73,8 +77,33 @@ const NSUInteger kGreyInitialCapacity = 8;
 const CGFloat kJPEGImageQuality = 1.0;  // Highest quality. No compression.
 
 // Maximum size in number of elements that the LRU cache can hold before
-// starting to evict elements.
-const NSUInteger kLRUCacheMaxCapacity = 6;
+// starting to evict elements. The LRU cache is mostly limited by
+// kLRUCacheByteBudget.
+const NSUInteger kLRUCacheMaxCapacity = 16;
+
+// Maximum size in decoded bytes of the snapshots held by the LRU cache, about
+// six full screen snapshots on large phones.
+const size_t kLRUCacheByteBudget = 36 * 1024 * 1024;
+
+// Maximum size of the JPEG data of the snapshots kept by the LRU cache, to
+// avoid reading the snapshots evicted from the LRU cache from disk.
+const size_t kLRUCacheCompressedByteBudget = 8 * 1024 * 1024;
+
+// Where the snapshots requested with -retrieveImageForSnapshotID:callback:
+// were found. These values are persisted to logs. Entries should not be
+// renumbered and numeric values should never be reused.
+enum class SnapshotLookupResult {
+  kMemory = 0,
+  kCompressedMemory = 1,
+  kDisk = 2,
+  kMaxValue = kDisk,
+};
+
+// A snapshot read from disk, with its JPEG data.
+struct EncodedImage {
+  UIImage* image = nil;
+  NSData* data = nil;
+};
 
 // Returns the path of the image for |snapshot_id|, in |cache_directory|,
 // of type |image_type| and scale |image_scale|.
@@ -118,6 +147,18 @@ ImageScale ImageScaleForDevice() {
   return [UIScreen mainScreen].scale == 1.0 ? IMAGE_SCALE_1X : IMAGE_SCALE_2X;
 }
 
+// Returns the maximum width of the thumbnails, which is the width of the tab
+// grid cells in pixels.
+uint32_t ThumbnailPixelWidthForDevice() {
+  // Width in points of the widest tab grid cells outside of the accessibility
+  // layout, kGridCellSizeLarge on tablet and kGridCellSizeMedium on handset.
+  const CGFloat cell_width =
+      ui::GetDeviceFormFactor() == ui::DEVICE_FORM_FACTOR_TABLET ? 228.0
+                                                                 : 168.0;
+  return static_cast<uint32_t>(
+      std::ceil(cell_width * [UIScreen mainScreen].scale));
+}
+
 CGFloat ScaleFromImageScale(ImageScale image_scale) {
   switch (image_scale) {
     case IMAGE_SCALE_1X:
@@ -129,10 +170,11 @@ CGFloat ScaleFromImageScale(ImageScale image_scale) {
   }
 }
 
-UIImage* ReadImageForSnapshotIDFromDisk(NSString* snapshot_id,
-                                        ImageType image_type,
-                                        ImageScale image_scale,
-                                        const base::FilePath& cache_directory) {
+EncodedImage ReadEncodedImageForSnapshotIDFromDisk(
+    NSString* snapshot_id,
+    ImageType image_type,
+    ImageScale image_scale,
+    const base::FilePath& cache_directory) {
   // TODO(crbug.com/295891): consider changing back to -imageWithContentsOfFile
   // instead of -imageWithData if both rdar://15747161 and the bug incorrectly
   // reporting the image as damaged https://stackoverflow.com/q/5081297/5353
@@ -142,15 +184,29 @@ UIImage* ReadImageForSnapshotIDFromDisk(NSString* snapshot_id,
   NSString* path = base::SysUTF8ToNSString(file_path.AsUTF8Unsafe());
   base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                                 base::BlockingType::WILL_BLOCK);
-  return [UIImage imageWithData:[NSData dataWithContentsOfFile:path]
-                          scale:(image_type == IMAGE_TYPE_GREYSCALE
-                                     ? 1.0
-                                     : ScaleFromImageScale(image_scale))];
+  EncodedImage encoded_image;
+  encoded_image.data = [NSData dataWithContentsOfFile:path];
+  encoded_image.image =
+      [UIImage imageWithData:encoded_image.data
+                       scale:(image_type == IMAGE_TYPE_GREYSCALE
+                                  ? 1.0
+                                  : ScaleFromImageScale(image_scale))];
+  return encoded_image;
 }
 
-void WriteImageToDisk(UIImage* image, const base::FilePath& file_path) {
+UIImage* ReadImageForSnapshotIDFromDisk(NSString* snapshot_id,
+                                        ImageType image_type,
+                                        ImageScale image_scale,
+                                        const base::FilePath& cache_directory) {
+  return ReadEncodedImageForSnapshotIDFromDisk(snapshot_id, image_type,
+                                               image_scale, cache_directory)
+      .image;
+}
+
+// Writes |image| to |file_path| as a JPEG, and returns the JPEG data.
+NSData* WriteImageToDisk(UIImage* image, const base::FilePath& file_path) {
   if (!image)
-    return;
+    return nil;
 
   base::FilePath directory = file_path.DirName();
   if (!base::DirectoryExists(directory)) {
@@ -158,15 +214,15 @@ void WriteImageToDisk(UIImage* image, const base::FilePath& file_path) {
     if (!success) {
       DLOG(ERROR) << "Error creating thumbnail directory "
                   << directory.AsUTF8Unsafe();
-      return;
+      return nil;
     }
   }
 
   NSString* path = base::SysUTF8ToNSString(file_path.AsUTF8Unsafe());
   base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                                 base::BlockingType::WILL_BLOCK);
-  [UIImageJPEGRepresentation(image, kJPEGImageQuality) writeToFile:path
-                                                        atomically:YES];
+  NSData* data = UIImageJPEGRepresentation(image, kJPEGImageQuality);
+  [data writeToFile:path atomically:YES];
 
   // Encrypt the snapshot file (mostly for Incognito, but can't hurt to
   // always do it).
@@ -181,6 +237,7 @@ void WriteImageToDisk(UIImage* image, const base::FilePath& file_path) {
     DLOG(ERROR) << "Error encrypting thumbnail file "
                 << base::SysNSStringToUTF8([error description]);
   }
+  return data;
 }
 
 void ConvertAndSaveGreyImage(NSString* snapshot_id,
@@ -195,7 +252,7 @@ void ConvertAndSaveGreyImage(NSString* snapshot_id,
     if (!color_image)
       return;
   }
-  UIImage* grey_image = GreyImage(color_image);
+  UIImage* grey_image = GreySnapshotImage(color_image);
   base::FilePath image_path = ImagePath(snapshot_id, IMAGE_TYPE_GREYSCALE,
                                         image_scale, cache_directory);
   WriteImageToDisk(grey_image, image_path);
@@ -312,21 +369,36 @@ void CreateCacheDirectory(const base::FilePath& cache_directory) {
   }
 }
 
-UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
-                                  NSString* snapshot_id,
-                                  ImageScale snapshot_scale,
-                                  UIImage* cached_image) {
-  // If the image is not in the cache, load it from disk.
-  UIImage* image = cached_image;
-  if (!image) {
-    image = ReadImageForSnapshotIDFromDisk(snapshot_id, IMAGE_TYPE_COLOR,
-                                           snapshot_scale, cache_directory);
-  }
+// Image read from disk to fill the grey image cache.
+struct GreyCacheSourceImage {
+  UIImage* image = nil;
+  // Whether |image| is the grey image saved next to the color snapshot, rather
+  // than the color snapshot still to be converted.
+  bool is_grey = false;
+};
 
-  if (!image)
-    return nil;
+GreyCacheSourceImage ReadGreyCacheSourceImage(
+    const base::FilePath& cache_directory,
+    NSString* snapshot_id,
+    ImageScale snapshot_scale) {
+  GreyCacheSourceImage source;
+  source.image = ReadImageForSnapshotIDFromDisk(
+      snapshot_id, IMAGE_TYPE_GREYSCALE, snapshot_scale, cache_directory);
+  if (source.image) {
+    source.is_grey = true;
+    return source;
+  }
+  source.image = ReadImageForSnapshotIDFromDisk(
+      snapshot_id, IMAGE_TYPE_COLOR, snapshot_scale, cache_directory);
+  return source;
+}
 
-  return GreyImage(image);
+// Converts |image| to grey on the thread pool, so that the images of a batch
+// are converted concurrently, and calls |callback| with the result.
+void ConvertToGreyImage(UIImage* image, void (^callback)(UIImage*)) {
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+      base::BindOnce(&GreySnapshotImage, image), base::BindOnce(callback));
 }
 
 }  // anonymous namespace
@@ -341,6 +413,11 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   // is called.
   NSMutableDictionary<NSString*, UIImage*>* _greyImageDictionary;
 
+  // IDs of the snapshots requested by -createGreyCache: which are not in
+  // |_greyImageDictionary| yet, and when they were requested.
+  NSMutableSet<NSString*>* _pendingGreySnapshotIDs;
+  base::TimeTicks _greyCacheCreationStartTime;
+
   // Snapshot ID of most recent pending grey snapshot request.
   NSString* _mostRecentGreySnapshotID;
   // Block used by pending request for a grey snapshot.
@@ -358,6 +435,10 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   // Directory where the thumbnails are saved.
   base::FilePath _cacheDirectory;
 
+  // Store for the downscaled snapshots displayed by the tab grid. Only used on
+  // |_taskRunner|, and deleted on it by -shutdown.
+  std::unique_ptr<SnapshotThumbnailStore> _thumbnailStore;
+
   // Task runner used to run tasks in the background. Will be invalidated when
   // -shutdown is invoked. Code should support this value to be null (generally
   // by not posting the task).
@@ -370,13 +451,17 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
 - (instancetype)initWithStoragePath:(const base::FilePath&)storagePath {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   if ((self = [super init])) {
-    _lruCache =
-        [[SnapshotLRUCache alloc] initWithCacheSize:kLRUCacheMaxCapacity];
+    _lruCache = [[SnapshotLRUCache alloc]
+           initWithCacheSize:kLRUCacheMaxCapacity
+                  byteBudget:kLRUCacheByteBudget
+        compressedByteBudget:kLRUCacheCompressedByteBudget];
     _cacheDirectory = storagePath;
     _snapshotsScale = ImageScaleForDevice();
 
     _taskRunner = base::ThreadPool::CreateSequencedTaskRunner(
         {base::MayBlock(), base::TaskPriority::USER_VISIBLE});
+    _thumbnailStore = std::make_unique<SnapshotThumbnailStore>(
+        storagePath, ThumbnailPixelWidthForDevice());
 
     // Must be called after task runner is created.
     [self createStorageIfNecessary];
@@ -430,46 +515,104 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   DCHECK(callback);
 
   if (UIImage* image = [_lruCache objectForKey:snapshotID]) {
+    base::UmaHistogramEnumeration("IOS.Snapshots.CacheLookupResult",
+                                  SnapshotLookupResult::kMemory);
     callback(image);
     return;
   }
 
+  // The JPEG data is only decoded when the image is drawn.
+  if (NSData* data = [_lruCache compressedDataForKey:snapshotID]) {
+    UIImage* image =
+        [UIImage imageWithData:data
+                         scale:ScaleFromImageScale(_snapshotsScale)];
+    if (image) {
+      base::UmaHistogramEnumeration("IOS.Snapshots.CacheLookupResult",
+                                    SnapshotLookupResult::kCompressedMemory);
+      [_lruCache setObject:image forKey:snapshotID];
+      [_lruCache setCompressedData:data ofObject:image forKey:snapshotID];
+      callback(image);
+      return;
+    }
+  }
+
   if (!_taskRunner) {
     callback(nil);
     return;
   }
 
+  base::UmaHistogramEnumeration("IOS.Snapshots.CacheLookupResult",
+                                SnapshotLookupResult::kDisk);
   __weak SnapshotLRUCache* weakLRUCache = _lruCache;
   base::PostTaskAndReplyWithResult(
       _taskRunner.get(), FROM_HERE,
-      base::BindOnce(&ReadImageForSnapshotIDFromDisk, snapshotID,
+      base::BindOnce(&ReadEncodedImageForSnapshotIDFromDisk, snapshotID,
                      IMAGE_TYPE_COLOR, _snapshotsScale, _cacheDirectory),
-      base::BindOnce(^(UIImage* image) {
-        if (image)
+      base::BindOnce(^(EncodedImage encodedImage) {
+        UIImage* image = encodedImage.image;
+        if (image) {
           [weakLRUCache setObject:image forKey:snapshotID];
+          [weakLRUCache setCompressedData:encodedImage.data
+                                 ofObject:image
+                                   forKey:snapshotID];
+        }
         callback(image);
       }));
 }
 
+- (void)retrieveThumbnailsForSnapshotIDs:(NSArray<NSString*>*)snapshotIDs
+                                callback:
+                                    (SnapshotCacheThumbnailsCallback)callback {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
+  DCHECK(callback);
+
+  if (!_taskRunner) {
+    callback(@{});
+    return;
+  }
+
+  base::PostTaskAndReplyWithResult(
+      _taskRunner.get(), FROM_HERE,
+      base::BindOnce(&SnapshotThumbnailStore::Get,
+                     base::Unretained(_thumbnailStore.get()),
+                     [snapshotIDs copy]),
+      base::BindOnce(callback));
+}
+
 - (void)setImage:(UIImage*)image withSnapshotID:(NSString*)snapshotID {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   if (!image || !snapshotID || !_taskRunner)
     return;
 
   [_lruCache setObject:image forKey:snapshotID];
-
-  // Each image in the cache has the same resolution and hence the same size.
-  size_t imageSizes = CGImageGetBytesPerRow(image.CGImage) *
-                      CGImageGetHeight(image.CGImage) * [_lruCache count];
-  base::UmaHistogramMemoryKB("IOS.Snapshots.CacheSize", imageSizes / 1024);
+  base::UmaHistogramMemoryKB("IOS.Snapshots.CacheSize",
+                             [_lruCache residentBytes] / 1024);
+  base::UmaHistogramMemoryKB("IOS.Snapshots.CompressedCacheSize",
+                             [_lruCache compressedResidentBytes] / 1024);
 
   [self.observers snapshotCache:self didUpdateSnapshotForIdentifier:snapshotID];
 
-  // Save the image to disk.
+  // Save the image to disk, keeping its JPEG data in memory, and delete the
+  // grey image converted from the previous one.
+  __weak SnapshotLRUCache* weakLRUCache = _lruCache;
+  base::PostTaskAndReplyWithResult(
+      _taskRunner.get(), FROM_HERE,
+      base::BindOnce(&WriteImageToDisk, image,
+                     ImagePath(snapshotID, IMAGE_TYPE_COLOR, _snapshotsScale,
+                               _cacheDirectory)),
+      base::BindOnce(^(NSData* data) {
+        [weakLRUCache setCompressedData:data ofObject:image forKey:snapshotID];
+      }));
+  _taskRunner->PostTask(
+      FROM_HERE,
+      base::BindOnce(base::IgnoreResult(&base::DeleteFile),
+                     ImagePath(snapshotID, IMAGE_TYPE_GREYSCALE,
+                               _snapshotsScale, _cacheDirectory)));
   _taskRunner->PostTask(
-      FROM_HERE, base::BindOnce(&WriteImageToDisk, image,
-                                ImagePath(snapshotID, IMAGE_TYPE_COLOR,
-                                          _snapshotsScale, _cacheDirectory)));
+      FROM_HERE,
+      base::BindOnce(&SnapshotThumbnailStore::Put,
+                     base::Unretained(_thumbnailStore.get()), snapshotID,
+                     image));
 }
 
 - (void)removeImageWithSnapshotID:(NSString*)snapshotID {
@@ -485,6 +628,10 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   _taskRunner->PostTask(
       FROM_HERE, base::BindOnce(&DeleteImageWithSnapshotID, _cacheDirectory,
                                 snapshotID, _snapshotsScale));
+  _taskRunner->PostTask(
+      FROM_HERE, base::BindOnce(&SnapshotThumbnailStore::Remove,
+                                base::Unretained(_thumbnailStore.get()),
+                                snapshotID));
 }
 
 - (void)removeAllImages {
@@ -497,6 +644,9 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
 
   _taskRunner->PostTask(FROM_HERE,
                         base::BindOnce(&RemoveAllImages, _cacheDirectory));
+  _taskRunner->PostTask(
+      FROM_HERE, base::BindOnce(&SnapshotThumbnailStore::Clear,
+                                base::Unretained(_thumbnailStore.get())));
 }
 
 - (base::FilePath)imagePathForSnapshotID:(NSString*)snapshotID {
@@ -530,6 +680,10 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   _taskRunner->PostTask(
       FROM_HERE, base::BindOnce(&PurgeCacheOlderThan, _cacheDirectory, date,
                                 liveSnapshotIDs, _snapshotsScale));
+  _taskRunner->PostTask(
+      FROM_HERE, base::BindOnce(&SnapshotThumbnailStore::PurgeOlderThan,
+                                base::Unretained(_thumbnailStore.get()), date,
+                                liveSnapshotIDs));
 }
 
 - (void)willBeSavedGreyWhenBackgrounding:(NSString*)snapshotID {
@@ -540,20 +694,11 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   _backgroundingColorImage = [_lruCache objectForKey:snapshotID];
 }
 
-// Remove all but adjacent UIImages from |lruCache_|.
+// Remove all but adjacent UIImages from |lruCache_|, and half of the JPEG
+// data.
 - (void)handleLowMemory {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
-  NSMutableDictionary<NSString*, UIImage*>* dictionary =
-      [NSMutableDictionary dictionaryWithCapacity:2];
-  for (NSString* snapshotID in self.pinnedIDs) {
-    UIImage* image = [_lruCache objectForKey:snapshotID];
-    if (image)
-      [dictionary setObject:image forKey:snapshotID];
-  }
-  [_lruCache removeAllObjects];
-  for (NSString* snapshotID in self.pinnedIDs)
-    [_lruCache setObject:[dictionary objectForKey:snapshotID]
-                  forKey:snapshotID];
+  [_lruCache shrinkKeepingObjectsForKeys:self.pinnedIDs];
 }
 
 // Remove all UIImages from |lruCache_|.
@@ -577,6 +722,14 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   if (greyImage)
     [_greyImageDictionary setObject:greyImage forKey:snapshotID];
+  if ([_pendingGreySnapshotIDs containsObject:snapshotID]) {
+    [_pendingGreySnapshotIDs removeObject:snapshotID];
+    if (!_pendingGreySnapshotIDs.count) {
+      UMA_HISTOGRAM_TIMES(
+          "IOS.Snapshots.GreyCacheCreationTime",
+          base::TimeTicks::Now() - _greyCacheCreationStartTime);
+    }
+  }
   if ([snapshotID isEqualToString:_mostRecentGreySnapshotID]) {
     _mostRecentGreyBlock(greyImage);
     [self clearGreySnapshotInfo];
@@ -586,21 +739,33 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
 // Load uncached snapshot image and convert image to grey.
 - (void)loadGreyImageAsync:(NSString*)snapshotID {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
+  __weak SnapshotCache* weakSelf = self;
+  void (^saveGreyImage)(UIImage*) = ^(UIImage* greyImage) {
+    [weakSelf saveGreyImage:greyImage forSnapshotID:snapshotID];
+  };
+
   // Don't call -retrieveImageForSnapshotID here because it caches the colored
   // image, which we don't need for the grey image cache. But if the image is
   // already in the cache, use it.
-  UIImage* image = [_lruCache objectForKey:snapshotID];
+  if (UIImage* image = [_lruCache objectForKey:snapshotID]) {
+    ConvertToGreyImage(image, saveGreyImage);
+    return;
+  }
 
   if (!_taskRunner)
     return;
 
-  __weak SnapshotCache* weakSelf = self;
+  // Only the disk reads run on |_taskRunner|, to stay ordered with the writes.
   base::PostTaskAndReplyWithResult(
       _taskRunner.get(), FROM_HERE,
-      base::BindOnce(&GreyImageFromCachedImage, _cacheDirectory, snapshotID,
-                     _snapshotsScale, image),
-      base::BindOnce(^(UIImage* greyImage) {
-        [weakSelf saveGreyImage:greyImage forSnapshotID:snapshotID];
+      base::BindOnce(&ReadGreyCacheSourceImage, _cacheDirectory, snapshotID,
+                     _snapshotsScale),
+      base::BindOnce(^(GreyCacheSourceImage source) {
+        if (source.is_grey || !source.image) {
+          saveGreyImage(source.image);
+          return;
+        }
+        ConvertToGreyImage(source.image, saveGreyImage);
       }));
 }
 
@@ -608,6 +773,8 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   _greyImageDictionary =
       [NSMutableDictionary dictionaryWithCapacity:kGreyInitialCapacity];
+  _pendingGreySnapshotIDs = [NSMutableSet setWithArray:snapshotIDs];
+  _greyCacheCreationStartTime = base::TimeTicks::Now();
   for (NSString* snapshotID in snapshotIDs)
     [self loadGreyImageAsync:snapshotID];
 }
@@ -615,6 +782,7 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
 - (void)removeGreyCache {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   _greyImageDictionary = nil;
+  _pendingGreySnapshotIDs = nil;
   [self clearGreySnapshotInfo];
 }
 
@@ -671,9 +839,11 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
         }
         [weakSelf retrieveImageForSnapshotID:snapshotID
                                     callback:^(UIImage* image) {
-                                      if (image)
-                                        image = GreyImage(image);
-                                      callback(image);
+                                      if (!image) {
+                                        callback(nil);
+                                        return;
+                                      }
+                                      ConvertToGreyImage(image, callback);
                                     }];
       }));
 }
@@ -709,6 +879,8 @@ UIImage* GreyImageFromCachedImage(const base::FilePath& cache_directory,
 }
 
 - (void)shutdown {
+  if (_taskRunner)
+    _taskRunner->DeleteSoon(FROM_HERE, std::move(_thumbnailStore));
   _taskRunner = nullptr;
 }
 
@@ -0,0 +1,16 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_SNAPSHOTS_SNAPSHOT_GREY_IMAGE_H_
+#define IOS_CHROME_BROWSER_SNAPSHOTS_SNAPSHOT_GREY_IMAGE_H_
+
+@class UIImage;
+
+// Returns a greyscale copy of the snapshot |image|, at scale 1.0 like
+// GreyImage(). The image is decoded into a bitmap and its luminance computed
+// with vImage, without UIKit drawing, so this may be called on any thread.
+// Returns nil if |image| has no bitmap.
+UIImage* GreySnapshotImage(UIImage* image);
+
+#endif  // IOS_CHROME_BROWSER_SNAPSHOTS_SNAPSHOT_GREY_IMAGE_H_
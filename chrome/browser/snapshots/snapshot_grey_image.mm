@@ -0,0 +1,90 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/snapshots/snapshot_grey_image.h"
+
+#import <Accelerate/Accelerate.h>
+#import <UIKit/UIKit.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "base/mac/scoped_cftyperef.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/timer/elapsed_timer.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Layout of the decoded color bitmap: 32 bits per pixel, in B, G, R, X order
+// in memory.
+const CGBitmapInfo kColorBitmapInfo =
+    kCGImageAlphaNoneSkipFirst | kCGBitmapByteOrder32Little;
+const size_t kBitsPerComponent = 8;
+
+// Rec. 601 luma coefficients of the channels of the color bitmap, in memory
+// order, with a sum of kLumaDivisor.
+const int16_t kLumaMatrix[4] = {29, 150, 77, 0};
+const int32_t kLumaDivisor = 256;
+
+}  // namespace
+
+UIImage* GreySnapshotImage(UIImage* image) {
+  CGImageRef cg_image = image.CGImage;
+  if (!cg_image)
+    return nil;
+  base::ElapsedTimer timer;
+
+  // Grey images are always non-retina to improve memory performance, so the
+  // snapshot is downscaled while it is decoded.
+  const size_t width = std::max(1L, std::lround(image.size.width));
+  const size_t height = std::max(1L, std::lround(image.size.height));
+
+  base::ScopedCFTypeRef<CGColorSpaceRef> rgb_color_space(
+      CGColorSpaceCreateDeviceRGB());
+  base::ScopedCFTypeRef<CGContextRef> color_context(CGBitmapContextCreate(
+      nullptr, width, height, kBitsPerComponent, 0, rgb_color_space,
+      kColorBitmapInfo));
+  if (!color_context)
+    return nil;
+  CGContextSetInterpolationQuality(color_context, kCGInterpolationMedium);
+  CGContextDrawImage(color_context, CGRectMake(0, 0, width, height), cg_image);
+
+  base::ScopedCFTypeRef<CGColorSpaceRef> grey_color_space(
+      CGColorSpaceCreateDeviceGray());
+  base::ScopedCFTypeRef<CGContextRef> grey_context(CGBitmapContextCreate(
+      nullptr, width, height, kBitsPerComponent, 0, grey_color_space,
+      kCGImageAlphaNone));
+  if (!grey_context)
+    return nil;
+
+  const vImage_Buffer source = {
+      CGBitmapContextGetData(color_context), height, width,
+      CGBitmapContextGetBytesPerRow(color_context)};
+  const vImage_Buffer destination = {
+      CGBitmapContextGetData(grey_context), height, width,
+      CGBitmapContextGetBytesPerRow(grey_context)};
+  const int32_t rounding_bias = kLumaDivisor / 2;
+  vImage_Error error = vImageMatrixMultiply_ARGB8888ToPlanar8(
+      &source, &destination, kLumaMatrix, kLumaDivisor, nullptr,
+      rounding_bias, kvImageNoFlags);
+  if (error != kvImageNoError)
+    return nil;
+
+  base::ScopedCFTypeRef<CGImageRef> grey_image(
+      CGBitmapContextCreateImage(grey_context));
+  if (!grey_image)
+    return nil;
+  UMA_HISTOGRAM_TIMES("IOS.Snapshots.GreyImageConversionTime",
+                      timer.Elapsed());
+  return [UIImage imageWithCGImage:grey_image
+                             scale:1.0
+                       orientation:UIImageOrientationUp];
+}
@@ -0,0 +1,76 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/snapshots/snapshot_grey_image.h"
+
+#import <UIKit/UIKit.h>
+
+#include "base/mac/scoped_cftyperef.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+using SnapshotGreyImageTest = PlatformTest;
+
+// Returns an opaque image of |size| at scale 2.0, with its left half filled
+// with |left_color| and its right half with |right_color|.
+UIImage* TwoColorImage(CGSize size, UIColor* left_color, UIColor* right_color) {
+  UIGraphicsBeginImageContextWithOptions(size, /*opaque=*/YES, /*scale=*/2.0);
+  CGContextRef context = UIGraphicsGetCurrentContext();
+  CGContextSetFillColorWithColor(context, left_color.CGColor);
+  CGContextFillRect(context, CGRectMake(0, 0, size.width / 2, size.height));
+  CGContextSetFillColorWithColor(context, right_color.CGColor);
+  CGContextFillRect(context, CGRectMake(size.width / 2, 0, size.width / 2,
+                                        size.height));
+  UIImage* image = UIGraphicsGetImageFromCurrentImageContext();
+  UIGraphicsEndImageContext();
+  return image;
+}
+
+// Tests that grey images are non-retina, with a single 8 bits channel.
+TEST_F(SnapshotGreyImageTest, GreyImageFormat) {
+  const CGSize kSize = CGSizeMake(40, 30);
+  UIImage* grey_image = GreySnapshotImage(
+      TwoColorImage(kSize, UIColor.whiteColor, UIColor.blackColor));
+  ASSERT_TRUE(grey_image);
+  EXPECT_EQ(kSize.width, grey_image.size.width);
+  EXPECT_EQ(kSize.height, grey_image.size.height);
+  EXPECT_EQ(1.0, grey_image.scale);
+  EXPECT_EQ(8u, CGImageGetBitsPerPixel(grey_image.CGImage));
+  EXPECT_EQ(kCGColorSpaceModelMonochrome,
+            CGColorSpaceGetModel(CGImageGetColorSpace(grey_image.CGImage)));
+}
+
+// Tests that the grey levels are the luminance of the colors.
+TEST_F(SnapshotGreyImageTest, Luminance) {
+  const CGSize kSize = CGSizeMake(20, 10);
+  UIImage* grey_image = GreySnapshotImage(
+      TwoColorImage(kSize, UIColor.redColor, UIColor.greenColor));
+  ASSERT_TRUE(grey_image);
+
+  CGImageRef cg_image = grey_image.CGImage;
+  base::ScopedCFTypeRef<CFDataRef> data(
+      CGDataProviderCopyData(CGImageGetDataProvider(cg_image)));
+  ASSERT_TRUE(data);
+  const UInt8* pixels = CFDataGetBytePtr(data);
+  const size_t bytes_per_row = CGImageGetBytesPerRow(cg_image);
+  const size_t middle_row = bytes_per_row * (CGImageGetHeight(cg_image) / 2);
+
+  // 0.299 * 255 for red and 0.587 * 255 for green.
+  EXPECT_NEAR(76, pixels[middle_row + 2], 2);
+  EXPECT_NEAR(150, pixels[middle_row + 17], 2);
+}
+
+// Tests that images without bitmap are not converted.
+TEST_F(SnapshotGreyImageTest, NoBitmap) {
+  EXPECT_FALSE(GreySnapshotImage([[UIImage alloc] init]));
+  EXPECT_FALSE(GreySnapshotImage(nil));
+}
+
+}  // namespace
@@ -7,9 +7,16 @@
 
 #import <Foundation/Foundation.h>
 
+#include <stddef.h>
+
 // This class implements a cache with a limited size. Once the cache reach its
 // size limit, it will start to evict items in a Least Recently Used order
 // (where the term "used" is determined in terms of query to the cache).
+//
+// The size of the cache is limited in number of items and, for UIImages, in
+// decoded bytes. Besides the objects, the cache can keep a second tier of
+// compressed data (e.g. the JPEG data of the images), with its own byte
+// budget, which is still available after the objects were evicted.
 @interface SnapshotLRUCache : NSObject
 
 // The maximum amount of items that the cache can hold before starting to
@@ -17,13 +24,39 @@
 // amount of elements (i.e. never evicts).
 @property(nonatomic, readonly) NSUInteger maxCacheSize;
 
+// The maximum amount of decoded bytes of the UIImages that the cache can hold
+// before starting to evict. The value 0 is used to signify that the amount of
+// bytes is unlimited. Objects which are not UIImages take no bytes.
+@property(nonatomic, readonly) size_t byteBudget;
+
+// The maximum amount of bytes of compressed data that the cache can hold. The
+// value 0 is used to signify that compressed data is not kept.
+@property(nonatomic, readonly) size_t compressedByteBudget;
+
+// Decoded bytes of the UIImages held, and bytes of compressed data held.
+@property(nonatomic, readonly) size_t residentBytes;
+@property(nonatomic, readonly) size_t compressedResidentBytes;
+
+// Number of queries which found an object, of queries which found no object,
+// and of queries which found compressed data.
+@property(nonatomic, readonly) NSUInteger hitCount;
+@property(nonatomic, readonly) NSUInteger missCount;
+@property(nonatomic, readonly) NSUInteger compressedHitCount;
+
 // Use the initWithCacheSize: designated initializer. The is no good general
 // default value for the cache size.
 - (instancetype)init NS_UNAVAILABLE;
 
 // |maxCacheSize| value is used to specify the maximum amount of items that the
-// cache can hold before starting to evict items.
+// cache can hold before starting to evict items. The amount of bytes is not
+// limited and no compressed data is kept.
+- (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize;
+
+// |maxCacheSize|, |byteBudget| and |compressedByteBudget| specify the limits
+// described by the properties with the same name.
 - (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize
+                       byteBudget:(size_t)byteBudget
+             compressedByteBudget:(size_t)compressedByteBudget
     NS_DESIGNATED_INITIALIZER;
 
 // Query the cache for an item corresponding to the |key|. Returns nil if there
@@ -31,17 +64,33 @@
 - (id)objectForKey:(id<NSObject>)key;
 
 // Adds the pair |key|, |obj| to the cache. If the value of the maxCacheSize
-// property is non zero, the cache may evict an elements if the maximum cache
-// size is reached. If the |key| is already present in the cache, the value for
-// that key is replaced by |object|.
+// or byteBudget properties is non zero, the cache may evict elements if the
+// limit is reached. If the |key| is already present in the cache, the value for
+// that key is replaced by |object| and its compressed data is removed.
 - (void)setObject:(id<NSObject>)object forKey:(NSObject*)key;
 
-// Remove the key, value pair corresponding to the given |key|.
+// Query the cache for the compressed data corresponding to the |key|. Returns
+// nil if there is no compressed data for that key.
+- (NSData*)compressedDataForKey:(id<NSObject>)key;
+
+// Stores |data| as the compressed data for |key|, if |object| is still the item
+// corresponding to |key|. The least recently stored compressed data is evicted
+// when the compressedByteBudget is reached.
+- (void)setCompressedData:(NSData*)data
+                 ofObject:(id<NSObject>)object
+                   forKey:(NSObject*)key;
+
+// Remove the key, value pair corresponding to the given |key|, and its
+// compressed data.
 - (void)removeObjectForKey:(id<NSObject>)key;
 
-// Remove all objects from the cache.
+// Remove all objects and compressed data from the cache.
 - (void)removeAllObjects;
 
+// Reduces the memory used by the cache, on memory warnings: removes the items
+// for keys which are not in |keys| and halves the compressed data.
+- (void)shrinkKeepingObjectsForKeys:(NSSet*)keys;
+
 // Returns the amount of items that the cache currently hold.
 - (NSUInteger)count;
 
@@ -4,11 +4,14 @@
 
 #import "ios/chrome/browser/snapshots/snapshot_lru_cache.h"
 
+#import <UIKit/UIKit.h>
+
 #include <stddef.h>
 
 #include <memory>
 #include <unordered_map>
 
+#include "base/check_op.h"
 #include "base/containers/lru_cache.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
@@ -27,45 +30,121 @@ struct NSObjectHash {
   std::size_t operator()(id<NSObject> obj) const { return [obj hash]; }
 };
 
+// An object of the cache, with its decoded size.
+struct CachedObject {
+  id<NSObject> object;
+  size_t bytes;
+};
+
 using NSObjectLRUCache = base::
-    HashingLRUCache<id<NSObject>, id<NSObject>, NSObjectHash, NSObjectEqualTo>;
+    HashingLRUCache<id<NSObject>, CachedObject, NSObjectHash, NSObjectEqualTo>;
+using NSDataLRUCache =
+    base::HashingLRUCache<id<NSObject>, NSData*, NSObjectHash, NSObjectEqualTo>;
+
+// Returns the size of |object| once decoded, if it is an image.
+size_t DecodedBytes(id<NSObject> object) {
+  if (![object isKindOfClass:[UIImage class]])
+    return 0;
+  CGImageRef image = static_cast<UIImage*>(object).CGImage;
+  return CGImageGetBytesPerRow(image) * CGImageGetHeight(image);
+}
 
 }  // namespace
 
 @implementation SnapshotLRUCache {
+  // Both caches evict in -evictObjectsIfNeeded and
+  // -evictCompressedDataToByteBudget:, to keep the byte counts exact.
   std::unique_ptr<NSObjectLRUCache> _cache;
+  std::unique_ptr<NSDataLRUCache> _compressedCache;
 }
 
 - (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize {
+  return [self initWithCacheSize:maxCacheSize
+                      byteBudget:0
+            compressedByteBudget:0];
+}
+
+- (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize
+                       byteBudget:(size_t)byteBudget
+             compressedByteBudget:(size_t)compressedByteBudget {
   if ((self = [super init])) {
-    _cache = std::make_unique<NSObjectLRUCache>(maxCacheSize);
+    _maxCacheSize = maxCacheSize;
+    _byteBudget = byteBudget;
+    _compressedByteBudget = compressedByteBudget;
+    _cache =
+        std::make_unique<NSObjectLRUCache>(NSObjectLRUCache::NO_AUTO_EVICT);
+    _compressedCache =
+        std::make_unique<NSDataLRUCache>(NSDataLRUCache::NO_AUTO_EVICT);
   }
   return self;
 }
 
-- (NSUInteger)maxCacheSize {
-  return _cache->max_size();
-}
-
 - (id)objectForKey:(id<NSObject>)key {
   auto it = _cache->Get(key);
-  if (it == _cache->end())
+  if (it == _cache->end()) {
+    _missCount++;
     return nil;
-  return it->second;
+  }
+  _hitCount++;
+  return it->second.object;
 }
 
 - (void)setObject:(id<NSObject>)value forKey:(NSObject*)key {
-  _cache->Put([key copy], value);
+  [self removeObjectForKey:key];
+  const size_t bytes = DecodedBytes(value);
+  _cache->Put([key copy], CachedObject{value, bytes});
+  _residentBytes += bytes;
+  [self evictObjectsIfNeeded];
+}
+
+- (NSData*)compressedDataForKey:(id<NSObject>)key {
+  auto it = _compressedCache->Get(key);
+  if (it == _compressedCache->end())
+    return nil;
+  _compressedHitCount++;
+  return it->second;
+}
+
+- (void)setCompressedData:(NSData*)data
+                 ofObject:(id<NSObject>)object
+                   forKey:(NSObject*)key {
+  if (!data.length || data.length > _compressedByteBudget)
+    return;
+  auto it = _cache->Peek(key);
+  if (it == _cache->end() || it->second.object != object)
+    return;
+  [self removeCompressedDataForKey:key];
+  _compressedCache->Put([key copy], data);
+  _compressedResidentBytes += data.length;
+  [self evictCompressedDataToByteBudget:_compressedByteBudget];
 }
 
 - (void)removeObjectForKey:(id<NSObject>)key {
   auto it = _cache->Peek(key);
-  if (it != _cache->end())
+  if (it != _cache->end()) {
+    _residentBytes -= it->second.bytes;
     _cache->Erase(it);
+  }
+  [self removeCompressedDataForKey:key];
 }
 
 - (void)removeAllObjects {
   _cache->Clear();
+  _compressedCache->Clear();
+  _residentBytes = 0;
+  _compressedResidentBytes = 0;
+}
+
+- (void)shrinkKeepingObjectsForKeys:(NSSet*)keys {
+  for (auto it = _cache->begin(); it != _cache->end();) {
+    if ([keys containsObject:it->first]) {
+      ++it;
+      continue;
+    }
+    _residentBytes -= it->second.bytes;
+    it = _cache->Erase(it);
+  }
+  [self evictCompressedDataToByteBudget:_compressedByteBudget / 2];
 }
 
 - (NSUInteger)count {
@@ -76,4 +155,37 @@ using NSObjectLRUCache = base::
   return _cache->empty();
 }
 
+#pragma mark - Private
+
+// Evicts the least recently used objects until the cache is within its limits.
+// The most recent object is kept even if it is larger than the byte budget.
+- (void)evictObjectsIfNeeded {
+  while (_cache->size() > 1 &&
+         ((_maxCacheSize && _cache->size() > _maxCacheSize) ||
+          (_byteBudget && _residentBytes > _byteBudget))) {
+    auto oldest = _cache->rbegin();
+    _residentBytes -= oldest->second.bytes;
+    _cache->Erase(oldest);
+  }
+}
+
+// Evicts the least recently used compressed data until it takes at most
+// |byteBudget| bytes.
+- (void)evictCompressedDataToByteBudget:(size_t)byteBudget {
+  while (!_compressedCache->empty() && _compressedResidentBytes > byteBudget) {
+    auto oldest = _compressedCache->rbegin();
+    _compressedResidentBytes -= oldest->second.length;
+    _compressedCache->Erase(oldest);
+  }
+}
+
+- (void)removeCompressedDataForKey:(id<NSObject>)key {
+  auto it = _compressedCache->Peek(key);
+  if (it == _compressedCache->end())
+    return;
+  DCHECK_GE(_compressedResidentBytes, it->second.length);
+  _compressedResidentBytes -= it->second.length;
+  _compressedCache->Erase(it);
+}
+
 @end
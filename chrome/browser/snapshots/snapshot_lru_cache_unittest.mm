@@ -3,6 +3,9 @@
 // found in the LICENSE file.
 
 #import "ios/chrome/browser/snapshots/snapshot_lru_cache.h"
+
+#import <UIKit/UIKit.h>
+
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -14,6 +17,21 @@ namespace {
 
 using SnapshotLRUCacheTest = PlatformTest;
 
+// Returns an image of |width| x |height| pixels.
+UIImage* ImageWithPixelSize(CGFloat width, CGFloat height) {
+  UIGraphicsBeginImageContextWithOptions(CGSizeMake(width, height),
+                                         /*opaque=*/YES, /*scale=*/1.0);
+  UIImage* image = UIGraphicsGetImageFromCurrentImageContext();
+  UIGraphicsEndImageContext();
+  return image;
+}
+
+// Returns the decoded size of |image|.
+size_t DecodedBytes(UIImage* image) {
+  return CGImageGetBytesPerRow(image.CGImage) *
+         CGImageGetHeight(image.CGImage);
+}
+
 TEST_F(SnapshotLRUCacheTest, Basic) {
   SnapshotLRUCache* cache = [[SnapshotLRUCache alloc] initWithCacheSize:3];
 
@@ -48,4 +66,105 @@ TEST_F(SnapshotLRUCacheTest, Basic) {
   EXPECT_TRUE([cache isEmpty]);
 }
 
+// Tests that images are evicted when their decoded bytes exceed the budget,
+// whatever their number.
+TEST_F(SnapshotLRUCacheTest, ByteBudget) {
+  UIImage* small_image = ImageWithPixelSize(10, 10);
+  UIImage* large_image = ImageWithPixelSize(100, 100);
+  const size_t budget =
+      DecodedBytes(large_image) + 2 * DecodedBytes(small_image);
+  SnapshotLRUCache* cache = [[SnapshotLRUCache alloc] initWithCacheSize:0
+                                                             byteBudget:budget
+                                                   compressedByteBudget:0];
+
+  [cache setObject:small_image forKey:@"small 1"];
+  [cache setObject:small_image forKey:@"small 2"];
+  [cache setObject:large_image forKey:@"large"];
+  EXPECT_EQ(3u, [cache count]);
+  EXPECT_EQ(budget, [cache residentBytes]);
+
+  // Adding another small image evicts the least recently used one.
+  EXPECT_EQ(small_image, [cache objectForKey:@"small 1"]);
+  [cache setObject:small_image forKey:@"small 3"];
+  EXPECT_EQ(3u, [cache count]);
+  EXPECT_FALSE([cache objectForKey:@"small 2"]);
+  EXPECT_EQ(budget, [cache residentBytes]);
+
+  // Adding another large image evicts the least recently used images until
+  // the budget is respected, which is only the first large image.
+  [cache setObject:large_image forKey:@"large 2"];
+  EXPECT_EQ(3u, [cache count]);
+  EXPECT_FALSE([cache objectForKey:@"large"]);
+  EXPECT_EQ(budget, [cache residentBytes]);
+
+  // Replacing or removing an image updates the resident bytes.
+  [cache setObject:small_image forKey:@"large 2"];
+  EXPECT_EQ(3 * DecodedBytes(small_image), [cache residentBytes]);
+  [cache removeObjectForKey:@"large 2"];
+  EXPECT_EQ(2 * DecodedBytes(small_image), [cache residentBytes]);
+
+  EXPECT_EQ(1u, [cache hitCount]);
+  EXPECT_EQ(2u, [cache missCount]);
+}
+
+// Tests that compressed data outlives its evicted object, within its own
+// budget.
+TEST_F(SnapshotLRUCacheTest, CompressedData) {
+  NSData* data = [NSMutableData dataWithLength:100];
+  SnapshotLRUCache* cache = [[SnapshotLRUCache alloc] initWithCacheSize:1
+                                                             byteBudget:0
+                                                   compressedByteBudget:250];
+  NSString* value1 = @"Value 1";
+  NSString* value2 = @"Value 2";
+  NSString* value3 = @"Value 3";
+
+  // Compressed data is only stored for the current object of the key.
+  [cache setObject:value1 forKey:@"KEY 1"];
+  [cache setCompressedData:data ofObject:value2 forKey:@"KEY 1"];
+  EXPECT_FALSE([cache compressedDataForKey:@"KEY 1"]);
+  [cache setCompressedData:data ofObject:value1 forKey:@"KEY 1"];
+  EXPECT_EQ(data, [cache compressedDataForKey:@"KEY 1"]);
+
+  // It is kept when the object is evicted.
+  [cache setObject:value2 forKey:@"KEY 2"];
+  [cache setCompressedData:data ofObject:value2 forKey:@"KEY 2"];
+  EXPECT_FALSE([cache objectForKey:@"KEY 1"]);
+  EXPECT_EQ(data, [cache compressedDataForKey:@"KEY 1"]);
+  EXPECT_EQ(200u, [cache compressedResidentBytes]);
+
+  // The least recently used data is evicted above the budget.
+  [cache setObject:value3 forKey:@"KEY 3"];
+  [cache setCompressedData:data ofObject:value3 forKey:@"KEY 3"];
+  EXPECT_EQ(200u, [cache compressedResidentBytes]);
+  EXPECT_FALSE([cache compressedDataForKey:@"KEY 2"]);
+  EXPECT_TRUE([cache compressedDataForKey:@"KEY 1"]);
+  EXPECT_EQ(3u, [cache compressedHitCount]);
+
+  // It is removed when the object is replaced.
+  [cache setObject:value1 forKey:@"KEY 3"];
+  EXPECT_FALSE([cache compressedDataForKey:@"KEY 3"]);
+  EXPECT_EQ(100u, [cache compressedResidentBytes]);
+}
+
+// Tests that shrinking keeps the objects of the given keys and half of the
+// compressed data.
+TEST_F(SnapshotLRUCacheTest, Shrink) {
+  NSData* data = [NSMutableData dataWithLength:100];
+  SnapshotLRUCache* cache = [[SnapshotLRUCache alloc] initWithCacheSize:0
+                                                             byteBudget:0
+                                                   compressedByteBudget:400];
+  NSArray<NSString*>* keys = @[ @"KEY 1", @"KEY 2", @"KEY 3", @"KEY 4" ];
+  for (NSString* key in keys) {
+    [cache setObject:key forKey:key];
+    [cache setCompressedData:data ofObject:key forKey:key];
+  }
+
+  [cache shrinkKeepingObjectsForKeys:[NSSet setWithObjects:@"KEY 1", nil]];
+  EXPECT_EQ(1u, [cache count]);
+  EXPECT_TRUE([cache objectForKey:@"KEY 1"]);
+  EXPECT_EQ(200u, [cache compressedResidentBytes]);
+  EXPECT_TRUE([cache compressedDataForKey:@"KEY 4"]);
+  EXPECT_FALSE([cache compressedDataForKey:@"KEY 1"]);
+}
+
 }  // namespace
@@ -0,0 +1,141 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_SNAPSHOTS_SNAPSHOT_THUMBNAIL_STORE_H_
+#define IOS_CHROME_BROWSER_SNAPSHOTS_SNAPSHOT_THUMBNAIL_STORE_H_
+
+#import <Foundation/Foundation.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+
+@class UIImage;
+
+class ThumbnailPackMapping;
+
+// SnapshotThumbnailStore keeps downscaled copies of the tab snapshots in a
+// single pack file, so that the thumbnails of all the tabs can be loaded
+// without opening and decoding one JPEG file per tab.
+//
+// Thumbnails are stored as raw 32 bits per pixel bitmaps that can be handed
+// to CoreGraphics as is: the images returned by Get() point directly into a
+// memory mapping of the pack file and are never copied nor decoded. The pack
+// file is append-only; replaced and removed thumbnails are reclaimed by
+// rewriting the live ones into a new file once they waste enough space.
+//
+// Must be used on a single sequence allowed to block, but may be created on
+// another sequence.
+class SnapshotThumbnailStore {
+ public:
+  // Name of the pack file in the snapshot cache directory.
+  static const char kPackFileName[];
+
+  // Thumbnails are downscaled to at most |max_pixel_width| pixels wide, which
+  // should be the width of the tab grid cells at the screen scale.
+  SnapshotThumbnailStore(const base::FilePath& cache_directory,
+                         uint32_t max_pixel_width);
+
+  SnapshotThumbnailStore(const SnapshotThumbnailStore&) = delete;
+  SnapshotThumbnailStore& operator=(const SnapshotThumbnailStore&) = delete;
+
+  ~SnapshotThumbnailStore();
+
+  // Downscales |image| and stores it as the thumbnail of |snapshot_id|,
+  // replacing the previous one if any.
+  void Put(NSString* snapshot_id, UIImage* image);
+
+  // Removes the thumbnail of |snapshot_id|, if any.
+  void Remove(NSString* snapshot_id);
+
+  // Returns the thumbnails of |snapshot_ids|, keyed by snapshot ID. Snapshot
+  // IDs without thumbnail are not present in the result.
+  NSDictionary<NSString*, UIImage*>* Get(NSArray<NSString*>* snapshot_ids);
+
+  // Removes the thumbnails written before |threshold_date|, except those of
+  // |keep_alive_snapshot_ids|.
+  void PurgeOlderThan(base::Time threshold_date,
+                      NSSet<NSString*>* keep_alive_snapshot_ids);
+
+  // Removes all the thumbnails and deletes the pack file.
+  void Clear();
+
+  // Returns the path of the pack file.
+  const base::FilePath& pack_path() const { return pack_path_; }
+
+ private:
+  // Location of a thumbnail in the pack file.
+  struct Record {
+    // Offset of the record in the pack file and size of the record, including
+    // its header.
+    size_t offset = 0;
+    size_t size = 0;
+    // Offset of the pixels in the pack file.
+    size_t pixels_offset = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t bytes_per_row = 0;
+    float scale = 1.0;
+    base::Time write_time;
+  };
+
+  // Opens the pack file and builds the index, creating the file if needed.
+  // Returns whether the store can be used.
+  bool EnsureOpen();
+
+  // Recreates the pack file with no record.
+  bool ResetPackFile();
+
+  // Appends a record for |snapshot_id| to the pack file. |pixels| is null for
+  // a tombstone. Returns the location of the record, or a Record of size 0 on
+  // failure.
+  Record AppendRecord(const std::string& snapshot_id,
+                      const Record& image_info,
+                      const uint8_t* pixels);
+
+  // Writes a tombstone for |snapshot_id| and forgets about its live record,
+  // if any.
+  void RemoveRecord(const std::string& snapshot_id);
+
+  // Forgets about the live record of |snapshot_id|, if any.
+  void EraseRecord(const std::string& snapshot_id);
+
+  // Maps the pack file in memory if the current mapping does not cover all
+  // the records.
+  bool EnsureMapped();
+
+  // Rewrites the live records to a new pack file if the dead records use too
+  // much space.
+  void MaybeCompact();
+
+  const base::FilePath pack_path_;
+
+  // Maximum width of the thumbnails, in pixels.
+  const uint32_t max_pixel_width_;
+
+  // Pack file, opened for reading and writing, and its length as known by the
+  // store (records are appended at this offset).
+  base::File file_;
+  size_t file_length_ = 0;
+
+  // Read-only mapping of the pack file. Shared with the images returned by
+  // Get() so that it outlives the store and the compactions.
+  scoped_refptr<ThumbnailPackMapping> mapping_;
+
+  // Live records by snapshot ID and their total size.
+  std::map<std::string, Record> index_;
+  size_t live_bytes_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+#endif  // IOS_CHROME_BROWSER_SNAPSHOTS_SNAPSHOT_THUMBNAIL_STORE_H_
@@ -0,0 +1,567 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/snapshots/snapshot_thumbnail_store.h"
+
+#import <UIKit/UIKit.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#import "base/mac/backup_util.h"
+#include "base/mac/scoped_cftyperef.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/sys_string_conversions.h"
+#include "base/threading/scoped_blocking_call.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+// Read-only mapping of a pack file, kept alive by the images pointing into it.
+class ThumbnailPackMapping
+    : public base::RefCountedThreadSafe<ThumbnailPackMapping> {
+ public:
+  ThumbnailPackMapping() = default;
+
+  ThumbnailPackMapping(const ThumbnailPackMapping&) = delete;
+  ThumbnailPackMapping& operator=(const ThumbnailPackMapping&) = delete;
+
+  bool Initialize(base::File file) {
+    return mapped_file_.Initialize(std::move(file));
+  }
+
+  const uint8_t* data() const { return mapped_file_.data(); }
+  size_t length() const { return mapped_file_.length(); }
+
+ private:
+  friend class base::RefCountedThreadSafe<ThumbnailPackMapping>;
+  ~ThumbnailPackMapping() = default;
+
+  base::MemoryMappedFile mapped_file_;
+};
+
+namespace {
+
+// The pack file starts with a PackHeader followed by the records. Each record
+// is a RecordHeader, followed by the snapshot ID and the thumbnail pixels,
+// each padded to kAlignment bytes. A record without pixels is a tombstone
+// marking the removal of the previous thumbnail for the same snapshot ID.
+struct PackHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t reserved[2];
+};
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t id_length;
+  uint32_t width;
+  uint32_t height;
+  uint32_t bytes_per_row;
+  float scale;
+  int64_t write_time;
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader must be 16 bytes");
+static_assert(sizeof(RecordHeader) == 32, "RecordHeader must be 32 bytes");
+
+const uint32_t kPackMagic = 0x4b504e53;  // "SNPK".
+const uint32_t kPackVersion = 2;
+const uint32_t kRecordMagic = 0x48544e53;  // "SNTH".
+
+// Alignment of the records and of the pixel rows in the pack file.
+const size_t kAlignment = 16;
+
+// Thumbnails keep at most the top kThumbnailMaxAspectRatio (height / width) of
+// the snapshot, which is what the grid cells display.
+const CGFloat kThumbnailMaxAspectRatio = 1.25;
+
+// Thumbnails are stored as 32 bits per pixel RGB in the native byte order,
+// which CoreGraphics can draw without conversion. 16 bits per pixel causes
+// visible banding in the gradients of the pages.
+const size_t kBitsPerComponent = 8;
+const size_t kBitsPerPixel = 32;
+const CGBitmapInfo kBitmapInfo =
+    kCGImageAlphaNoneSkipFirst | kCGBitmapByteOrder32Little;
+
+const uint32_t kMaxSnapshotIDLength = 256;
+
+// The pack file is compacted once the dead records use more than this and
+// more than the live records.
+const size_t kMinCompactionBytes = 4 * 1024 * 1024;
+
+size_t AlignUp(size_t value) {
+  return (value + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+uint32_t BytesPerRow(uint32_t width) {
+  return static_cast<uint32_t>(AlignUp(width * kBitsPerPixel / 8));
+}
+
+size_t RecordSize(const RecordHeader& header) {
+  return sizeof(RecordHeader) + AlignUp(header.id_length) +
+         static_cast<size_t>(header.bytes_per_row) * header.height;
+}
+
+// Returns the maximum height of a thumbnail |max_width| pixels wide.
+uint32_t MaxPixelHeight(uint32_t max_width) {
+  return static_cast<uint32_t>(
+      std::lround(max_width * kThumbnailMaxAspectRatio));
+}
+
+bool IsValidRecordHeader(const RecordHeader& header, uint32_t max_width) {
+  if (header.magic != kRecordMagic || header.id_length == 0 ||
+      header.id_length > kMaxSnapshotIDLength) {
+    return false;
+  }
+  // Tombstone.
+  if (header.width == 0)
+    return header.height == 0 && header.bytes_per_row == 0;
+  return header.width <= max_width &&
+         header.height <= MaxPixelHeight(max_width) && header.height > 0 &&
+         header.bytes_per_row == BytesPerRow(header.width) &&
+         header.scale > 0;
+}
+
+// Sets the protection and backup attributes of the pack file at |path|, as
+// done for the snapshot files.
+void ProtectPackFile(const base::FilePath& path) {
+  NSDictionary* attribute_dict = [NSDictionary
+      dictionaryWithObject:NSFileProtectionCompleteUntilFirstUserAuthentication
+                    forKey:NSFileProtectionKey];
+  NSError* error = nil;
+  BOOL success = [[NSFileManager defaultManager]
+      setAttributes:attribute_dict
+       ofItemAtPath:base::SysUTF8ToNSString(path.AsUTF8Unsafe())
+              error:&error];
+  if (!success) {
+    DLOG(ERROR) << "Error encrypting thumbnail pack file "
+                << base::SysNSStringToUTF8([error description]);
+  }
+  base::mac::SetBackupExclusion(path);
+}
+
+// Releases the reference to the ThumbnailPackMapping taken for an image.
+void ReleaseThumbnailPackMapping(void* info, const void* data, size_t size) {
+  static_cast<ThumbnailPackMapping*>(info)->Release();
+}
+
+}  // namespace
+
+// static
+const char SnapshotThumbnailStore::kPackFileName[] = "Thumbnails.pack";
+
+SnapshotThumbnailStore::SnapshotThumbnailStore(
+    const base::FilePath& cache_directory,
+    uint32_t max_pixel_width)
+    : pack_path_(cache_directory.Append(kPackFileName)),
+      max_pixel_width_(max_pixel_width) {
+  DCHECK_GT(max_pixel_width_, 0u);
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+SnapshotThumbnailStore::~SnapshotThumbnailStore() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+void SnapshotThumbnailStore::Put(NSString* snapshot_id, UIImage* image) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::MAY_BLOCK);
+  CGImageRef cg_image = image.CGImage;
+  const std::string id = base::SysNSStringToUTF8(snapshot_id);
+  if (!cg_image || id.empty() || id.size() > kMaxSnapshotIDLength)
+    return;
+
+  const size_t image_width = CGImageGetWidth(cg_image);
+  const size_t image_height = CGImageGetHeight(cg_image);
+  if (!image_width || !image_height || !EnsureOpen())
+    return;
+
+  // Downscale the snapshot to the thumbnail width and keep its top part.
+  const CGFloat factor =
+      std::min<CGFloat>(1.0, CGFloat(max_pixel_width_) / image_width);
+  const CGFloat scaled_height = image_height * factor;
+  Record info;
+  info.width = static_cast<uint32_t>(
+      std::max(1L, std::lround(image_width * factor)));
+  info.height = static_cast<uint32_t>(std::max(
+      1L, std::min(std::lround(scaled_height),
+                   std::lround(info.width * kThumbnailMaxAspectRatio))));
+  info.bytes_per_row = BytesPerRow(info.width);
+  info.scale = static_cast<float>(image.scale * info.width / image_width);
+
+  std::vector<uint8_t> pixels(info.bytes_per_row * info.height);
+  base::ScopedCFTypeRef<CGColorSpaceRef> color_space(
+      CGColorSpaceCreateDeviceRGB());
+  base::ScopedCFTypeRef<CGContextRef> context(CGBitmapContextCreate(
+      pixels.data(), info.width, info.height, kBitsPerComponent,
+      info.bytes_per_row, color_space, kBitmapInfo));
+  if (!context)
+    return;
+  CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+  CGContextDrawImage(context,
+                     CGRectMake(0, info.height - scaled_height, info.width,
+                                scaled_height),
+                     cg_image);
+
+  Record record = AppendRecord(id, info, pixels.data());
+  if (!record.size)
+    return;
+  EraseRecord(id);
+  index_[id] = record;
+  live_bytes_ += record.size;
+  MaybeCompact();
+}
+
+void SnapshotThumbnailStore::Remove(NSString* snapshot_id) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::MAY_BLOCK);
+  if (!EnsureOpen())
+    return;
+  RemoveRecord(base::SysNSStringToUTF8(snapshot_id));
+  MaybeCompact();
+}
+
+NSDictionary<NSString*, UIImage*>* SnapshotThumbnailStore::Get(
+    NSArray<NSString*>* snapshot_ids) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::MAY_BLOCK);
+  NSMutableDictionary<NSString*, UIImage*>* thumbnails =
+      [NSMutableDictionary dictionaryWithCapacity:snapshot_ids.count];
+  if (!EnsureOpen() || index_.empty() || !EnsureMapped())
+    return thumbnails;
+
+  base::ScopedCFTypeRef<CGColorSpaceRef> color_space(
+      CGColorSpaceCreateDeviceRGB());
+  for (NSString* snapshot_id in snapshot_ids) {
+    auto it = index_.find(base::SysNSStringToUTF8(snapshot_id));
+    if (it == index_.end())
+      continue;
+
+    // The image points into the mapping and keeps a reference on it, released
+    // by ReleaseThumbnailPackMapping().
+    const Record& record = it->second;
+    mapping_->AddRef();
+    base::ScopedCFTypeRef<CGDataProviderRef> provider(
+        CGDataProviderCreateWithData(
+            mapping_.get(), mapping_->data() + record.pixels_offset,
+            record.bytes_per_row * record.height,
+            &ReleaseThumbnailPackMapping));
+    if (!provider) {
+      mapping_->Release();
+      continue;
+    }
+    base::ScopedCFTypeRef<CGImageRef> cg_image(CGImageCreate(
+        record.width, record.height, kBitsPerComponent, kBitsPerPixel,
+        record.bytes_per_row, color_space, kBitmapInfo, provider, nullptr,
+        false, kCGRenderingIntentDefault));
+    if (!cg_image)
+      continue;
+    thumbnails[snapshot_id] =
+        [UIImage imageWithCGImage:cg_image
+                            scale:record.scale
+                      orientation:UIImageOrientationUp];
+  }
+  return thumbnails;
+}
+
+void SnapshotThumbnailStore::PurgeOlderThan(
+    base::Time threshold_date,
+    NSSet<NSString*>* keep_alive_snapshot_ids) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::MAY_BLOCK);
+  if (!EnsureOpen())
+    return;
+
+  std::set<std::string> ids_to_keep;
+  for (NSString* snapshot_id in keep_alive_snapshot_ids)
+    ids_to_keep.insert(base::SysNSStringToUTF8(snapshot_id));
+
+  std::vector<std::string> ids_to_remove;
+  for (const auto& entry : index_) {
+    if (entry.second.write_time > threshold_date)
+      continue;
+    if (ids_to_keep.count(entry.first))
+      continue;
+    ids_to_remove.push_back(entry.first);
+  }
+
+  for (const std::string& id : ids_to_remove)
+    RemoveRecord(id);
+  MaybeCompact();
+}
+
+void SnapshotThumbnailStore::Clear() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::MAY_BLOCK);
+  mapping_ = nullptr;
+  file_.Close();
+  file_length_ = 0;
+  index_.clear();
+  live_bytes_ = 0;
+  base::DeleteFile(pack_path_);
+}
+
+bool SnapshotThumbnailStore::EnsureOpen() {
+  if (file_.IsValid())
+    return true;
+
+  if (!base::DirectoryExists(pack_path_.DirName()))
+    return false;
+  if (!base::PathExists(pack_path_))
+    return ResetPackFile();
+
+  file_.Initialize(pack_path_, base::File::FLAG_OPEN | base::File::FLAG_READ |
+                                   base::File::FLAG_WRITE);
+  if (!file_.IsValid()) {
+    DLOG(ERROR) << "Error opening thumbnail pack file "
+                << pack_path_.AsUTF8Unsafe();
+    return false;
+  }
+
+  mapping_ = nullptr;
+  index_.clear();
+  live_bytes_ = 0;
+  const int64_t length = file_.GetLength();
+  if (length < static_cast<int64_t>(sizeof(PackHeader)))
+    return ResetPackFile();
+  file_length_ = static_cast<size_t>(length);
+  if (!EnsureMapped())
+    return ResetPackFile();
+
+  const uint8_t* data = mapping_->data();
+  PackHeader pack_header;
+  memcpy(&pack_header, data, sizeof(pack_header));
+  if (pack_header.magic != kPackMagic || pack_header.version != kPackVersion)
+    return ResetPackFile();
+
+  // Build the index. Only the record headers are read, the pixels are not
+  // paged in.
+  size_t offset = sizeof(PackHeader);
+  while (offset + sizeof(RecordHeader) <= file_length_) {
+    RecordHeader header;
+    memcpy(&header, data + offset, sizeof(header));
+    if (!IsValidRecordHeader(header, max_pixel_width_))
+      break;
+    const size_t size = RecordSize(header);
+    if (size > file_length_ - offset)
+      break;
+
+    const std::string id(
+        reinterpret_cast<const char*>(data + offset + sizeof(RecordHeader)),
+        header.id_length);
+    EraseRecord(id);
+    if (header.width) {
+      Record record;
+      record.offset = offset;
+      record.size = size;
+      record.pixels_offset =
+          offset + sizeof(RecordHeader) + AlignUp(header.id_length);
+      record.width = header.width;
+      record.height = header.height;
+      record.bytes_per_row = header.bytes_per_row;
+      record.scale = header.scale;
+      record.write_time = base::Time::FromDeltaSinceWindowsEpoch(
+          base::Microseconds(header.write_time));
+      index_[id] = record;
+      live_bytes_ += size;
+    }
+    offset += size;
+  }
+
+  // Drop the last record if it was not completely written. No image can
+  // point to it, so the file can be truncated.
+  if (offset < file_length_) {
+    mapping_ = nullptr;
+    if (!file_.SetLength(offset))
+      return ResetPackFile();
+    file_length_ = offset;
+  }
+  return true;
+}
+
+bool SnapshotThumbnailStore::ResetPackFile() {
+  mapping_ = nullptr;
+  index_.clear();
+  live_bytes_ = 0;
+  file_length_ = 0;
+
+  // Delete the file instead of truncating it, as images returned by a previous
+  // store may still map it.
+  file_.Close();
+  base::DeleteFile(pack_path_);
+  file_.Initialize(pack_path_, base::File::FLAG_CREATE_ALWAYS |
+                                   base::File::FLAG_READ |
+                                   base::File::FLAG_WRITE);
+  if (!file_.IsValid()) {
+    DLOG(ERROR) << "Error creating thumbnail pack file "
+                << pack_path_.AsUTF8Unsafe();
+    return false;
+  }
+  ProtectPackFile(pack_path_);
+
+  const PackHeader header = {kPackMagic, kPackVersion, {0, 0}};
+  if (file_.Write(0, reinterpret_cast<const char*>(&header), sizeof(header)) !=
+      static_cast<int>(sizeof(header))) {
+    file_.Close();
+    return false;
+  }
+  file_length_ = sizeof(header);
+  return true;
+}
+
+SnapshotThumbnailStore::Record SnapshotThumbnailStore::AppendRecord(
+    const std::string& snapshot_id,
+    const Record& image_info,
+    const uint8_t* pixels) {
+  const base::Time write_time = base::Time::Now();
+  RecordHeader header = {};
+  header.magic = kRecordMagic;
+  header.id_length = static_cast<uint32_t>(snapshot_id.size());
+  if (pixels) {
+    header.width = image_info.width;
+    header.height = image_info.height;
+    header.bytes_per_row = image_info.bytes_per_row;
+    header.scale = image_info.scale;
+  }
+  header.write_time =
+      write_time.ToDeltaSinceWindowsEpoch().InMicroseconds();
+
+  const size_t size = RecordSize(header);
+  const size_t pixels_offset = sizeof(RecordHeader) + AlignUp(header.id_length);
+  std::vector<char> buffer(size, 0);
+  memcpy(buffer.data(), &header, sizeof(header));
+  memcpy(buffer.data() + sizeof(header), snapshot_id.data(),
+         snapshot_id.size());
+  if (pixels)
+    memcpy(buffer.data() + pixels_offset, pixels, size - pixels_offset);
+
+  if (file_.Write(file_length_, buffer.data(), static_cast<int>(size)) !=
+      static_cast<int>(size)) {
+    DLOG(ERROR) << "Error writing thumbnail pack file "
+                << pack_path_.AsUTF8Unsafe();
+    return Record();
+  }
+
+  Record record = image_info;
+  record.offset = file_length_;
+  record.size = size;
+  record.pixels_offset = file_length_ + pixels_offset;
+  record.write_time = write_time;
+  file_length_ += size;
+  return record;
+}
+
+void SnapshotThumbnailStore::RemoveRecord(const std::string& snapshot_id) {
+  if (!index_.count(snapshot_id))
+    return;
+  // Write a tombstone so that the thumbnail is not restored when the index is
+  // rebuilt.
+  if (AppendRecord(snapshot_id, Record(), nullptr).size)
+    EraseRecord(snapshot_id);
+}
+
+void SnapshotThumbnailStore::EraseRecord(const std::string& snapshot_id) {
+  auto it = index_.find(snapshot_id);
+  if (it == index_.end())
+    return;
+  live_bytes_ -= it->second.size;
+  index_.erase(it);
+}
+
+bool SnapshotThumbnailStore::EnsureMapped() {
+  if (mapping_ && mapping_->length() >= file_length_)
+    return true;
+
+  // Records are never modified once written, so images using the previous
+  // mapping stay valid.
+  auto mapping = base::MakeRefCounted<ThumbnailPackMapping>();
+  if (!mapping->Initialize(base::File(
+          pack_path_, base::File::FLAG_OPEN | base::File::FLAG_READ))) {
+    DLOG(ERROR) << "Error mapping thumbnail pack file "
+                << pack_path_.AsUTF8Unsafe();
+    return false;
+  }
+  if (mapping->length() < file_length_)
+    return false;
+  mapping_ = std::move(mapping);
+  return true;
+}
+
+void SnapshotThumbnailStore::MaybeCompact() {
+  const size_t dead_bytes = file_length_ - sizeof(PackHeader) - live_bytes_;
+  if (dead_bytes < kMinCompactionBytes || dead_bytes < live_bytes_)
+    return;
+  if (!EnsureMapped())
+    return;
+
+  // Copy the live records to a new file and swap it with the current one. The
+  // current file is unlinked but stays valid for the images mapping it.
+  const base::FilePath temp_path =
+      pack_path_.AddExtension(FILE_PATH_LITERAL("tmp"));
+  base::File temp_file(temp_path,
+                       base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  if (!temp_file.IsValid())
+    return;
+
+  const PackHeader pack_header = {kPackMagic, kPackVersion, {0, 0}};
+  bool success = temp_file.Write(0, reinterpret_cast<const char*>(&pack_header),
+                                 sizeof(pack_header)) ==
+                 static_cast<int>(sizeof(pack_header));
+
+  std::map<std::string, Record> compacted_index;
+  size_t offset = sizeof(PackHeader);
+  for (const auto& entry : index_) {
+    if (!success)
+      break;
+    const Record& record = entry.second;
+    success = temp_file.Write(offset,
+                              reinterpret_cast<const char*>(mapping_->data() +
+                                                            record.offset),
+                              static_cast<int>(record.size)) ==
+              static_cast<int>(record.size);
+    Record moved_record = record;
+    moved_record.offset = offset;
+    moved_record.pixels_offset = record.pixels_offset - record.offset + offset;
+    compacted_index[entry.first] = moved_record;
+    offset += record.size;
+  }
+  temp_file.Close();
+
+  if (success) {
+    ProtectPackFile(temp_path);
+    success = base::ReplaceFile(temp_path, pack_path_, nullptr);
+  }
+  if (!success) {
+    DLOG(ERROR) << "Error compacting thumbnail pack file "
+                << pack_path_.AsUTF8Unsafe();
+    base::DeleteFile(temp_path);
+    return;
+  }
+
+  mapping_ = nullptr;
+  index_ = std::move(compacted_index);
+  file_length_ = offset;
+  file_.Close();
+  file_.Initialize(pack_path_, base::File::FLAG_OPEN | base::File::FLAG_READ |
+                                   base::File::FLAG_WRITE);
+  if (!file_.IsValid()) {
+    // The index is rebuilt from the file on next use.
+    index_.clear();
+    live_bytes_ = 0;
+  }
+}
@@ -0,0 +1,200 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/snapshots/snapshot_thumbnail_store.h"
+
+#import <UIKit/UIKit.h>
+
+#include <memory>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/format_macros.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Returns an opaque image of |size| points at scale 1, filled with |color|.
+UIImage* GenerateImage(CGSize size, UIColor* color) {
+  UIGraphicsBeginImageContextWithOptions(size, /*opaque=*/YES, 1.0);
+  [color setFill];
+  UIRectFill(CGRectMake(0, 0, size.width, size.height));
+  UIImage* image = UIGraphicsGetImageFromCurrentImageContext();
+  UIGraphicsEndImageContext();
+  return image;
+}
+
+// Maximum width of the thumbnails in the tests.
+const uint32_t kMaxPixelWidth = 256;
+
+}  // namespace
+
+class SnapshotThumbnailStoreTest : public PlatformTest {
+ protected:
+  void SetUp() override {
+    PlatformTest::SetUp();
+    ASSERT_TRUE(scoped_temp_directory_.CreateUniqueTempDir());
+    store_ = CreateStore();
+  }
+
+  std::unique_ptr<SnapshotThumbnailStore> CreateStore() {
+    return std::make_unique<SnapshotThumbnailStore>(
+        scoped_temp_directory_.GetPath(), kMaxPixelWidth);
+  }
+
+  base::ScopedTempDir scoped_temp_directory_;
+  std::unique_ptr<SnapshotThumbnailStore> store_;
+};
+
+// Tests that thumbnails are downscaled, cropped and keep their size in points.
+TEST_F(SnapshotThumbnailStoreTest, PutAndGet) {
+  store_->Put(@"small", GenerateImage(CGSizeMake(100, 50), UIColor.redColor));
+  store_->Put(@"large",
+              GenerateImage(CGSizeMake(1024, 4096), UIColor.blueColor));
+
+  NSDictionary<NSString*, UIImage*>* thumbnails =
+      store_->Get(@[ @"small", @"large", @"missing" ]);
+  ASSERT_EQ(2u, thumbnails.count);
+  EXPECT_FALSE(thumbnails[@"missing"]);
+
+  UIImage* small = thumbnails[@"small"];
+  EXPECT_EQ(100u, CGImageGetWidth(small.CGImage));
+  EXPECT_EQ(50u, CGImageGetHeight(small.CGImage));
+  EXPECT_EQ(1.0, small.scale);
+
+  UIImage* large = thumbnails[@"large"];
+  EXPECT_EQ(256u, CGImageGetWidth(large.CGImage));
+  EXPECT_EQ(320u, CGImageGetHeight(large.CGImage));
+  EXPECT_EQ(1024.0, large.size.width);
+  EXPECT_EQ(32u, CGImageGetBitsPerPixel(large.CGImage));
+}
+
+// Tests that the thumbnails are as wide as the maximum width of the store,
+// which is the width of the grid cells in pixels.
+TEST_F(SnapshotThumbnailStoreTest, CellResolution) {
+  // A 168 points wide grid cell at scale 3.
+  SnapshotThumbnailStore store(scoped_temp_directory_.GetPath(), 504);
+  store.Put(@"a", GenerateImage(CGSizeMake(780, 1688), UIColor.redColor));
+
+  UIImage* thumbnail = store.Get(@[ @"a" ])[@"a"];
+  EXPECT_EQ(504u, CGImageGetWidth(thumbnail.CGImage));
+  EXPECT_EQ(630u, CGImageGetHeight(thumbnail.CGImage));
+  EXPECT_EQ(780.0, thumbnail.size.width);
+}
+
+// Tests that the thumbnails are persisted, including their removal.
+TEST_F(SnapshotThumbnailStoreTest, Persistence) {
+  store_->Put(@"a", GenerateImage(CGSizeMake(64, 64), UIColor.redColor));
+  store_->Put(@"b", GenerateImage(CGSizeMake(64, 64), UIColor.greenColor));
+  store_->Put(@"b", GenerateImage(CGSizeMake(32, 32), UIColor.blueColor));
+  store_->Put(@"c", GenerateImage(CGSizeMake(64, 64), UIColor.blueColor));
+  store_->Remove(@"a");
+  store_.reset();
+
+  store_ = CreateStore();
+  NSDictionary<NSString*, UIImage*>* thumbnails =
+      store_->Get(@[ @"a", @"b", @"c" ]);
+  EXPECT_FALSE(thumbnails[@"a"]);
+  EXPECT_EQ(32u, CGImageGetWidth(thumbnails[@"b"].CGImage));
+  EXPECT_TRUE(thumbnails[@"c"]);
+}
+
+// Tests that a truncated record is ignored and overwritten.
+TEST_F(SnapshotThumbnailStoreTest, TruncatedRecord) {
+  store_->Put(@"a", GenerateImage(CGSizeMake(64, 64), UIColor.redColor));
+  store_->Put(@"b", GenerateImage(CGSizeMake(64, 64), UIColor.greenColor));
+  store_.reset();
+
+  const base::FilePath pack_path = CreateStore()->pack_path();
+  int64_t length = 0;
+  ASSERT_TRUE(base::GetFileSize(pack_path, &length));
+  base::File pack_file(pack_path,
+                       base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+  ASSERT_TRUE(pack_file.SetLength(length - 10));
+  pack_file.Close();
+
+  store_ = CreateStore();
+  EXPECT_EQ(1u, store_->Get(@[ @"a", @"b" ]).count);
+  store_->Put(@"c", GenerateImage(CGSizeMake(64, 64), UIColor.blueColor));
+  store_.reset();
+
+  store_ = CreateStore();
+  NSDictionary<NSString*, UIImage*>* thumbnails =
+      store_->Get(@[ @"a", @"b", @"c" ]);
+  EXPECT_TRUE(thumbnails[@"a"]);
+  EXPECT_FALSE(thumbnails[@"b"]);
+  EXPECT_TRUE(thumbnails[@"c"]);
+}
+
+// Tests that replaced thumbnails are reclaimed, and that the images returned
+// before the compaction stay valid.
+TEST_F(SnapshotThumbnailStoreTest, Compaction) {
+  const CGSize size = CGSizeMake(256, 320);
+  store_->Put(@"a", GenerateImage(size, UIColor.redColor));
+  UIImage* first = store_->Get(@[ @"a" ])[@"a"];
+  ASSERT_TRUE(first);
+
+  // Each thumbnail uses 320kB, replace it enough times to trigger compactions.
+  for (int i = 0; i < 60; ++i)
+    store_->Put(@"a", GenerateImage(size, UIColor.greenColor));
+
+  int64_t length = 0;
+  ASSERT_TRUE(base::GetFileSize(store_->pack_path(), &length));
+  EXPECT_LT(length, 30 * 320 * 1024);
+
+  // Draw the first image to read its pixels from the old mapping.
+  UIGraphicsBeginImageContextWithOptions(size, /*opaque=*/YES, 1.0);
+  [first drawAtPoint:CGPointZero];
+  UIGraphicsEndImageContext();
+  EXPECT_TRUE(store_->Get(@[ @"a" ])[@"a"]);
+}
+
+// Tests that the thumbnails are purged by date, except the kept ones.
+TEST_F(SnapshotThumbnailStoreTest, Purge) {
+  store_->Put(@"a", GenerateImage(CGSizeMake(64, 64), UIColor.redColor));
+  store_->Put(@"b", GenerateImage(CGSizeMake(64, 64), UIColor.greenColor));
+  store_->PurgeOlderThan(base::Time::Now(), [NSSet setWithObject:@"b"]);
+  store_->Put(@"c", GenerateImage(CGSizeMake(64, 64), UIColor.blueColor));
+  store_->PurgeOlderThan(base::Time::Now() - base::Hours(1), [NSSet set]);
+
+  NSDictionary<NSString*, UIImage*>* thumbnails =
+      store_->Get(@[ @"a", @"b", @"c" ]);
+  EXPECT_FALSE(thumbnails[@"a"]);
+  EXPECT_TRUE(thumbnails[@"b"]);
+  EXPECT_TRUE(thumbnails[@"c"]);
+}
+
+// Tests that the thumbnails of a large number of tabs are all loaded at once.
+TEST_F(SnapshotThumbnailStoreTest, ManyThumbnails) {
+  const NSUInteger kTabCount = 500;
+  NSMutableArray<NSString*>* snapshot_ids = [NSMutableArray array];
+  UIImage* image = GenerateImage(CGSizeMake(390, 844), UIColor.redColor);
+  for (NSUInteger i = 0; i < kTabCount; ++i) {
+    NSString* snapshot_id =
+        [NSString stringWithFormat:@"SnapshotID-%" PRIuNS, i];
+    [snapshot_ids addObject:snapshot_id];
+    store_->Put(snapshot_id, image);
+  }
+  store_.reset();
+
+  store_ = CreateStore();
+  EXPECT_EQ(kTabCount, store_->Get(snapshot_ids).count);
+}
+
+// Tests that Clear() removes all the thumbnails and the pack file.
+TEST_F(SnapshotThumbnailStoreTest, Clear) {
+  store_->Put(@"a", GenerateImage(CGSizeMake(64, 64), UIColor.redColor));
+  store_->Clear();
+  EXPECT_FALSE(base::PathExists(store_->pack_path()));
+  EXPECT_EQ(0u, store_->Get(@[ @"a" ]).count);
+
+  store_->Put(@"a", GenerateImage(CGSizeMake(64, 64), UIColor.redColor));
+  EXPECT_EQ(1u, store_->Get(@[ @"a" ]).count);
+}
@@ -0,0 +1,167 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_TABS_SEARCH_TABS_SEARCH_INDEX_H_
+#define IOS_CHROME_BROWSER_TABS_SEARCH_TABS_SEARCH_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/scoped_multi_source_observation.h"
+#include "base/scoped_observation.h"
+#include "ios/chrome/browser/main/browser_list.h"
+#include "ios/chrome/browser/main/browser_list_observer.h"
+#include "ios/chrome/browser/web_state_list/web_state_list.h"
+#include "ios/chrome/browser/web_state_list/web_state_list_observer.h"
+#include "ios/web/public/web_state.h"
+#include "ios/web/public/web_state_observer.h"
+
+// Index of the titles and URLs of the tabs of all the regular (or all the
+// incognito) Browsers of a BrowserList, used to search the open tabs without
+// scanning all of them.
+//
+// Titles and URLs are folded (case, accents and width insensitive) and their
+// trigrams are indexed. A query returns the tabs containing all the trigrams
+// of the folded query, which are then checked with the same matching as the
+// rest of the tab search. Tabs whose folded title or URL are not printable
+// ASCII cannot be indexed reliably and are always checked.
+//
+// The index follows the Browsers, WebStateLists and WebStates. Changed tabs
+// are only re-indexed on the next search.
+class TabsSearchIndex : public BrowserListObserver,
+                        public WebStateListObserver,
+                        public web::WebStateObserver {
+ public:
+  // How well a tab matches a query. Lower values are better.
+  enum class MatchRank {
+    kTitlePrefix,
+    kTitle,
+    kURL,
+  };
+
+  // A tab matching a query.
+  struct Match {
+    web::WebState* web_state;
+    WebStateList* web_state_list;
+    MatchRank rank;
+  };
+
+  TabsSearchIndex(BrowserList* browser_list, bool off_the_record);
+
+  TabsSearchIndex(const TabsSearchIndex&) = delete;
+  TabsSearchIndex& operator=(const TabsSearchIndex&) = delete;
+
+  ~TabsSearchIndex() override;
+
+  // Returns the tabs whose title or visible URL contain |term|, ignoring case
+  // and accents. The matches are in no particular order.
+  std::vector<Match> Search(const std::u16string& term);
+
+  // Returns the number of indexed tabs.
+  size_t size() const { return entries_.size(); }
+
+  // BrowserListObserver:
+  void OnBrowserAdded(const BrowserList* browser_list,
+                      Browser* browser) override;
+  void OnIncognitoBrowserAdded(const BrowserList* browser_list,
+                               Browser* browser) override;
+  void OnBrowserRemoved(const BrowserList* browser_list,
+                        Browser* browser) override;
+  void OnIncognitoBrowserRemoved(const BrowserList* browser_list,
+                                 Browser* browser) override;
+  void OnBrowserListShutdown(BrowserList* browser_list) override;
+
+  // WebStateListObserver:
+  void WebStateInsertedAt(WebStateList* web_state_list,
+                          web::WebState* web_state,
+                          int index,
+                          bool activating) override;
+  void WebStateReplacedAt(WebStateList* web_state_list,
+                          web::WebState* old_web_state,
+                          web::WebState* new_web_state,
+                          int index) override;
+  void WebStateDetachedAt(WebStateList* web_state_list,
+                          web::WebState* web_state,
+                          int index) override;
+
+  // web::WebStateObserver:
+  void DidStartNavigation(web::WebState* web_state,
+                          web::NavigationContext* navigation_context) override;
+  void DidFinishNavigation(web::WebState* web_state,
+                           web::NavigationContext* navigation_context) override;
+  void TitleWasSet(web::WebState* web_state) override;
+  void WebStateDestroyed(web::WebState* web_state) override;
+
+ private:
+  // An indexed tab.
+  struct Entry {
+    WebStateList* web_state_list = nullptr;
+    // Identifier of the current version of the entry in the postings, or 0 if
+    // the entry needs to be indexed.
+    uint32_t id = 0;
+    // Title and visible URL, as searched.
+    std::u16string title;
+    std::u16string url;
+    // Number of postings of the entry.
+    size_t posting_count = 0;
+  };
+
+  // Starts or stops following |browser| and its WebStates.
+  void AddBrowser(Browser* browser);
+  void RemoveBrowser(Browser* browser);
+
+  // Starts or stops following |web_state|.
+  void AddWebState(web::WebState* web_state, WebStateList* web_state_list);
+  void RemoveWebState(web::WebState* web_state);
+
+  // Marks the entry of |web_state| as needing to be indexed.
+  void Invalidate(web::WebState* web_state);
+
+  // Forgets about the current version of |entry| in the postings.
+  void Deindex(Entry& entry);
+
+  // Indexes the entries changed since the last search.
+  void IndexInvalidatedEntries();
+
+  // Drops the postings of the removed entries once they are too many.
+  void MaybeCompactPostings();
+
+  // Returns the sorted identifiers of the indexed entries that may contain
+  // |folded_term|, which must be printable ASCII.
+  std::vector<uint32_t> IndexedCandidates(const std::u16string& folded_term);
+
+  base::ScopedObservation<BrowserList, BrowserListObserver>
+      browser_list_observation_{this};
+  base::ScopedMultiSourceObservation<WebStateList, WebStateListObserver>
+      web_state_list_observations_{this};
+  base::ScopedMultiSourceObservation<web::WebState, web::WebStateObserver>
+      web_state_observations_{this};
+
+  const bool off_the_record_;
+
+  // Entries of all the followed WebStates, entries waiting to be indexed, and
+  // WebStates by entry identifier.
+  std::map<web::WebState*, Entry> entries_;
+  std::set<web::WebState*> invalidated_web_states_;
+  std::map<uint32_t, web::WebState*> web_states_by_id_;
+
+  // Identifiers of the entries containing each trigram, sorted. Identifiers
+  // are never reused, so removed entries are simply ignored until the
+  // postings are compacted.
+  std::map<uint32_t, std::vector<uint32_t>> postings_;
+  size_t posting_count_ = 0;
+  size_t live_posting_count_ = 0;
+
+  // Identifiers of the entries which could not be indexed.
+  std::set<uint32_t> unindexed_ids_;
+
+  uint32_t next_id_ = 1;
+};
+
+#endif  // IOS_CHROME_BROWSER_TABS_SEARCH_TABS_SEARCH_INDEX_H_
@@ -0,0 +1,366 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/tabs_search/tabs_search_index.h"
+
+#import <Foundation/Foundation.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "base/containers/cxx20_erase.h"
+#include "base/i18n/string_search.h"
+#include "base/strings/string_util.h"
+#include "base/strings/sys_string_conversions.h"
+#include "base/strings/utf_string_conversions.h"
+#include "ios/chrome/browser/main/browser.h"
+#import "ios/chrome/browser/tabs/tab_title_util.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+using base::i18n::FixedPatternStringSearchIgnoringCaseAndAccents;
+
+namespace {
+
+// The postings are compacted once there are at least this many postings of
+// removed entries, and more than live postings.
+const size_t kMinDeadPostingsForCompaction = 16 * 1024;
+
+// Returns |text| folded for indexing.
+std::u16string FoldForIndex(NSString* text) {
+  return base::SysNSStringToUTF16([text
+      stringByFoldingWithOptions:NSCaseInsensitiveSearch |
+                                 NSDiacriticInsensitiveSearch |
+                                 NSWidthInsensitiveSearch
+                          locale:nil]);
+}
+
+// Returns whether |text| only contains printable ASCII characters. Those are
+// matched by the tab search exactly as they are folded.
+bool IsPrintableASCII(const std::u16string& text) {
+  return std::all_of(text.begin(), text.end(),
+                     [](char16_t c) { return c >= 0x20 && c < 0x7f; });
+}
+
+// Returns the key of the trigram |a|, |b|, |c|. Characters must be printable
+// ASCII or 0.
+uint32_t Trigram(char16_t a, char16_t b, char16_t c) {
+  return (static_cast<uint32_t>(a) << 16) | (static_cast<uint32_t>(b) << 8) |
+         static_cast<uint32_t>(c);
+}
+
+// Adds the trigrams of |folded_text| to |trigrams|. The text is padded with
+// zeros so that any substring of one or two characters is the prefix of a
+// trigram.
+void AddTrigrams(const std::u16string& folded_text,
+                 std::set<uint32_t>* trigrams) {
+  const size_t size = folded_text.size();
+  for (size_t i = 0; i < size; ++i) {
+    trigrams->insert(Trigram(folded_text[i],
+                             i + 1 < size ? folded_text[i + 1] : 0,
+                             i + 2 < size ? folded_text[i + 2] : 0));
+  }
+}
+
+}  // namespace
+
+TabsSearchIndex::TabsSearchIndex(BrowserList* browser_list,
+                                 bool off_the_record)
+    : off_the_record_(off_the_record) {
+  browser_list_observation_.Observe(browser_list);
+  const std::set<Browser*> browsers = off_the_record_
+                                          ? browser_list->AllIncognitoBrowsers()
+                                          : browser_list->AllRegularBrowsers();
+  for (Browser* browser : browsers)
+    AddBrowser(browser);
+}
+
+TabsSearchIndex::~TabsSearchIndex() = default;
+
+std::vector<TabsSearchIndex::Match> TabsSearchIndex::Search(
+    const std::u16string& term) {
+  IndexInvalidatedEntries();
+  MaybeCompactPostings();
+
+  std::vector<Match> matches;
+  if (entries_.empty())
+    return matches;
+
+  std::vector<uint32_t> candidate_ids;
+  const std::u16string folded_term =
+      FoldForIndex(base::SysUTF16ToNSString(term));
+  if (!folded_term.empty() && IsPrintableASCII(folded_term)) {
+    candidate_ids = IndexedCandidates(folded_term);
+    candidate_ids.insert(candidate_ids.end(), unindexed_ids_.begin(),
+                         unindexed_ids_.end());
+  } else {
+    // The term cannot be looked up, check all the entries.
+    for (const auto& id_and_web_state : web_states_by_id_)
+      candidate_ids.push_back(id_and_web_state.first);
+  }
+
+  FixedPatternStringSearchIgnoringCaseAndAccents query_search(term);
+  for (uint32_t id : candidate_ids) {
+    auto web_state_it = web_states_by_id_.find(id);
+    if (web_state_it == web_states_by_id_.end())
+      continue;
+    web::WebState* web_state = web_state_it->second;
+    const Entry& entry = entries_[web_state];
+
+    size_t match_index = 0;
+    MatchRank rank;
+    if (query_search.Search(entry.title, &match_index,
+                            /*match_length=*/nullptr)) {
+      rank = match_index == 0 ? MatchRank::kTitlePrefix : MatchRank::kTitle;
+    } else if (query_search.Search(entry.url, /*match_index=*/nullptr,
+                                   /*match_length=*/nullptr)) {
+      rank = MatchRank::kURL;
+    } else {
+      continue;
+    }
+    matches.push_back({web_state, entry.web_state_list, rank});
+  }
+  return matches;
+}
+
+#pragma mark - BrowserListObserver
+
+void TabsSearchIndex::OnBrowserAdded(const BrowserList* browser_list,
+                                     Browser* browser) {
+  if (!off_the_record_)
+    AddBrowser(browser);
+}
+
+void TabsSearchIndex::OnIncognitoBrowserAdded(const BrowserList* browser_list,
+                                              Browser* browser) {
+  if (off_the_record_)
+    AddBrowser(browser);
+}
+
+void TabsSearchIndex::OnBrowserRemoved(const BrowserList* browser_list,
+                                       Browser* browser) {
+  if (!off_the_record_)
+    RemoveBrowser(browser);
+}
+
+void TabsSearchIndex::OnIncognitoBrowserRemoved(
+    const BrowserList* browser_list,
+    Browser* browser) {
+  if (off_the_record_)
+    RemoveBrowser(browser);
+}
+
+void TabsSearchIndex::OnBrowserListShutdown(BrowserList* browser_list) {
+  web_state_observations_.RemoveAllObservations();
+  web_state_list_observations_.RemoveAllObservations();
+  browser_list_observation_.Reset();
+
+  entries_.clear();
+  invalidated_web_states_.clear();
+  web_states_by_id_.clear();
+  postings_.clear();
+  posting_count_ = 0;
+  live_posting_count_ = 0;
+  unindexed_ids_.clear();
+}
+
+#pragma mark - WebStateListObserver
+
+void TabsSearchIndex::WebStateInsertedAt(WebStateList* web_state_list,
+                                         web::WebState* web_state,
+                                         int index,
+                                         bool activating) {
+  AddWebState(web_state, web_state_list);
+}
+
+void TabsSearchIndex::WebStateReplacedAt(WebStateList* web_state_list,
+                                         web::WebState* old_web_state,
+                                         web::WebState* new_web_state,
+                                         int index) {
+  RemoveWebState(old_web_state);
+  AddWebState(new_web_state, web_state_list);
+}
+
+void TabsSearchIndex::WebStateDetachedAt(WebStateList* web_state_list,
+                                         web::WebState* web_state,
+                                         int index) {
+  RemoveWebState(web_state);
+}
+
+#pragma mark - web::WebStateObserver
+
+void TabsSearchIndex::DidStartNavigation(
+    web::WebState* web_state,
+    web::NavigationContext* navigation_context) {
+  Invalidate(web_state);
+}
+
+void TabsSearchIndex::DidFinishNavigation(
+    web::WebState* web_state,
+    web::NavigationContext* navigation_context) {
+  Invalidate(web_state);
+}
+
+void TabsSearchIndex::TitleWasSet(web::WebState* web_state) {
+  Invalidate(web_state);
+}
+
+void TabsSearchIndex::WebStateDestroyed(web::WebState* web_state) {
+  RemoveWebState(web_state);
+}
+
+#pragma mark - Private
+
+void TabsSearchIndex::AddBrowser(Browser* browser) {
+  WebStateList* web_state_list = browser->GetWebStateList();
+  if (web_state_list_observations_.IsObservingSource(web_state_list))
+    return;
+  web_state_list_observations_.AddObservation(web_state_list);
+  for (int index = 0; index < web_state_list->count(); ++index)
+    AddWebState(web_state_list->GetWebStateAt(index), web_state_list);
+}
+
+void TabsSearchIndex::RemoveBrowser(Browser* browser) {
+  WebStateList* web_state_list = browser->GetWebStateList();
+  if (!web_state_list_observations_.IsObservingSource(web_state_list))
+    return;
+  web_state_list_observations_.RemoveObservation(web_state_list);
+  for (int index = 0; index < web_state_list->count(); ++index)
+    RemoveWebState(web_state_list->GetWebStateAt(index));
+}
+
+void TabsSearchIndex::AddWebState(web::WebState* web_state,
+                                  WebStateList* web_state_list) {
+  entries_[web_state].web_state_list = web_state_list;
+  if (!web_state_observations_.IsObservingSource(web_state))
+    web_state_observations_.AddObservation(web_state);
+  Invalidate(web_state);
+}
+
+void TabsSearchIndex::RemoveWebState(web::WebState* web_state) {
+  auto it = entries_.find(web_state);
+  if (it == entries_.end())
+    return;
+  Deindex(it->second);
+  invalidated_web_states_.erase(web_state);
+  entries_.erase(it);
+  if (web_state_observations_.IsObservingSource(web_state))
+    web_state_observations_.RemoveObservation(web_state);
+}
+
+void TabsSearchIndex::Invalidate(web::WebState* web_state) {
+  auto it = entries_.find(web_state);
+  if (it == entries_.end())
+    return;
+  Deindex(it->second);
+  invalidated_web_states_.insert(web_state);
+}
+
+void TabsSearchIndex::Deindex(Entry& entry) {
+  if (!entry.id)
+    return;
+  web_states_by_id_.erase(entry.id);
+  unindexed_ids_.erase(entry.id);
+  live_posting_count_ -= entry.posting_count;
+  entry.posting_count = 0;
+  entry.id = 0;
+}
+
+void TabsSearchIndex::IndexInvalidatedEntries() {
+  for (web::WebState* web_state : invalidated_web_states_) {
+    Entry& entry = entries_[web_state];
+    DCHECK(!entry.id);
+
+    NSString* title = tab_util::GetTabTitle(web_state);
+    entry.title = base::SysNSStringToUTF16(title);
+    entry.url = base::UTF8ToUTF16(web_state->GetVisibleURL().spec());
+    entry.id = next_id_++;
+    web_states_by_id_[entry.id] = web_state;
+
+    // URLs are ASCII, only their case needs to be folded.
+    const std::u16string folded_title = FoldForIndex(title);
+    const std::u16string folded_url = base::ToLowerASCII(entry.url);
+    if (!IsPrintableASCII(folded_title) || !IsPrintableASCII(folded_url)) {
+      unindexed_ids_.insert(entry.id);
+      continue;
+    }
+
+    // Identifiers are increasing, so the postings stay sorted.
+    std::set<uint32_t> trigrams;
+    AddTrigrams(folded_title, &trigrams);
+    AddTrigrams(folded_url, &trigrams);
+    for (uint32_t trigram : trigrams)
+      postings_[trigram].push_back(entry.id);
+    entry.posting_count = trigrams.size();
+    posting_count_ += entry.posting_count;
+    live_posting_count_ += entry.posting_count;
+  }
+  invalidated_web_states_.clear();
+}
+
+void TabsSearchIndex::MaybeCompactPostings() {
+  const size_t dead_posting_count = posting_count_ - live_posting_count_;
+  if (dead_posting_count < kMinDeadPostingsForCompaction ||
+      dead_posting_count < live_posting_count_) {
+    return;
+  }
+
+  for (auto it = postings_.begin(); it != postings_.end();) {
+    base::EraseIf(it->second, [this](uint32_t id) {
+      return !web_states_by_id_.count(id);
+    });
+    it = it->second.empty() ? postings_.erase(it) : std::next(it);
+  }
+  posting_count_ = live_posting_count_;
+}
+
+std::vector<uint32_t> TabsSearchIndex::IndexedCandidates(
+    const std::u16string& folded_term) {
+  DCHECK(!folded_term.empty());
+  const size_t size = folded_term.size();
+
+  // Terms shorter than a trigram are looked up as trigram prefixes.
+  if (size < 3) {
+    const uint32_t begin =
+        Trigram(folded_term[0], size > 1 ? folded_term[1] : 0, 0);
+    const uint32_t end = begin + (size > 1 ? (1 << 8) : (1 << 16));
+    std::vector<uint32_t> ids;
+    for (auto it = postings_.lower_bound(begin);
+         it != postings_.end() && it->first < end; ++it) {
+      ids.insert(ids.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+  }
+
+  // Intersect the postings of all the trigrams of the term, smallest first.
+  std::vector<const std::vector<uint32_t>*> postings;
+  std::set<uint32_t> trigrams;
+  for (size_t i = 0; i + 2 < size; ++i) {
+    const uint32_t trigram =
+        Trigram(folded_term[i], folded_term[i + 1], folded_term[i + 2]);
+    if (!trigrams.insert(trigram).second)
+      continue;
+    auto it = postings_.find(trigram);
+    if (it == postings_.end())
+      return std::vector<uint32_t>();
+    postings.push_back(&it->second);
+  }
+  std::sort(postings.begin(), postings.end(),
+            [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+              return a->size() < b->size();
+            });
+
+  std::vector<uint32_t> ids = *postings.front();
+  for (size_t i = 1; i < postings.size() && !ids.empty(); ++i) {
+    std::vector<uint32_t> intersection;
+    std::set_intersection(ids.begin(), ids.end(), postings[i]->begin(),
+                          postings[i]->end(), std::back_inserter(intersection));
+    ids.swap(intersection);
+  }
+  return ids;
+}
@@ -0,0 +1,304 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/tabs_search/tabs_search_index.h"
+
+#include <iterator>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "base/i18n/string_search.h"
+#include "base/strings/stringprintf.h"
+#include "base/strings/sys_string_conversions.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
+#import "ios/chrome/browser/main/browser_list.h"
+#import "ios/chrome/browser/main/browser_list_factory.h"
+#include "ios/chrome/browser/main/test_browser.h"
+#import "ios/chrome/browser/tabs/tab_title_util.h"
+#import "ios/chrome/browser/web_state_list/web_state_list.h"
+#import "ios/chrome/browser/web_state_list/web_state_opener.h"
+#import "ios/web/public/test/fakes/fake_navigation_context.h"
+#import "ios/web/public/test/fakes/fake_web_state.h"
+#include "ios/web/public/test/web_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "testing/platform_test.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+using base::i18n::FixedPatternStringSearchIgnoringCaseAndAccents;
+
+namespace {
+
+// Words used to build the titles of generated tabs.
+const char* const kTitleWords[] = {"news", "Weather", "recipes", "Café",
+                                   "sports", "Mail",    "maps",    "vidéos"};
+
+}  // namespace
+
+// Test fixture for TabsSearchIndex.
+class TabsSearchIndexTest : public PlatformTest {
+ public:
+  TabsSearchIndexTest() {
+    chrome_browser_state_ = TestChromeBrowserState::Builder().Build();
+    browser_list_ =
+        BrowserListFactory::GetForBrowserState(chrome_browser_state_.get());
+    browser_ = std::make_unique<TestBrowser>(chrome_browser_state_.get());
+    browser_list_->AddBrowser(browser_.get());
+    index_ = std::make_unique<TabsSearchIndex>(browser_list_,
+                                               /*off_the_record=*/false);
+  }
+
+  ~TabsSearchIndexTest() override {
+    index_.reset();
+    browser_list_->RemoveBrowser(browser_.get());
+  }
+
+ protected:
+  // Appends a new web state to the web state list of |browser|.
+  web::FakeWebState* AppendNewWebState(Browser* browser,
+                                       const std::u16string& title,
+                                       const GURL& url) {
+    auto fake_web_state = std::make_unique<web::FakeWebState>();
+    fake_web_state->SetVisibleURL(url);
+    fake_web_state->SetTitle(title);
+    web::FakeWebState* inserted_web_state = fake_web_state.get();
+    browser->GetWebStateList()->InsertWebState(
+        WebStateList::kInvalidIndex, std::move(fake_web_state),
+        WebStateList::INSERT_NO_FLAGS, WebStateOpener());
+    return inserted_web_state;
+  }
+
+  // Changes the title of |web_state| as a navigation would.
+  void Navigate(web::FakeWebState* web_state,
+                const std::u16string& title,
+                const GURL& url) {
+    web_state->SetTitle(title);
+    web_state->SetVisibleURL(url);
+    web::FakeNavigationContext context;
+    web_state->OnNavigationFinished(&context);
+  }
+
+  // Returns the WebStates matching |term| according to the index.
+  std::set<web::WebState*> Search(const std::u16string& term) {
+    std::set<web::WebState*> web_states;
+    for (const TabsSearchIndex::Match& match : index_->Search(term))
+      web_states.insert(match.web_state);
+    return web_states;
+  }
+
+  // Returns the WebStates of |browser_| matching |term|, found by checking
+  // every tab.
+  std::set<web::WebState*> SearchAllTabs(const std::u16string& term) {
+    FixedPatternStringSearchIgnoringCaseAndAccents query_search(term);
+    std::set<web::WebState*> web_states;
+    WebStateList* web_state_list = browser_->GetWebStateList();
+    for (int index = 0; index < web_state_list->count(); ++index) {
+      web::WebState* web_state = web_state_list->GetWebStateAt(index);
+      if (query_search.Search(
+              base::SysNSStringToUTF16(tab_util::GetTabTitle(web_state)),
+              /*match_index=*/nullptr, /*match_length=*/nullptr) ||
+          query_search.Search(
+              base::UTF8ToUTF16(web_state->GetVisibleURL().spec()),
+              /*match_index=*/nullptr, /*match_length=*/nullptr)) {
+        web_states.insert(web_state);
+      }
+    }
+    return web_states;
+  }
+
+  // Appends |count| tabs with generated titles and URLs to |browser_|.
+  void AppendGeneratedWebStates(int count) {
+    for (int i = 0; i < count; ++i) {
+      const char* word = kTitleWords[i % std::size(kTitleWords)];
+      AppendNewWebState(
+          browser_.get(),
+          base::UTF8ToUTF16(base::StringPrintf("%s page %d", word, i)),
+          GURL(base::StringPrintf("https://www.%s.example/%d?q=%d", word,
+                                  i % 97, i)));
+    }
+  }
+
+  web::WebTaskEnvironment task_environment_;
+  std::unique_ptr<TestChromeBrowserState> chrome_browser_state_;
+  std::unique_ptr<Browser> browser_;
+  BrowserList* browser_list_;
+  std::unique_ptr<TabsSearchIndex> index_;
+};
+
+// Tests that titles and URLs are found and ranked.
+TEST_F(TabsSearchIndexTest, Ranks) {
+  web::WebState* prefix = AppendNewWebState(browser_.get(), u"Weather today",
+                                            GURL("https://forecast.test/"));
+  web::WebState* title = AppendNewWebState(browser_.get(), u"Local weather",
+                                           GURL("https://local.test/"));
+  web::WebState* url = AppendNewWebState(browser_.get(), u"Forecast",
+                                         GURL("https://weather.test/"));
+  AppendNewWebState(browser_.get(), u"News", GURL("https://news.test/"));
+
+  std::vector<TabsSearchIndex::Match> matches = index_->Search(u"weather");
+  ASSERT_EQ(3u, matches.size());
+  for (const TabsSearchIndex::Match& match : matches) {
+    EXPECT_EQ(browser_->GetWebStateList(), match.web_state_list);
+    if (match.web_state == prefix) {
+      EXPECT_EQ(TabsSearchIndex::MatchRank::kTitlePrefix, match.rank);
+    } else if (match.web_state == title) {
+      EXPECT_EQ(TabsSearchIndex::MatchRank::kTitle, match.rank);
+    } else {
+      EXPECT_EQ(url, match.web_state);
+      EXPECT_EQ(TabsSearchIndex::MatchRank::kURL, match.rank);
+    }
+  }
+}
+
+// Tests that short, accented and non-ASCII terms and titles are matched like
+// the rest of the tab search.
+TEST_F(TabsSearchIndexTest, FoldedTerms) {
+  web::WebState* cafe = AppendNewWebState(browser_.get(), u"Café de Flore",
+                                          GURL("https://flore.test/"));
+  web::WebState* tokyo = AppendNewWebState(browser_.get(), u"東京の天気",
+                                           GURL("https://tenki.test/"));
+  web::WebState* wide = AppendNewWebState(browser_.get(), u"ＷＩＤＥ",
+                                          GURL("https://w.test/"));
+
+  EXPECT_EQ(std::set<web::WebState*>({cafe}), Search(u"CAFE"));
+  EXPECT_EQ(std::set<web::WebState*>({cafe}), Search(u"fé"));
+  EXPECT_EQ(std::set<web::WebState*>({cafe}), Search(u"fl"));
+  EXPECT_EQ(SearchAllTabs(u"é"), Search(u"é"));
+  EXPECT_EQ(std::set<web::WebState*>({tokyo}), Search(u"天気"));
+  EXPECT_EQ(std::set<web::WebState*>({tokyo}), Search(u"tenki"));
+  EXPECT_EQ(std::set<web::WebState*>({wide}), Search(u"wide"));
+  EXPECT_EQ(SearchAllTabs(u""), Search(u""));
+}
+
+// Tests that the index follows the changes of the tabs.
+TEST_F(TabsSearchIndexTest, FollowsChanges) {
+  web::FakeWebState* web_state = AppendNewWebState(
+      browser_.get(), u"Weather", GURL("https://weather.test/"));
+  EXPECT_EQ(1u, Search(u"weather").size());
+
+  Navigate(web_state, u"News", GURL("https://news.test/"));
+  EXPECT_TRUE(Search(u"weather").empty());
+  EXPECT_EQ(1u, Search(u"news").size());
+
+  web::WebState* inserted = AppendNewWebState(browser_.get(), u"More news",
+                                              GURL("https://more.test/"));
+  EXPECT_EQ(2u, Search(u"news").size());
+
+  auto replacement = std::make_unique<web::FakeWebState>();
+  replacement->SetTitle(u"Mail");
+  web::WebState* replacement_web_state = replacement.get();
+  browser_->GetWebStateList()->ReplaceWebStateAt(0, std::move(replacement));
+  EXPECT_EQ(std::set<web::WebState*>({inserted}), Search(u"news"));
+  EXPECT_EQ(std::set<web::WebState*>({replacement_web_state}),
+            Search(u"mail"));
+
+  browser_->GetWebStateList()->CloseWebStateAt(1, WebStateList::CLOSE_NO_FLAGS);
+  EXPECT_TRUE(Search(u"news").empty());
+  EXPECT_EQ(1u, index_->size());
+}
+
+// Tests that the index follows the Browsers of its BrowserList.
+TEST_F(TabsSearchIndexTest, FollowsBrowsers) {
+  AppendNewWebState(browser_.get(), u"Weather", GURL("https://a.test/"));
+
+  auto other_browser =
+      std::make_unique<TestBrowser>(chrome_browser_state_.get());
+  web::WebState* other_web_state = AppendNewWebState(
+      other_browser.get(), u"Weather", GURL("https://b.test/"));
+  browser_list_->AddBrowser(other_browser.get());
+
+  auto incognito_browser = std::make_unique<TestBrowser>(
+      chrome_browser_state_->GetOffTheRecordChromeBrowserState());
+  AppendNewWebState(incognito_browser.get(), u"Weather",
+                    GURL("https://c.test/"));
+  browser_list_->AddIncognitoBrowser(incognito_browser.get());
+
+  std::vector<TabsSearchIndex::Match> matches = index_->Search(u"weather");
+  ASSERT_EQ(2u, matches.size());
+
+  browser_list_->RemoveBrowser(other_browser.get());
+  EXPECT_EQ(1u, Search(u"weather").size());
+  EXPECT_FALSE(Search(u"weather").count(other_web_state));
+
+  // Destroyed Browsers are forgotten too.
+  browser_list_->AddBrowser(other_browser.get());
+  EXPECT_EQ(2u, Search(u"weather").size());
+  other_browser.reset();
+  EXPECT_EQ(1u, Search(u"weather").size());
+
+  browser_list_->RemoveIncognitoBrowser(incognito_browser.get());
+}
+
+// Tests that typing a query in a large number of tabs finds the same tabs as
+// checking all the tabs, including while the tabs change.
+TEST_F(TabsSearchIndexTest, ManyTabs) {
+  AppendGeneratedWebStates(2000);
+
+  const std::u16string query = u"vidéos page 1";
+  for (size_t length = 1; length <= query.size(); ++length) {
+    const std::u16string term = query.substr(0, length);
+    EXPECT_EQ(SearchAllTabs(term), Search(term)) << term;
+  }
+
+  // Navigate all the tabs several times, so that the postings of the previous
+  // titles are reclaimed.
+  WebStateList* web_state_list = browser_->GetWebStateList();
+  for (int round = 0; round < 3; ++round) {
+    for (int index = 0; index < web_state_list->count(); ++index) {
+      Navigate(static_cast<web::FakeWebState*>(
+                   web_state_list->GetWebStateAt(index)),
+               base::UTF8ToUTF16(
+                   base::StringPrintf("round %d tab %d", round, index)),
+               GURL(base::StringPrintf("https://round%d.test/", round)));
+    }
+    EXPECT_EQ(SearchAllTabs(u"news"), Search(u"news"));
+    EXPECT_EQ(SearchAllTabs(u"tab 19"), Search(u"tab 19"));
+    EXPECT_EQ(SearchAllTabs(u"ROUND"), Search(u"ROUND"));
+  }
+  EXPECT_EQ(2000u, Search(u"round2").size());
+}
+
+// Measures typing queries against 2,000 tabs, through the index and by checking
+// every tab as TabsSearchService used to.
+TEST_F(TabsSearchIndexTest, TypingPerformance) {
+  AppendGeneratedWebStates(2000);
+  // Index the tabs before measuring.
+  Search(u"news");
+
+  const std::u16string queries[] = {u"vidéos page 1", u"weather.example/4",
+                                    u"CAFE PAGE 19", u"not found"};
+  base::TimeDelta index_time;
+  base::TimeDelta linear_time;
+  for (const std::u16string& query : queries) {
+    for (size_t length = 1; length <= query.size(); ++length) {
+      const std::u16string term = query.substr(0, length);
+
+      base::ElapsedTimer index_timer;
+      std::set<web::WebState*> index_results = Search(term);
+      index_time += index_timer.Elapsed();
+
+      base::ElapsedTimer linear_timer;
+      std::set<web::WebState*> linear_results = SearchAllTabs(term);
+      linear_time += linear_timer.Elapsed();
+
+      EXPECT_EQ(linear_results, index_results) << term;
+    }
+  }
+
+  // Log the elapsed times for performance tracking.
+  perf_test::PrintResult("TabsSearchIndex", "", "2000 tabs, index",
+                         index_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+  perf_test::PrintResult("TabsSearchIndex", "", "2000 tabs, all tabs",
+                         linear_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+}
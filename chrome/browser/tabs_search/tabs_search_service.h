@@ -5,6 +5,7 @@
 #ifndef IOS_CHROME_BROWSER_TABS_SEARCH_TABS_SEARCH_SERVICE_H_
 #define IOS_CHROME_BROWSER_TABS_SEARCH_TABS_SEARCH_SERVICE_H_
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -17,6 +18,7 @@
 
 class Browser;
 class ChromeBrowserState;
+class TabsSearchIndex;
 
 namespace sessions {
 class SerializedNavigationEntry;
@@ -39,6 +41,9 @@ class TabsSearchService : public IOSBrowsingHistoryDriverDelegate,
   TabsSearchService(ChromeBrowserState* browser_state);
   ~TabsSearchService() override;
 
+  // KeyedService:
+  void Shutdown() override;
+
   // A container to store matched WebStates with a reference to their associated
   // |browser|.
   struct TabsSearchBrowserResults {
@@ -53,7 +58,9 @@ class TabsSearchService : public IOSBrowsingHistoryDriverDelegate,
   // Searches through tabs in all the Browsers associated with |browser_state|
   // for WebStates with current titles or URLs matching |term|. The matching
   // WebStates are returned to the |completion| callback in instances of
-  // TabsSearchBrowserResults along with their associated Browser.
+  // TabsSearchBrowserResults along with their associated Browser. Within a
+  // Browser, tabs whose title starts with |term| come first, then tabs whose
+  // title contains it, then tabs whose URL contains it, each in tab order.
   void Search(const std::u16string& term,
               base::OnceCallback<void(std::vector<TabsSearchBrowserResults>)>
                   completion);
@@ -115,6 +122,8 @@ class TabsSearchService : public IOSBrowsingHistoryDriverDelegate,
 
   // The associated BrowserState.
   ChromeBrowserState* browser_state_;
+  // Index of the open tabs, created on the first search.
+  std::unique_ptr<TabsSearchIndex> tabs_index_;
   // The most recent search history term.
   std::u16string ongoing_history_search_term_;
   // A callback to return history search results once the current in progress
@@ -6,9 +6,11 @@
 
 #import <Foundation/Foundation.h>
 
+#include <algorithm>
+#include <map>
+
 #include "base/i18n/break_iterator.h"
 #include "base/i18n/string_search.h"
-#import "base/strings/sys_string_conversions.h"
 #import "base/strings/utf_string_conversions.h"
 #include "components/keyed_service/core/service_access_type.h"
 #include "components/sessions/core/tab_restore_service.h"
@@ -26,7 +28,7 @@
 #include "ios/chrome/browser/signin/identity_manager_factory.h"
 #include "ios/chrome/browser/sync/session_sync_service_factory.h"
 #include "ios/chrome/browser/sync/sync_service_factory.h"
-#import "ios/chrome/browser/tabs/tab_title_util.h"
+#import "ios/chrome/browser/tabs_search/tabs_search_index.h"
 #include "ios/chrome/browser/ui/recent_tabs/synced_sessions.h"
 #import "ios/chrome/browser/web_state_list/web_state_list.h"
 #import "ios/web/public/web_state.h"
@@ -55,6 +57,10 @@ TabsSearchService::TabsSearchBrowserResults::TabsSearchBrowserResults(
 
 TabsSearchService::~TabsSearchService() = default;
 
+void TabsSearchService::Shutdown() {
+  tabs_index_.reset();
+}
+
 void TabsSearchService::Search(
     const std::u16string& term,
     base::OnceCallback<void(std::vector<TabsSearchBrowserResults>)>
@@ -185,29 +191,44 @@ void TabsSearchService::SearchWithinBrowsers(
     const std::u16string& term,
     base::OnceCallback<void(std::vector<TabsSearchBrowserResults>)>
         completion) {
-  FixedPatternStringSearchIgnoringCaseAndAccents query_search(term);
+  if (!tabs_index_) {
+    tabs_index_ = std::make_unique<TabsSearchIndex>(
+        BrowserListFactory::GetForBrowserState(browser_state_),
+        browser_state_->IsOffTheRecord());
+  }
+
+  std::map<web::WebState*, TabsSearchIndex::MatchRank> ranks;
+  std::map<WebStateList*, size_t> match_counts;
+  for (const TabsSearchIndex::Match& match : tabs_index_->Search(term)) {
+    ranks[match.web_state] = match.rank;
+    ++match_counts[match.web_state_list];
+  }
 
   std::vector<TabsSearchBrowserResults> results;
 
   for (Browser* browser : browsers) {
-    std::vector<web::WebState*> matching_web_states;
     WebStateList* webStateList = browser->GetWebStateList();
-    for (int index = 0; index < webStateList->count(); ++index) {
+    auto match_count = match_counts.find(webStateList);
+    if (match_count == match_counts.end())
+      continue;
+
+    // Collect the matches in tab order, then order them by rank.
+    std::vector<web::WebState*> matching_web_states;
+    matching_web_states.reserve(match_count->second);
+    for (int index = 0; index < webStateList->count() &&
+                        matching_web_states.size() < match_count->second;
+         ++index) {
       web::WebState* web_state = webStateList->GetWebStateAt(index);
-      auto title = base::SysNSStringToUTF16(tab_util::GetTabTitle(web_state));
-      auto url_string = base::UTF8ToUTF16(web_state->GetVisibleURL().spec());
-      if (query_search.Search(title, /*match_index=*/nullptr,
-                              /*match_length=*/nullptr) ||
-          query_search.Search(url_string, /*match_index=*/nullptr,
-                              /*match_length=*/nullptr)) {
+      if (ranks.count(web_state))
         matching_web_states.push_back(web_state);
-      }
     }
+    std::stable_sort(matching_web_states.begin(), matching_web_states.end(),
+                     [&ranks](web::WebState* a, web::WebState* b) {
+                       return ranks[a] < ranks[b];
+                     });
 
-    if (!matching_web_states.empty()) {
-      TabsSearchBrowserResults browser_results(browser, matching_web_states);
-      results.push_back(browser_results);
-    }
+    TabsSearchBrowserResults browser_results(browser, matching_web_states);
+    results.push_back(browser_results);
   }
 
   std::move(completion).Run(results);
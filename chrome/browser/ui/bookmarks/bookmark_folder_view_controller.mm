@@ -57,6 +57,9 @@ using bookmarks::BookmarkNode;
     UITableViewDelegate> {
   std::set<const BookmarkNode*> _editedNodes;
   std::vector<const BookmarkNode*> _folders;
+  // Whether `_folders` reflects the current state of the bookmark model. The
+  // folders are only listed again after a change of the model.
+  BOOL _foldersUpToDate;
   std::unique_ptr<bookmarks::BookmarkModelBridge> _modelBridge;
 }
 
@@ -313,16 +316,20 @@ using bookmarks::BookmarkNode;
 - (void)bookmarkNodeChanged:(const BookmarkNode*)bookmarkNode {
   if (!bookmarkNode->is_folder())
     return;
+  _foldersUpToDate = NO;
   [self reloadModel];
 }
 
 - (void)bookmarkNodeChildrenChanged:(const BookmarkNode*)bookmarkNode {
+  _foldersUpToDate = NO;
   [self reloadModel];
 }
 
 - (void)bookmarkNode:(const BookmarkNode*)bookmarkNode
      movedFromParent:(const BookmarkNode*)oldParent
             toParent:(const BookmarkNode*)newParent {
+  // Moving a bookmark may change the visibility of a permanent folder.
+  _foldersUpToDate = NO;
   if (bookmarkNode->is_folder()) {
     [self reloadModel];
   }
@@ -330,6 +337,7 @@ using bookmarks::BookmarkNode;
 
 - (void)bookmarkNodeDeleted:(const BookmarkNode*)bookmarkNode
                  fromFolder:(const BookmarkNode*)folder {
+  _foldersUpToDate = NO;
   // Remove node from editedNodes if it is already deleted (possibly remotely by
   // another sync device).
   if (self.editedNodes.find(bookmarkNode) != self.editedNodes.end()) {
@@ -355,6 +363,7 @@ using bookmarks::BookmarkNode;
 }
 
 - (void)bookmarkModelRemovedAllNodes {
+  _foldersUpToDate = NO;
   // The selected folder is no longer valid. Fallback on the Mobile Bookmarks
   // node.
   [self changeSelectedFolder:self.bookmarkModel->mobile_node()];
@@ -378,8 +387,11 @@ using bookmarks::BookmarkNode;
 }
 
 - (void)reloadModel {
-  _folders = bookmark_utils_ios::VisibleNonDescendantNodes(self.editedNodes,
-                                                           self.bookmarkModel);
+  if (!_foldersUpToDate) {
+    _folders = bookmark_utils_ios::VisibleNonDescendantNodes(
+        self.editedNodes, self.bookmarkModel);
+    _foldersUpToDate = YES;
+  }
 
   // Delete any existing section.
   if ([self.tableViewModel
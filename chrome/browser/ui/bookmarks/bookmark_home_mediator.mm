@@ -8,7 +8,6 @@
 #include "base/mac/foundation_util.h"
 #include "base/strings/sys_string_conversions.h"
 #include "components/bookmarks/browser/bookmark_model.h"
-#include "components/bookmarks/browser/bookmark_utils.h"
 #include "components/bookmarks/browser/titled_url_match.h"
 #include "components/bookmarks/common/bookmark_pref_names.h"
 #include "components/bookmarks/managed/managed_bookmark_service.h"
@@ -27,6 +26,7 @@
 #import "ios/chrome/browser/ui/bookmarks/bookmark_home_shared_state.h"
 #include "ios/chrome/browser/ui/bookmarks/bookmark_model_bridge_observer.h"
 #import "ios/chrome/browser/ui/bookmarks/bookmark_promo_controller.h"
+#import "ios/chrome/browser/ui/bookmarks/bookmark_search_index.h"
 #import "ios/chrome/browser/ui/bookmarks/cells/bookmark_home_node_item.h"
 #import "ios/chrome/browser/ui/bookmarks/synced_bookmarks_bridge.h"
 #import "ios/chrome/browser/ui/table_view/cells/table_view_text_item.h"
@@ -44,7 +44,7 @@ using bookmarks::BookmarkNode;
 
 namespace {
 // Maximum number of entries to fetch when searching.
-const int kMaxBookmarksSearchResults = 50;
+const size_t kMaxBookmarksSearchResults = 50;
 }  // namespace
 
 @interface BookmarkHomeMediator () <BookmarkModelBridgeObserver,
@@ -63,6 +63,11 @@ const int kMaxBookmarksSearchResults = 50;
   std::unique_ptr<PrefObserverBridge> _prefObserverBridge;
   // Registrar for pref changes notifications.
   std::unique_ptr<PrefChangeRegistrar> _prefChangeRegistrar;
+
+  // Index of the bookmarks, created on the first search.
+  std::unique_ptr<BookmarkSearchIndex> _searchIndex;
+  // Items of the current search results by node, reused by the next search.
+  NSMutableDictionary<NSValue*, BookmarkHomeNodeItem*>* _searchResultItems;
 }
 
 // Shared state between Bookmark home classes.
@@ -131,6 +136,8 @@ const int kMaxBookmarksSearchResults = 50;
   _bookmarkPromoController = nil;
 
   _modelBridge = nullptr;
+  _searchIndex = nullptr;
+  _searchResultItems = nil;
   _syncedBookmarksObserver = nullptr;
   self.browserState = nullptr;
   self.consumer = nil;
@@ -143,6 +150,7 @@ const int kMaxBookmarksSearchResults = 50;
 
 // Computes the bookmarks table view based on the current root node.
 - (void)computeBookmarkTableViewData {
+  _searchResultItems = nil;
   [self deleteAllItemsOrAddSectionWithIdentifier:
             BookmarkHomeSectionIdentifierBookmarks];
   [self deleteAllItemsOrAddSectionWithIdentifier:
@@ -244,23 +252,32 @@ const int kMaxBookmarksSearchResults = 50;
   [self deleteAllItemsOrAddSectionWithIdentifier:
             BookmarkHomeSectionIdentifierMessages];
 
-  std::vector<const BookmarkNode*> nodes;
-  bookmarks::QueryFields query;
-  query.word_phrase_query.reset(new std::u16string);
-  *query.word_phrase_query = base::SysNSStringToUTF16(searchText);
-  GetBookmarksMatchingProperties(self.sharedState.bookmarkModel, query,
-                                 kMaxBookmarksSearchResults, &nodes);
+  if (!_searchIndex) {
+    _searchIndex =
+        std::make_unique<BookmarkSearchIndex>(self.sharedState.bookmarkModel);
+  }
+  std::vector<const BookmarkNode*> nodes = _searchIndex->Search(
+      base::SysNSStringToUTF16(searchText), kMaxBookmarksSearchResults);
 
+  // Nodes which were already in the previous results keep their item.
+  NSMutableDictionary<NSValue*, BookmarkHomeNodeItem*>* searchResultItems =
+      [NSMutableDictionary dictionaryWithCapacity:nodes.size()];
   int count = 0;
   for (const BookmarkNode* node : nodes) {
-    BookmarkHomeNodeItem* nodeItem =
-        [[BookmarkHomeNodeItem alloc] initWithType:BookmarkHomeItemTypeBookmark
-                                      bookmarkNode:node];
+    NSValue* key = [NSValue valueWithPointer:node];
+    BookmarkHomeNodeItem* nodeItem = _searchResultItems[key];
+    if (!nodeItem) {
+      nodeItem = [[BookmarkHomeNodeItem alloc]
+          initWithType:BookmarkHomeItemTypeBookmark
+          bookmarkNode:node];
+    }
+    searchResultItems[key] = nodeItem;
     [self.sharedState.tableViewModel
                         addItem:nodeItem
         toSectionWithIdentifier:BookmarkHomeSectionIdentifierBookmarks];
     count++;
   }
+  _searchResultItems = searchResultItems;
 
   if (count == 0) {
     TableViewTextItem* item =
@@ -415,6 +432,8 @@ const int kMaxBookmarksSearchResults = 50;
 // `node` was deleted from `folder`.
 - (void)bookmarkNodeDeleted:(const BookmarkNode*)node
                  fromFolder:(const BookmarkNode*)folder {
+  // The items refer to their node, which may have been deleted.
+  _searchResultItems = nil;
   if (self.sharedState.currentlyShowingSearchResults) {
     [self.consumer refreshContents];
   } else if (self.sharedState.tableViewDisplayedRootNode == node) {
@@ -0,0 +1,145 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_UI_BOOKMARKS_BOOKMARK_SEARCH_INDEX_H_
+#define IOS_CHROME_BROWSER_UI_BOOKMARKS_BOOKMARK_SEARCH_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/scoped_observation.h"
+#include "components/bookmarks/browser/bookmark_model.h"
+#include "components/bookmarks/browser/bookmark_model_observer.h"
+
+// Index of the titles and URLs of the bookmarks of a BookmarkModel, used to
+// search the bookmarks as the user types without checking the whole model.
+//
+// Search matches as GetBookmarksMatchingProperties does: a node matches if
+// its title, or its URL, contains every word of the query, ignoring case and
+// accents. Titles and URLs are folded (case, accents and width insensitive)
+// and their trigrams are indexed. The trigrams of the query words only narrow
+// the candidates, which are then checked in depth-first order until enough
+// matches are found. Nodes whose folded title or URL are not printable ASCII
+// cannot be indexed reliably and are always checked.
+//
+// The index follows the changes of the model. The depth-first order of the
+// nodes is only computed again after the tree changed.
+class BookmarkSearchIndex : public bookmarks::BookmarkModelObserver {
+ public:
+  explicit BookmarkSearchIndex(bookmarks::BookmarkModel* model);
+
+  BookmarkSearchIndex(const BookmarkSearchIndex&) = delete;
+  BookmarkSearchIndex& operator=(const BookmarkSearchIndex&) = delete;
+
+  ~BookmarkSearchIndex() override;
+
+  // Returns the first `max_count` bookmarks and folders matching `query`, in
+  // depth-first order. Permanent nodes are never returned.
+  std::vector<const bookmarks::BookmarkNode*> Search(
+      const std::u16string& query,
+      size_t max_count);
+
+  // Returns the number of indexed nodes.
+  size_t size() const { return entries_.size(); }
+
+  // BookmarkModelObserver:
+  void BookmarkModelLoaded(bookmarks::BookmarkModel* model,
+                           bool ids_reassigned) override;
+  void BookmarkModelBeingDeleted(bookmarks::BookmarkModel* model) override;
+  void BookmarkNodeMoved(bookmarks::BookmarkModel* model,
+                         const bookmarks::BookmarkNode* old_parent,
+                         size_t old_index,
+                         const bookmarks::BookmarkNode* new_parent,
+                         size_t new_index) override;
+  void BookmarkNodeAdded(bookmarks::BookmarkModel* model,
+                         const bookmarks::BookmarkNode* parent,
+                         size_t index) override;
+  void BookmarkNodeRemoved(bookmarks::BookmarkModel* model,
+                           const bookmarks::BookmarkNode* parent,
+                           size_t old_index,
+                           const bookmarks::BookmarkNode* node,
+                           const std::set<GURL>& removed_urls) override;
+  void BookmarkNodeChanged(bookmarks::BookmarkModel* model,
+                           const bookmarks::BookmarkNode* node) override;
+  void BookmarkNodeFaviconChanged(
+      bookmarks::BookmarkModel* model,
+      const bookmarks::BookmarkNode* node) override;
+  void BookmarkNodeChildrenReordered(
+      bookmarks::BookmarkModel* model,
+      const bookmarks::BookmarkNode* node) override;
+  void BookmarkAllUserNodesRemoved(bookmarks::BookmarkModel* model,
+                                   const std::set<GURL>& removed_urls) override;
+
+ private:
+  // An indexed node.
+  struct Entry {
+    // Identifier of the current version of the entry in the postings.
+    uint32_t id = 0;
+    // Title, URL spec and formatted URL, as searched.
+    std::u16string title;
+    std::u16string url;
+    std::u16string formatted_url;
+    // Number of postings of the entry.
+    size_t posting_count = 0;
+  };
+
+  // Indexes `node` and its descendants, or removes them from the index.
+  void AddSubtree(const bookmarks::BookmarkNode* node);
+  void RemoveSubtree(const bookmarks::BookmarkNode* node);
+
+  // Indexes `node`, or removes it from the index.
+  void AddNode(const bookmarks::BookmarkNode* node);
+  void RemoveNode(const bookmarks::BookmarkNode* node);
+
+  // Forgets about all the nodes.
+  void Clear();
+
+  // Drops the postings of the removed entries once they are too many.
+  void MaybeCompactPostings();
+
+  // Returns the sorted identifiers of the indexed entries that may contain
+  // all of `folded_words`, which must be printable ASCII and at least as long
+  // as a trigram.
+  std::vector<uint32_t> IndexedCandidates(
+      const std::vector<std::u16string>& folded_words);
+
+  // Computes the depth-first order of the nodes if the tree changed.
+  void UpdatePositions();
+
+  base::ScopedObservation<bookmarks::BookmarkModel,
+                          bookmarks::BookmarkModelObserver>
+      model_observation_{this};
+
+  bookmarks::BookmarkModel* model_;
+
+  // Entries of all the indexed nodes, and nodes by entry identifier.
+  std::unordered_map<const bookmarks::BookmarkNode*, Entry> entries_;
+  std::unordered_map<uint32_t, const bookmarks::BookmarkNode*> nodes_by_id_;
+
+  // Identifiers of the entries containing each trigram, sorted. Identifiers
+  // are never reused, so removed entries are simply ignored until the
+  // postings are compacted.
+  std::map<uint32_t, std::vector<uint32_t>> postings_;
+  size_t posting_count_ = 0;
+  size_t live_posting_count_ = 0;
+
+  // Identifiers of the entries which could not be indexed.
+  std::set<uint32_t> unindexed_ids_;
+
+  uint32_t next_id_ = 1;
+
+  // Indexed nodes in depth-first order and their positions, valid unless
+  // `positions_outdated_`.
+  std::vector<const bookmarks::BookmarkNode*> ordered_nodes_;
+  std::unordered_map<const bookmarks::BookmarkNode*, size_t> positions_;
+  bool positions_outdated_ = true;
+};
+
+#endif  // IOS_CHROME_BROWSER_UI_BOOKMARKS_BOOKMARK_SEARCH_INDEX_H_
@@ -0,0 +1,359 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/ui/bookmarks/bookmark_search_index.h"
+
+#import <Foundation/Foundation.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+#include "base/check.h"
+#include "base/containers/cxx20_erase.h"
+#include "base/i18n/case_conversion.h"
+#include "base/i18n/string_search.h"
+#include "base/strings/escape.h"
+#include "base/strings/string_util.h"
+#include "base/strings/sys_string_conversions.h"
+#include "base/strings/utf_string_conversions.h"
+#include "components/query_parser/query_parser.h"
+#include "components/url_formatter/url_formatter.h"
+#include "ui/base/models/tree_node_iterator.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+using base::i18n::FixedPatternStringSearchIgnoringCaseAndAccents;
+using bookmarks::BookmarkModel;
+using bookmarks::BookmarkNode;
+
+namespace {
+
+// The postings are compacted once there are at least this many postings of
+// removed entries, and more than live postings.
+const size_t kMinDeadPostingsForCompaction = 16 * 1024;
+
+// Searches of the words of a query.
+using WordSearches = std::vector<
+    std::unique_ptr<FixedPatternStringSearchIgnoringCaseAndAccents>>;
+
+// Returns `text` folded for indexing.
+std::u16string FoldForIndex(const std::u16string& text) {
+  return base::SysNSStringToUTF16([base::SysUTF16ToNSString(text)
+      stringByFoldingWithOptions:NSCaseInsensitiveSearch |
+                                 NSDiacriticInsensitiveSearch |
+                                 NSWidthInsensitiveSearch
+                          locale:nil]);
+}
+
+// Returns whether `text` only contains printable ASCII characters. Those are
+// matched by the string search exactly as they are folded.
+bool IsPrintableASCII(const std::u16string& text) {
+  return std::all_of(text.begin(), text.end(),
+                     [](char16_t c) { return c >= 0x20 && c < 0x7f; });
+}
+
+// Returns the key of the trigram starting at `i` in `folded_text`, which must
+// be printable ASCII.
+uint32_t TrigramAt(const std::u16string& folded_text, size_t i) {
+  return (static_cast<uint32_t>(folded_text[i]) << 16) |
+         (static_cast<uint32_t>(folded_text[i + 1]) << 8) |
+         static_cast<uint32_t>(folded_text[i + 2]);
+}
+
+// Adds the trigrams of `folded_text` to `trigrams`.
+void AddTrigrams(const std::u16string& folded_text,
+                 std::set<uint32_t>* trigrams) {
+  for (size_t i = 0; i + 2 < folded_text.size(); ++i)
+    trigrams->insert(TrigramAt(folded_text, i));
+}
+
+// Returns whether `text` contains all the words searched by `searches`.
+bool ContainsAllWords(const std::u16string& text, WordSearches& searches) {
+  return !text.empty() &&
+         std::all_of(searches.begin(), searches.end(),
+                     [&text](const auto& search) {
+                       return search->Search(text, /*match_index=*/nullptr,
+                                             /*match_length=*/nullptr);
+                     });
+}
+
+}  // namespace
+
+BookmarkSearchIndex::BookmarkSearchIndex(BookmarkModel* model)
+    : model_(model) {
+  DCHECK(model_);
+  model_observation_.Observe(model_);
+  if (model_->loaded())
+    AddSubtree(model_->root_node());
+}
+
+BookmarkSearchIndex::~BookmarkSearchIndex() = default;
+
+std::vector<const BookmarkNode*> BookmarkSearchIndex::Search(
+    const std::u16string& query,
+    size_t max_count) {
+  // Split the query as GetBookmarksMatchingProperties does.
+  std::vector<std::u16string> query_words;
+  query_parser::QueryParser::ParseQueryWords(
+      base::i18n::ToLower(query), query_parser::MatchingAlgorithm::DEFAULT,
+      &query_words);
+  std::vector<const BookmarkNode*> matches;
+  if (query_words.empty() || !max_count)
+    return matches;
+
+  MaybeCompactPostings();
+  UpdatePositions();
+
+  // Words shorter than a trigram do not narrow the candidates. If a word
+  // cannot be looked up, all the nodes are candidates.
+  bool use_index = true;
+  std::vector<std::u16string> folded_words;
+  WordSearches searches;
+  for (const std::u16string& word : query_words) {
+    searches.push_back(
+        std::make_unique<FixedPatternStringSearchIgnoringCaseAndAccents>(
+            word));
+    const std::u16string folded_word = FoldForIndex(word);
+    if (!IsPrintableASCII(folded_word))
+      use_index = false;
+    else if (folded_word.size() >= 3)
+      folded_words.push_back(folded_word);
+  }
+
+  std::vector<const BookmarkNode*> candidates;
+  if (use_index && !folded_words.empty()) {
+    std::vector<uint32_t> ids = IndexedCandidates(folded_words);
+    ids.insert(ids.end(), unindexed_ids_.begin(), unindexed_ids_.end());
+    for (uint32_t id : ids) {
+      auto it = nodes_by_id_.find(id);
+      if (it != nodes_by_id_.end())
+        candidates.push_back(it->second);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [this](const BookmarkNode* lhs, const BookmarkNode* rhs) {
+                return positions_[lhs] < positions_[rhs];
+              });
+  } else {
+    candidates = ordered_nodes_;
+  }
+
+  // Check the candidates in depth-first order, stopping after `max_count`
+  // matches.
+  for (const BookmarkNode* node : candidates) {
+    const Entry& entry = entries_[node];
+    if (ContainsAllWords(entry.title, searches) ||
+        ContainsAllWords(entry.url, searches) ||
+        ContainsAllWords(entry.formatted_url, searches)) {
+      matches.push_back(node);
+      if (matches.size() == max_count)
+        break;
+    }
+  }
+  return matches;
+}
+
+#pragma mark - BookmarkModelObserver
+
+void BookmarkSearchIndex::BookmarkModelLoaded(BookmarkModel* model,
+                                              bool ids_reassigned) {
+  Clear();
+  AddSubtree(model_->root_node());
+}
+
+void BookmarkSearchIndex::BookmarkModelBeingDeleted(BookmarkModel* model) {
+  model_observation_.Reset();
+  Clear();
+}
+
+void BookmarkSearchIndex::BookmarkNodeMoved(BookmarkModel* model,
+                                            const BookmarkNode* old_parent,
+                                            size_t old_index,
+                                            const BookmarkNode* new_parent,
+                                            size_t new_index) {
+  positions_outdated_ = true;
+}
+
+void BookmarkSearchIndex::BookmarkNodeAdded(BookmarkModel* model,
+                                            const BookmarkNode* parent,
+                                            size_t index) {
+  AddSubtree(parent->children()[index].get());
+}
+
+void BookmarkSearchIndex::BookmarkNodeRemoved(
+    BookmarkModel* model,
+    const BookmarkNode* parent,
+    size_t old_index,
+    const BookmarkNode* node,
+    const std::set<GURL>& removed_urls) {
+  RemoveSubtree(node);
+}
+
+void BookmarkSearchIndex::BookmarkNodeChanged(BookmarkModel* model,
+                                              const BookmarkNode* node) {
+  if (!entries_.count(node))
+    return;
+  RemoveNode(node);
+  AddNode(node);
+}
+
+void BookmarkSearchIndex::BookmarkNodeFaviconChanged(BookmarkModel* model,
+                                                     const BookmarkNode* node) {
+}
+
+void BookmarkSearchIndex::BookmarkNodeChildrenReordered(
+    BookmarkModel* model,
+    const BookmarkNode* node) {
+  positions_outdated_ = true;
+}
+
+void BookmarkSearchIndex::BookmarkAllUserNodesRemoved(
+    BookmarkModel* model,
+    const std::set<GURL>& removed_urls) {
+  // Nodes which are not user nodes, like managed bookmarks, are still there.
+  Clear();
+  AddSubtree(model_->root_node());
+}
+
+#pragma mark - Private
+
+void BookmarkSearchIndex::AddSubtree(const BookmarkNode* node) {
+  AddNode(node);
+  ui::TreeNodeIterator<const BookmarkNode> iterator(node);
+  while (iterator.has_next())
+    AddNode(iterator.Next());
+}
+
+void BookmarkSearchIndex::RemoveSubtree(const BookmarkNode* node) {
+  RemoveNode(node);
+  ui::TreeNodeIterator<const BookmarkNode> iterator(node);
+  while (iterator.has_next())
+    RemoveNode(iterator.Next());
+}
+
+void BookmarkSearchIndex::AddNode(const BookmarkNode* node) {
+  if (node->is_permanent_node() || entries_.count(node))
+    return;
+  Entry& entry = entries_[node];
+  entry.id = next_id_++;
+  nodes_by_id_[entry.id] = node;
+  entry.title = node->GetTitle();
+  if (node->is_url()) {
+    entry.url = base::UTF8ToUTF16(node->url().spec());
+    entry.formatted_url = url_formatter::FormatUrl(
+        node->url(), url_formatter::kFormatUrlOmitNothing,
+        base::UnescapeRule::NORMAL, nullptr, nullptr, nullptr);
+  }
+  positions_outdated_ = true;
+
+  const std::u16string folded_title = FoldForIndex(entry.title);
+  const std::u16string folded_url = FoldForIndex(entry.url);
+  const std::u16string folded_formatted_url =
+      FoldForIndex(entry.formatted_url);
+  if (!IsPrintableASCII(folded_title) || !IsPrintableASCII(folded_url) ||
+      !IsPrintableASCII(folded_formatted_url)) {
+    unindexed_ids_.insert(entry.id);
+    return;
+  }
+
+  // Identifiers are increasing, so the postings stay sorted.
+  std::set<uint32_t> trigrams;
+  AddTrigrams(folded_title, &trigrams);
+  AddTrigrams(folded_url, &trigrams);
+  AddTrigrams(folded_formatted_url, &trigrams);
+  for (uint32_t trigram : trigrams)
+    postings_[trigram].push_back(entry.id);
+  entry.posting_count = trigrams.size();
+  posting_count_ += entry.posting_count;
+  live_posting_count_ += entry.posting_count;
+}
+
+void BookmarkSearchIndex::RemoveNode(const BookmarkNode* node) {
+  auto it = entries_.find(node);
+  if (it == entries_.end())
+    return;
+  nodes_by_id_.erase(it->second.id);
+  unindexed_ids_.erase(it->second.id);
+  live_posting_count_ -= it->second.posting_count;
+  entries_.erase(it);
+  positions_outdated_ = true;
+}
+
+void BookmarkSearchIndex::Clear() {
+  entries_.clear();
+  nodes_by_id_.clear();
+  postings_.clear();
+  posting_count_ = 0;
+  live_posting_count_ = 0;
+  unindexed_ids_.clear();
+  ordered_nodes_.clear();
+  positions_.clear();
+  positions_outdated_ = true;
+}
+
+void BookmarkSearchIndex::MaybeCompactPostings() {
+  const size_t dead_posting_count = posting_count_ - live_posting_count_;
+  if (dead_posting_count < kMinDeadPostingsForCompaction ||
+      dead_posting_count < live_posting_count_) {
+    return;
+  }
+
+  for (auto it = postings_.begin(); it != postings_.end();) {
+    base::EraseIf(it->second,
+                  [this](uint32_t id) { return !nodes_by_id_.count(id); });
+    it = it->second.empty() ? postings_.erase(it) : std::next(it);
+  }
+  posting_count_ = live_posting_count_;
+}
+
+std::vector<uint32_t> BookmarkSearchIndex::IndexedCandidates(
+    const std::vector<std::u16string>& folded_words) {
+  // Intersect the postings of all the trigrams of the words, smallest first.
+  std::vector<const std::vector<uint32_t>*> postings;
+  std::set<uint32_t> trigrams;
+  for (const std::u16string& folded_word : folded_words) {
+    DCHECK_GE(folded_word.size(), 3u);
+    for (size_t i = 0; i + 2 < folded_word.size(); ++i) {
+      const uint32_t trigram = TrigramAt(folded_word, i);
+      if (!trigrams.insert(trigram).second)
+        continue;
+      auto it = postings_.find(trigram);
+      if (it == postings_.end())
+        return std::vector<uint32_t>();
+      postings.push_back(&it->second);
+    }
+  }
+  std::sort(postings.begin(), postings.end(),
+            [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+              return a->size() < b->size();
+            });
+
+  std::vector<uint32_t> ids = *postings.front();
+  for (size_t i = 1; i < postings.size() && !ids.empty(); ++i) {
+    std::vector<uint32_t> intersection;
+    std::set_intersection(ids.begin(), ids.end(), postings[i]->begin(),
+                          postings[i]->end(), std::back_inserter(intersection));
+    ids.swap(intersection);
+  }
+  return ids;
+}
+
+void BookmarkSearchIndex::UpdatePositions() {
+  if (!positions_outdated_)
+    return;
+  ordered_nodes_.clear();
+  positions_.clear();
+  ui::TreeNodeIterator<const BookmarkNode> iterator(model_->root_node());
+  while (iterator.has_next()) {
+    const BookmarkNode* node = iterator.Next();
+    if (entries_.count(node)) {
+      positions_[node] = ordered_nodes_.size();
+      ordered_nodes_.push_back(node);
+    }
+  }
+  positions_outdated_ = false;
+}
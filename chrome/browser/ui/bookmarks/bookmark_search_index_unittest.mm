@@ -0,0 +1,237 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/ui/bookmarks/bookmark_search_index.h"
+
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "components/bookmarks/browser/bookmark_model.h"
+#include "components/bookmarks/browser/bookmark_utils.h"
+#include "ios/chrome/browser/ui/bookmarks/bookmark_ios_unittest.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+using bookmarks::BookmarkNode;
+
+namespace {
+
+using NodeVector = std::vector<const BookmarkNode*>;
+
+// Words used to build the titles of generated bookmarks.
+const char* const kTitleWords[] = {"news",  "weather", "recipes", "travel",
+                                   "sport", "mail",    "maps",    "vidéos"};
+
+class BookmarkSearchIndexTest : public BookmarkIOSUnitTest {
+ protected:
+  void SetUp() override {
+    BookmarkIOSUnitTest::SetUp();
+    index_ = std::make_unique<BookmarkSearchIndex>(bookmark_model_);
+  }
+
+  void TearDown() override {
+    index_.reset();
+    BookmarkIOSUnitTest::TearDown();
+  }
+
+  // Adds a bookmark with `title` and `url` at the end of `parent`.
+  const BookmarkNode* AddURL(const BookmarkNode* parent,
+                             const std::u16string& title,
+                             const std::string& url) {
+    return bookmark_model_->AddURL(parent, parent->children().size(), title,
+                                   GURL(url));
+  }
+
+  // Returns the matches of `query` from the index, without limit.
+  NodeVector Search(const std::u16string& query) {
+    return index_->Search(query, std::numeric_limits<size_t>::max());
+  }
+
+  // Returns the first `max_count` nodes matching `query`, found by checking
+  // every node with GetBookmarksMatchingProperties.
+  NodeVector SearchAllNodes(const std::u16string& query,
+                            size_t max_count =
+                                std::numeric_limits<size_t>::max()) {
+    bookmarks::QueryFields query_fields;
+    query_fields.word_phrase_query = std::make_unique<std::u16string>(query);
+    NodeVector nodes;
+    bookmarks::GetBookmarksMatchingProperties(bookmark_model_, query_fields,
+                                              max_count, &nodes);
+    return nodes;
+  }
+
+  // Adds `count` generated bookmarks to the mobile node, in folders of 500.
+  void AddGeneratedBookmarks(int count) {
+    const BookmarkNode* mobile_node = bookmark_model_->mobile_node();
+    const BookmarkNode* folder = nullptr;
+    for (int i = 0; i < count; ++i) {
+      if (i % 500 == 0) {
+        folder = bookmark_model_->AddFolder(
+            mobile_node, mobile_node->children().size(),
+            base::UTF8ToUTF16(base::StringPrintf("folder %d", i / 500)));
+      }
+      const char* word = kTitleWords[i % std::size(kTitleWords)];
+      AddURL(folder,
+             base::UTF8ToUTF16(base::StringPrintf("%s page %d", word, i)),
+             base::StringPrintf("https://www.%s.example/%d?q=%d",
+                                i % 2 ? "tube" : "book", i % 97, i));
+    }
+  }
+
+  std::unique_ptr<BookmarkSearchIndex> index_;
+};
+
+// Tests that the query words are matched anywhere in the title or the URL,
+// ignoring case and accents, and that all the words of the query must be in
+// the title or all in the URL.
+TEST_F(BookmarkSearchIndexTest, MatchesSubstrings) {
+  const BookmarkNode* mobile_node = bookmark_model_->mobile_node();
+  const BookmarkNode* youtube =
+      AddURL(mobile_node, u"Videos", "https://www.youtube.com/");
+  const BookmarkNode* facebook =
+      AddURL(mobile_node, u"Friends", "https://www.facebook.com/");
+  const BookmarkNode* cafe =
+      AddURL(mobile_node, u"Café de Flore", "https://flore.test/paris");
+  const BookmarkNode* tokyo =
+      AddURL(mobile_node, u"東京の天気", "https://tenki.test/");
+  const BookmarkNode* folder = AddFolder(mobile_node, @"Paris trip");
+
+  EXPECT_EQ(NodeVector({youtube}), Search(u"tube"));
+  EXPECT_EQ(NodeVector({facebook}), Search(u"book"));
+  EXPECT_EQ(NodeVector({youtube, facebook}), Search(u"www com"));
+  EXPECT_EQ(NodeVector({youtube, facebook}), Search(u"OM"));
+  EXPECT_EQ(NodeVector({cafe}), Search(u"CAFE"));
+  EXPECT_EQ(NodeVector({cafe}), Search(u"afé"));
+  EXPECT_EQ(NodeVector({cafe, folder}), Search(u"aris"));
+  EXPECT_EQ(NodeVector({cafe}), Search(u"flore paris"));
+  EXPECT_EQ(NodeVector({folder}), Search(u"paris trip"));
+  EXPECT_EQ(NodeVector({tokyo}), Search(u"tenki"));
+  EXPECT_EQ(NodeVector({tokyo}), Search(u"天気"));
+  // Words in the title and words in the URL do not match together.
+  EXPECT_TRUE(Search(u"videos youtube").empty());
+  EXPECT_TRUE(Search(u"cafe tokyo").empty());
+  EXPECT_TRUE(Search(u" ").empty());
+  // Permanent nodes are not returned.
+  EXPECT_TRUE(Search(u"mobile").empty());
+}
+
+// Tests that the matches are returned depth-first and limited in number.
+TEST_F(BookmarkSearchIndexTest, DepthFirstOrder) {
+  const BookmarkNode* mobile_node = bookmark_model_->mobile_node();
+  const BookmarkNode* other_node = bookmark_model_->other_node();
+  const BookmarkNode* second =
+      AddURL(other_node, u"news 2", "https://b.test/");
+  const BookmarkNode* folder = AddFolder(mobile_node, @"news folder");
+  const BookmarkNode* first = AddURL(folder, u"news 1", "https://a.test/");
+  const BookmarkNode* third =
+      AddURL(other_node, u"news 3", "https://c.test/");
+
+  // The other bookmarks come before the mobile bookmarks in the model.
+  EXPECT_EQ(NodeVector({second, third, folder, first}), Search(u"news"));
+  EXPECT_EQ(NodeVector({second, third}), index_->Search(u"news", 2));
+
+  bookmark_model_->Move(second, mobile_node, 0);
+  EXPECT_EQ(NodeVector({third, second, folder, first}), Search(u"news"));
+}
+
+// Tests that the index follows the changes of the model.
+TEST_F(BookmarkSearchIndexTest, FollowsChanges) {
+  const BookmarkNode* mobile_node = bookmark_model_->mobile_node();
+  const BookmarkNode* folder = AddFolder(mobile_node, @"folder");
+  const BookmarkNode* weather =
+      AddURL(folder, u"Weather", "https://forecast.test/");
+  EXPECT_EQ(NodeVector({weather}), Search(u"weather"));
+
+  bookmark_model_->SetTitle(weather, u"News");
+  EXPECT_TRUE(Search(u"weather").empty());
+  EXPECT_EQ(NodeVector({weather}), Search(u"news"));
+
+  bookmark_model_->SetURL(weather, GURL("https://headlines.test/"));
+  EXPECT_TRUE(Search(u"forecast").empty());
+  EXPECT_EQ(NodeVector({weather}), Search(u"headlines"));
+
+  // Removing a folder removes its descendants.
+  bookmark_model_->Remove(folder);
+  EXPECT_TRUE(Search(u"news").empty());
+  EXPECT_EQ(0u, index_->size());
+
+  AddURL(mobile_node, u"More news", "https://more.test/");
+  bookmark_model_->RemoveAllUserBookmarks();
+  EXPECT_TRUE(Search(u"news").empty());
+}
+
+// Tests that the index finds the same bookmarks as checking all of them while
+// typing, including after the model changed.
+TEST_F(BookmarkSearchIndexTest, MatchesAllNodesSearch) {
+  AddGeneratedBookmarks(2000);
+  EXPECT_EQ(2004u, index_->size());
+
+  const std::u16string queries[] = {u"vidéos page 1?q=1", u"TUBE.EXAMPLE/4",
+                                    u"ok weather 19", u"not found"};
+  for (const std::u16string& query : queries) {
+    for (size_t length = 1; length <= query.size(); ++length) {
+      const std::u16string term = query.substr(0, length);
+      EXPECT_EQ(SearchAllNodes(term), Search(term)) << term;
+    }
+  }
+
+  const BookmarkNode* mobile_node = bookmark_model_->mobile_node();
+  bookmark_model_->SetTitle(mobile_node->children()[1]->children()[7].get(),
+                            u"renamed videos");
+  EXPECT_EQ(SearchAllNodes(u"videos"), Search(u"videos"));
+  // Removing most bookmarks compacts the postings.
+  while (mobile_node->children().size() > 1)
+    bookmark_model_->Remove(mobile_node->children().back().get());
+  EXPECT_EQ(SearchAllNodes(u"videos"), Search(u"videos"));
+  EXPECT_EQ(SearchAllNodes(u"tube"), Search(u"tube"));
+}
+
+// Measures searching while typing, compared to checking all the bookmarks.
+TEST_F(BookmarkSearchIndexTest, TypingPerformance) {
+  AddGeneratedBookmarks(10000);
+
+  const size_t kMaxCount = 50;
+  const std::u16string queries[] = {u"vidéos page 1?q=1", u"tube.example/4",
+                                    u"weather 19", u"not found"};
+  base::TimeDelta index_time;
+  base::TimeDelta linear_time;
+  for (const std::u16string& query : queries) {
+    for (size_t length = 1; length <= query.size(); ++length) {
+      const std::u16string term = query.substr(0, length);
+
+      base::ElapsedTimer index_timer;
+      NodeVector index_results = index_->Search(term, kMaxCount);
+      index_time += index_timer.Elapsed();
+
+      base::ElapsedTimer linear_timer;
+      NodeVector linear_results = SearchAllNodes(term, kMaxCount);
+      linear_time += linear_timer.Elapsed();
+
+      EXPECT_EQ(linear_results, index_results) << term;
+    }
+  }
+
+  // Log the elapsed times for performance tracking.
+  perf_test::PrintResult("BookmarkSearchIndex", "", "10000 bookmarks, index",
+                         index_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+  perf_test::PrintResult("BookmarkSearchIndex", "",
+                         "10000 bookmarks, all bookmarks",
+                         linear_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+}
+
+}  // namespace
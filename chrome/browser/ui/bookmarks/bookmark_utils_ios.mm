@@ -6,14 +6,16 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #import <MaterialComponents/MaterialSnackbar.h>
 
 #include "base/check.h"
 #include "base/hash/hash.h"
-#include "base/i18n/string_compare.h"
 #include "base/metrics/user_metrics_action.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/strings/utf_string_conversions.h"
@@ -26,6 +28,8 @@
 #include "ios/chrome/browser/ui/util/ui_util.h"
 #import "ios/chrome/browser/ui/util/uikit_ui_util.h"
 #include "ios/chrome/grit/ios_strings.h"
+#include "third_party/icu/source/common/unicode/unistr.h"
+#include "third_party/icu/source/i18n/unicode/coll.h"
 #include "third_party/skia/include/core/SkColor.h"
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/l10n/l10n_util_mac.h"
@@ -438,110 +442,102 @@ void segregateNodes(
 
 #pragma mark - Useful bookmark manipulation.
 
-// Adds all children of `folder` that are not obstructed to `results`. They are
-// placed immediately after `folder`, using a depth-first, then alphabetically
-// ordering. `results` must contain `folder`.
-void UpdateFoldersFromNode(const BookmarkNode* folder,
-                           NodeVector* results,
-                           const NodeSet& obstructions);
-// Returns whether `folder` has an ancestor in any of the nodes in
-// `bookmarkNodes`.
-bool FolderHasAncestorInBookmarkNodes(const BookmarkNode* folder,
-                                      const NodeSet& bookmarkNodes);
-// Returns true if the node is not a folder, is not visible, or is an ancestor
-// of any of the nodes in `obstructions`.
-bool IsObstructed(const BookmarkNode* node, const NodeSet& obstructions);
-
 namespace {
-// Comparator used to sort bookmarks. No folders are allowed.
-class FolderNodeComparator {
- public:
-  explicit FolderNodeComparator(icu::Collator* collator)
-      : collator_(collator) {}
-
-  // Returns true if `n1` precedes `n2`.
-  bool operator()(const BookmarkNode* n1, const BookmarkNode* n2) {
-    if (!collator_)
-      return n1->GetTitle() < n2->GetTitle();
-    return base::i18n::CompareString16WithCollator(*collator_, n1->GetTitle(),
-                                                   n2->GetTitle()) == UCOL_LESS;
-  }
 
- private:
-  icu::Collator* collator_;
-};
-}  // namespace
+// Returns the collator used to sort folders by title, or null if it cannot be
+// created.
+std::unique_ptr<icu::Collator> CreateFolderCollator() {
+  UErrorCode error = U_ZERO_ERROR;
+  std::unique_ptr<icu::Collator> collator(icu::Collator::createInstance(error));
+  if (U_FAILURE(error))
+    return nullptr;
+  return collator;
+}
 
-bool FolderHasAncestorInBookmarkNodes(const BookmarkNode* folder,
-                                      const NodeSet& bookmarkNodes) {
-  DCHECK(folder->is_folder());
-  for (const BookmarkNode* node : bookmarkNodes) {
-    if (folder->HasAncestor(node))
-      return true;
+// Returns the sort key of `title`, so that titles are ordered by comparing
+// their sort keys byte by byte. Falls back on the code point order if
+// `collator` is null.
+std::string TitleSortKey(const icu::Collator* collator,
+                         const std::u16string& title) {
+  if (!collator)
+    return base::UTF16ToUTF8(title);
+
+  const icu::UnicodeString unicode_title(title.data(),
+                                         static_cast<int32_t>(title.size()));
+  // Sort keys are usually a bit longer than the title.
+  std::string sort_key(2 * title.size() + 16, '\0');
+  int32_t length = collator->getSortKey(
+      unicode_title, reinterpret_cast<uint8_t*>(&sort_key[0]),
+      static_cast<int32_t>(sort_key.size()));
+  if (length > static_cast<int32_t>(sort_key.size())) {
+    sort_key.resize(length);
+    length = collator->getSortKey(unicode_title,
+                                  reinterpret_cast<uint8_t*>(&sort_key[0]),
+                                  static_cast<int32_t>(sort_key.size()));
+  }
+  sort_key.resize(length);
+  return sort_key;
+}
+
+// Sorts `folders` by title. The sort key of each title is computed once, so
+// that the titles are not collated again at every comparison.
+void SortFoldersWithCollator(const icu::Collator* collator,
+                             NodeVector* folders) {
+  std::vector<std::pair<std::string, const BookmarkNode*>> sortable_folders;
+  sortable_folders.reserve(folders->size());
+  for (const BookmarkNode* folder : *folders) {
+    sortable_folders.emplace_back(TitleSortKey(collator, folder->GetTitle()),
+                                  folder);
   }
-  return false;
+  std::stable_sort(sortable_folders.begin(), sortable_folders.end(),
+                   [](const auto& lhs, const auto& rhs) {
+                     return lhs.first < rhs.first;
+                   });
+  for (size_t i = 0; i < sortable_folders.size(); ++i)
+    (*folders)[i] = sortable_folders[i].second;
 }
 
+// Returns true if `node` is not a folder, is not visible, or is one of the
+// nodes in `obstructions`. Descendants of `node` are not checked.
 bool IsObstructed(const BookmarkNode* node, const NodeSet& obstructions) {
-  if (!node->is_folder())
-    return true;
-  if (!node->IsVisible())
-    return true;
-  if (FolderHasAncestorInBookmarkNodes(node, obstructions))
-    return true;
-  return false;
+  return !node->is_folder() || !node->IsVisible() || obstructions.count(node);
 }
 
-void UpdateFoldersFromNode(const BookmarkNode* folder,
-                           NodeVector* results,
-                           const NodeSet& obstructions) {
-  std::vector<const BookmarkNode*> directDescendants;
-  for (const auto& subfolder : folder->children()) {
-    if (!IsObstructed(subfolder.get(), obstructions))
-      directDescendants.push_back(subfolder.get());
+// Appends `folder` to `results`, followed by its descendant folders that are
+// not obstructed, using a depth-first, then alphabetically ordering. The
+// descendants of obstructed folders are skipped without being visited.
+void AppendFolderTree(const BookmarkNode* folder,
+                      const NodeSet& obstructions,
+                      const icu::Collator* collator,
+                      NodeVector* results) {
+  results->push_back(folder);
+
+  NodeVector subfolders;
+  for (const auto& child : folder->children()) {
+    if (!IsObstructed(child.get(), obstructions))
+      subfolders.push_back(child.get());
   }
+  SortFoldersWithCollator(collator, &subfolders);
 
-  bookmark_utils_ios::SortFolders(&directDescendants);
-
-  auto it = std::find(results->begin(), results->end(), folder);
-  DCHECK(it != results->end());
-  ++it;
-  results->insert(it, directDescendants.begin(), directDescendants.end());
-
-  // Recursively perform the operation on each direct descendant.
-  for (auto* node : directDescendants)
-    UpdateFoldersFromNode(node, results, obstructions);
+  for (const BookmarkNode* subfolder : subfolders)
+    AppendFolderTree(subfolder, obstructions, collator, results);
 }
 
+}  // namespace
+
 void SortFolders(NodeVector* vector) {
-  UErrorCode error = U_ZERO_ERROR;
-  std::unique_ptr<icu::Collator> collator(icu::Collator::createInstance(error));
-  if (U_FAILURE(error))
-    collator.reset(NULL);
-  std::sort(vector->begin(), vector->end(),
-            FolderNodeComparator(collator.get()));
+  std::unique_ptr<icu::Collator> collator = CreateFolderCollator();
+  SortFoldersWithCollator(collator.get(), vector);
 }
 
 NodeVector VisibleNonDescendantNodes(const NodeSet& obstructions,
                                      bookmarks::BookmarkModel* model) {
+  std::unique_ptr<icu::Collator> collator = CreateFolderCollator();
   NodeVector results;
-
-  NodeVector primaryNodes = PrimaryPermanentNodes(model);
-  NodeVector filteredPrimaryNodes;
-  for (auto* node : primaryNodes) {
-    if (IsObstructed(node, obstructions))
-      continue;
-
-    filteredPrimaryNodes.push_back(node);
+  for (const BookmarkNode* node : PrimaryPermanentNodes(model)) {
+    if (!IsObstructed(node, obstructions))
+      AppendFolderTree(node, obstructions, collator.get(), &results);
   }
-
-  // Copy the results over.
-  results = filteredPrimaryNodes;
-
-  // Iterate over a static copy of the filtered, root folders.
-  for (auto* node : filteredPrimaryNodes)
-    UpdateFoldersFromNode(node, &results, obstructions);
-
   return results;
 }
 
@@ -237,6 +237,27 @@ TEST_F(BookmarkIOSUtilsUnitTest, TestVisibleNonDescendantNodes) {
   EXPECT_NSEQ(base::SysUTF16ToNSString(result[12]->GetTitle()), @"buildings");
 }
 
+// Tests that folders are sorted by collated title rather than code point, and
+// that the descendants of obstructed folders are skipped.
+TEST_F(BookmarkIOSUtilsUnitTest, TestVisibleNonDescendantNodesCollation) {
+  const BookmarkNode* mobileNode = bookmark_model_->mobile_node();
+  const BookmarkNode* zebra = AddFolder(mobileNode, @"zebra");
+  const BookmarkNode* echelle = AddFolder(mobileNode, @"Échelle");
+  const BookmarkNode* apple = AddFolder(mobileNode, @"apple");
+  const BookmarkNode* obstructed = AddFolder(echelle, @"obstructed");
+  AddFolder(obstructed, @"hidden");
+  const BookmarkNode* visible = AddFolder(echelle, @"visible");
+
+  bookmark_utils_ios::NodeVector result =
+      bookmark_utils_ios::VisibleNonDescendantNodes({obstructed},
+                                                    bookmark_model_);
+  ASSERT_LE(5u, result.size());
+  EXPECT_EQ(bookmark_utils_ios::NodeVector(
+                {mobileNode, apple, echelle, visible, zebra}),
+            bookmark_utils_ios::NodeVector(result.begin(),
+                                           result.begin() + 5));
+}
+
 TEST_F(BookmarkIOSUtilsUnitTest, TestIsSubvectorOfNodes) {
   // Empty vectors: [] - [].
   bookmark_utils_ios::NodeVector vector1;
@@ -96,7 +96,7 @@
       };
 
   if (self.cache) {
-    std::unique_ptr<favicon_base::LargeIconResult> cached_result =
+    const favicon_base::LargeIconResult* cached_result =
         self.cache->GetCachedResult(URL);
     if (cached_result) {
       faviconBlock(*cached_result);
@@ -0,0 +1,42 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_UI_TAB_SWITCHER_TAB_GRID_GRID_GRID_ITEMS_DIFFER_H_
+#define IOS_CHROME_BROWSER_UI_TAB_SWITCHER_TAB_GRID_GRID_GRID_ITEMS_DIFFER_H_
+
+#import <Foundation/Foundation.h>
+
+#import "ios/chrome/browser/ui/tab_switcher/tab_grid/grid/grid_consumer.h"
+
+// Maximum number of removals, insertions and moves sent to the consumer by
+// `-updateItems:selectedItemID:`. Above it, the items are populated again.
+extern const NSUInteger kGridItemsDifferMaxChangeCount;
+
+// GridConsumer keeping the items sent to another GridConsumer, keyed by
+// identifier. Besides forwarding single changes, it can update the consumer to
+// a whole new list of items by only sending the differences, so that the cells
+// of the unchanged items are not configured again.
+@interface GridItemsDiffer : NSObject <GridConsumer>
+
+- (instancetype)initWithConsumer:(id<GridConsumer>)consumer
+    NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+// The consumer to which the changes are sent.
+@property(nonatomic, weak, readonly) id<GridConsumer> consumer;
+
+// Updates the items of the consumer to `items` by removing, inserting and
+// moving items, then replacing the items whose content changed. Populates the
+// consumer with `items` instead if that takes more than
+// `kGridItemsDifferMaxChangeCount` changes.
+- (void)updateItems:(NSArray<TabSwitcherItem*>*)items
+     selectedItemID:(NSString*)selectedItemID;
+
+// Replaces the item with the identifier of `item` if the content of `item` is
+// different. Use `-replaceItemID:withItem:` to always replace it.
+- (void)updateItem:(TabSwitcherItem*)item;
+
+@end
+
+#endif  // IOS_CHROME_BROWSER_UI_TAB_SWITCHER_TAB_GRID_GRID_GRID_ITEMS_DIFFER_H_
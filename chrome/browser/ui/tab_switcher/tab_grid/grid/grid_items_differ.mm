@@ -0,0 +1,192 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/ui/tab_switcher/tab_grid/grid/grid_items_differ.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/check.h"
+#import "ios/chrome/browser/ui/tab_switcher/tab_switcher_item.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+const NSUInteger kGridItemsDifferMaxChangeCount = 16;
+
+namespace {
+
+// A change of the list of items sent to the consumer.
+struct ItemChange {
+  enum class Type {
+    kRemove,
+    kInsert,
+    kMove,
+  };
+  Type type;
+  NSString* identifier;
+  // Inserted item, for kInsert.
+  TabSwitcherItem* item;
+  // Index of the item after the change, for kInsert and kMove.
+  NSUInteger index;
+};
+
+// Returns the changes turning the items with `old_identifiers` into `items`:
+// removals first, then the insertions and moves putting each item at its
+// index, in increasing index order.
+std::vector<ItemChange> ComputeChanges(NSArray<NSString*>* old_identifiers,
+                                       NSArray<TabSwitcherItem*>* items) {
+  std::vector<ItemChange> changes;
+  NSMutableSet<NSString*>* identifiers =
+      [NSMutableSet setWithCapacity:items.count];
+  for (TabSwitcherItem* item in items)
+    [identifiers addObject:item.identifier];
+
+  NSMutableArray<NSString*>* current_identifiers =
+      [NSMutableArray arrayWithCapacity:items.count];
+  for (NSString* identifier in old_identifiers) {
+    if ([identifiers containsObject:identifier]) {
+      [current_identifiers addObject:identifier];
+    } else {
+      changes.push_back(
+          {ItemChange::Type::kRemove, identifier, nil, NSNotFound});
+    }
+  }
+
+  // The first `index` identifiers of `current_identifiers` are the ones of
+  // the first `index` items.
+  for (NSUInteger index = 0; index < items.count; ++index) {
+    TabSwitcherItem* item = items[index];
+    if (index < current_identifiers.count &&
+        [current_identifiers[index] isEqualToString:item.identifier]) {
+      continue;
+    }
+    NSUInteger from_index = [current_identifiers indexOfObject:item.identifier];
+    if (from_index == NSNotFound) {
+      changes.push_back(
+          {ItemChange::Type::kInsert, item.identifier, item, index});
+    } else {
+      [current_identifiers removeObjectAtIndex:from_index];
+      changes.push_back({ItemChange::Type::kMove, item.identifier, nil, index});
+    }
+    [current_identifiers insertObject:item.identifier atIndex:index];
+  }
+  return changes;
+}
+
+}  // namespace
+
+@implementation GridItemsDiffer {
+  // Identifiers of the items of the consumer, in order.
+  NSMutableArray<NSString*>* _identifiers;
+  // Items of the consumer by identifier.
+  NSMutableDictionary<NSString*, TabSwitcherItem*>* _itemsByIdentifier;
+}
+
+- (instancetype)initWithConsumer:(id<GridConsumer>)consumer {
+  if (self = [super init]) {
+    _consumer = consumer;
+    _identifiers = [[NSMutableArray alloc] init];
+    _itemsByIdentifier = [[NSMutableDictionary alloc] init];
+  }
+  return self;
+}
+
+#pragma mark - Public
+
+- (void)updateItems:(NSArray<TabSwitcherItem*>*)items
+     selectedItemID:(NSString*)selectedItemID {
+  const std::vector<ItemChange> changes = ComputeChanges(_identifiers, items);
+  if (changes.size() > kGridItemsDifferMaxChangeCount) {
+    [self populateItems:items selectedItemID:selectedItemID];
+    return;
+  }
+
+  for (const ItemChange& change : changes) {
+    switch (change.type) {
+      case ItemChange::Type::kRemove:
+        [self removeItemWithID:change.identifier selectedItemID:selectedItemID];
+        break;
+      case ItemChange::Type::kInsert:
+        [self insertItem:change.item
+                   atIndex:change.index
+            selectedItemID:selectedItemID];
+        break;
+      case ItemChange::Type::kMove:
+        [self moveItemWithID:change.identifier toIndex:change.index];
+        break;
+    }
+  }
+  for (TabSwitcherItem* item in items)
+    [self updateItem:item];
+  [self selectItemWithID:selectedItemID];
+}
+
+- (void)updateItem:(TabSwitcherItem*)item {
+  TabSwitcherItem* currentItem = _itemsByIdentifier[item.identifier];
+  if (!currentItem || [currentItem hasSameContentAsItem:item])
+    return;
+  [self replaceItemID:item.identifier withItem:item];
+}
+
+#pragma mark - GridConsumer
+
+- (void)populateItems:(NSArray<TabSwitcherItem*>*)items
+       selectedItemID:(NSString*)selectedItemID {
+  [_identifiers removeAllObjects];
+  [_itemsByIdentifier removeAllObjects];
+  for (TabSwitcherItem* item in items) {
+    [_identifiers addObject:item.identifier];
+    _itemsByIdentifier[item.identifier] = item;
+  }
+  [self.consumer populateItems:items selectedItemID:selectedItemID];
+}
+
+- (void)insertItem:(TabSwitcherItem*)item
+           atIndex:(NSUInteger)index
+    selectedItemID:(NSString*)selectedItemID {
+  DCHECK(!_itemsByIdentifier[item.identifier]);
+  [_identifiers insertObject:item.identifier
+                     atIndex:std::min(index, _identifiers.count)];
+  _itemsByIdentifier[item.identifier] = item;
+  [self.consumer insertItem:item atIndex:index selectedItemID:selectedItemID];
+}
+
+- (void)removeItemWithID:(NSString*)removedItemID
+          selectedItemID:(NSString*)selectedItemID {
+  [_identifiers removeObject:removedItemID];
+  [_itemsByIdentifier removeObjectForKey:removedItemID];
+  [self.consumer removeItemWithID:removedItemID selectedItemID:selectedItemID];
+}
+
+- (void)selectItemWithID:(NSString*)selectedItemID {
+  [self.consumer selectItemWithID:selectedItemID];
+}
+
+- (void)replaceItemID:(NSString*)itemID withItem:(TabSwitcherItem*)item {
+  NSUInteger index = [_identifiers indexOfObject:itemID];
+  if (index != NSNotFound) {
+    [_itemsByIdentifier removeObjectForKey:itemID];
+    _identifiers[index] = item.identifier;
+    _itemsByIdentifier[item.identifier] = item;
+  }
+  [self.consumer replaceItemID:itemID withItem:item];
+}
+
+- (void)moveItemWithID:(NSString*)itemID toIndex:(NSUInteger)toIndex {
+  NSUInteger fromIndex = [_identifiers indexOfObject:itemID];
+  if (fromIndex != NSNotFound) {
+    [_identifiers removeObjectAtIndex:fromIndex];
+    [_identifiers insertObject:itemID
+                       atIndex:std::min(toIndex, _identifiers.count)];
+  }
+  [self.consumer moveItemWithID:itemID toIndex:toIndex];
+}
+
+- (void)dismissModals {
+  [self.consumer dismissModals];
+}
+
+@end
@@ -0,0 +1,200 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/ui/tab_switcher/tab_grid/grid/grid_items_differ.h"
+
+#import "ios/chrome/browser/ui/tab_switcher/tab_switcher_item.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#import "testing/gtest_mac.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+// Consumer keeping its items like GridViewController, and counting the calls.
+@interface FakeGridItemsConsumer : NSObject <GridConsumer>
+@property(nonatomic, strong) NSMutableArray<TabSwitcherItem*>* items;
+@property(nonatomic, copy) NSString* selectedItemID;
+@property(nonatomic, assign) NSUInteger populateCount;
+// Number of insertions, removals and moves.
+@property(nonatomic, assign) NSUInteger changeCount;
+// Identifiers of the replaced items.
+@property(nonatomic, strong) NSMutableArray<NSString*>* replacedItemIDs;
+@end
+
+@implementation FakeGridItemsConsumer
+
+- (instancetype)init {
+  if (self = [super init]) {
+    _items = [[NSMutableArray alloc] init];
+    _replacedItemIDs = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (NSUInteger)indexOfItemWithID:(NSString*)identifier {
+  return [self.items
+      indexOfObjectPassingTest:^BOOL(TabSwitcherItem* item, NSUInteger index,
+                                     BOOL* stop) {
+        return [item.identifier isEqualToString:identifier];
+      }];
+}
+
+- (void)populateItems:(NSArray<TabSwitcherItem*>*)items
+       selectedItemID:(NSString*)selectedItemID {
+  self.items = [items mutableCopy];
+  self.selectedItemID = selectedItemID;
+  self.populateCount++;
+}
+
+- (void)insertItem:(TabSwitcherItem*)item
+           atIndex:(NSUInteger)index
+    selectedItemID:(NSString*)selectedItemID {
+  [self.items insertObject:item atIndex:index];
+  self.selectedItemID = selectedItemID;
+  self.changeCount++;
+}
+
+- (void)removeItemWithID:(NSString*)removedItemID
+          selectedItemID:(NSString*)selectedItemID {
+  [self.items removeObjectAtIndex:[self indexOfItemWithID:removedItemID]];
+  self.selectedItemID = selectedItemID;
+  self.changeCount++;
+}
+
+- (void)selectItemWithID:(NSString*)selectedItemID {
+  self.selectedItemID = selectedItemID;
+}
+
+- (void)replaceItemID:(NSString*)itemID withItem:(TabSwitcherItem*)item {
+  self.items[[self indexOfItemWithID:itemID]] = item;
+  [self.replacedItemIDs addObject:itemID];
+}
+
+- (void)moveItemWithID:(NSString*)itemID toIndex:(NSUInteger)toIndex {
+  NSUInteger fromIndex = [self indexOfItemWithID:itemID];
+  TabSwitcherItem* item = self.items[fromIndex];
+  [self.items removeObjectAtIndex:fromIndex];
+  [self.items insertObject:item atIndex:toIndex];
+  self.changeCount++;
+}
+
+- (void)dismissModals {
+}
+
+@end
+
+namespace {
+
+class GridItemsDifferTest : public PlatformTest {
+ protected:
+  GridItemsDifferTest() {
+    consumer_ = [[FakeGridItemsConsumer alloc] init];
+    differ_ = [[GridItemsDiffer alloc] initWithConsumer:consumer_];
+  }
+
+  // Returns an item with `identifier` and `title`.
+  TabSwitcherItem* Item(NSString* identifier, NSString* title) {
+    TabSwitcherItem* item =
+        [[TabSwitcherItem alloc] initWithIdentifier:identifier];
+    item.title = title;
+    return item;
+  }
+
+  // Returns items titled after their identifier.
+  NSArray<TabSwitcherItem*>* Items(NSArray<NSString*>* identifiers) {
+    NSMutableArray<TabSwitcherItem*>* items = [NSMutableArray array];
+    for (NSString* identifier in identifiers)
+      [items addObject:Item(identifier, identifier)];
+    return items;
+  }
+
+  // Returns the identifiers of the items of the consumer.
+  NSArray<NSString*>* ConsumerIdentifiers() {
+    NSMutableArray<NSString*>* identifiers = [NSMutableArray array];
+    for (TabSwitcherItem* item in consumer_.items)
+      [identifiers addObject:item.identifier];
+    return identifiers;
+  }
+
+  FakeGridItemsConsumer* consumer_;
+  GridItemsDiffer* differ_;
+};
+
+// Tests that only the differences between the items are sent to the consumer.
+TEST_F(GridItemsDifferTest, SendsDifferences) {
+  [differ_ populateItems:Items(@[ @"A", @"B", @"C", @"D", @"E" ])
+          selectedItemID:@"A"];
+  EXPECT_EQ(1u, consumer_.populateCount);
+
+  NSArray<TabSwitcherItem*>* items = Items(@[ @"E", @"B", @"F", @"D", @"A" ]);
+  [differ_ updateItems:items selectedItemID:@"F"];
+  EXPECT_NSEQ((@[ @"E", @"B", @"F", @"D", @"A" ]), ConsumerIdentifiers());
+  EXPECT_NSEQ(@"F", consumer_.selectedItemID);
+  EXPECT_EQ(1u, consumer_.populateCount);
+  // C is removed, E and B are moved, F is inserted and D is moved after F,
+  // which leaves A last.
+  EXPECT_EQ(5u, consumer_.changeCount);
+  EXPECT_EQ(0u, consumer_.replacedItemIDs.count);
+
+  // Updating to the same items sends nothing.
+  consumer_.changeCount = 0;
+  [differ_ updateItems:Items(@[ @"E", @"B", @"F", @"D", @"A" ])
+        selectedItemID:@"F"];
+  EXPECT_EQ(0u, consumer_.changeCount);
+  EXPECT_EQ(0u, consumer_.replacedItemIDs.count);
+}
+
+// Tests that only the items whose content changed are replaced.
+TEST_F(GridItemsDifferTest, ReplacesChangedItems) {
+  [differ_ populateItems:Items(@[ @"A", @"B", @"C" ]) selectedItemID:nil];
+
+  [differ_ updateItem:Item(@"B", @"B")];
+  EXPECT_EQ(0u, consumer_.replacedItemIDs.count);
+  TabSwitcherItem* loadingItem = Item(@"B", @"B");
+  loadingItem.showsActivity = YES;
+  [differ_ updateItem:loadingItem];
+  EXPECT_NSEQ(@[ @"B" ], consumer_.replacedItemIDs);
+  EXPECT_NSEQ(loadingItem, consumer_.items[1]);
+
+  // Unknown items are ignored.
+  [differ_ updateItem:Item(@"D", @"D")];
+  EXPECT_EQ(1u, consumer_.replacedItemIDs.count);
+
+  NSArray<TabSwitcherItem*>* items =
+      @[ Item(@"C", @"C"), Item(@"A", @"New title"), loadingItem ];
+  [differ_ updateItems:items selectedItemID:nil];
+  EXPECT_NSEQ((@[ @"C", @"A", @"B" ]), ConsumerIdentifiers());
+  EXPECT_NSEQ((@[ @"B", @"A" ]), consumer_.replacedItemIDs);
+  EXPECT_NSEQ(@"New title", consumer_.items[1].title);
+
+  // Replacing an item always reaches the consumer, for instance to reload its
+  // snapshot.
+  [differ_ replaceItemID:@"C" withItem:Item(@"C", @"C")];
+  EXPECT_NSEQ((@[ @"B", @"A", @"C" ]), consumer_.replacedItemIDs);
+}
+
+// Tests that the consumer is populated when there are too many changes.
+TEST_F(GridItemsDifferTest, PopulatesLargeChanges) {
+  NSMutableArray<NSString*>* identifiers = [NSMutableArray array];
+  for (NSUInteger i = 0; i <= kGridItemsDifferMaxChangeCount; ++i)
+    [identifiers addObject:[NSString stringWithFormat:@"%lu", i]];
+  [differ_ populateItems:@[] selectedItemID:nil];
+  [differ_ updateItems:Items(identifiers) selectedItemID:@"0"];
+  EXPECT_NSEQ(identifiers, ConsumerIdentifiers());
+  EXPECT_EQ(2u, consumer_.populateCount);
+  EXPECT_EQ(0u, consumer_.changeCount);
+  EXPECT_NSEQ(@"0", consumer_.selectedItemID);
+
+  // Later updates are computed from the populated items.
+  [differ_ removeItemWithID:@"3" selectedItemID:@"0"];
+  [identifiers removeObject:@"3"];
+  [differ_ updateItems:Items(identifiers) selectedItemID:@"0"];
+  EXPECT_NSEQ(identifiers, ConsumerIdentifiers());
+  EXPECT_EQ(2u, consumer_.populateCount);
+  EXPECT_EQ(1u, consumer_.changeCount);
+}
+
+}  // namespace
@@ -90,6 +90,7 @@ NSIndexPath* CreateIndexPath(NSInteger index) {
 @interface GridViewController () <GridCellDelegate,
                                   SuggestedActionsViewControllerDelegate,
                                   UICollectionViewDataSource,
+                                  UICollectionViewDataSourcePrefetching,
                                   UICollectionViewDelegate,
                                   UICollectionViewDelegateFlowLayout,
                                   UICollectionViewDragDelegate,
@@ -205,6 +206,7 @@ NSIndexPath* CreateIndexPath(NSInteger index) {
   // immediately on touch, but after a short delay.
   collectionView.delaysContentTouches = NO;
   collectionView.dataSource = self;
+  collectionView.prefetchDataSource = self;
   collectionView.delegate = self;
   collectionView.backgroundView = [[UIView alloc] init];
   collectionView.backgroundView.backgroundColor =
@@ -569,6 +571,27 @@ NSIndexPath* CreateIndexPath(NSInteger index) {
   return cell;
 }
 
+#pragma mark - UICollectionViewDataSourcePrefetching
+
+- (void)collectionView:(UICollectionView*)collectionView
+    prefetchItemsAtIndexPaths:(NSArray<NSIndexPath*>*)indexPaths {
+  // Only the snapshots are prefetched, favicons are returned synchronously.
+  // Fetching a snapshot loads it in the snapshot cache, so that it is ready
+  // when the cell is configured.
+  for (NSIndexPath* indexPath in indexPaths) {
+    if (indexPath.section == kSuggestedActionsSectionIndex ||
+        [self isIndexPathForPlusSignCell:indexPath]) {
+      continue;
+    }
+    NSUInteger itemIndex = base::checked_cast<NSUInteger>(indexPath.item);
+    if (itemIndex >= self.items.count)
+      continue;
+    [self.imageDataSource snapshotForIdentifier:self.items[itemIndex].identifier
+                                     completion:^(UIImage* snapshot){
+                                     }];
+  }
+}
+
 #pragma mark - UICollectionViewDelegate
 
 - (CGSize)collectionView:(UICollectionView*)collectionView
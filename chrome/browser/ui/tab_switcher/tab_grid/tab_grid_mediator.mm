@@ -16,6 +16,7 @@
 #include "base/scoped_multi_source_observation.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/sys_string_conversions.h"
+#include "base/time/time.h"
 #include "components/bookmarks/browser/bookmark_model.h"
 #import "components/bookmarks/common/bookmark_pref_names.h"
 #include "components/favicon/ios/web_favicon_driver.h"
@@ -50,6 +51,7 @@
 #import "ios/chrome/browser/ui/main/scene_state_browser_agent.h"
 #import "ios/chrome/browser/ui/menu/action_factory.h"
 #import "ios/chrome/browser/ui/tab_switcher/tab_grid/grid/grid_consumer.h"
+#import "ios/chrome/browser/ui/tab_switcher/tab_grid/grid/grid_items_differ.h"
 #import "ios/chrome/browser/ui/tab_switcher/tab_grid/grid/grid_item.h"
 #import "ios/chrome/browser/ui/tab_switcher/tab_switcher_item.h"
 #import "ios/chrome/browser/ui/util/url_with_title.h"
@@ -164,6 +166,20 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
   return nullptr;
 }
 
+// Records the time needed to load the thumbnails of the `tab_count` tabs of the
+// grid, split by number of tabs.
+void RecordThumbnailsLoadTime(int tab_count, base::TimeDelta load_time) {
+  const char* suffix = "Under100Tabs";
+  if (tab_count >= 500) {
+    suffix = "500TabsOrMore";
+  } else if (tab_count >= 100) {
+    suffix = "100To499Tabs";
+  }
+  base::UmaHistogramTimes(
+      base::StringPrintf("IOS.TabGrid.ThumbnailsLoadTime.%s", suffix),
+      load_time);
+}
+
 }  // namespace
 
 @interface TabGridMediator () <CRWWebStateObserver,
@@ -198,11 +214,17 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
   std::unique_ptr<
       base::ScopedMultiSourceObservation<web::WebState, web::WebStateObserver>>
       _scopedWebStateObservation;
+  // Sends the item changes to the consumer, keeping track of its items.
+  GridItemsDiffer* _itemsDiffer;
+  // Whether the consumer shows search results rather than the items of
+  // `webStateList`.
+  BOOL _showingSearchResults;
 }
 
 - (instancetype)initWithConsumer:(id<GridConsumer>)consumer {
   if (self = [super init]) {
     _consumer = consumer;
+    _itemsDiffer = [[GridItemsDiffer alloc] initWithConsumer:consumer];
     _webStateListObserverBridge =
         std::make_unique<WebStateListObserverBridge>(self);
     _scopedWebStateListObservation = std::make_unique<
@@ -259,9 +281,9 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
   DCHECK_EQ(_webStateList, webStateList);
   if (webStateList->IsBatchInProgress())
     return;
-  [self.consumer insertItem:CreateItem(webState)
-                    atIndex:index
-             selectedItemID:GetActiveTabId(webStateList)];
+  [_itemsDiffer insertItem:CreateItem(webState)
+                   atIndex:index
+            selectedItemID:GetActiveTabId(webStateList)];
   _scopedWebStateObservation->AddObservation(webState);
 }
 
@@ -272,8 +294,8 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
   DCHECK_EQ(_webStateList, webStateList);
   if (webStateList->IsBatchInProgress())
     return;
-  [self.consumer moveItemWithID:webState->GetStableIdentifier()
-                        toIndex:toIndex];
+  [_itemsDiffer moveItemWithID:webState->GetStableIdentifier()
+                       toIndex:toIndex];
 }
 
 - (void)webStateList:(WebStateList*)webStateList
@@ -283,8 +305,8 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
   DCHECK_EQ(_webStateList, webStateList);
   if (webStateList->IsBatchInProgress())
     return;
-  [self.consumer replaceItemID:oldWebState->GetStableIdentifier()
-                      withItem:CreateItem(newWebState)];
+  [_itemsDiffer replaceItemID:oldWebState->GetStableIdentifier()
+                     withItem:CreateItem(newWebState)];
   _scopedWebStateObservation->RemoveObservation(oldWebState);
   _scopedWebStateObservation->AddObservation(newWebState);
 }
@@ -297,8 +319,8 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
     return;
   if (!webStateList)
     return;
-  [self.consumer removeItemWithID:webState->GetStableIdentifier()
-                   selectedItemID:GetActiveTabId(webStateList)];
+  [_itemsDiffer removeItemWithID:webState->GetStableIdentifier()
+                  selectedItemID:GetActiveTabId(webStateList)];
   _scopedWebStateObservation->RemoveObservation(webState);
 }
 
@@ -313,11 +335,11 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
   // If the selected index changes as a result of the last webstate being
   // detached, atIndex will be kInvalidIndex.
   if (atIndex == WebStateList::kInvalidIndex) {
-    [self.consumer selectItemWithID:nil];
+    [_itemsDiffer selectItemWithID:nil];
     return;
   }
 
-  [self.consumer selectItemWithID:newWebState->GetStableIdentifier()];
+  [_itemsDiffer selectItemWithID:newWebState->GetStableIdentifier()];
 }
 
 - (void)webStateListWillBeginBatchOperation:(WebStateList*)webStateList {
@@ -331,8 +353,14 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
     web::WebState* webState = self.webStateList->GetWebStateAt(i);
     _scopedWebStateObservation->AddObservation(webState);
   }
-  [self.consumer populateItems:CreateItems(self.webStateList)
-                selectedItemID:GetActiveTabId(self.webStateList)];
+  if (_showingSearchResults) {
+    [self populateConsumerItems];
+    return;
+  }
+  // Only send the differences, so that the cells of the tabs which were not
+  // changed by the batch operation are not reconfigured.
+  [_itemsDiffer updateItems:CreateItems(self.webStateList)
+             selectedItemID:GetActiveTabId(self.webStateList)];
 }
 
 #pragma mark - CRWWebStateObserver
@@ -350,8 +378,8 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
 }
 
 - (void)updateConsumerItemForWebState:(web::WebState*)webState {
-  [self.consumer replaceItemID:webState->GetStableIdentifier()
-                      withItem:CreateItem(webState)];
+  // Loading and title notifications often don't change what the cell shows.
+  [_itemsDiffer updateItem:CreateItem(webState)];
 }
 
 #pragma mark - SnapshotCacheObserver
@@ -364,7 +392,7 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
     // It is possible to observe an updated snapshot for a WebState before
     // observing that the WebState has been added to the WebStateList. It is the
     // consumer's responsibility to ignore any updates before inserts.
-    [self.consumer replaceItemID:identifier withItem:CreateItem(webState)];
+    [_itemsDiffer replaceItemID:identifier withItem:CreateItem(webState)];
   }
 }
 
@@ -431,7 +459,7 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
     // In search mode the consumer doesn't have any information about the
     // selected item. So even if the active webstate is the same as the one that
     // is being selected, make sure that the consumer update its selected item.
-    [self.consumer selectItemWithID:itemID];
+    [_itemsDiffer selectItemWithID:itemID];
     return;
   }
 
@@ -468,7 +496,7 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
     // This item is not from the current browser therefore no UI updates will be
     // sent to the current grid. So notify the current grid consumer about the
     // change.
-    [self.consumer removeItemWithID:itemID selectedItemID:nil];
+    [_itemsDiffer removeItemWithID:itemID selectedItemID:nil];
     base::RecordAction(base::UserMetricsAction(
         "MobileTabGridSearchCloseTabFromAnotherWindow"));
   }
@@ -640,11 +668,13 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
         } else {
           allItems = currentBrowserItems;
         }
-        [self.consumer populateItems:allItems selectedItemID:nil];
+        self->_showingSearchResults = YES;
+        [self->_itemsDiffer populateItems:allItems selectedItemID:nil];
       }));
 }
 
 - (void)resetToAllItems {
+  _showingSearchResults = NO;
   [self populateConsumerItems];
 }
 
@@ -826,6 +856,7 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
 }
 
 - (void)preloadSnapshotsForVisibleGridSize:(int)gridSize {
+  [self preloadThumbnails];
   int startIndex = std::max(self.webStateList->active_index() - gridSize, 0);
   int endIndex = std::min(self.webStateList->active_index() + gridSize,
                           self.webStateList->count() - 1);
@@ -875,10 +906,45 @@ Browser* GetBrowserForTabWithId(BrowserList* browser_list,
 
 #pragma mark - Private
 
+// Loads the thumbnails of all the tabs in `appearanceCache`, so that the grid
+// can be displayed without loading every snapshot. The full snapshots of the
+// tabs around the active one are loaded by
+// `-preloadSnapshotsForVisibleGridSize:` and take precedence.
+- (void)preloadThumbnails {
+  SnapshotCache* snapshotCache = self.snapshotCache;
+  if (!snapshotCache)
+    return;
+
+  const int tabCount = self.webStateList->count();
+  NSMutableArray<NSString*>* identifiers =
+      [NSMutableArray arrayWithCapacity:tabCount];
+  for (int i = 0; i < tabCount; i++) {
+    [identifiers
+        addObject:self.webStateList->GetWebStateAt(i)->GetStableIdentifier()];
+  }
+
+  const base::TimeTicks startTime = base::TimeTicks::Now();
+  __weak TabGridMediator* weakSelf = self;
+  auto callback = ^(NSDictionary<NSString*, UIImage*>* thumbnails) {
+    RecordThumbnailsLoadTime(tabCount, base::TimeTicks::Now() - startTime);
+    [weakSelf cacheThumbnails:thumbnails];
+  };
+  [snapshotCache retrieveThumbnailsForSnapshotIDs:identifiers
+                                         callback:callback];
+}
+
+// Adds `thumbnails` to `appearanceCache` for the tabs without snapshot.
+- (void)cacheThumbnails:(NSDictionary<NSString*, UIImage*>*)thumbnails {
+  for (NSString* identifier in thumbnails) {
+    if (!self.appearanceCache[identifier])
+      self.appearanceCache[identifier] = thumbnails[identifier];
+  }
+}
+
 // Calls `-populateItems:selectedItemID:` on the consumer.
 - (void)populateConsumerItems {
-  [self.consumer populateItems:CreateItems(self.webStateList)
-                selectedItemID:GetActiveTabId(self.webStateList)];
+  [_itemsDiffer populateItems:CreateItems(self.webStateList)
+               selectedItemID:GetActiveTabId(self.webStateList)];
 }
 
 // Removes `self.syncedClosedTabsCount` most recent entries from the
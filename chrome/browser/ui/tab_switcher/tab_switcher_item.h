@@ -20,6 +20,11 @@
 @property(nonatomic, copy) NSString* title;
 @property(nonatomic, assign) BOOL hidesTitle;
 @property(nonatomic, assign) BOOL showsActivity;
+
+// Returns whether `item` has the same identifier as the receiver and displays
+// the same content.
+- (BOOL)hasSameContentAsItem:(TabSwitcherItem*)item;
+
 @end
 
 #endif  // IOS_CHROME_BROWSER_UI_TAB_SWITCHER_TAB_SWITCHER_ITEM_H_
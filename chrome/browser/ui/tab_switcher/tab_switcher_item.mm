@@ -20,4 +20,12 @@
   return self;
 }
 
+- (BOOL)hasSameContentAsItem:(TabSwitcherItem*)item {
+  return [self.identifier isEqualToString:item.identifier] &&
+         (self.title == item.title ||
+          [self.title isEqualToString:item.title]) &&
+         self.hidesTitle == item.hidesTitle &&
+         self.showsActivity == item.showsActivity;
+}
+
 @end
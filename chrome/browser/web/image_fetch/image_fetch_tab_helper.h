@@ -5,6 +5,7 @@
 #ifndef IOS_CHROME_BROWSER_WEB_IMAGE_FETCH_IMAGE_FETCH_TAB_HELPER_H_
 #define IOS_CHROME_BROWSER_WEB_IMAGE_FETCH_IMAGE_FETCH_TAB_HELPER_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -28,10 +29,10 @@ enum class ContextMenuGetImageDataByJsResult {
   kMaxValue = kTimeout,
 };
 
-// Gets the image data by JavaScript or
-// image_fetcher::FetchImageData. Always use this class by
-// ImageFetchTabHelper::FromWebState on UI thread. All callbacks will also be
-// invoked on UI thread.
+// Gets the image data through the network stack of the browser state, or by
+// JavaScript if the download does not return the image. Always use this class
+// by ImageFetchTabHelper::FromWebState on UI thread. All callbacks will also
+// be invoked on UI thread.
 class ImageFetchTabHelper : public ImageFetchJavaScriptFeature::Handler,
                             public web::WebStateObserver,
                             public web::WebStateUserData<ImageFetchTabHelper> {
@@ -46,9 +47,13 @@ class ImageFetchTabHelper : public ImageFetchJavaScriptFeature::Handler,
   typedef void (^ImageDataCallback)(NSData* data);
 
   // Gets image data in binary format by following steps:
-  //   1. Call injected JavaScript to get the image data from web page;
-  //   2. If JavaScript fails or does not send a message back in 300ms, try
-  //   downloading the image by image_fetcher::FetchImageData.
+  //   1. Download the image with |referrer| through the network stack of the
+  //   browser state, which does not share the HTTP cache of the web view. The
+  //   downloaded bytes are wrapped in NSData without being copied;
+  //   2. If the download fails or its response is not a 200, or if |url| is
+  //   not an HTTP(S) URL, call injected JavaScript to get the image data from
+  //   web page. |callback| is invoked with nil if JavaScript fails or does not
+  //   send a message back in 300ms.
   void GetImageData(const GURL& url,
                     const web::Referrer& referrer,
                     ImageDataCallback callback);
@@ -71,7 +76,8 @@ class ImageFetchTabHelper : public ImageFetchJavaScriptFeature::Handler,
 
   // Callback for GetImageDataByJs. |data| will be in binary format, or nullptr
   // if GetImageDataByJs failed.
-  typedef base::OnceCallback<void(const std::string* data)> JsCallback;
+  typedef base::OnceCallback<void(std::unique_ptr<std::string> data)>
+      JsCallback;
 
   // Gets image data in binary format via ImageFetchJavaScriptFeature.
   // |url| should be equal to the resolved "src" attribute of <img>, otherwise
@@ -87,11 +93,16 @@ class ImageFetchTabHelper : public ImageFetchJavaScriptFeature::Handler,
   // Handler for timeout on GetImageDataByJs.
   void OnJsTimeout(int call_id);
 
+  // Handler for the native download started by GetImageData. Falls back to
+  // GetImageDataByJs if the download failed and |tab_helper| is still alive.
+  static void OnImageDataFetched(base::WeakPtr<ImageFetchTabHelper> tab_helper,
+                                 const GURL& url,
+                                 ImageDataCallback callback,
+                                 std::unique_ptr<std::string> data);
+
   // Handler for calling GetImageDataByJs inside GetImageData.
-  void JsCallbackOfGetImageData(const GURL& url,
-                                const web::Referrer& referrer,
-                                ImageDataCallback callback,
-                                const std::string* data);
+  static void JsCallbackOfGetImageData(ImageDataCallback callback,
+                                       std::unique_ptr<std::string> data);
 
   // WebState this tab helper is attached to.
   web::WebState* web_state_ = nullptr;
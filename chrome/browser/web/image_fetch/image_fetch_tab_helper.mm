@@ -4,21 +4,23 @@
 
 #import "ios/chrome/browser/web/image_fetch/image_fetch_tab_helper.h"
 
-#include "base/base64.h"
+#include <map>
+
 #include "base/bind.h"
-#include "base/json/string_escape.h"
 #include "base/metrics/histogram_macros.h"
-#include "base/strings/stringprintf.h"
-#include "base/strings/utf_string_conversions.h"
-#include "base/values.h"
-#include "components/image_fetcher/core/image_data_fetcher.h"
 #include "ios/chrome/browser/web/image_fetch/image_fetch_java_script_feature.h"
 #include "ios/web/common/referrer_util.h"
 #include "ios/web/public/browser_state.h"
 #import "ios/web/public/navigation/navigation_context.h"
 #include "ios/web/public/thread/web_task_traits.h"
 #include "ios/web/public/thread/web_thread.h"
+#include "net/base/load_flags.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_status_code.h"
+#include "services/network/public/cpp/resource_request.h"
 #include "services/network/public/cpp/shared_url_loader_factory.h"
+#include "services/network/public/cpp/simple_url_loader.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
 #error "This file requires ARC support."
@@ -32,22 +34,70 @@ namespace {
 const char kImageFetcherKeyName[] = "0";
 // Timeout for GetImageDataByJs in milliseconds.
 const int kGetImageDataByJsTimeout = 300;
+// Maximum size of an image downloaded by ImageFetcher.
+const size_t kMaxImageDataSize = 50 * 1024 * 1024;
+
+// Returns an NSData owning |data| without copying its bytes, or nil if |data|
+// is null or empty.
+NSData* NSDataFromString(std::unique_ptr<std::string> data) {
+  if (!data || data->empty())
+    return nil;
+  std::string* bytes = data.release();
+  return [[NSData alloc] initWithBytesNoCopy:bytes->data()
+                                      length:bytes->size()
+                                 deallocator:^(void*, NSUInteger) {
+                                   delete bytes;
+                                 }];
+}
 
-// Wrapper class for image_fetcher::IOSImageDataFetcherWrapper. ImageFetcher is
+// Downloads images through the network stack of the browser state. Its HTTP
+// cache is not the one of WKWebView, so the images displayed by the page are
+// usually downloaded again; LOAD_SKIP_CACHE_VALIDATION only avoids revalidating
+// the images already in the cache of the browser state. ImageFetcher is
 // attached to web::BrowserState instead of web::WebState, because if a user
 // closes the tab immediately after Copy/Save image, the web::WebState will be
 // destroyed thus fail the download.
-class ImageFetcher : public image_fetcher::ImageDataFetcher,
-                     public base::SupportsUserData::Data {
+class ImageFetcher : public base::SupportsUserData::Data {
  public:
+  // Callback for FetchImageData. |data| is null if the download failed or if
+  // the response is not a 200.
+  using FetchCallback =
+      base::OnceCallback<void(std::unique_ptr<std::string> data)>;
+
   ImageFetcher(const ImageFetcher&) = delete;
   ImageFetcher& operator=(const ImageFetcher&) = delete;
 
   ~ImageFetcher() override = default;
 
-  ImageFetcher(
+  explicit ImageFetcher(
       scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory)
-      : image_fetcher::ImageDataFetcher(url_loader_factory) {}
+      : url_loader_factory_(std::move(url_loader_factory)) {}
+
+  // Downloads |url| with |referrer|. The bytes are handed over to |callback|
+  // without any intermediate copy.
+  void FetchImageData(const GURL& url,
+                      const web::Referrer& referrer,
+                      FetchCallback callback) {
+    auto resource_request = std::make_unique<network::ResourceRequest>();
+    resource_request->url = url;
+    resource_request->referrer =
+        GURL(web::ReferrerHeaderValueForNavigation(url, referrer));
+    resource_request->referrer_policy =
+        web::PolicyForNavigation(url, referrer);
+    resource_request->load_flags = net::LOAD_SKIP_CACHE_VALIDATION;
+
+    std::unique_ptr<network::SimpleURLLoader> url_loader =
+        network::SimpleURLLoader::Create(std::move(resource_request),
+                                         NO_TRAFFIC_ANNOTATION_YET);
+    network::SimpleURLLoader* url_loader_ptr = url_loader.get();
+    url_loaders_[url_loader_ptr] = std::move(url_loader);
+    url_loader_ptr->DownloadToString(
+        url_loader_factory_.get(),
+        base::BindOnce(&ImageFetcher::OnURLLoadComplete,
+                       base::Unretained(this), url_loader_ptr,
+                       std::move(callback)),
+        kMaxImageDataSize);
+  }
 
   static ImageFetcher* FromBrowserState(web::BrowserState* browser_state) {
     if (!browser_state->GetUserData(&kImageFetcherKeyName)) {
@@ -59,6 +109,27 @@ class ImageFetcher : public image_fetcher::ImageDataFetcher,
     return static_cast<ImageFetcher*>(
         browser_state->GetUserData(&kImageFetcherKeyName));
   }
+
+ private:
+  void OnURLLoadComplete(network::SimpleURLLoader* url_loader,
+                         FetchCallback callback,
+                         std::unique_ptr<std::string> data) {
+    // Other successful responses, e.g. a 206 with part of the image, do not
+    // hold the image displayed by the page.
+    const network::mojom::URLResponseHead* response_info =
+        url_loader->ResponseInfo();
+    if (!response_info || !response_info->headers ||
+        response_info->headers->response_code() != net::HTTP_OK) {
+      data.reset();
+    }
+    url_loaders_.erase(url_loader);
+    std::move(callback).Run(std::move(data));
+  }
+
+  scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory_;
+  // In-flight downloads.
+  std::map<network::SimpleURLLoader*, std::unique_ptr<network::SimpleURLLoader>>
+      url_loaders_;
 };
 }
 
@@ -90,35 +161,46 @@ void ImageFetchTabHelper::WebStateDestroyed(web::WebState* web_state) {
 void ImageFetchTabHelper::GetImageData(const GURL& url,
                                        const web::Referrer& referrer,
                                        ImageDataCallback callback) {
-  // |this| is captured into the callback of GetImageDataByJs, which will always
-  // be invoked before the |this| is destroyed, so it's safe.
-  GetImageDataByJs(
-      url, base::Milliseconds(kGetImageDataByJsTimeout),
-      base::BindOnce(&ImageFetchTabHelper::JsCallbackOfGetImageData,
-                     base::Unretained(this), url, referrer, callback));
+  if (!url.SchemeIsHTTPOrHTTPS()) {
+    // Images that are not served over the network (e.g. data: or blob: URLs)
+    // can only be retrieved from the page.
+    GetImageDataByJs(
+        url, base::Milliseconds(kGetImageDataByJsTimeout),
+        base::BindOnce(&ImageFetchTabHelper::JsCallbackOfGetImageData,
+                       callback));
+    return;
+  }
+  ImageFetcher::FromBrowserState(web_state_->GetBrowserState())
+      ->FetchImageData(
+          url, referrer,
+          base::BindOnce(&ImageFetchTabHelper::OnImageDataFetched,
+                         weak_ptr_factory_.GetWeakPtr(), url, callback));
 }
 
-void ImageFetchTabHelper::JsCallbackOfGetImageData(
+// static
+void ImageFetchTabHelper::OnImageDataFetched(
+    base::WeakPtr<ImageFetchTabHelper> tab_helper,
     const GURL& url,
-    const web::Referrer& referrer,
     ImageDataCallback callback,
-    const std::string* data) {
-  if (data) {
-    callback([NSData dataWithBytes:data->c_str() length:data->size()]);
+    std::unique_ptr<std::string> data) {
+  if (data && !data->empty()) {
+    callback(NSDataFromString(std::move(data)));
     return;
   }
-  ImageFetcher::FromBrowserState(web_state_->GetBrowserState())
-      ->FetchImageData(
-          url,
-          base::BindOnce(^(const std::string& image_data,
-                           const image_fetcher::RequestMetadata& metadata) {
-            NSData* data = [NSData dataWithBytes:image_data.data()
-                                          length:image_data.size()];
-            callback(data);
-          }),
-          web::ReferrerHeaderValueForNavigation(url, referrer),
-          web::PolicyForNavigation(url, referrer), NO_TRAFFIC_ANNOTATION_YET,
-          /*send_cookies=*/true);
+  if (!tab_helper || !tab_helper->web_state_) {
+    callback(nil);
+    return;
+  }
+  tab_helper->GetImageDataByJs(
+      url, base::Milliseconds(kGetImageDataByJsTimeout),
+      base::BindOnce(&ImageFetchTabHelper::JsCallbackOfGetImageData, callback));
+}
+
+// static
+void ImageFetchTabHelper::JsCallbackOfGetImageData(
+    ImageDataCallback callback,
+    std::unique_ptr<std::string> data) {
+  callback(NSDataFromString(std::move(data)));
 }
 
 void ImageFetchTabHelper::GetImageDataByJs(const GURL& url,
@@ -153,7 +235,8 @@ void ImageFetchTabHelper::HandleJsSuccess(int call_id,
   js_callbacks_.erase(call_id);
 
   DCHECK(!decoded_data.empty());
-  std::move(callback).Run(&decoded_data);
+  std::move(callback).Run(
+      std::make_unique<std::string>(std::move(decoded_data)));
 
   if (from == "canvas") {
     RecordGetImageDataByJsResult(
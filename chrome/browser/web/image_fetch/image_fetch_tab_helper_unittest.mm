@@ -38,6 +38,12 @@ namespace {
 const NSTimeInterval kWaitForGetImageDataTimeout = 1.0;
 
 const char kImageUrl[] = "http://www.chrooooooooooome.com/";
+// URL of an image that cannot be downloaded by the network stack.
+const char kUncachedImageUrl[] = "http://www.chrooooooooooome.com/uncached";
+// URL of an image for which the network stack only returns a part.
+const char kPartialImageUrl[] = "http://www.chrooooooooooome.com/partial";
+// URL of an image that can only be retrieved from the page.
+const char kDataImageUrl[] = "data:image/png;base64,YWJj";
 const char kImageData[] = "abc";
 }
 
@@ -88,6 +94,10 @@ class ImageFetchTabHelperTest : public PlatformTest {
     status.decoded_body_length = strlen(kImageData);
     test_url_loader_factory_.AddResponse(GURL(kImageUrl), std::move(head),
                                          kImageData, status);
+    test_url_loader_factory_.AddResponse(kUncachedImageUrl, std::string(),
+                                         net::HTTP_NOT_FOUND);
+    test_url_loader_factory_.AddResponse(kPartialImageUrl, "ab",
+                                         net::HTTP_PARTIAL_CONTENT);
   }
 
   id ExecuteJavaScriptForFeature(NSString* script,
@@ -124,7 +134,33 @@ class ImageFetchTabHelperTest : public PlatformTest {
   base::HistogramTester histogram_tester_;
 };
 
-// Tests that ImageFetchTabHelper::GetImageData can get image data from Js.
+// Tests that ImageFetchTabHelper::GetImageData gets image data from the network
+// stack without calling Js.
+TEST_F(ImageFetchTabHelperTest, GetImageDataFromNetwork) {
+  // Inject fake |__gCrWeb.imageFetch.getImageData| that does not do anything.
+  id script_result = ExecuteJavaScriptForFeature(
+      @"__gCrWeb.imageFetch = {}; __gCrWeb.imageFetch.getImageData = "
+      @"function(id, url) {}; true;",
+      ImageFetchJavaScriptFeature::GetInstance());
+  ASSERT_NSEQ(@YES, script_result);
+
+  __block bool callback_invoked = false;
+  image_fetch_tab_helper()->GetImageData(GURL(kImageUrl), web::Referrer(),
+                                         ^(NSData* data) {
+                                           ASSERT_TRUE(data);
+                                           EXPECT_NSEQ(GetExpectedData(), data);
+                                           callback_invoked = true;
+                                         });
+
+  EXPECT_TRUE(WaitUntilConditionOrTimeout(kWaitForGetImageDataTimeout, ^{
+    base::RunLoop().RunUntilIdle();
+    return callback_invoked;
+  }));
+  histogram_tester_.ExpectTotalCount(kUmaGetImageDataByJsResult, 0);
+}
+
+// Tests that ImageFetchTabHelper::GetImageData can get image data from Js when
+// the image cannot be downloaded.
 TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsSucceedFromCanvas) {
   // Inject fake |__gCrWeb.imageFetch.getImageData| that returns |kImageData|
   // in base64 format.
@@ -140,8 +176,41 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsSucceedFromCanvas) {
   ASSERT_NSEQ(@YES, script_result);
 
   __block bool callback_invoked = false;
-  image_fetch_tab_helper()->GetImageData(GURL(kImageUrl), web::Referrer(),
-                                         ^(NSData* data) {
+  image_fetch_tab_helper()->GetImageData(GURL(kUncachedImageUrl),
+                                         web::Referrer(), ^(NSData* data) {
+                                           ASSERT_TRUE(data);
+                                           EXPECT_NSEQ(GetExpectedData(), data);
+                                           callback_invoked = true;
+                                         });
+
+  EXPECT_TRUE(WaitUntilConditionOrTimeout(kWaitForGetImageDataTimeout, ^{
+    base::RunLoop().RunUntilIdle();
+    return callback_invoked;
+  }));
+  histogram_tester_.ExpectUniqueSample(
+      kUmaGetImageDataByJsResult,
+      ContextMenuGetImageDataByJsResult::kCanvasSucceed, 1);
+}
+
+// Tests that ImageFetchTabHelper::GetImageData gets image data from Js when the
+// download succeeds with a response other than 200.
+TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsAfterPartialResponse) {
+  // Inject fake |__gCrWeb.imageFetch.getImageData| that returns |kImageData|
+  // in base64 format.
+  id script_result = ExecuteJavaScriptForFeature(
+      [NSString
+          stringWithFormat:
+              @"__gCrWeb.imageFetch = {}; __gCrWeb.imageFetch.getImageData = "
+               "function(id, url) { "
+               "__gCrWeb.common.sendWebKitMessage('ImageFetchMessageHandler', "
+               "{'id': id, 'data': btoa('%s'), 'from':'canvas'}); }; true;",
+              kImageData],
+      ImageFetchJavaScriptFeature::GetInstance());
+  ASSERT_NSEQ(@YES, script_result);
+
+  __block bool callback_invoked = false;
+  image_fetch_tab_helper()->GetImageData(GURL(kPartialImageUrl),
+                                         web::Referrer(), ^(NSData* data) {
                                            ASSERT_TRUE(data);
                                            EXPECT_NSEQ(GetExpectedData(), data);
                                            callback_invoked = true;
@@ -156,7 +225,8 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsSucceedFromCanvas) {
       ContextMenuGetImageDataByJsResult::kCanvasSucceed, 1);
 }
 
-// Tests that ImageFetchTabHelper::GetImageData can get image data from Js.
+// Tests that ImageFetchTabHelper::GetImageData can get image data from Js when
+// the image cannot be downloaded.
 TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsSucceedFromXmlHttpRequest) {
   // Inject fake |__gCrWeb.imageFetch.getImageData| that returns |kImageData|
   // in base64 format.
@@ -172,8 +242,8 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsSucceedFromXmlHttpRequest) {
   ASSERT_NSEQ(@YES, script_result);
 
   __block bool callback_invoked = false;
-  image_fetch_tab_helper()->GetImageData(GURL(kImageUrl), web::Referrer(),
-                                         ^(NSData* data) {
+  image_fetch_tab_helper()->GetImageData(GURL(kUncachedImageUrl),
+                                         web::Referrer(), ^(NSData* data) {
                                            ASSERT_TRUE(data);
                                            EXPECT_NSEQ(GetExpectedData(), data);
                                            callback_invoked = true;
@@ -188,8 +258,8 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsSucceedFromXmlHttpRequest) {
       ContextMenuGetImageDataByJsResult::kXMLHttpRequestSucceed, 1);
 }
 
-// Tests that ImageFetchTabHelper::GetImageData gets image data from server when
-// Js fails.
+// Tests that ImageFetchTabHelper::GetImageData fails when the image cannot be
+// downloaded and Js fails.
 TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsFail) {
   id script_result = ExecuteJavaScriptForFeature(
       @"__gCrWeb.imageFetch = {}; __gCrWeb.imageFetch.getImageData = "
@@ -200,10 +270,9 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsFail) {
   ASSERT_NSEQ(@YES, script_result);
 
   __block bool callback_invoked = false;
-  image_fetch_tab_helper()->GetImageData(GURL(kImageUrl), web::Referrer(),
-                                         ^(NSData* data) {
-                                           ASSERT_TRUE(data);
-                                           EXPECT_NSEQ(GetExpectedData(), data);
+  image_fetch_tab_helper()->GetImageData(GURL(kUncachedImageUrl),
+                                         web::Referrer(), ^(NSData* data) {
+                                           EXPECT_FALSE(data);
                                            callback_invoked = true;
                                          });
 
@@ -215,8 +284,8 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsFail) {
       kUmaGetImageDataByJsResult, ContextMenuGetImageDataByJsResult::kFail, 1);
 }
 
-// Tests that ImageFetchTabHelper::GetImageData gets image data from server when
-// Js does not send a message back.
+// Tests that ImageFetchTabHelper::GetImageData fails when the image cannot be
+// downloaded and Js does not send a message back.
 TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsTimeout) {
   // Inject fake |__gCrWeb.imageFetch.getImageData| that does not do anything.
   id script_result = ExecuteJavaScriptForFeature(
@@ -226,10 +295,9 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsTimeout) {
   ASSERT_NSEQ(@YES, script_result);
 
   __block bool callback_invoked = false;
-  image_fetch_tab_helper()->GetImageData(GURL(kImageUrl), web::Referrer(),
-                                         ^(NSData* data) {
-                                           ASSERT_TRUE(data);
-                                           EXPECT_NSEQ(GetExpectedData(), data);
+  image_fetch_tab_helper()->GetImageData(GURL(kUncachedImageUrl),
+                                         web::Referrer(), ^(NSData* data) {
+                                           EXPECT_FALSE(data);
                                            callback_invoked = true;
                                          });
 
@@ -242,8 +310,8 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithJsTimeout) {
       1);
 }
 
-// Tests that ImageFetchTabHelper::GetImageData gets image data from server when
-// WebState is destroyed.
+// Tests that ImageFetchTabHelper::GetImageData fails when the image is only
+// available from the page and WebState is destroyed.
 TEST_F(ImageFetchTabHelperTest, GetImageDataWithWebStateDestroy) {
   // Inject fake |__gCrWeb.imageFetch.getImageData| that does not do anything.
   id script_result = ExecuteJavaScriptForFeature(
@@ -253,10 +321,9 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithWebStateDestroy) {
   ASSERT_NSEQ(@YES, script_result);
 
   __block bool callback_invoked = false;
-  image_fetch_tab_helper()->GetImageData(GURL(kImageUrl), web::Referrer(),
+  image_fetch_tab_helper()->GetImageData(GURL(kDataImageUrl), web::Referrer(),
                                          ^(NSData* data) {
-                                           ASSERT_TRUE(data);
-                                           EXPECT_NSEQ(GetExpectedData(), data);
+                                           EXPECT_FALSE(data);
                                            callback_invoked = true;
                                          });
 
@@ -269,8 +336,8 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithWebStateDestroy) {
   histogram_tester_.ExpectTotalCount(kUmaGetImageDataByJsResult, 0);
 }
 
-// Tests that ImageFetchTabHelper::GetImageData gets image data from server when
-// WebState navigates to a new web page.
+// Tests that ImageFetchTabHelper::GetImageData fails when the image is only
+// available from the page and WebState navigates to a new web page.
 TEST_F(ImageFetchTabHelperTest, GetImageDataWithWebStateNavigate) {
   // Inject fake |__gCrWeb.imageFetch.getImageData| that does not do anything.
   id script_result = ExecuteJavaScriptForFeature(
@@ -280,10 +347,9 @@ TEST_F(ImageFetchTabHelperTest, GetImageDataWithWebStateNavigate) {
   ASSERT_NSEQ(@YES, script_result);
 
   __block bool callback_invoked = false;
-  image_fetch_tab_helper()->GetImageData(GURL(kImageUrl), web::Referrer(),
+  image_fetch_tab_helper()->GetImageData(GURL(kDataImageUrl), web::Referrer(),
                                          ^(NSData* data) {
-                                           ASSERT_TRUE(data);
-                                           EXPECT_NSEQ(GetExpectedData(), data);
+                                           EXPECT_FALSE(data);
                                            callback_invoked = true;
                                          });
 
@@ -25,6 +25,10 @@
 class PrefProxyConfigTracker;
 class PrefService;
 
+namespace base {
+class RepeatingTimer;
+}  // namespace base
+
 namespace net {
 class HttpAuthHandlerFactory;
 class HttpAuthPreferences;
@@ -171,6 +175,9 @@ class IOSIOThread : public web::WebThreadDelegate {
   // Observer that logs network changes to the NetLog.
   std::unique_ptr<net::LoggingNetworkChangeObserver> network_change_observer_;
 
+  // Periodically records the live instances of the leak tracked classes.
+  std::unique_ptr<base::RepeatingTimer> leak_report_timer_;
+
   // These member variables are initialized by a task posted to the IO thread,
   // which gets posted by calling certain member functions of IOSIOThread.
   std::unique_ptr<net::ProxyConfigService> system_proxy_config_service_;
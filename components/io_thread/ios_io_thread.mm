@@ -22,6 +22,7 @@
 #include "base/task/single_thread_task_runner.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "base/trace_event/trace_event.h"
 #include "components/network_session_configurator/browser/network_session_configurator.h"
 #include "components/prefs/pref_service.h"
@@ -78,6 +79,16 @@ namespace {
 
 const char kSupportedAuthSchemes[] = "basic,digest,ntlm";
 
+// Interval at which the live instances of the leak tracked classes are
+// recorded.
+constexpr base::TimeDelta kLeakReportInterval = base::Minutes(30);
+
+// Histograms of the live SystemURLRequestContextGetters.
+const char kLiveSystemURLRequestContextGettersHistogram[] =
+    "IOS.LeakTracker.SystemURLRequestContextGetter.LiveInstances";
+const char kLiveSystemURLRequestContextGettersAtShutdownHistogram[] =
+    "IOS.LeakTracker.SystemURLRequestContextGetter.LiveInstancesAtShutdown";
+
 }  // namespace
 
 std::unique_ptr<net::HostResolver> CreateGlobalHostResolver(
@@ -246,9 +257,18 @@ void IOSIOThread::Init() {
       &quic_params_);
 
   globals_->system_request_context = ConstructSystemRequestContext();
+
+  leak_report_timer_ = std::make_unique<base::RepeatingTimer>();
+  leak_report_timer_->Start(
+      FROM_HERE, kLeakReportInterval, base::BindRepeating([] {
+        LeakTracker<SystemURLRequestContextGetter>::RecordLiveInstances(
+            kLiveSystemURLRequestContextGettersHistogram);
+      }));
 }
 
 void IOSIOThread::CleanUp() {
+  leak_report_timer_.reset();
+
   system_url_request_context_getter_->Shutdown();
   system_url_request_context_getter_ = nullptr;
 
@@ -263,6 +283,8 @@ void IOSIOThread::CleanUp() {
   delete globals_;
   globals_ = nullptr;
 
+  LeakTracker<SystemURLRequestContextGetter>::RecordLiveInstances(
+      kLiveSystemURLRequestContextGettersAtShutdownHistogram);
   LeakTracker<SystemURLRequestContextGetter>::CheckForLeaks();
 }
 
@@ -6,19 +6,27 @@
 #define IOS_COMPONENTS_IO_THREAD_LEAK_TRACKER_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
+#include "base/containers/linked_list.h"
+#include "base/debug/stack_trace.h"
+#include "base/logging.h"
+#include "base/metrics/histogram_functions.h"
 #include "build/build_config.h"
 
-// Only enable leak tracking in non-uClibc debug builds.
+// Only enable full leak tracking in non-uClibc debug builds.
 #if !defined(NDEBUG) && !defined(__UCLIBC__)
 #define ENABLE_LEAK_TRACKER
 #endif
 
 #ifdef ENABLE_LEAK_TRACKER
 #include "base/check_op.h"
-#include "base/containers/linked_list.h"
-#include "base/debug/stack_trace.h"
-#include "base/logging.h"
+#else
+#include <atomic>
+#include <memory>
+
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
 #endif  // ENABLE_LEAK_TRACKER
 
 // LeakTracker is a helper to verify that all instances of a class
@@ -46,19 +54,100 @@
 // then the allocation callstack for each leaked instances is dumped to
 // the error log.
 //
-// If ENABLE_LEAK_TRACKER is not defined, then the check has no effect.
+// If ENABLE_LEAK_TRACKER is not defined, LeakTracker is cheap enough to ship:
+// it only counts the live instances, and captures the allocation callstack of
+// one instance in kLeakTrackerStackSampleRate. The check then logs the sampled
+// callstacks of the leaked instances instead of failing.
+//
+// In both modes, the number of live instances can be reported to UMA:
+//
+//   LeakTracker<net::URLRequest>::RecordLiveInstances("Net.URLRequest.Live");
 
 #ifndef ENABLE_LEAK_TRACKER
 
-// If leak tracking is disabled, do nothing.
+// The allocation callstack is captured for one in this many instances.
+constexpr uint32_t kLeakTrackerStackSampleRate = 1000;
+
 template <typename T>
 class LeakTracker {
  public:
-  // This destructor suppresses warnings about instances of this class not being
-  // used.
-  ~LeakTracker() {}
-  static void CheckForLeaks() {}
-  static int NumLiveInstances() { return -1; }
+  LeakTracker() {
+    live_instances().fetch_add(1, std::memory_order_relaxed);
+    // The first instance is always sampled, so that leaking the only instance
+    // of a class is reported with its callstack.
+    if (allocations().fetch_add(1, std::memory_order_relaxed) %
+            kLeakTrackerStackSampleRate ==
+        0) {
+      sample_ = std::make_unique<Sample>();
+      base::AutoLock lock(samples_lock());
+      samples()->Append(sample_.get());
+    }
+  }
+
+  LeakTracker(const LeakTracker&) = delete;
+  LeakTracker& operator=(const LeakTracker&) = delete;
+
+  ~LeakTracker() {
+    live_instances().fetch_sub(1, std::memory_order_relaxed);
+    if (sample_) {
+      base::AutoLock lock(samples_lock());
+      sample_->RemoveFromList();
+    }
+  }
+
+  static void CheckForLeaks() {
+    const int count = NumLiveInstances();
+    if (!count || !LOG_IS_ON(ERROR))
+      return;
+
+    LOG_STREAM(ERROR) << "Leaked " << count << " instances";
+    base::AutoLock lock(samples_lock());
+    for (base::LinkNode<Sample>* node = samples()->head();
+         node != samples()->end(); node = node->next()) {
+      LOG_STREAM(ERROR) << "Leaked " << node << " which was allocated by:";
+      node->value()->allocation_stack.OutputToStream(&LOG_STREAM(ERROR));
+    }
+  }
+
+  static int NumLiveInstances() {
+    return live_instances().load(std::memory_order_relaxed);
+  }
+
+  static void RecordLiveInstances(const char* histogram_name) {
+    base::UmaHistogramCounts1000(histogram_name, NumLiveInstances());
+  }
+
+ private:
+  // A sampled live instance.
+  struct Sample : public base::LinkNode<Sample> {
+    base::debug::StackTrace allocation_stack;
+  };
+
+  // Each specialization of LeakTracker gets its own static storage. The
+  // counters are only updated with relaxed atomic operations, which don't
+  // contend as the tracked classes are mostly bound to a single thread.
+  static std::atomic<int>& live_instances() {
+    static std::atomic<int> count(0);
+    return count;
+  }
+
+  static std::atomic<uint32_t>& allocations() {
+    static std::atomic<uint32_t> count(0);
+    return count;
+  }
+
+  static base::Lock& samples_lock() {
+    static base::NoDestructor<base::Lock> lock;
+    return *lock;
+  }
+
+  static base::LinkedList<Sample>* samples() {
+    static base::NoDestructor<base::LinkedList<Sample>> list;
+    return list.get();
+  }
+
+  // The callstack of this instance, if sampled.
+  std::unique_ptr<Sample> sample_;
 };
 
 #else
@@ -117,6 +206,10 @@ class LeakTracker : public base::LinkNode<LeakTracker<T>> {
     return count;
   }
 
+  static void RecordLiveInstances(const char* histogram_name) {
+    base::UmaHistogramCounts1000(histogram_name, NumLiveInstances());
+  }
+
  private:
   // Each specialization of LeakTracker gets its own static storage.
   static base::LinkedList<LeakTracker<T>>* instances() {
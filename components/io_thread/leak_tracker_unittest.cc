@@ -5,7 +5,9 @@
 #include "ios/components/io_thread/leak_tracker.h"
 
 #include <memory>
+#include <vector>
 
+#include "base/test/metrics/histogram_tester.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace {
@@ -20,24 +22,6 @@ class ClassB {
   LeakTracker<ClassB> leak_tracker_;
 };
 
-#ifndef ENABLE_LEAK_TRACKER
-
-// If leak tracking is disabled, we should do nothing.
-TEST(LeakTrackerTest, NotEnabled) {
-  EXPECT_EQ(-1, LeakTracker<ClassA>::NumLiveInstances());
-  EXPECT_EQ(-1, LeakTracker<ClassB>::NumLiveInstances());
-
-  // Use unique_ptr so compiler doesn't complain about unused variables.
-  std::unique_ptr<ClassA> a1(new ClassA);
-  std::unique_ptr<ClassB> b1(new ClassB);
-  std::unique_ptr<ClassB> b2(new ClassB);
-
-  EXPECT_EQ(-1, LeakTracker<ClassA>::NumLiveInstances());
-  EXPECT_EQ(-1, LeakTracker<ClassB>::NumLiveInstances());
-}
-
-#else
-
 TEST(LeakTrackerTest, Basic) {
   {
     ClassA a1;
@@ -104,6 +88,41 @@ TEST(LeakTrackerTest, NoOpCheckForLeaks) {
   LeakTracker<ClassA>::CheckForLeaks();
 }
 
+// Tests that the number of live instances is recorded.
+TEST(LeakTrackerTest, RecordLiveInstances) {
+  base::HistogramTester histogram_tester;
+  std::unique_ptr<ClassA> a1(new ClassA);
+  std::unique_ptr<ClassA> a2(new ClassA);
+  LeakTracker<ClassA>::RecordLiveInstances("LeakTracker.ClassA");
+  a2.reset();
+  LeakTracker<ClassA>::RecordLiveInstances("LeakTracker.ClassA");
+
+  histogram_tester.ExpectBucketCount("LeakTracker.ClassA", 2, 1);
+  histogram_tester.ExpectBucketCount("LeakTracker.ClassA", 1, 1);
+}
+
+#ifndef ENABLE_LEAK_TRACKER
+
+class ClassC {
+ private:
+  LeakTracker<ClassC> leak_tracker_;
+};
+
+// Tests that the sampled callstacks are tracked for more instances than the
+// sample rate, and that leaks are only logged.
+TEST(LeakTrackerTest, SampledCheckForLeaks) {
+  std::vector<std::unique_ptr<ClassC>> instances;
+  for (uint32_t i = 0; i < 2 * kLeakTrackerStackSampleRate + 1; ++i)
+    instances.push_back(std::make_unique<ClassC>());
+  EXPECT_EQ(static_cast<int>(instances.size()),
+            LeakTracker<ClassC>::NumLiveInstances());
+
+  LeakTracker<ClassC>::CheckForLeaks();
+
+  instances.clear();
+  EXPECT_EQ(0, LeakTracker<ClassC>::NumLiveInstances());
+}
+
 #endif  // ENABLE_LEAK_TRACKER
 
 }  // namespace
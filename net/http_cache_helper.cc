@@ -4,12 +4,14 @@
 
 #include "ios/net/http_cache_helper.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/callback_helpers.h"
 #include "base/location.h"
+#include "base/memory/weak_ptr.h"
 #include "base/task/task_runner.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/time.h"
@@ -21,10 +23,14 @@
 #include "net/quic/quic_stream_factory.h"
 #include "net/url_request/url_request_context.h"
 #include "net/url_request/url_request_context_getter.h"
+#include "net/url_request/url_request_context_getter_observer.h"
 #include "url/gurl.h"
 
 namespace {
 
+// Duration of the most recent time slice doomed by ClearHttpCache.
+constexpr base::TimeDelta kDefaultClearSliceDuration = base::Hours(1);
+
 // Posts |callback| on |task_runner|.
 void PostCallback(const scoped_refptr<base::TaskRunner>& task_runner,
                   net::CompletionOnceCallback callback,
@@ -32,28 +38,187 @@ void PostCallback(const scoped_refptr<base::TaskRunner>& task_runner,
   task_runner->PostTask(FROM_HERE, base::BindOnce(std::move(callback), error));
 }
 
+// Dooms the entries of a disk_cache::Backend last used in a time range, one
+// time slice at a time, most recent first. Each slice is doomed with
+// DoomEntriesBetween, which only looks at the index of the backend. Lives on
+// the IO thread and deletes itself once done, or when the URLRequestContext
+// owning the backend shuts down. Backend callbacks and reposted tasks are
+// bound to weak pointers, so they are dropped if the clearer was deleted at
+// shutdown.
+class BatchedCacheClearer : public net::URLRequestContextGetterObserver {
+ public:
+  BatchedCacheClearer(
+      const scoped_refptr<net::URLRequestContextGetter>& getter,
+      disk_cache::Backend* backend,
+      const scoped_refptr<base::TaskRunner>& client_task_runner,
+      const base::Time& delete_begin,
+      const base::Time& delete_end,
+      base::TimeDelta slice_duration,
+      const net::ClearHttpCacheProgressCallback& progress_callback,
+      net::CompletionOnceCallback callback)
+      : getter_(getter),
+        backend_(backend),
+        client_task_runner_(client_task_runner),
+        delete_begin_(delete_begin),
+        delete_end_(delete_end),
+        progress_callback_(progress_callback),
+        callback_(std::move(callback)),
+        slice_duration_(slice_duration) {
+    DCHECK(slice_duration_.is_positive());
+    getter_->AddObserver(this);
+  }
+
+  BatchedCacheClearer(const BatchedCacheClearer&) = delete;
+  BatchedCacheClearer& operator=(const BatchedCacheClearer&) = delete;
+
+  ~BatchedCacheClearer() override { getter_->RemoveObserver(this); }
+
+  // Starts clearing the cache.
+  void Start() {
+    // Clearing the whole cache does not need to be split.
+    if (delete_begin_.is_null() && delete_end_.is_max()) {
+      DoomAllEntries();
+      return;
+    }
+    entry_count_ = backend_->GetEntryCount();
+    // The most recent slice ends at |delete_end_|, to include the entries
+    // with a last use time in the future, but only lasts |slice_duration_|
+    // from now on.
+    slice_end_ = delete_end_;
+    slice_begin_ = std::min(delete_end_, base::Time::Now()) - slice_duration_;
+    DoomNextSlice();
+  }
+
+  // net::URLRequestContextGetterObserver implementation:
+  void OnContextShuttingDown() override { Finish(net::ERR_CONTEXT_SHUT_DOWN); }
+
+ private:
+  // Dooms all the entries of the backend at once.
+  void DoomAllEntries() {
+    const int32_t entry_count = backend_->GetEntryCount();
+    const int rv = backend_->DoomAllEntries(
+        base::BindOnce(&BatchedCacheClearer::OnAllEntriesDoomed,
+                       weak_ptr_factory_.GetWeakPtr(), entry_count));
+    // DoomAllEntries does not invoke callback unless rv is ERR_IO_PENDING.
+    if (rv != net::ERR_IO_PENDING)
+      OnAllEntriesDoomed(entry_count, rv);
+  }
+
+  // Called when all the |entry_count| entries of the backend were doomed.
+  void OnAllEntriesDoomed(int32_t entry_count, int rv) {
+    if (rv == net::OK && entry_count > 0) {
+      doomed_entries_ = entry_count;
+      ReportProgress();
+    }
+    Finish(rv);
+  }
+
+  // Dooms the entries last used between |slice_begin_| and |slice_end_|. The
+  // last slice is cut at |delete_begin_|.
+  void DoomNextSlice() {
+    if (slice_begin_ <= delete_begin_) {
+      slice_begin_ = delete_begin_;
+      last_slice_ = true;
+    }
+    const int rv = backend_->DoomEntriesBetween(
+        slice_begin_, slice_end_,
+        base::BindOnce(&BatchedCacheClearer::OnSliceDoomed,
+                       weak_ptr_factory_.GetWeakPtr()));
+    // DoomEntriesBetween does not invoke callback unless rv is
+    // ERR_IO_PENDING.
+    if (rv != net::ERR_IO_PENDING)
+      OnSliceDoomed(rv);
+  }
+
+  // Called when the entries of the current slice were doomed. Reports
+  // progress and either completes or schedules the next, older slice.
+  void OnSliceDoomed(int rv) {
+    if (rv != net::OK) {
+      Finish(rv);
+      return;
+    }
+
+    // The number of entries of the backend is known without enumerating it.
+    // Entries added concurrently may hide some of the doomed ones, so the
+    // progress is a lower bound.
+    const int32_t entry_count = backend_->GetEntryCount();
+    if (entry_count < entry_count_)
+      doomed_entries_ += entry_count_ - entry_count;
+    entry_count_ = entry_count;
+    ReportProgress();
+
+    if (last_slice_) {
+      Finish(net::OK);
+      return;
+    }
+
+    // Older entries are usually sparser, so each slice is twice as long as
+    // the previous one. A range of any length is thus cleared in a
+    // logarithmic number of slices.
+    slice_end_ = slice_begin_;
+    slice_duration_ *= 2;
+    slice_begin_ = slice_end_ - slice_duration_;
+
+    // Yield the IO thread before dooming the next slice.
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&BatchedCacheClearer::DoomNextSlice,
+                                  weak_ptr_factory_.GetWeakPtr()));
+  }
+
+  // Reports the number of entries doomed so far to |progress_callback_|.
+  void ReportProgress() {
+    if (progress_callback_) {
+      client_task_runner_->PostTask(
+          FROM_HERE, base::BindOnce(progress_callback_, doomed_entries_));
+    }
+  }
+
+  // Reports |rv| to |callback_| and deletes |this|.
+  void Finish(int rv) {
+    client_task_runner_->PostTask(FROM_HERE,
+                                  base::BindOnce(std::move(callback_), rv));
+    delete this;
+  }
+
+  scoped_refptr<net::URLRequestContextGetter> getter_;
+  disk_cache::Backend* backend_;
+  scoped_refptr<base::TaskRunner> client_task_runner_;
+  const base::Time delete_begin_;
+  const base::Time delete_end_;
+  net::ClearHttpCacheProgressCallback progress_callback_;
+  net::CompletionOnceCallback callback_;
+
+  // Current time slice.
+  base::TimeDelta slice_duration_;
+  base::Time slice_begin_;
+  base::Time slice_end_;
+  bool last_slice_ = false;
+
+  int32_t entry_count_ = 0;
+  size_t doomed_entries_ = 0;
+
+  base::WeakPtrFactory<BatchedCacheClearer> weak_ptr_factory_{this};
+};
+
 // Clears the disk_cache::Backend on the IO thread and deletes |backend|.
 void DoomHttpCache(std::unique_ptr<disk_cache::Backend*> backend,
+                   const scoped_refptr<net::URLRequestContextGetter>& getter,
                    const scoped_refptr<base::TaskRunner>& client_task_runner,
                    const base::Time& delete_begin,
                    const base::Time& delete_end,
+                   base::TimeDelta slice_duration,
+                   const net::ClearHttpCacheProgressCallback& progress_callback,
                    net::CompletionOnceCallback callback,
                    int error) {
   // |*backend| may be null in case of error.
   if (*backend) {
-    auto callback_pair = base::SplitOnceCallback(std::move(callback));
-    const int rv = (*backend)->DoomEntriesBetween(
-        delete_begin, delete_end,
-        base::BindOnce(&PostCallback, client_task_runner,
-                       std::move(callback_pair.first)));
-    // DoomEntriesBetween does not invoke callback unless rv is ERR_IO_PENDING.
-    if (rv != net::ERR_IO_PENDING) {
-      client_task_runner->PostTask(
-          FROM_HERE, base::BindOnce(std::move(callback_pair.second), rv));
-    }
+    // BatchedCacheClearer deletes itself when done.
+    BatchedCacheClearer* clearer = new BatchedCacheClearer(
+        getter, *backend, client_task_runner, delete_begin, delete_end,
+        slice_duration, progress_callback, std::move(callback));
+    clearer->Start();
   } else {
-    client_task_runner->PostTask(FROM_HERE,
-                                 base::BindOnce(std::move(callback), error));
+    PostCallback(client_task_runner, std::move(callback), error);
   }
 }
 
@@ -64,9 +229,17 @@ void ClearHttpCacheOnIOThread(
     const scoped_refptr<base::TaskRunner>& client_task_runner,
     const base::Time& delete_begin,
     const base::Time& delete_end,
+    base::TimeDelta slice_duration,
+    const net::ClearHttpCacheProgressCallback& progress_callback,
     net::CompletionOnceCallback callback) {
-  net::HttpCache* http_cache =
-      getter->GetURLRequestContext()->http_transaction_factory()->GetCache();
+  net::URLRequestContext* context = getter->GetURLRequestContext();
+  if (!context) {
+    // The context is already shutting down.
+    PostCallback(client_task_runner, std::move(callback),
+                 net::ERR_CONTEXT_SHUT_DOWN);
+    return;
+  }
+  net::HttpCache* http_cache = context->http_transaction_factory()->GetCache();
 
   // Clear QUIC server information from memory and the disk cache.
   http_cache->GetSession()
@@ -78,9 +251,10 @@ void ClearHttpCacheOnIOThread(
       new disk_cache::Backend*(nullptr));
   disk_cache::Backend** backend_ptr = backend.get();
 
-  auto doom_callback_pair = base::SplitOnceCallback(
-      base::BindOnce(&DoomHttpCache, std::move(backend), client_task_runner,
-                     delete_begin, delete_end, std::move(callback)));
+  auto doom_callback_pair = base::SplitOnceCallback(base::BindOnce(
+      &DoomHttpCache, std::move(backend), getter, client_task_runner,
+      delete_begin, delete_end, slice_duration, progress_callback,
+      std::move(callback)));
 
   const int rv =
       http_cache->GetBackend(backend_ptr, std::move(doom_callback_pair.first));
@@ -100,11 +274,27 @@ void ClearHttpCache(const scoped_refptr<net::URLRequestContextGetter>& getter,
                     const base::Time& delete_begin,
                     const base::Time& delete_end,
                     net::CompletionOnceCallback callback) {
+  ClearHttpCacheInBatches(getter, network_task_runner, delete_begin,
+                          delete_end, kDefaultClearSliceDuration,
+                          ClearHttpCacheProgressCallback(),
+                          std::move(callback));
+}
+
+void ClearHttpCacheInBatches(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    const scoped_refptr<base::TaskRunner>& network_task_runner,
+    const base::Time& delete_begin,
+    const base::Time& delete_end,
+    base::TimeDelta slice_duration,
+    const ClearHttpCacheProgressCallback& progress_callback,
+    net::CompletionOnceCallback callback) {
   DCHECK(delete_end != base::Time());
   network_task_runner->PostTask(
-      FROM_HERE, base::BindOnce(&ClearHttpCacheOnIOThread, getter,
-                                base::ThreadTaskRunnerHandle::Get(),
-                                delete_begin, delete_end, std::move(callback)));
+      FROM_HERE,
+      base::BindOnce(&ClearHttpCacheOnIOThread, getter,
+                     base::ThreadTaskRunnerHandle::Get(), delete_begin,
+                     delete_end, slice_duration, progress_callback,
+                     std::move(callback)));
 }
 
 }  // namespace net
@@ -5,18 +5,25 @@
 #ifndef IOS_NET_HTTP_CACHE_HELPER_H_
 #define IOS_NET_HTTP_CACHE_HELPER_H_
 
+#include <stddef.h>
+
 #include "base/callback_forward.h"
 #include "base/memory/ref_counted.h"
+#include "base/time/time.h"
 #include "net/base/completion_once_callback.h"
 
 namespace base {
 class TaskRunner;
-class Time;
 }
 
 namespace net {
 class URLRequestContextGetter;
 
+// Callback reporting the progress of ClearHttpCacheInBatches with the total
+// number of entries doomed so far.
+using ClearHttpCacheProgressCallback =
+    base::RepeatingCallback<void(size_t doomed_entries)>;
+
 // Clears the HTTP cache and calls |closure| back.
 void ClearHttpCache(const scoped_refptr<net::URLRequestContextGetter>& getter,
                     const scoped_refptr<base::TaskRunner>& network_task_runner,
@@ -24,6 +31,28 @@ void ClearHttpCache(const scoped_refptr<net::URLRequestContextGetter>& getter,
                     const base::Time& delete_end,
                     net::CompletionOnceCallback callback);
 
+// Clears the HTTP cache entries last used between |delete_begin| and
+// |delete_end| one time slice at a time, most recent first. The most recent
+// slice lasts |slice_duration| and each older slice is twice as long as the
+// previous one. The network thread is released between two slices so that
+// clearing a large cache does not starve other network tasks. An unbounded
+// range (null |delete_begin| and max |delete_end|) dooms all the entries at
+// once instead. |progress_callback| (which may be null) is called on the
+// calling sequence after each slice and |callback| once the whole range has
+// been cleared.
+//
+// If the URLRequestContext of |getter| shuts down before the end, |callback|
+// is called with ERR_CONTEXT_SHUT_DOWN. Entries doomed by completed slices
+// stay doomed, so calling this again with the same range resumes the clear.
+void ClearHttpCacheInBatches(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    const scoped_refptr<base::TaskRunner>& network_task_runner,
+    const base::Time& delete_begin,
+    const base::Time& delete_end,
+    base::TimeDelta slice_duration,
+    const ClearHttpCacheProgressCallback& progress_callback,
+    net::CompletionOnceCallback callback);
+
 }  // namespace net
 
 #endif  // IOS_NET_HTTP_CACHE_HELPER_H_
@@ -0,0 +1,224 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/net/http_cache_helper.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_runner.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "net/base/net_errors.h"
+#include "net/base/request_priority.h"
+#include "net/base/test_completion_callback.h"
+#include "net/disk_cache/disk_cache.h"
+#include "net/http/http_cache.h"
+#include "net/http/http_transaction_factory.h"
+#include "net/proxy_resolution/proxy_config_service_fixed.h"
+#include "net/proxy_resolution/proxy_config_with_annotation.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_context_builder.h"
+#include "net/url_request/url_request_context_getter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+namespace net {
+
+namespace {
+
+// URLRequestContextGetter for a context with an in-memory HTTP cache.
+class CacheContextGetter : public URLRequestContextGetter {
+ public:
+  explicit CacheContextGetter(
+      scoped_refptr<base::SingleThreadTaskRunner> network_task_runner)
+      : network_task_runner_(std::move(network_task_runner)) {
+    URLRequestContextBuilder builder;
+    builder.set_proxy_config_service(std::make_unique<ProxyConfigServiceFixed>(
+        ProxyConfigWithAnnotation::CreateDirect()));
+    URLRequestContextBuilder::HttpCacheParams cache_params;
+    cache_params.type = URLRequestContextBuilder::HttpCacheParams::IN_MEMORY;
+    builder.EnableHttpCache(cache_params);
+    context_ = builder.Build();
+  }
+
+  CacheContextGetter(const CacheContextGetter&) = delete;
+  CacheContextGetter& operator=(const CacheContextGetter&) = delete;
+
+  // Notifies the observers that the context shuts down and destroys it.
+  void Shutdown() {
+    NotifyContextShuttingDown();
+    context_.reset();
+  }
+
+  // URLRequestContextGetter implementation:
+  URLRequestContext* GetURLRequestContext() override { return context_.get(); }
+  scoped_refptr<base::SingleThreadTaskRunner> GetNetworkTaskRunner()
+      const override {
+    return network_task_runner_;
+  }
+
+ private:
+  ~CacheContextGetter() override = default;
+
+  scoped_refptr<base::SingleThreadTaskRunner> network_task_runner_;
+  std::unique_ptr<URLRequestContext> context_;
+};
+
+}  // namespace
+
+class HttpCacheHelperTest : public PlatformTest {
+ protected:
+  HttpCacheHelperTest()
+      : getter_(base::MakeRefCounted<CacheContextGetter>(
+            base::ThreadTaskRunnerHandle::Get())) {}
+
+  // Returns the disk cache backend of the context.
+  disk_cache::Backend* GetBackend() {
+    disk_cache::Backend* backend = nullptr;
+    TestCompletionCallback callback;
+    int rv = getter_->GetURLRequestContext()
+                 ->http_transaction_factory()
+                 ->GetCache()
+                 ->GetBackend(&backend, callback.callback());
+    EXPECT_EQ(OK, callback.GetResult(rv));
+    return backend;
+  }
+
+  // Creates an empty cache entry for |key|. The in-memory backend creates
+  // entries synchronously.
+  void CreateEntry(const std::string& key) {
+    disk_cache::EntryResult result =
+        GetBackend()->CreateEntry(key, HIGHEST, base::DoNothing());
+    ASSERT_EQ(OK, result.net_error());
+    result.ReleaseEntry()->Close();
+  }
+
+  // Creates the entries "entry0" now, "entry1" 4 hours later and "entry2" 6
+  // hours later, and moves the clock to the creation of the last one.
+  void CreateSpreadEntries() {
+    CreateEntry("entry0");
+    task_environment_.FastForwardBy(base::Hours(4));
+    CreateEntry("entry1");
+    task_environment_.FastForwardBy(base::Hours(2));
+    CreateEntry("entry2");
+  }
+
+  // Clears the cache entries last used between |delete_begin| and
+  // |delete_end| and waits for the end of the clear.
+  void ClearCache(base::Time delete_begin, base::Time delete_end) {
+    base::RunLoop run_loop;
+    ClearHttpCacheInBatches(
+        getter_, base::ThreadTaskRunnerHandle::Get(), delete_begin,
+        delete_end, base::Hours(1),
+        base::BindRepeating(&HttpCacheHelperTest::OnProgress,
+                            base::Unretained(this)),
+        base::BindOnce(&HttpCacheHelperTest::OnCleared, base::Unretained(this),
+                       run_loop.QuitClosure()));
+    run_loop.Run();
+  }
+
+  void OnProgress(size_t doomed_entries) {
+    progress_.push_back(doomed_entries);
+    if (progress_closure_)
+      std::move(progress_closure_).Run();
+  }
+
+  void OnCleared(base::OnceClosure quit_closure, int rv) {
+    result_ = rv;
+    std::move(quit_closure).Run();
+  }
+
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::MainThreadType::IO,
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  scoped_refptr<CacheContextGetter> getter_;
+  std::vector<size_t> progress_;
+  base::OnceClosure progress_closure_;
+  int result_ = ERR_IO_PENDING;
+};
+
+// Tests that a bounded range is cleared in time slices, most recent first,
+// with progress reported after each slice.
+TEST_F(HttpCacheHelperTest, ClearsInSlices) {
+  const base::Time delete_begin = base::Time::Now() + base::Minutes(1);
+  CreateSpreadEntries();
+
+  // The slices are the last hour, the two hours before and the four hours
+  // before, cut at |delete_begin|.
+  ClearCache(delete_begin, base::Time::Max());
+
+  EXPECT_EQ(OK, result_);
+  EXPECT_EQ(std::vector<size_t>({1, 2, 2}), progress_);
+  EXPECT_EQ(1, GetBackend()->GetEntryCount());
+  disk_cache::EntryResult result =
+      GetBackend()->OpenEntry("entry0", HIGHEST, base::DoNothing());
+  ASSERT_EQ(OK, result.net_error());
+  result.ReleaseEntry()->Close();
+}
+
+// Tests that only the entries last used in the range are doomed.
+TEST_F(HttpCacheHelperTest, ClearsTimeRange) {
+  CreateEntry("old");
+  task_environment_.FastForwardBy(base::Hours(1));
+  const base::Time delete_begin = base::Time::Now();
+  CreateEntry("new1");
+  CreateEntry("new2");
+
+  ClearCache(delete_begin, base::Time::Max());
+
+  EXPECT_EQ(OK, result_);
+  ASSERT_FALSE(progress_.empty());
+  EXPECT_EQ(2u, progress_.back());
+  EXPECT_EQ(1, GetBackend()->GetEntryCount());
+  disk_cache::EntryResult result =
+      GetBackend()->OpenEntry("old", HIGHEST, base::DoNothing());
+  ASSERT_EQ(OK, result.net_error());
+  result.ReleaseEntry()->Close();
+}
+
+// Tests that an unbounded range dooms all the entries at once.
+TEST_F(HttpCacheHelperTest, ClearsAllEntries) {
+  for (int i = 0; i < 3; ++i)
+    CreateEntry("entry" + std::to_string(i));
+
+  ClearCache(base::Time(), base::Time::Max());
+
+  EXPECT_EQ(OK, result_);
+  EXPECT_EQ(std::vector<size_t>({3}), progress_);
+  EXPECT_EQ(0, GetBackend()->GetEntryCount());
+}
+
+// Tests that the clear stops and reports an error if the context shuts down
+// between two slices.
+TEST_F(HttpCacheHelperTest, StopsWhenContextShutsDown) {
+  const base::Time delete_begin = base::Time::Now() - base::Minutes(1);
+  CreateSpreadEntries();
+
+  base::RunLoop progress_run_loop;
+  progress_closure_ = progress_run_loop.QuitClosure();
+  ClearHttpCacheInBatches(
+      getter_, base::ThreadTaskRunnerHandle::Get(), delete_begin,
+      base::Time::Max(), base::Hours(1),
+      base::BindRepeating(&HttpCacheHelperTest::OnProgress,
+                          base::Unretained(this)),
+      base::BindOnce(&HttpCacheHelperTest::OnCleared, base::Unretained(this),
+                     base::DoNothing()));
+  progress_run_loop.Run();
+  ASSERT_EQ(std::vector<size_t>({1}), progress_);
+
+  // The next slice is pending on the network thread.
+  getter_->Shutdown();
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(ERR_CONTEXT_SHUT_DOWN, result_);
+  EXPECT_EQ(std::vector<size_t>({1}), progress_);
+}
+
+}  // namespace net
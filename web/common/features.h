@@ -66,6 +66,10 @@ extern const base::Feature kEnableFullscreenAPI;
 // should be used instead of directly checking this feature.
 extern const base::Feature kUseLoadSimulatedRequestForOfflinePage;
 
+// Feature flag enabling the pool of web views created ahead of time for new
+// tabs and prerenders.
+extern const base::Feature kWebViewPool;
+
 // When true, the native context menu for the web content are used.
 bool UseWebViewNativeContextMenuWeb();
 
@@ -8,6 +8,8 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #import <WebKit/WebKit.h>
 
@@ -28,6 +30,13 @@ class JavaScriptFeature;
 // the state added to the WKUserContentController associated with
 // |browser_state| because WKUserContentController does not expose API to remove
 // specific WKUserScript instances.
+//
+// The scripts of the features added together are concatenated into as few
+// WKUserScripts as their dependency order allows: consecutive scripts with
+// the same injection time and target frames share a WKUserScript. Each script
+// runs in its own function and catches its own exceptions. The script messages
+// of all the features are received by a single handler which routes them by
+// handler name.
 class JavaScriptContentWorld {
  public:
   ~JavaScriptContentWorld();
@@ -45,13 +54,33 @@ class JavaScriptContentWorld {
   // callbacks.
   void AddFeature(const JavaScriptFeature* feature);
 
+  // Adds |features| and the features they depend on, in order. Their scripts
+  // are bundled, so adding all the features at once is much cheaper for the
+  // web views than adding them one by one.
+  void AddFeatures(const std::vector<const JavaScriptFeature*>& features);
+
   // Returns true if and only if |feature| has been added to this content world.
   bool HasFeature(const JavaScriptFeature* feature);
 
  private:
-  // Processes the response of a script message and forwards it to |handler|.
-  void ScriptMessageReceived(JavaScriptFeature::ScriptMessageHandler handler,
-                             BrowserState* browser_state,
+  // Marks |feature| and its dependencies as added, and appends those which
+  // were not already added to |added_features|, dependencies first.
+  void CollectFeature(const JavaScriptFeature* feature,
+                      std::vector<const JavaScriptFeature*>* added_features);
+
+  // Adds a user script with |source| to |user_content_controller_|.
+  void AddUserScript(NSString* source,
+                     WKUserScriptInjectionTime injection_time,
+                     bool main_frame_only);
+
+  // Routes the script messages sent to |handler_name| to |handler|.
+  void AddScriptMessageHandler(
+      const std::string& handler_name,
+      JavaScriptFeature::ScriptMessageHandler handler);
+
+  // Processes the response of a script message and forwards it to the handler
+  // registered for its name.
+  void ScriptMessageReceived(BrowserState* browser_state,
                              WKScriptMessage* script_message);
 
   // The features which have already been configured for |content_world_|.
@@ -65,9 +94,11 @@ class JavaScriptContentWorld {
   // script message handler JavaScript->native communication.
   WKUserContentController* user_content_controller_;
 
-  std::map<const JavaScriptFeature*,
-           std::unique_ptr<ScopedWKScriptMessageHandler>>
+  // The script message handlers of the features by handler name, and the
+  // WKScriptMessageHandler registered for all these names.
+  std::map<std::string, JavaScriptFeature::ScriptMessageHandler>
       script_message_handlers_;
+  std::unique_ptr<ScopedWKScriptMessageHandler> script_message_handler_;
 
   // The associated WKContentWorld. May be null which represents the main world
   // which the page content itself uses. (The same content world can also be
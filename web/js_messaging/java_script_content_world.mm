@@ -5,6 +5,7 @@
 #import "ios/web/js_messaging/java_script_content_world.h"
 
 #include "base/check_op.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/notreached.h"
 #import "base/strings/sys_string_conversions.h"
 #import "ios/web/js_messaging/web_view_js_utils.h"
@@ -38,6 +39,22 @@ WKUserScriptInjectionTime InjectionTimeToWKUserScriptInjectionTime(
   return WKUserScriptInjectionTimeAtDocumentStart;
 }
 
+// Returns |script| wrapped so that it can be concatenated with other scripts
+// in a single WKUserScript and still run as if it was injected on its own:
+// it runs in its own function so that a "use strict" directive at its top
+// only applies to it, and an exception thrown by it is logged without
+// preventing the following scripts from running.
+NSString* WrapScriptForBundle(NSString* script) {
+  return [NSString stringWithFormat:@"try {\n"
+                                    @"(function() {\n"
+                                    @"%@\n"
+                                    @"}).call(this);\n"
+                                    @"} catch (error) {\n"
+                                    @"  console.error(error);\n"
+                                    @"}\n",
+                                    script];
+}
+
 // Returns the WKUserContentController associated with |browser_state|.
 // NOTE: Only fetch the WKUserContentController once at construction. Although
 // it is not guaranteed to remain constant over the lifetime of the
@@ -71,6 +88,77 @@ bool JavaScriptContentWorld::HasFeature(const JavaScriptFeature* feature) {
 }
 
 void JavaScriptContentWorld::AddFeature(const JavaScriptFeature* feature) {
+  AddFeatures({feature});
+}
+
+void JavaScriptContentWorld::AddFeatures(
+    const std::vector<const JavaScriptFeature*>& features) {
+  std::vector<const JavaScriptFeature*> added_features;
+  for (const JavaScriptFeature* feature : features)
+    CollectFeature(feature, &added_features);
+  if (added_features.empty())
+    return;
+
+  // Bundle the scripts in the order of the features. WebKit runs all the
+  // document start scripts before the document end ones, in the order they
+  // were added, so only the order within an injection time matters.
+  // Consecutive scripts of an injection time targeting the same frames share a
+  // bundle, and a script targeting other frames starts a new bundle.
+  struct ScriptBundle {
+    JavaScriptFeature::FeatureScript::InjectionTime injection_time;
+    JavaScriptFeature::FeatureScript::TargetFrames target_frames;
+    NSMutableString* source;
+  };
+  std::vector<ScriptBundle> bundles;
+  for (const JavaScriptFeature* feature : added_features) {
+    for (const JavaScriptFeature::FeatureScript& feature_script :
+         feature->GetScripts()) {
+      ScriptBundle* bundle = nullptr;
+      for (auto it = bundles.rbegin(); it != bundles.rend(); ++it) {
+        if (it->injection_time == feature_script.GetInjectionTime()) {
+          bundle = &*it;
+          break;
+        }
+      }
+      if (!bundle ||
+          bundle->target_frames != feature_script.GetTargetFrames()) {
+        bundles.push_back({feature_script.GetInjectionTime(),
+                           feature_script.GetTargetFrames(),
+                           [NSMutableString string]});
+        bundle = &bundles.back();
+      }
+      [bundle->source
+          appendString:WrapScriptForBundle(feature_script.GetScriptString())];
+    }
+  }
+
+  for (const ScriptBundle& bundle : bundles) {
+    if (bundle.injection_time ==
+        JavaScriptFeature::FeatureScript::InjectionTime::kDocumentStart) {
+      UMA_HISTOGRAM_COUNTS_10M("IOS.JavaScriptContentWorld.DocumentStartSize",
+                               bundle.source.length);
+    }
+    AddUserScript(
+        bundle.source,
+        InjectionTimeToWKUserScriptInjectionTime(bundle.injection_time),
+        /*main_frame_only=*/bundle.target_frames ==
+            JavaScriptFeature::FeatureScript::TargetFrames::kMainFrame);
+  }
+
+  // Setup Javascript message callbacks.
+  for (const JavaScriptFeature* feature : added_features) {
+    auto optional_handler_name = feature->GetScriptMessageHandlerName();
+    if (!optional_handler_name)
+      continue;
+    auto handler = feature->GetScriptMessageHandler();
+    DCHECK(handler);
+    AddScriptMessageHandler(optional_handler_name.value(), handler.value());
+  }
+}
+
+void JavaScriptContentWorld::CollectFeature(
+    const JavaScriptFeature* feature,
+    std::vector<const JavaScriptFeature*>* added_features) {
   if (HasFeature(feature)) {
     // |feature| has already been added to this content world.
     return;
@@ -97,67 +185,63 @@ void JavaScriptContentWorld::AddFeature(const JavaScriptFeature* feature) {
 
   // Add dependent features first.
   for (const JavaScriptFeature* dep_feature : feature->GetDependentFeatures()) {
-    AddFeature(dep_feature);
+    CollectFeature(dep_feature, added_features);
   }
 
-  // Setup user scripts.
-  for (const JavaScriptFeature::FeatureScript& feature_script :
-       feature->GetScripts()) {
-    WKUserScriptInjectionTime injection_time =
-        InjectionTimeToWKUserScriptInjectionTime(
-            feature_script.GetInjectionTime());
-
-    bool main_frame_only =
-        feature_script.GetTargetFrames() !=
-        JavaScriptFeature::FeatureScript::TargetFrames::kAllFrames;
-
-    if (content_world_) {
-      WKUserScript* user_script =
-          [[WKUserScript alloc] initWithSource:feature_script.GetScriptString()
-                                 injectionTime:injection_time
-                              forMainFrameOnly:main_frame_only
-                                inContentWorld:content_world_];
-      [user_content_controller_ addUserScript:user_script];
-    } else {
-      WKUserScript* user_script =
-          [[WKUserScript alloc] initWithSource:feature_script.GetScriptString()
-                                 injectionTime:injection_time
-                              forMainFrameOnly:main_frame_only];
-      [user_content_controller_ addUserScript:user_script];
-    }
+  added_features->push_back(feature);
+}
+
+void JavaScriptContentWorld::AddUserScript(
+    NSString* source,
+    WKUserScriptInjectionTime injection_time,
+    bool main_frame_only) {
+  WKUserScript* user_script = nil;
+  if (content_world_) {
+    user_script = [[WKUserScript alloc] initWithSource:source
+                                         injectionTime:injection_time
+                                      forMainFrameOnly:main_frame_only
+                                        inContentWorld:content_world_];
+  } else {
+    user_script = [[WKUserScript alloc] initWithSource:source
+                                         injectionTime:injection_time
+                                      forMainFrameOnly:main_frame_only];
   }
+  [user_content_controller_ addUserScript:user_script];
+}
 
-  // Setup Javascript message callback.
-  auto optional_handler_name = feature->GetScriptMessageHandlerName();
-  if (optional_handler_name) {
-    auto handler = feature->GetScriptMessageHandler();
-    DCHECK(handler);
+void JavaScriptContentWorld::AddScriptMessageHandler(
+    const std::string& handler_name,
+    JavaScriptFeature::ScriptMessageHandler handler) {
+  DCHECK(!script_message_handlers_.count(handler_name));
+  script_message_handlers_[handler_name] = std::move(handler);
 
-    NSString* handler_name =
-        base::SysUTF8ToNSString(optional_handler_name.value());
+  NSString* ns_handler_name = base::SysUTF8ToNSString(handler_name);
+  if (script_message_handler_) {
+    script_message_handler_->AddScriptHandlerName(ns_handler_name);
+    return;
+  }
 
-    std::unique_ptr<ScopedWKScriptMessageHandler> script_message_handler;
-    if (content_world_) {
-      script_message_handler = std::make_unique<ScopedWKScriptMessageHandler>(
-          user_content_controller_, handler_name, content_world_,
-          base::BindRepeating(&JavaScriptContentWorld::ScriptMessageReceived,
-                              weak_factory_.GetWeakPtr(), handler.value(),
-                              browser_state_));
-    } else {
-      script_message_handler = std::make_unique<ScopedWKScriptMessageHandler>(
-          user_content_controller_, handler_name,
-          base::BindRepeating(&JavaScriptContentWorld::ScriptMessageReceived,
-                              weak_factory_.GetWeakPtr(), handler.value(),
-                              browser_state_));
-    }
-    script_message_handlers_[feature] = std::move(script_message_handler);
+  auto callback =
+      base::BindRepeating(&JavaScriptContentWorld::ScriptMessageReceived,
+                          weak_factory_.GetWeakPtr(), browser_state_);
+  if (content_world_) {
+    script_message_handler_ = std::make_unique<ScopedWKScriptMessageHandler>(
+        user_content_controller_, ns_handler_name, content_world_, callback);
+  } else {
+    script_message_handler_ = std::make_unique<ScopedWKScriptMessageHandler>(
+        user_content_controller_, ns_handler_name, callback);
   }
 }
 
 void JavaScriptContentWorld::ScriptMessageReceived(
-    JavaScriptFeature::ScriptMessageHandler handler,
     BrowserState* browser_state,
     WKScriptMessage* script_message) {
+  auto handler_it = script_message_handlers_.find(
+      base::SysNSStringToUTF8(script_message.name));
+  if (handler_it == script_message_handlers_.end()) {
+    return;
+  }
+
   web::WebViewWebStateMap* map =
       web::WebViewWebStateMap::FromBrowserState(browser_state);
   web::WebState* web_state = map->GetWebStateForWebView(script_message.webView);
@@ -184,7 +268,7 @@ void JavaScriptContentWorld::ScriptMessageReceived(
                         web_controller.isUserInteracting,
                         script_message.frameInfo.mainFrame, url);
 
-  handler.Run(web_state, message);
+  handler_it->second.Run(web_state, message);
 }
 
 }  // namespace web
@@ -7,6 +7,8 @@
 #import <WebKit/WebKit.h>
 
 #include "base/ios/ios_util.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/time/time.h"
 #import "ios/web/public/browser_state.h"
 #import "ios/web/public/js_messaging/java_script_feature.h"
 #include "ios/web/public/js_messaging/java_script_feature_util.h"
@@ -22,17 +24,17 @@ namespace {
 const char kWebJavaScriptFeatureManagerKeyName[] =
     "web_java_script_feature_manager";
 
-// Adds common features to |world|.
-void AddSharedCommonFeatures(web::JavaScriptContentWorld* world) {
+// Returns the common features which are added to every content world.
+std::vector<const web::JavaScriptFeature*> GetSharedCommonFeatures() {
   // The scripts defined by these features were previously hardcoded into
   // js_compile.gni and are assumed to always exist by other feature javascript
   // (regardless of content world).
   // TODO(crbug.com/1152112): Remove unconditional injection of these features
   // once dependent features are migrated to JavaScriptFeatures and correctly
   // define their dependencies.
-  world->AddFeature(web::java_script_features::GetBaseJavaScriptFeature());
-  world->AddFeature(web::java_script_features::GetCommonJavaScriptFeature());
-  world->AddFeature(web::java_script_features::GetMessageJavaScriptFeature());
+  return {web::java_script_features::GetBaseJavaScriptFeature(),
+          web::java_script_features::GetCommonJavaScriptFeature(),
+          web::java_script_features::GetMessageJavaScriptFeature()};
 }
 
 }  // namespace
@@ -68,25 +70,35 @@ JavaScriptFeatureManager::GetPageContentWorldForBrowserState(
 
 void JavaScriptFeatureManager::ConfigureFeatures(
     std::vector<JavaScriptFeature*> features) {
-  page_content_world_ = std::make_unique<JavaScriptContentWorld>(
-      browser_state_, WKContentWorld.pageWorld);
-  AddSharedCommonFeatures(page_content_world_.get());
-
-  isolated_world_ = std::make_unique<JavaScriptContentWorld>(
-      browser_state_, WKContentWorld.defaultClientWorld);
-  AddSharedCommonFeatures(isolated_world_.get());
-
+  const base::TimeTicks start_time = base::TimeTicks::Now();
+
+  // Features are added to each world at once, so that their scripts can be
+  // bundled together.
+  std::vector<const JavaScriptFeature*> page_world_features =
+      GetSharedCommonFeatures();
+  std::vector<const JavaScriptFeature*> isolated_world_features =
+      GetSharedCommonFeatures();
   for (JavaScriptFeature* feature : features) {
-    if (isolated_world_ &&
-        feature->GetSupportedContentWorld() !=
-            JavaScriptFeature::ContentWorld::kPageContentWorld) {
-      isolated_world_->AddFeature(feature);
+    if (feature->GetSupportedContentWorld() !=
+        JavaScriptFeature::ContentWorld::kPageContentWorld) {
+      isolated_world_features.push_back(feature);
     } else {
       DCHECK_NE(feature->GetSupportedContentWorld(),
                 JavaScriptFeature::ContentWorld::kIsolatedWorldOnly);
-      page_content_world_->AddFeature(feature);
+      page_world_features.push_back(feature);
     }
   }
+
+  page_content_world_ = std::make_unique<JavaScriptContentWorld>(
+      browser_state_, WKContentWorld.pageWorld);
+  page_content_world_->AddFeatures(page_world_features);
+
+  isolated_world_ = std::make_unique<JavaScriptContentWorld>(
+      browser_state_, WKContentWorld.defaultClientWorld);
+  isolated_world_->AddFeatures(isolated_world_features);
+
+  UMA_HISTOGRAM_TIMES("IOS.JavaScriptFeatureManager.ConfigureFeaturesTime",
+                      base::TimeTicks::Now() - start_time);
 }
 
 JavaScriptContentWorld* JavaScriptFeatureManager::GetContentWorldForFeature(
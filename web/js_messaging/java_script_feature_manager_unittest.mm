@@ -36,19 +36,34 @@ class JavaScriptFeatureManagerTest : public web::WebTest {
         .userContentController;
   }
 
+  // Returns the number of scripts bundled in |user_script|, each of them
+  // running in its own function and catching its own exceptions.
+  size_t CountIsolatedScripts(WKUserScript* user_script) {
+    return [user_script.source componentsSeparatedByString:@"} catch (error) {"]
+               .count -
+           1;
+  }
+
   void SetUp() override {
     web::WebTest::SetUp();
     [GetUserContentController() removeAllUserScripts];
   }
 };
 
-// Tests that JavaScriptFeatureManager adds base shared user scripts.
+// Tests that JavaScriptFeatureManager adds base shared user scripts, bundled
+// into a single user script per content world.
 TEST_F(JavaScriptFeatureManagerTest, Configure) {
   ASSERT_TRUE(GetJavaScriptFeatureManager());
   ASSERT_EQ(0ul, [GetUserContentController().userScripts count]);
 
   GetJavaScriptFeatureManager()->ConfigureFeatures({});
-  EXPECT_EQ(6ul, [GetUserContentController().userScripts count]);
+  ASSERT_EQ(2ul, [GetUserContentController().userScripts count]);
+
+  // Each of the three shared scripts is isolated from the others in the
+  // bundle.
+  for (WKUserScript* user_script in GetUserContentController().userScripts) {
+    EXPECT_EQ(3ul, CountIsolatedScripts(user_script));
+  }
 }
 
 // Tests that JavaScriptFeatureManager adds a JavaScriptFeature for all frames
@@ -69,9 +84,11 @@ TEST_F(JavaScriptFeatureManagerTest, AllFramesStartFeature) {
 
   GetJavaScriptFeatureManager()->ConfigureFeatures({feature.get()});
 
-  EXPECT_EQ(7ul, [GetUserContentController().userScripts count]);
+  // The feature script is bundled with the shared scripts of the page content
+  // world.
+  EXPECT_EQ(2ul, [GetUserContentController().userScripts count]);
   WKUserScript* user_script =
-      [GetUserContentController().userScripts lastObject];
+      [GetUserContentController().userScripts firstObject];
   EXPECT_TRUE(
       [user_script.source containsString:@"__gCrWeb.javaScriptFeatureTest"]);
   EXPECT_EQ(WKUserScriptInjectionTimeAtDocumentStart,
@@ -97,7 +114,7 @@ TEST_F(JavaScriptFeatureManagerTest, MainFrameEndFeature) {
 
   GetJavaScriptFeatureManager()->ConfigureFeatures({feature.get()});
 
-  EXPECT_EQ(7ul, [GetUserContentController().userScripts count]);
+  EXPECT_EQ(3ul, [GetUserContentController().userScripts count]);
   WKUserScript* user_script =
       [GetUserContentController().userScripts lastObject];
   EXPECT_TRUE(
@@ -124,7 +141,7 @@ TEST_F(JavaScriptFeatureManagerTest, MainFrameEndFeatureIsolatedWorld) {
 
   GetJavaScriptFeatureManager()->ConfigureFeatures({feature.get()});
 
-  EXPECT_EQ(7ul, [GetUserContentController().userScripts count]);
+  EXPECT_EQ(3ul, [GetUserContentController().userScripts count]);
   WKUserScript* user_script =
       [GetUserContentController().userScripts lastObject];
   EXPECT_TRUE(
@@ -132,3 +149,53 @@ TEST_F(JavaScriptFeatureManagerTest, MainFrameEndFeatureIsolatedWorld) {
   EXPECT_EQ(WKUserScriptInjectionTimeAtDocumentEnd, user_script.injectionTime);
   EXPECT_EQ(YES, user_script.forMainFrameOnly);
 }
+
+// Tests that JavaScriptFeatureManager keeps the dependency order of scripts
+// targeting different frames, and does not bundle them together.
+TEST_F(JavaScriptFeatureManagerTest, DependencyOrder) {
+  ASSERT_TRUE(GetJavaScriptFeatureManager());
+
+  std::vector<const web::JavaScriptFeature::FeatureScript> main_frame_scripts =
+      {web::JavaScriptFeature::FeatureScript::CreateWithFilename(
+          "java_script_feature_test_inject_once",
+          web::JavaScriptFeature::FeatureScript::InjectionTime::kDocumentStart,
+          web::JavaScriptFeature::FeatureScript::TargetFrames::kMainFrame)};
+  web::JavaScriptFeature main_frame_feature(
+      web::JavaScriptFeature::ContentWorld::kPageContentWorld,
+      main_frame_scripts);
+
+  std::vector<const web::JavaScriptFeature::FeatureScript> all_frames_scripts =
+      {web::JavaScriptFeature::FeatureScript::CreateWithFilename(
+          "java_script_feature_test_reinject",
+          web::JavaScriptFeature::FeatureScript::InjectionTime::kDocumentStart,
+          web::JavaScriptFeature::FeatureScript::TargetFrames::kAllFrames,
+          web::JavaScriptFeature::FeatureScript::ReinjectionBehavior::
+              kReinjectOnDocumentRecreation)};
+  web::JavaScriptFeature all_frames_feature(
+      web::JavaScriptFeature::ContentWorld::kPageContentWorld,
+      all_frames_scripts, {&main_frame_feature});
+
+  GetJavaScriptFeatureManager()->ConfigureFeatures({&all_frames_feature});
+
+  // The page content world has the shared scripts, then the main frame
+  // dependency, then the all frames feature. The isolated world only has the
+  // shared scripts.
+  NSArray<WKUserScript*>* user_scripts =
+      GetUserContentController().userScripts;
+  ASSERT_EQ(4ul, [user_scripts count]);
+
+  EXPECT_EQ(3ul, CountIsolatedScripts(user_scripts[0]));
+  EXPECT_EQ(NO, user_scripts[0].forMainFrameOnly);
+
+  EXPECT_EQ(1ul, CountIsolatedScripts(user_scripts[1]));
+  EXPECT_EQ(YES, user_scripts[1].forMainFrameOnly);
+  EXPECT_TRUE([user_scripts[1].source
+      containsString:@"__gCrWeb.javaScriptFeatureTest = {}"]);
+
+  EXPECT_EQ(1ul, CountIsolatedScripts(user_scripts[2]));
+  EXPECT_EQ(NO, user_scripts[2].forMainFrameOnly);
+  EXPECT_TRUE([user_scripts[2].source
+      containsString:@"window.addEventListener('error'"]);
+
+  EXPECT_EQ(3ul, CountIsolatedScripts(user_scripts[3]));
+}
@@ -24,8 +24,10 @@ NSString* GetPageScript(NSString* script_file_name);
 // prevents multiple injections into the same page. |script_identifier| should
 // identify the script being injected in order to enforce the injection of
 // |script| to only once.
-// NOTE: |script_identifier| will be used as the suffix for a JavaScript var, so
-// it must adhere to JavaScript var naming rules.
+// The check uses a property of |window| rather than a var, so that it also
+// works for a script run inside a function.
+// NOTE: |script_identifier| will be used as the suffix for a JavaScript
+// property name, so it must adhere to JavaScript var naming rules.
 NSString* MakeScriptInjectableOnce(NSString* script_identifier,
                                    NSString* script);
 
@@ -19,25 +19,34 @@ namespace web {
 
 NSString* GetPageScript(NSString* script_file_name) {
   DCHECK(script_file_name);
+  // The bundled scripts never change, so they are only read once. The cache
+  // is thread safe and may be purged under memory pressure.
+  static NSCache<NSString*, NSString*>* cache = [[NSCache alloc] init];
+  NSString* content = [cache objectForKey:script_file_name];
+  if (content)
+    return content;
+
   NSString* path =
       [base::mac::FrameworkBundle() pathForResource:script_file_name
                                              ofType:@"js"];
   DCHECK(path) << "Script file not found: "
                << base::SysNSStringToUTF8(script_file_name) << ".js";
   NSError* error = nil;
-  NSString* content = [NSString stringWithContentsOfFile:path
-                                                encoding:NSUTF8StringEncoding
-                                                   error:&error];
+  content = [NSString stringWithContentsOfFile:path
+                                      encoding:NSUTF8StringEncoding
+                                         error:&error];
   DCHECK(!error) << "Error fetching script: "
                  << base::SysNSStringToUTF8(error.description);
   DCHECK(content);
+  if (content)
+    [cache setObject:content forKey:script_file_name];
   return content;
 }
 
 NSString* MakeScriptInjectableOnce(NSString* script_identifier,
                                    NSString* script) {
   NSString* kOnceWrapperTemplate =
-      @"if (typeof %@ === 'undefined') { var %@ = true; %%@ }";
+      @"if (typeof window.%@ === 'undefined') { window.%@ = true; %%@ }";
   NSString* injected_var_name =
       [NSString stringWithFormat:@"_injected_%@", script_identifier];
   NSString* once_wrapper =
@@ -38,6 +38,11 @@ class ScopedWKScriptMessageHandler {
 
   ~ScopedWKScriptMessageHandler();
 
+  // Also registers |script_handler_name|, in the same content world. |callback|
+  // will be called for the post messages to all the registered names, which
+  // can be told apart with WKScriptMessage.name.
+  void AddScriptHandlerName(NSString* script_handler_name);
+
  private:
   // The content world associated with this feature. May be null which
   // represents the main world that the page content itself uses. (May also be
@@ -45,7 +50,7 @@ class ScopedWKScriptMessageHandler {
   WKContentWorld* content_world_ = nullptr;
 
   __weak WKUserContentController* user_content_controller_;
-  NSString* script_handler_name_;
+  NSMutableArray<NSString*>* script_handler_names_;
 
   CRWScriptMessageHandler* script_message_handler_;
 
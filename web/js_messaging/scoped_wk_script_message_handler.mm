@@ -39,14 +39,10 @@ ScopedWKScriptMessageHandler::ScopedWKScriptMessageHandler(
     WKUserContentController* user_content_controller,
     NSString* script_handler_name,
     ScriptMessageCallback callback)
-    : user_content_controller_(user_content_controller),
-      script_handler_name_(script_handler_name),
-      script_message_handler_(
-          [[CRWScriptMessageHandler alloc] initWithCallback:callback]) {
-  DCHECK(callback);
-  [user_content_controller_ addScriptMessageHandler:script_message_handler_
-                                               name:script_handler_name_];
-}
+    : ScopedWKScriptMessageHandler(user_content_controller,
+                                   script_handler_name,
+                                   /*content_world=*/nil,
+                                   callback) {}
 
 ScopedWKScriptMessageHandler::ScopedWKScriptMessageHandler(
     WKUserContentController* user_content_controller,
@@ -55,27 +51,36 @@ ScopedWKScriptMessageHandler::ScopedWKScriptMessageHandler(
     ScriptMessageCallback callback)
     : content_world_(content_world),
       user_content_controller_(user_content_controller),
-      script_handler_name_(script_handler_name),
+      script_handler_names_([NSMutableArray array]),
       script_message_handler_(
           [[CRWScriptMessageHandler alloc] initWithCallback:callback]) {
   DCHECK(callback);
-  if (content_world_) {
-    [user_content_controller_ addScriptMessageHandler:script_message_handler_
-                                         contentWorld:content_world_
-                                                 name:script_handler_name_];
-  } else {
-    [user_content_controller_ addScriptMessageHandler:script_message_handler_
-                                                 name:script_handler_name_];
-  }
+  AddScriptHandlerName(script_handler_name);
 }
 
 ScopedWKScriptMessageHandler::~ScopedWKScriptMessageHandler() {
+  for (NSString* script_handler_name in script_handler_names_) {
+    if (content_world_) {
+      [user_content_controller_
+          removeScriptMessageHandlerForName:script_handler_name
+                               contentWorld:content_world_];
+    } else {
+      [user_content_controller_
+          removeScriptMessageHandlerForName:script_handler_name];
+    }
+  }
+}
+
+void ScopedWKScriptMessageHandler::AddScriptHandlerName(
+    NSString* script_handler_name) {
+  DCHECK(![script_handler_names_ containsObject:script_handler_name]);
+  [script_handler_names_ addObject:script_handler_name];
   if (content_world_) {
-    [user_content_controller_
-        removeScriptMessageHandlerForName:script_handler_name_
-                             contentWorld:content_world_];
+    [user_content_controller_ addScriptMessageHandler:script_message_handler_
+                                         contentWorld:content_world_
+                                                 name:script_handler_name];
   } else {
-    [user_content_controller_
-        removeScriptMessageHandlerForName:script_handler_name_];
+    [user_content_controller_ addScriptMessageHandler:script_message_handler_
+                                                 name:script_handler_name];
   }
 }
@@ -23,8 +23,9 @@ using base::test::ios::WaitUntilConditionOrTimeout;
 
 namespace {
 
-// The test message handler name.
+// The test message handler names.
 static NSString* kScriptHandlerName = @"FakeHandlerName";
+static NSString* kOtherScriptHandlerName = @"OtherFakeHandlerName";
 
 // Script which sends a post message back to the native message handlers.
 // Evaluation will result in true on success, or false if the messageHandler
@@ -54,8 +55,12 @@ class ScopedWKScriptMessageHandlerTest : public WebTestWithWebState {
   }
 
   NSString* GetPostMessageScript() {
+    return GetPostMessageScript(kScriptHandlerName);
+  }
+
+  NSString* GetPostMessageScript(NSString* script_handler_name) {
     return [NSString
-        stringWithFormat:kPostMessageScriptFormat, kScriptHandlerName];
+        stringWithFormat:kPostMessageScriptFormat, script_handler_name];
   }
 };
 
@@ -199,4 +204,36 @@ TEST_F(ScopedWKScriptMessageHandlerTest, ScriptMessageCrossWorldIsolated) {
   EXPECT_FALSE(handler_called);
 }
 
+// Tests that a single ScopedWKScriptMessageHandler receives the messages of
+// all its names, and unregisters all of them on deconstruction.
+TEST_F(ScopedWKScriptMessageHandlerTest, MultipleNames) {
+  __block NSMutableArray<NSString*>* received_names = [NSMutableArray array];
+
+  std::unique_ptr<ScopedWKScriptMessageHandler> scoped_handler =
+      std::make_unique<ScopedWKScriptMessageHandler>(
+          GetUserContentController(), kScriptHandlerName,
+          base::BindRepeating(^(WKScriptMessage* callback_message) {
+            [received_names addObject:callback_message.name];
+          }));
+  scoped_handler->AddScriptHandlerName(kOtherScriptHandlerName);
+
+  ASSERT_TRUE(LoadHtml("<p>"));
+
+  ASSERT_TRUE([ExecuteJavaScript(GetPostMessageScript()) boolValue]);
+  ASSERT_TRUE(
+      [ExecuteJavaScript(GetPostMessageScript(kOtherScriptHandlerName))
+          boolValue]);
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(kWaitForJSCompletionTimeout, ^bool {
+    return received_names.count == 2;
+  }));
+  EXPECT_NSEQ((@[ kScriptHandlerName, kOtherScriptHandlerName ]),
+              received_names);
+
+  scoped_handler.reset();
+  EXPECT_FALSE([ExecuteJavaScript(GetPostMessageScript()) boolValue]);
+  EXPECT_FALSE(
+      [ExecuteJavaScript(GetPostMessageScript(kOtherScriptHandlerName))
+          boolValue]);
+}
+
 }  // namespace web
@@ -0,0 +1,131 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/navigation/interned_url.h"
+
+#include <set>
+#include <string>
+#include <tuple>
+
+#include "base/check_op.h"
+#include "base/memory/ref_counted.h"
+#include "base/no_destructor.h"
+#include "base/sequence_checker.h"
+
+namespace web {
+
+class InternedURL::Entry : public base::RefCounted<Entry> {
+ public:
+  Entry(const Entry&) = delete;
+  Entry& operator=(const Entry&) = delete;
+
+  // Returns the entry shared for |url|, creating it if needed.
+  static scoped_refptr<Entry> Get(const GURL& url) {
+    Registry& registry = GetRegistry();
+    DCHECK_CALLED_ON_VALID_SEQUENCE(registry.sequence_checker);
+    Set& entries = registry.entries;
+    auto it = entries.find(url);
+    if (it != entries.end())
+      return base::WrapRefCounted(*it);
+    scoped_refptr<Entry> entry = base::WrapRefCounted(new Entry(url));
+    entries.insert(entry.get());
+    return entry;
+  }
+
+  // Returns the number of entries currently shared.
+  static size_t GetCount() { return GetRegistry().entries.size(); }
+
+  const GURL& url() const { return url_; }
+
+ private:
+  friend class base::RefCounted<Entry>;
+
+  // Orders the entries by URL, and allows to look them up with a GURL. The
+  // validity is compared too, as an invalid GURL may have the spec of a valid
+  // one.
+  struct Less {
+    using is_transparent = void;
+
+    static std::tuple<const std::string&, bool> Key(const GURL& url) {
+      return std::tuple<const std::string&, bool>(url.possibly_invalid_spec(),
+                                                  url.is_valid());
+    }
+
+    bool operator()(const Entry* lhs, const Entry* rhs) const {
+      return Key(lhs->url_) < Key(rhs->url_);
+    }
+    bool operator()(const Entry* lhs, const GURL& rhs) const {
+      return Key(lhs->url_) < Key(rhs);
+    }
+    bool operator()(const GURL& lhs, const Entry* rhs) const {
+      return Key(lhs) < Key(rhs->url_);
+    }
+  };
+
+  using Set = std::set<Entry*, Less>;
+
+  // The entries currently shared. The entries are not owned by the set, and
+  // remove themselves from it when destroyed. The set is not thread safe, so
+  // the entries must be created and released on a single sequence. That
+  // sequence may change once no entry is left, e.g. between unit tests.
+  struct Registry {
+    Set entries;
+    SEQUENCE_CHECKER(sequence_checker);
+  };
+
+  static Registry& GetRegistry() {
+    static base::NoDestructor<Registry> registry;
+    return *registry;
+  }
+
+  explicit Entry(const GURL& url) : url_(url) {}
+
+  ~Entry() {
+    Registry& registry = GetRegistry();
+    DCHECK_CALLED_ON_VALID_SEQUENCE(registry.sequence_checker);
+    size_t erased = registry.entries.erase(this);
+    DCHECK_EQ(1u, erased);
+    if (registry.entries.empty())
+      DETACH_FROM_SEQUENCE(registry.sequence_checker);
+  }
+
+  const GURL url_;
+};
+
+InternedURL::InternedURL() = default;
+
+InternedURL::InternedURL(const GURL& url) {
+  if (url.is_empty())
+    return;
+
+  entry_ = Entry::Get(url);
+}
+
+InternedURL::InternedURL(const InternedURL& other) = default;
+
+InternedURL& InternedURL::operator=(const InternedURL& other) = default;
+
+InternedURL::~InternedURL() = default;
+
+const GURL& InternedURL::get() const {
+  return entry_ ? entry_->url() : GURL::EmptyGURL();
+}
+
+// static
+size_t InternedURL::GetInternedURLCountForTesting() {
+  return Entry::GetCount();
+}
+
+size_t EstimateURLMemoryUsage(const GURL& url) {
+  size_t usage = sizeof(GURL);
+  // Short specs are stored inline by std::string.
+  const size_t spec_capacity = url.possibly_invalid_spec().capacity();
+  if (spec_capacity > std::string().capacity())
+    usage += spec_capacity + 1;
+  if (url.inner_url())
+    usage += EstimateURLMemoryUsage(*url.inner_url());
+  return usage;
+}
+
+}  // namespace web
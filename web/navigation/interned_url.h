@@ -0,0 +1,61 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_NAVIGATION_INTERNED_URL_H_
+#define IOS_WEB_NAVIGATION_INTERNED_URL_H_
+
+#include <stddef.h>
+
+#include "base/memory/scoped_refptr.h"
+#include "url/gurl.h"
+
+namespace web {
+
+// Holds a GURL which is shared by all the InternedURLs created from an equal
+// GURL, so that the NavigationItems of all the session histories keep a
+// single copy of each URL. The shared GURL is destroyed with the last
+// InternedURL referring to it. Empty URLs are not interned.
+//
+// InternedURLs must only be used on the UI thread, like NavigationItems. This
+// is checked when GURLs are shared and released.
+class InternedURL {
+ public:
+  InternedURL();
+  explicit InternedURL(const GURL& url);
+  InternedURL(const InternedURL& other);
+  InternedURL& operator=(const InternedURL& other);
+  ~InternedURL();
+
+  // Returns the URL, or an empty GURL.
+  const GURL& get() const;
+
+  bool is_empty() const { return !entry_; }
+
+  // Returns an identifier of the shared GURL, or null if empty. Used to count
+  // the memory of each shared GURL once.
+  const void* id() const { return entry_.get(); }
+
+  // As URLs are interned, equal URLs share the same GURL.
+  bool operator==(const InternedURL& other) const {
+    return entry_ == other.entry_;
+  }
+  bool operator!=(const InternedURL& other) const { return !(*this == other); }
+
+  // Returns the number of GURLs currently shared.
+  static size_t GetInternedURLCountForTesting();
+
+ private:
+  class Entry;
+
+  scoped_refptr<Entry> entry_;
+
+  // Copy and assignment is explicitly allowed for this class.
+};
+
+// Returns the estimated memory used by |url|, including its spec.
+size_t EstimateURLMemoryUsage(const GURL& url);
+
+}  // namespace web
+
+#endif  // IOS_WEB_NAVIGATION_INTERNED_URL_H_
@@ -0,0 +1,62 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/navigation/interned_url.h"
+
+#include <memory>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+namespace web {
+namespace {
+
+using InternedURLTest = PlatformTest;
+
+// Tests that equal URLs share a GURL, which is destroyed with the last
+// InternedURL referring to it.
+TEST_F(InternedURLTest, Sharing) {
+  const size_t initial_count = InternedURL::GetInternedURLCountForTesting();
+  auto url = std::make_unique<InternedURL>(GURL("http://a.test/"));
+  InternedURL same_url(GURL("http://a.test/"));
+  InternedURL other_url(GURL("http://b.test/"));
+  EXPECT_EQ(initial_count + 2, InternedURL::GetInternedURLCountForTesting());
+
+  EXPECT_EQ(*url, same_url);
+  EXPECT_EQ(&url->get(), &same_url.get());
+  EXPECT_EQ(url->id(), same_url.id());
+  EXPECT_NE(*url, other_url);
+  EXPECT_EQ(GURL("http://b.test/"), other_url.get());
+
+  url.reset();
+  EXPECT_EQ(initial_count + 2, InternedURL::GetInternedURLCountForTesting());
+  EXPECT_EQ(GURL("http://a.test/"), same_url.get());
+
+  same_url = other_url;
+  EXPECT_EQ(initial_count + 1, InternedURL::GetInternedURLCountForTesting());
+  EXPECT_EQ(&other_url.get(), &same_url.get());
+}
+
+// Tests that empty URLs are not interned.
+TEST_F(InternedURLTest, Empty) {
+  const size_t initial_count = InternedURL::GetInternedURLCountForTesting();
+  InternedURL url((GURL()));
+  EXPECT_TRUE(url.is_empty());
+  EXPECT_FALSE(url.id());
+  EXPECT_TRUE(url.get().is_empty());
+  EXPECT_EQ(InternedURL(), url);
+  EXPECT_EQ(initial_count, InternedURL::GetInternedURLCountForTesting());
+}
+
+// Tests that an invalid URL does not share the GURL of a valid one.
+TEST_F(InternedURLTest, InvalidURL) {
+  InternedURL valid_url(GURL("http://a.test/"));
+  InternedURL invalid_url(GURL("a.test"));
+  EXPECT_NE(valid_url, invalid_url);
+  EXPECT_TRUE(valid_url.get().is_valid());
+  EXPECT_FALSE(invalid_url.get().is_valid());
+}
+
+}  // namespace
+}  // namespace web
@@ -7,10 +7,14 @@
 
 #import <Foundation/Foundation.h>
 
+#include <stddef.h>
+
 #include <memory>
+#include <set>
 #include <string>
 
 #include "base/time/time.h"
+#include "ios/web/navigation/interned_url.h"
 #include "ios/web/public/favicon/favicon_status.h"
 #import "ios/web/public/navigation/navigation_item.h"
 #include "ios/web/public/navigation/referrer.h"
@@ -118,6 +122,16 @@ class NavigationItemImpl : public web::NavigationItem {
   // Restores the state of the |other| navigation item in this item.
   void RestoreStateFromItem(NavigationItem* other);
 
+  // Returns the estimated memory used by this item. The interned URLs whose id
+  // is in |counted_urls| are not counted, and the others are added to it, so
+  // that the URLs shared by several items are counted once.
+  size_t EstimateMemoryUsage(std::set<const void*>* counted_urls) const;
+
+  // Returns the estimated memory that this item would use if each of its URLs
+  // was a GURL of its own, and if its referrer, favicon status and SSL status
+  // were always allocated. Used to report the savings of the compact storage.
+  size_t EstimateUncompactedMemoryUsage() const;
+
 #ifndef NDEBUG
   // Returns a human-readable description of the state for debugging purposes.
   NSString* GetDescription() const;
@@ -128,16 +142,26 @@ class NavigationItemImpl : public web::NavigationItem {
   // private variables of NavigationItemImpl.
   friend NavigationItemStorageBuilder;
 
+  // Returns the estimated memory used by the fields which are stored the same
+  // way by EstimateMemoryUsage() and EstimateUncompactedMemoryUsage().
+  size_t EstimateCommonMemoryUsage() const;
+
   int unique_id_;
-  GURL original_request_url_;
-  GURL url_;
-  Referrer referrer_;
-  GURL virtual_url_;
+  // The URLs are interned, so they share a single GURL with the equal URLs of
+  // all the items. |original_request_url_| is usually equal to |url_|.
+  // |virtual_url_| is empty when it is equal to |url_|.
+  InternedURL original_request_url_;
+  InternedURL url_;
+  InternedURL virtual_url_;
+  // Only allocated when set to a non default value.
+  std::unique_ptr<Referrer> referrer_;
   std::u16string title_;
   PageDisplayState page_display_state_;
   ui::PageTransition transition_type_;
-  FaviconStatus favicon_status_;
-  SSLStatus ssl_;
+  // Only allocated once set, as most items of a restored session never get a
+  // favicon nor an SSL status.
+  std::unique_ptr<FaviconStatus> favicon_status_;
+  std::unique_ptr<SSLStatus> ssl_;
   base::Time timestamp_;
   UserAgentType user_agent_type_;
   NSMutableDictionary* http_request_headers_;
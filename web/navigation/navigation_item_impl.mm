@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "base/check_op.h"
+#include "base/no_destructor.h"
 #include "base/strings/utf_string_conversions.h"
 #include "components/url_formatter/url_formatter.h"
 #include "ios/web/common/features.h"
@@ -32,6 +33,34 @@ static int GetUniqueIDInConstructor() {
   return ++unique_id_counter;
 }
 
+// Returns a copy of |*value|, or null if |value| is null.
+template <typename T>
+std::unique_ptr<T> CopyIfSet(const std::unique_ptr<T>& value) {
+  return value ? std::make_unique<T>(*value) : nullptr;
+}
+
+// Returns the memory used by the spec of |url|, not counting the GURL itself.
+size_t EstimateURLSpecMemoryUsage(const GURL& url) {
+  return web::EstimateURLMemoryUsage(url) - sizeof(GURL);
+}
+
+// Returns the referrer, favicon status and SSL status of the items which have
+// none allocated.
+const web::Referrer& GetDefaultReferrer() {
+  static const base::NoDestructor<web::Referrer> referrer;
+  return *referrer;
+}
+
+const web::FaviconStatus& GetDefaultFaviconStatus() {
+  static const base::NoDestructor<web::FaviconStatus> favicon_status;
+  return *favicon_status;
+}
+
+const web::SSLStatus& GetDefaultSSLStatus() {
+  static const base::NoDestructor<web::SSLStatus> ssl_status;
+  return *ssl_status;
+}
+
 }  // namespace
 
 namespace web {
@@ -65,13 +94,13 @@ NavigationItemImpl::NavigationItemImpl(const NavigationItemImpl& item)
     : unique_id_(item.unique_id_),
       original_request_url_(item.original_request_url_),
       url_(item.url_),
-      referrer_(item.referrer_),
       virtual_url_(item.virtual_url_),
+      referrer_(CopyIfSet(item.referrer_)),
       title_(item.title_),
       page_display_state_(item.page_display_state_),
       transition_type_(item.transition_type_),
-      favicon_status_(item.favicon_status_),
-      ssl_(item.ssl_),
+      favicon_status_(CopyIfSet(item.favicon_status_)),
+      ssl_(CopyIfSet(item.ssl_)),
       timestamp_(item.timestamp_),
       user_agent_type_(item.user_agent_type_),
       http_request_headers_([item.http_request_headers_ mutableCopy]),
@@ -91,37 +120,41 @@ int NavigationItemImpl::GetUniqueID() const {
 }
 
 void NavigationItemImpl::SetOriginalRequestURL(const GURL& url) {
-  original_request_url_ = url;
+  original_request_url_ = InternedURL(url);
 }
 
 const GURL& NavigationItemImpl::GetOriginalRequestURL() const {
-  return original_request_url_;
+  return original_request_url_.get();
 }
 
 void NavigationItemImpl::SetURL(const GURL& url) {
-  url_ = url;
+  url_ = InternedURL(url);
   cached_display_title_.clear();
 }
 
 const GURL& NavigationItemImpl::GetURL() const {
-  return url_;
+  return url_.get();
 }
 
 void NavigationItemImpl::SetReferrer(const web::Referrer& referrer) {
-  referrer_ = referrer;
+  if (referrer.url.is_empty() && referrer.policy == ReferrerPolicyDefault) {
+    referrer_.reset();
+    return;
+  }
+  referrer_ = std::make_unique<Referrer>(referrer);
 }
 
 const web::Referrer& NavigationItemImpl::GetReferrer() const {
-  return referrer_;
+  return referrer_ ? *referrer_ : GetDefaultReferrer();
 }
 
 void NavigationItemImpl::SetVirtualURL(const GURL& url) {
-  virtual_url_ = (url == url_) ? GURL() : url;
+  virtual_url_ = (url == url_.get()) ? InternedURL() : InternedURL(url);
   cached_display_title_.clear();
 }
 
 const GURL& NavigationItemImpl::GetVirtualURL() const {
-  return virtual_url_.is_empty() ? url_ : virtual_url_;
+  return virtual_url_.is_empty() ? url_.get() : virtual_url_.get();
 }
 
 void NavigationItemImpl::SetTitle(const std::u16string& title) {
@@ -175,19 +208,22 @@ ui::PageTransition NavigationItemImpl::GetTransitionType() const {
 }
 
 const FaviconStatus& NavigationItemImpl::GetFaviconStatus() const {
-  return favicon_status_;
+  return favicon_status_ ? *favicon_status_ : GetDefaultFaviconStatus();
 }
 
 void NavigationItemImpl::SetFaviconStatus(const FaviconStatus& favicon_status) {
-  favicon_status_ = favicon_status;
+  favicon_status_ = std::make_unique<FaviconStatus>(favicon_status);
 }
 
 const SSLStatus& NavigationItemImpl::GetSSL() const {
-  return ssl_;
+  return ssl_ ? *ssl_ : GetDefaultSSLStatus();
 }
 
 SSLStatus& NavigationItemImpl::GetSSL() {
-  return ssl_;
+  // The caller may modify the status, so it is allocated now.
+  if (!ssl_)
+    ssl_ = std::make_unique<SSLStatus>();
+  return *ssl_;
 }
 
 void NavigationItemImpl::SetTimestamp(base::Time timestamp) {
@@ -320,7 +356,7 @@ void NavigationItemImpl::RestoreStateFromItem(NavigationItem* other) {
   if (other->GetUserAgentType() != UserAgentType::NONE) {
     SetUserAgentType(other->GetUserAgentType());
   }
-  if (url_ == other->GetURL()) {
+  if (GetURL() == other->GetURL()) {
     SetPageDisplayState(other->GetPageDisplayState());
     SetVirtualURL(other->GetVirtualURL());
   }
@@ -345,6 +381,49 @@ std::u16string NavigationItemImpl::GetDisplayTitleForURL(const GURL& url) {
   return title;
 }
 
+size_t NavigationItemImpl::EstimateMemoryUsage(
+    std::set<const void*>* counted_urls) const {
+  DCHECK(counted_urls);
+  size_t usage = sizeof(*this) + EstimateCommonMemoryUsage();
+  for (const InternedURL* url :
+       {&original_request_url_, &url_, &virtual_url_}) {
+    if (!url->is_empty() && counted_urls->insert(url->id()).second)
+      usage += EstimateURLMemoryUsage(url->get());
+  }
+  if (referrer_)
+    usage += sizeof(Referrer) + EstimateURLSpecMemoryUsage(referrer_->url);
+  if (favicon_status_) {
+    usage += sizeof(FaviconStatus) +
+             EstimateURLSpecMemoryUsage(favicon_status_->url);
+  }
+  if (ssl_)
+    usage += sizeof(SSLStatus) + ssl_->cert_status_host.capacity();
+  return usage;
+}
+
+size_t NavigationItemImpl::EstimateUncompactedMemoryUsage() const {
+  const size_t compact_fields_size =
+      3 * sizeof(InternedURL) + sizeof(referrer_) + sizeof(favicon_status_) +
+      sizeof(ssl_);
+  const size_t inline_fields_size = 3 * sizeof(GURL) + sizeof(Referrer) +
+                                    sizeof(FaviconStatus) + sizeof(SSLStatus);
+  const FaviconStatus& favicon_status = GetFaviconStatus();
+  return sizeof(*this) - compact_fields_size + inline_fields_size +
+         EstimateCommonMemoryUsage() +
+         EstimateURLSpecMemoryUsage(original_request_url_.get()) +
+         EstimateURLSpecMemoryUsage(url_.get()) +
+         EstimateURLSpecMemoryUsage(virtual_url_.get()) +
+         EstimateURLSpecMemoryUsage(GetReferrer().url) +
+         EstimateURLSpecMemoryUsage(favicon_status.url) +
+         GetSSL().cert_status_host.capacity();
+}
+
+size_t NavigationItemImpl::EstimateCommonMemoryUsage() const {
+  return (title_.capacity() + cached_display_title_.capacity()) *
+             sizeof(char16_t) +
+         post_data_.length;
+}
+
 #ifndef NDEBUG
 NSString* NavigationItemImpl::GetDescription() const {
   return [NSString
@@ -355,8 +434,9 @@ NSString* NavigationItemImpl::GetDescription() const {
            "is_created_from_hash_change: %@ "
            "navigation_initiation_type: %d "
            "https_upgrade_type: %s",
-          url_.spec().c_str(), virtual_url_.spec().c_str(),
-          original_request_url_.spec().c_str(), referrer_.url.spec().c_str(),
+          url_.get().spec().c_str(), virtual_url_.get().spec().c_str(),
+          original_request_url_.get().spec().c_str(),
+          GetReferrer().url.spec().c_str(),
           base::UTF16ToUTF8(title_).c_str(), transition_type_,
           page_display_state_.GetDescription(),
           GetUserAgentTypeDescription(user_agent_type_).c_str(),
@@ -5,6 +5,8 @@
 #import "ios/web/navigation/navigation_item_impl.h"
 
 #include <memory>
+#include <set>
+#include <string>
 
 #include "base/strings/utf_string_conversions.h"
 #include "ios/web/navigation/wk_navigation_util.h"
@@ -223,5 +225,75 @@ TEST_F(NavigationItemTest, RestoreState) {
   EXPECT_EQ(other_item2.GetVirtualURL(), item_->GetVirtualURL());
 }
 
+// Tests that the items share a single GURL for equal URLs.
+TEST_F(NavigationItemTest, InternedURLs) {
+  // The original request URL of |item_| is equal to its URL.
+  EXPECT_EQ(&item_->GetURL(), &item_->GetOriginalRequestURL());
+
+  NavigationItemImpl other_item;
+  other_item.SetURL(GURL(kItemURLString));
+  EXPECT_EQ(&item_->GetURL(), &other_item.GetURL());
+
+  web::NavigationItemImpl copy(*item_);
+  EXPECT_EQ(&item_->GetURL(), &copy.GetURL());
+
+  // Changing the URL of an item does not change the other items.
+  other_item.SetURL(GURL("http://other.test"));
+  EXPECT_EQ(GURL(kItemURLString), item_->GetURL());
+  EXPECT_EQ(GURL("http://other.test"), other_item.GetURL());
+}
+
+// Tests that the referrer, favicon status and SSL status are only allocated
+// once set.
+TEST_F(NavigationItemTest, LazilyAllocatedFields) {
+  std::set<const void*> counted_urls;
+  const size_t default_usage = item_->EstimateMemoryUsage(&counted_urls);
+  EXPECT_TRUE(item_->GetReferrer().url.is_empty());
+  EXPECT_EQ(ReferrerPolicyDefault, item_->GetReferrer().policy);
+  EXPECT_FALSE(item_->GetFaviconStatus().valid);
+  const NavigationItemImpl* const_item = item_.get();
+  EXPECT_EQ(SECURITY_STYLE_UNKNOWN, const_item->GetSSL().security_style);
+
+  // Reading the fields does not allocate them.
+  counted_urls.clear();
+  EXPECT_EQ(default_usage, item_->EstimateMemoryUsage(&counted_urls));
+
+  const GURL referrer_url("http://referrer.test");
+  item_->SetReferrer(Referrer(referrer_url, ReferrerPolicyAlways));
+  item_->GetSSL().security_style = SECURITY_STYLE_AUTHENTICATED;
+  EXPECT_EQ(referrer_url, item_->GetReferrer().url);
+  EXPECT_EQ(SECURITY_STYLE_AUTHENTICATED, const_item->GetSSL().security_style);
+  counted_urls.clear();
+  EXPECT_LT(default_usage, item_->EstimateMemoryUsage(&counted_urls));
+
+  // The copies have their own fields.
+  web::NavigationItemImpl copy(*item_);
+  copy.GetSSL().security_style = SECURITY_STYLE_UNAUTHENTICATED;
+  EXPECT_EQ(SECURITY_STYLE_AUTHENTICATED, const_item->GetSSL().security_style);
+  EXPECT_EQ(referrer_url, copy.GetReferrer().url);
+}
+
+// Tests that the URLs shared by several items are counted once, and that the
+// compact storage uses less memory than the uncompacted one.
+TEST_F(NavigationItemTest, EstimateMemoryUsage) {
+  const GURL long_url(std::string("http://long.test/") +
+                      std::string(200, 'a'));
+  item_->SetURL(long_url);
+  item_->SetOriginalRequestURL(long_url);
+  NavigationItemImpl other_item;
+  other_item.SetURL(long_url);
+
+  std::set<const void*> counted_urls;
+  const size_t item_usage = item_->EstimateMemoryUsage(&counted_urls);
+  EXPECT_EQ(1u, counted_urls.size());
+  const size_t other_item_usage =
+      other_item.EstimateMemoryUsage(&counted_urls);
+  EXPECT_EQ(1u, counted_urls.size());
+  EXPECT_LT(other_item_usage, item_usage);
+
+  EXPECT_LT(item_usage, item_->EstimateUncompactedMemoryUsage());
+  EXPECT_LT(other_item_usage, other_item.EstimateUncompactedMemoryUsage());
+}
+
 }  // namespace
 }  // namespace web
@@ -46,7 +46,7 @@ NavigationItemStorageBuilder::BuildNavigationItemImpl(
   // and the non-virtual URL to be set upon NavigationItem creation.  Since
   // GetVirtualURL() returns |url_| for the non-overridden case, this will also
   // update the virtual URL reported by this object.
-  item->original_request_url_ = navigation_item_storage.URL;
+  item->original_request_url_ = InternedURL(navigation_item_storage.URL);
 
   // In the cases where the URL to be restored is not an HTTP URL, it very
   // probable that we can't restore the page (for example for files, either
@@ -60,7 +60,7 @@ NavigationItemStorageBuilder::BuildNavigationItemImpl(
     item->SetURL(navigation_item_storage.virtualURL);
   }
 
-  item->referrer_ = navigation_item_storage.referrer;
+  item->SetReferrer(navigation_item_storage.referrer);
   item->timestamp_ = navigation_item_storage.timestamp;
   item->title_ = navigation_item_storage.title;
   item->page_display_state_ = navigation_item_storage.displayState;
@@ -41,6 +41,12 @@ extern const char kRestoreNavigationItemCount[];
 // restoration.
 extern const char kRestoreNavigationTime[];
 
+// Names of UMA histograms to log the estimated memory used by the items
+// Navigation Manager was requested to restore, and the memory they would use
+// without interned URLs nor lazily allocated fields.
+extern const char kRestoreNavigationItemsMemoryUsage[];
+extern const char kRestoreNavigationItemsUncompactedMemoryUsage[];
+
 // Defines the ways how a pending navigation can be initiated.
 enum class NavigationInitiationType {
   // Navigation initiation type is only valid for pending navigations, use NONE
@@ -356,6 +362,10 @@ class NavigationManagerImpl : public NavigationManager {
   // items.
   void WillRestore(size_t item_count);
 
+  // Logs the estimated memory used by the navigation |items| to restore.
+  void RecordRestoredItemsMemoryUsage(
+      const std::vector<std::unique_ptr<NavigationItem>>& items) const;
+
   // Some app-specific URLs need to be rewritten to about: scheme.
   void RewriteItemURLIfNecessary(NavigationItem* item) const;
 
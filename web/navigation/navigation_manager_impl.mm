@@ -7,6 +7,7 @@
 #import <Foundation/Foundation.h>
 #include <algorithm>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "base/bind.h"
@@ -15,6 +16,7 @@
 #include "base/logging.h"
 #include "base/mac/bundle_locations.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/numerics/checked_math.h"
 #include "base/strings/string_util.h"
@@ -60,6 +62,10 @@ namespace web {
 
 const char kRestoreNavigationItemCount[] = "IOS.RestoreNavigationItemCount";
 const char kRestoreNavigationTime[] = "IOS.RestoreNavigationTime";
+const char kRestoreNavigationItemsMemoryUsage[] =
+    "IOS.RestoreNavigationItemsMemoryUsage";
+const char kRestoreNavigationItemsUncompactedMemoryUsage[] =
+    "IOS.RestoreNavigationItemsUncompactedMemoryUsage";
 
 NavigationManager::WebLoadParams::WebLoadParams(const GURL& url)
     : url(url),
@@ -909,6 +915,7 @@ void NavigationManagerImpl::Restore(
     std::vector<std::unique_ptr<NavigationItem>> items) {
   DCHECK(!is_restore_session_in_progress_);
   WillRestore(items.size());
+  RecordRestoredItemsMemoryUsage(items);
 
   DCHECK_LT(last_committed_item_index, static_cast<int>(items.size()));
   DCHECK(items.empty() || last_committed_item_index >= 0);
@@ -1153,6 +1160,24 @@ void NavigationManagerImpl::WillRestore(size_t item_count) {
   UMA_HISTOGRAM_COUNTS_100(kRestoreNavigationItemCount, item_count);
 }
 
+void NavigationManagerImpl::RecordRestoredItemsMemoryUsage(
+    const std::vector<std::unique_ptr<NavigationItem>>& items) const {
+  // The URLs shared by several items of the session are counted once.
+  std::set<const void*> counted_urls;
+  size_t memory_usage = 0;
+  size_t uncompacted_memory_usage = 0;
+  for (const std::unique_ptr<NavigationItem>& item : items) {
+    const NavigationItemImpl* item_impl =
+        static_cast<const NavigationItemImpl*>(item.get());
+    memory_usage += item_impl->EstimateMemoryUsage(&counted_urls);
+    uncompacted_memory_usage += item_impl->EstimateUncompactedMemoryUsage();
+  }
+  base::UmaHistogramMemoryKB(kRestoreNavigationItemsMemoryUsage,
+                             memory_usage / 1024);
+  base::UmaHistogramMemoryKB(kRestoreNavigationItemsUncompactedMemoryUsage,
+                             uncompacted_memory_usage / 1024);
+}
+
 void NavigationManagerImpl::RewriteItemURLIfNecessary(
     NavigationItem* item) const {
   GURL url = item->GetURL();
@@ -29,7 +29,8 @@ size_t GetCertPolicyBytesEncoded();
 
 }  // namespace web
 
-// A serializable representation of a certificate.
+// A serializable representation of a certificate. Two storages are equal if
+// they have the same certificate, host and status.
 @interface CRWSessionCertificateStorage : NSObject <NSCoding>
 
 // Designated initializer.
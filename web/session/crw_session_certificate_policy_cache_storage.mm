@@ -4,6 +4,10 @@
 
 #import "ios/web/public/session/crw_session_certificate_policy_cache_storage.h"
 
+#include <string.h>
+
+#include <functional>
+
 #import "base/strings/sys_string_conversions.h"
 #include "net/base/hash_value.h"
 #include "net/cert/x509_certificate.h"
@@ -66,6 +70,9 @@ size_t GetCertPolicyBytesEncoded() {
   // Backing objects for properties of the same name.
   scoped_refptr<net::X509Certificate> _certificate;
   std::string _host;
+  // Fingerprint of |_certificate|, which addresses the storage with its host
+  // and status.
+  net::SHA256HashValue _fingerprint;
 }
 
 // Initializes the CRWSessionCertificateStorage using decoded values.  Can
@@ -95,10 +102,31 @@ size_t GetCertPolicyBytesEncoded() {
     _certificate = cert;
     _host = host;
     _status = status;
+    _fingerprint = _certificate->CalculateChainFingerprint256();
   }
   return self;
 }
 
+#pragma mark NSObject
+
+- (BOOL)isEqual:(id)object {
+  if (self == object)
+    return YES;
+  if (![object isKindOfClass:[CRWSessionCertificateStorage class]])
+    return NO;
+  CRWSessionCertificateStorage* other =
+      static_cast<CRWSessionCertificateStorage*>(object);
+  return _fingerprint == other->_fingerprint && _host == other->_host &&
+         _status == other->_status;
+}
+
+- (NSUInteger)hash {
+  // The fingerprint is a cryptographic hash, so any of its bytes can be used.
+  NSUInteger fingerprintHash = 0;
+  memcpy(&fingerprintHash, _fingerprint.data, sizeof(fingerprintHash));
+  return fingerprintHash ^ std::hash<std::string>()(_host) ^ _status;
+}
+
 #pragma mark Accessors
 
 - (net::X509Certificate*)certificate {
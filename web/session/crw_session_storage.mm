@@ -156,7 +156,7 @@ NSString* const kTabIdKey = @"TabId";
                forKey:kCertificatePolicyCacheStorageKey];
   base::UmaHistogramCounts100000(
       "Session.WebStates.SerializedCertPolicyCacheSize",
-      web::GetCertPolicyBytesEncoded() - previous_cert_policy_bytes / 1024);
+      (web::GetCertPolicyBytesEncoded() - previous_cert_policy_bytes) / 1024);
 
   if (_userData) {
     [coder encodeObject:_userData forKey:kSerializedUserDataKey];
@@ -15,6 +15,8 @@ class X509Certificate;
 
 namespace web {
 
+class SessionCertificatePolicyStore;
+
 // Concrete implementation of SessionCertificatePolicyCache.
 class SessionCertificatePolicyCacheImpl : public SessionCertificatePolicyCache {
  public:
@@ -35,11 +37,15 @@ class SessionCertificatePolicyCacheImpl : public SessionCertificatePolicyCache {
       const std::string& host,
       net::CertStatus status) override;
 
-  // Allows for batch updating the allowed certificate storages.
+  // Allows for batch updating the allowed certificate storages. The storages
+  // are replaced by the equal ones of the SessionCertificatePolicyStore.
   void SetAllowedCerts(NSSet* allowed_certs);
   NSSet* GetAllowedCerts() const;
 
  private:
+  // The store of the BrowserState, which shares the storages between sessions.
+  SessionCertificatePolicyStore* store_;
+
   // An set of CRWSessionCertificateStorages representing allowed certs.
   NSMutableSet* allowed_certs_;
 };
@@ -8,6 +8,7 @@
 #include "ios/web/public/browser_state.h"
 #include "ios/web/public/security/certificate_policy_cache.h"
 #import "ios/web/public/session/crw_session_certificate_policy_cache_storage.h"
+#import "ios/web/session/session_certificate_policy_store.h"
 #include "ios/web/public/thread/web_task_traits.h"
 #include "ios/web/public/thread/web_thread.h"
 #include "net/cert/x509_util.h"
@@ -51,6 +52,7 @@ namespace web {
 SessionCertificatePolicyCacheImpl::SessionCertificatePolicyCacheImpl(
     BrowserState* browser_state)
     : SessionCertificatePolicyCache(browser_state),
+      store_(SessionCertificatePolicyStore::FromBrowserState(browser_state)),
       allowed_certs_([[NSMutableSet alloc] init]) {}
 
 SessionCertificatePolicyCacheImpl::~SessionCertificatePolicyCacheImpl() {}
@@ -87,10 +89,11 @@ void SessionCertificatePolicyCacheImpl::RegisterAllowedCertificate(
   }
   DCHECK(certificate->intermediate_buffers().empty());
 
-  [allowed_certs_ addObject:[[CRWSessionCertificateStorage alloc]
-                                initWithCertificate:certificate
-                                               host:host
-                                             status:status]];
+  CRWSessionCertificateStorage* storage =
+      [[CRWSessionCertificateStorage alloc] initWithCertificate:certificate
+                                                           host:host
+                                                         status:status];
+  [allowed_certs_ addObject:store_->GetSharedStorage(storage)];
   const scoped_refptr<CertificatePolicyCache> cache =
       GetCertificatePolicyCache();
   GetIOThreadTaskRunner({})->PostTask(
@@ -100,7 +103,9 @@ void SessionCertificatePolicyCacheImpl::RegisterAllowedCertificate(
 }
 
 void SessionCertificatePolicyCacheImpl::SetAllowedCerts(NSSet* allowed_certs) {
-  allowed_certs_ = [allowed_certs mutableCopy];
+  allowed_certs_ = [[NSMutableSet alloc] initWithCapacity:allowed_certs.count];
+  for (CRWSessionCertificateStorage* cert in allowed_certs)
+    [allowed_certs_ addObject:store_->GetSharedStorage(cert)];
 }
 
 NSSet* SessionCertificatePolicyCacheImpl::GetAllowedCerts() const {
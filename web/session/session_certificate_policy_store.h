@@ -0,0 +1,57 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_SESSION_SESSION_CERTIFICATE_POLICY_STORE_H_
+#define IOS_WEB_SESSION_SESSION_CERTIFICATE_POLICY_STORE_H_
+
+#import <Foundation/Foundation.h>
+
+#include <stddef.h>
+
+#include "base/supports_user_data.h"
+
+@class CRWSessionCertificateStorage;
+
+namespace web {
+
+class BrowserState;
+
+// Stores the allowed certificates of all the sessions of a BrowserState. The
+// CRWSessionCertificateStorages are addressed by the fingerprint of their
+// certificate, their host and their status, so all the sessions which allowed
+// the same certificate share a single storage. NSKeyedArchiver encodes a
+// shared storage once per archive, which keeps the certificate chains out of
+// every other session, and the sessions decoded from the archive share the
+// decoded storage. Must be accessed on the UI thread.
+class SessionCertificatePolicyStore : public base::SupportsUserData::Data {
+ public:
+  SessionCertificatePolicyStore(const SessionCertificatePolicyStore&) = delete;
+  SessionCertificatePolicyStore& operator=(
+      const SessionCertificatePolicyStore&) = delete;
+
+  ~SessionCertificatePolicyStore() override;
+
+  // Returns the store of |browser_state|, creating it if needed.
+  static SessionCertificatePolicyStore* FromBrowserState(
+      BrowserState* browser_state);
+
+  // Returns the storage of the store equal to |storage|. If there is none,
+  // |storage| is added to the store and returned.
+  CRWSessionCertificateStorage* GetSharedStorage(
+      CRWSessionCertificateStorage* storage);
+
+  // Returns the number of storages used by at least one session.
+  size_t GetStorageCount() const;
+
+ private:
+  SessionCertificatePolicyStore();
+
+  // The storages are weakly held, so they are removed once no session uses
+  // them anymore.
+  NSHashTable<CRWSessionCertificateStorage*>* storages_;
+};
+
+}  // namespace web
+
+#endif  // IOS_WEB_SESSION_SESSION_CERTIFICATE_POLICY_STORE_H_
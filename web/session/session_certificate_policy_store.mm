@@ -0,0 +1,61 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/session/session_certificate_policy_store.h"
+
+#include "base/check.h"
+#include "base/memory/ptr_util.h"
+#include "ios/web/public/browser_state.h"
+#import "ios/web/public/session/crw_session_certificate_policy_cache_storage.h"
+#include "ios/web/public/thread/web_thread.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+const char kSessionCertificatePolicyStoreKeyName[] =
+    "session_certificate_policy_store";
+}  // namespace
+
+namespace web {
+
+SessionCertificatePolicyStore::SessionCertificatePolicyStore()
+    : storages_([NSHashTable weakObjectsHashTable]) {}
+
+SessionCertificatePolicyStore::~SessionCertificatePolicyStore() {}
+
+// static
+SessionCertificatePolicyStore* SessionCertificatePolicyStore::FromBrowserState(
+    BrowserState* browser_state) {
+  DCHECK(browser_state);
+
+  SessionCertificatePolicyStore* store =
+      static_cast<SessionCertificatePolicyStore*>(
+          browser_state->GetUserData(kSessionCertificatePolicyStoreKeyName));
+  if (!store) {
+    store = new SessionCertificatePolicyStore();
+    browser_state->SetUserData(kSessionCertificatePolicyStoreKeyName,
+                               base::WrapUnique(store));
+  }
+  return store;
+}
+
+CRWSessionCertificateStorage* SessionCertificatePolicyStore::GetSharedStorage(
+    CRWSessionCertificateStorage* storage) {
+  DCHECK_CURRENTLY_ON(WebThread::UI);
+  DCHECK(storage);
+  CRWSessionCertificateStorage* shared_storage = [storages_ member:storage];
+  if (shared_storage)
+    return shared_storage;
+  [storages_ addObject:storage];
+  return storage;
+}
+
+size_t SessionCertificatePolicyStore::GetStorageCount() const {
+  // The count of a weak NSHashTable includes the released objects.
+  return storages_.allObjects.count;
+}
+
+}  // namespace web
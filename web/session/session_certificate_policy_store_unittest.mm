@@ -0,0 +1,148 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/session/session_certificate_policy_store.h"
+
+#include <memory>
+#include <vector>
+
+#import "ios/web/public/session/crw_session_certificate_policy_cache_storage.h"
+#include "ios/web/public/test/fakes/fake_browser_state.h"
+#include "ios/web/public/test/web_task_environment.h"
+#import "ios/web/session/session_certificate_policy_cache_impl.h"
+#include "ios/web/session/session_certificate_policy_cache_storage_builder.h"
+#include "net/cert/x509_certificate.h"
+#include "net/test/cert_test_util.h"
+#include "net/test/test_data_directory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of sessions of the large session tests.
+const size_t kSessionCount = 100;
+
+// Returns the data of |root_object| archived with NSKeyedArchiver.
+NSData* Archive(id root_object) {
+  return [NSKeyedArchiver archivedDataWithRootObject:root_object
+                               requiringSecureCoding:NO
+                                               error:nil];
+}
+
+// Returns the root object unarchived from |data|.
+id Unarchive(NSData* data) {
+  NSKeyedUnarchiver* unarchiver =
+      [[NSKeyedUnarchiver alloc] initForReadingFromData:data error:nil];
+  unarchiver.requiresSecureCoding = NO;
+  return [unarchiver decodeObjectForKey:NSKeyedArchiveRootObjectKey];
+}
+
+}  // namespace
+
+// Test fixture to test SessionCertificatePolicyStore class.
+class SessionCertificatePolicyStoreTest : public PlatformTest {
+ protected:
+  SessionCertificatePolicyStoreTest()
+      : store_(web::SessionCertificatePolicyStore::FromBrowserState(
+            &browser_state_)),
+        cert_(net::ImportCertFromFile(net::GetTestCertsDirectory(),
+                                      "ok_cert.pem")) {}
+
+  // Returns a new storage allowing |cert_| for |host|.
+  CRWSessionCertificateStorage* CreateStorage(const std::string& host) {
+    return [[CRWSessionCertificateStorage alloc]
+        initWithCertificate:cert_
+                       host:host
+                     status:net::CERT_STATUS_REVOKED];
+  }
+
+  web::WebTaskEnvironment task_environment_;
+  web::FakeBrowserState browser_state_;
+  web::SessionCertificatePolicyStore* store_;
+  scoped_refptr<net::X509Certificate> cert_;
+};
+
+// Tests that equal storages are shared, and that storages are removed once
+// they are no longer used.
+TEST_F(SessionCertificatePolicyStoreTest, SharedStorage) {
+  @autoreleasepool {
+    CRWSessionCertificateStorage* storage = CreateStorage("test.com");
+    EXPECT_EQ(storage, store_->GetSharedStorage(storage));
+    EXPECT_EQ(storage, store_->GetSharedStorage(CreateStorage("test.com")));
+    CRWSessionCertificateStorage* other_storage = CreateStorage("other.com");
+    EXPECT_EQ(other_storage, store_->GetSharedStorage(other_storage));
+    EXPECT_EQ(2u, store_->GetStorageCount());
+  }
+  EXPECT_EQ(0u, store_->GetStorageCount());
+}
+
+// Tests that the sessions of a BrowserState share the storage of the same
+// allowed certificate, including the restored sessions.
+TEST_F(SessionCertificatePolicyStoreTest, SharedBetweenSessions) {
+  web::SessionCertificatePolicyCacheImpl cache(&browser_state_);
+  cache.RegisterAllowedCertificate(cert_, "test.com",
+                                   net::CERT_STATUS_REVOKED);
+  web::SessionCertificatePolicyCacheImpl other_cache(&browser_state_);
+  other_cache.RegisterAllowedCertificate(cert_, "test.com",
+                                         net::CERT_STATUS_REVOKED);
+  other_cache.RegisterAllowedCertificate(cert_, "test.com",
+                                         net::CERT_STATUS_REVOKED);
+  ASSERT_EQ(1u, other_cache.GetAllowedCerts().count);
+  EXPECT_EQ([cache.GetAllowedCerts() anyObject],
+            [other_cache.GetAllowedCerts() anyObject]);
+
+  web::SessionCertificatePolicyCacheImpl restored_cache(&browser_state_);
+  restored_cache.SetAllowedCerts(
+      [NSSet setWithObject:CreateStorage("test.com")]);
+  EXPECT_EQ([cache.GetAllowedCerts() anyObject],
+            [restored_cache.GetAllowedCerts() anyObject]);
+}
+
+// Measures the size of a large session, where all the tabs allowed the same
+// certificate. The shared storage is only encoded once.
+TEST_F(SessionCertificatePolicyStoreTest, LargeSession) {
+  std::vector<std::unique_ptr<web::SessionCertificatePolicyCacheImpl>> caches;
+  NSMutableArray* shared_storages = [NSMutableArray array];
+  NSMutableArray* unshared_storages = [NSMutableArray array];
+  for (size_t i = 0; i < kSessionCount; ++i) {
+    caches.push_back(std::make_unique<web::SessionCertificatePolicyCacheImpl>(
+        &browser_state_));
+    caches.back()->RegisterAllowedCertificate(cert_, "test.com",
+                                              net::CERT_STATUS_REVOKED);
+    [shared_storages
+        addObject:web::SessionCertificatePolicyCacheStorageBuilder::
+                      BuildStorage(*caches.back())];
+
+    CRWSessionCertificatePolicyCacheStorage* unshared_storage =
+        [[CRWSessionCertificatePolicyCacheStorage alloc] init];
+    unshared_storage.certificateStorages =
+        [NSSet setWithObject:CreateStorage("test.com")];
+    [unshared_storages addObject:unshared_storage];
+  }
+
+  size_t previous_bytes_encoded = web::GetCertPolicyBytesEncoded();
+  NSData* unshared_data = Archive(unshared_storages);
+  const size_t unshared_bytes_encoded =
+      web::GetCertPolicyBytesEncoded() - previous_bytes_encoded;
+  previous_bytes_encoded = web::GetCertPolicyBytesEncoded();
+  NSData* shared_data = Archive(shared_storages);
+  const size_t shared_bytes_encoded =
+      web::GetCertPolicyBytesEncoded() - previous_bytes_encoded;
+
+  EXPECT_EQ(unshared_bytes_encoded, kSessionCount * shared_bytes_encoded);
+  EXPECT_LT(shared_data.length * 5, unshared_data.length);
+
+  // The decoded sessions share the decoded storage.
+  NSArray* decoded_storages = Unarchive(shared_data);
+  ASSERT_EQ(kSessionCount, decoded_storages.count);
+  CRWSessionCertificateStorage* decoded_storage =
+      [[decoded_storages[0] certificateStorages] anyObject];
+  ASSERT_TRUE(decoded_storage);
+  for (CRWSessionCertificatePolicyCacheStorage* storage in decoded_storages)
+    EXPECT_EQ(decoded_storage, [storage.certificateStorages anyObject]);
+}
@@ -50,6 +50,7 @@
 #import "ios/web/security/crw_cert_verification_controller.h"
 #import "ios/web/security/crw_ssl_status_updater.h"
 #import "ios/web/text_fragments/text_fragments_manager_impl.h"
+#import "ios/web/web_state/crw_web_view.h"
 #import "ios/web/web_state/page_viewport_state.h"
 #import "ios/web/web_state/ui/crw_context_menu_controller.h"
 #import "ios/web/web_state/ui/crw_swipe_recognizer_provider.h"
@@ -59,6 +60,7 @@
 #import "ios/web/web_state/ui/crw_wk_ui_handler.h"
 #import "ios/web/web_state/ui/crw_wk_ui_handler_delegate.h"
 #import "ios/web/web_state/ui/wk_web_view_configuration_provider.h"
+#import "ios/web/web_state/ui/wk_web_view_pool.h"
 #import "ios/web/web_state/user_interaction_state.h"
 #import "ios/web/web_state/web_state_impl.h"
 #import "ios/web/web_state/web_view_internal_creation_util.h"
@@ -1582,12 +1584,12 @@ CrFullscreenState CrFullscreenStateFromWKFullscreenState(
 
 // Creates a web view if it's not yet created.
 - (WKWebView*)ensureWebViewCreated {
-  WKWebViewConfiguration* config =
-      [self webViewConfigurationProvider].GetWebViewConfiguration();
-  return [self ensureWebViewCreatedWithConfiguration:config];
+  // Without a given configuration, a pooled web view can be used.
+  return [self ensureWebViewCreatedWithConfiguration:nil];
 }
 
-// Creates a web view with given |config|. No-op if web view is already created.
+// Creates a web view with given |config|, or with the configuration of the
+// browser state if |config| is nil. No-op if web view is already created.
 - (WKWebView*)ensureWebViewCreatedWithConfiguration:
     (WKWebViewConfiguration*)config {
   if (!self.webView) {
@@ -1638,7 +1640,9 @@ CrFullscreenState CrFullscreenStateFromWKFullscreenState(
   return self.webView;
 }
 
-// Returns a new autoreleased web view created with given configuration.
+// Returns a new autoreleased web view created with given configuration. If
+// |config| is nil, the web view uses the configuration of the browser state,
+// and is taken from the pool of pre-created web views if possible.
 - (WKWebView*)webViewWithConfiguration:(WKWebViewConfiguration*)config {
   // Do not attach the context menu controller immediately as the JavaScript
   // delegate must be specified.
@@ -1651,9 +1655,37 @@ CrFullscreenState CrFullscreenStateFromWKFullscreenState(
         web::GetWebClient()->GetDefaultUserAgent(self.webStateImpl, GURL());
   }
 
-  return web::BuildWKWebView(CGRectZero, config,
-                             self.webStateImpl->GetBrowserState(),
-                             userAgentType, self);
+  web::BrowserState* browserState = self.webStateImpl->GetBrowserState();
+  if (!config) {
+    // The pool is not refilled while the web usage of this controller is
+    // disabled, e.g. while the web states are suspended on memory pressure.
+    // The pool outlives this controller, and still refills once it is
+    // destroyed, as closing the tab does not disable the web usage of the
+    // browser state.
+    __weak CRWWebController* weakSelf = self;
+    WKWebView* pooledWebView =
+        [self webViewConfigurationProvider].GetWebViewPool().DequeueWebView(
+            userAgentType, ^WKWebView*(web::UserAgentType poolUserAgentType) {
+              CRWWebController* strongSelf = weakSelf;
+              if (strongSelf && !strongSelf.webUsageEnabled)
+                return nil;
+              return web::BuildWKWebView(
+                  CGRectZero,
+                  web::WKWebViewConfigurationProvider::FromBrowserState(
+                      browserState)
+                      .GetWebViewConfiguration(),
+                  browserState, poolUserAgentType, nil);
+            });
+    if (pooledWebView) {
+      base::mac::ObjCCastStrict<CRWWebView>(pooledWebView).inputViewProvider =
+          self;
+      return pooledWebView;
+    }
+    config = [self webViewConfigurationProvider].GetWebViewConfiguration();
+  }
+
+  return web::BuildWKWebView(CGRectZero, config, browserState, userAgentType,
+                             self);
 }
 
 // Wraps the web view in a CRWWebViewContentView and adds it to the container
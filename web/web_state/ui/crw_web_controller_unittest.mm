@@ -50,6 +50,8 @@
 #import "ios/web/test/wk_web_view_crash_utils.h"
 #import "ios/web/web_state/ui/crw_web_controller.h"
 #import "ios/web/web_state/ui/crw_web_controller_container_view.h"
+#import "ios/web/web_state/ui/wk_web_view_configuration_provider.h"
+#import "ios/web/web_state/ui/wk_web_view_pool.h"
 #import "ios/web/web_state/web_state_impl.h"
 #import "net/base/mac/url_conversions.h"
 #include "net/cert/x509_util_apple.h"
@@ -1400,4 +1402,43 @@ TEST_F(CRWWebControllerWebViewTest, CheckNoKVOWhenWebStateDestroyed) {
   EXPECT_FALSE(web_view_.hadObserversWhenStopping);
 }
 
+// Test fixture for the use of the pool of web views by CRWWebController.
+class CRWWebControllerWebViewPoolTest : public WebTestWithWebController {
+ protected:
+  CRWWebControllerWebViewPoolTest() {
+    feature_list_.InitAndEnableFeature(features::kWebViewPool);
+  }
+
+  WKWebViewPool& pool() {
+    return WKWebViewConfigurationProvider::FromBrowserState(GetBrowserState())
+        .GetWebViewPool();
+  }
+
+  base::test::ScopedFeatureList feature_list_;
+};
+
+// Tests that the pool is refilled after the web state which requested a
+// web view was destroyed.
+TEST_F(CRWWebControllerWebViewPoolTest, RefillAfterRequesterDestroyed) {
+  [web_controller() removeWebView];
+  ASSERT_TRUE([web_controller() ensureWebViewCreated]);
+  DestroyWebState();
+
+  EXPECT_TRUE(WaitUntilConditionOrTimeout(kWaitForPageLoadTimeout, ^{
+    return pool().size() == 1u;
+  }));
+}
+
+// Tests that the pool is not refilled while the web usage of the web state
+// which requested a web view is disabled.
+TEST_F(CRWWebControllerWebViewPoolTest, NoRefillWithoutWebUsage) {
+  [web_controller() removeWebView];
+  ASSERT_TRUE([web_controller() ensureWebViewCreated]);
+  web_state()->SetWebUsageEnabled(false);
+
+  // Wait for longer than the refill delay.
+  base::test::ios::SpinRunLoopWithMinDelay(base::Seconds(3));
+  EXPECT_EQ(0u, pool().size());
+}
+
 }  // namespace web
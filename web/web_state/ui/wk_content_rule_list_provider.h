@@ -15,7 +15,8 @@
 namespace web {
 
 // A provider class that handles compiling and configuring Content Blocker
-// rules.
+// rules. The rule lists compiled by a previous launch are reused as long as
+// their rules do not change.
 class WKContentRuleListProvider {
  public:
   explicit WKContentRuleListProvider();
@@ -17,21 +17,84 @@
 
 namespace web {
 
+namespace {
+
+// Name of the rule list blocking the resources loaded by local pages.
+NSString* const kBlockLocalRuleListName = @"block-local";
+
+// Removes from |store| the lists compiled for |name| with other rules than the
+// list identified by |identifier|.
+void RemoveStaleContentRuleLists(WKContentRuleListStore* store,
+                                 NSString* name,
+                                 NSString* identifier) {
+  [store getAvailableContentRuleListIdentifiers:^(
+             NSArray<NSString*>* identifiers) {
+    for (NSString* stale_identifier in identifiers) {
+      if ([stale_identifier isEqualToString:identifier] ||
+          !IsContentRuleListIdentifierForName(stale_identifier, name)) {
+        continue;
+      }
+      [store removeContentRuleListForIdentifier:stale_identifier
+                              completionHandler:^(NSError* error){
+                              }];
+    }
+  }];
+}
+
+// Compiles |json_rule_list| as the list |identifier| of |name| in |store|,
+// and runs |completion| with the compiled list.
+void CompileContentRuleList(WKContentRuleListStore* store,
+                            NSString* name,
+                            NSString* identifier,
+                            NSString* json_rule_list,
+                            void (^completion)(WKContentRuleList* rule_list)) {
+  [store compileContentRuleListForIdentifier:identifier
+                      encodedContentRuleList:json_rule_list
+                           completionHandler:^(WKContentRuleList* rule_list,
+                                               NSError* error) {
+                             completion(rule_list);
+                             RemoveStaleContentRuleLists(store, name,
+                                                         identifier);
+                           }];
+}
+
+// Runs |completion| with the rule list |name| compiled from |json_rule_list|.
+// Compiling large rule lists is slow, so the list compiled by a previous
+// launch is used if the rules did not change, and the rules are only compiled
+// otherwise.
+void LoadContentRuleList(WKContentRuleListStore* store,
+                         NSString* name,
+                         NSString* json_rule_list,
+                         void (^completion)(WKContentRuleList* rule_list)) {
+  NSString* identifier = GetContentRuleListIdentifier(name, json_rule_list);
+  [store lookUpContentRuleListForIdentifier:identifier
+                          completionHandler:^(WKContentRuleList* rule_list,
+                                              NSError* error) {
+                            if (rule_list) {
+                              completion(rule_list);
+                              return;
+                            }
+                            CompileContentRuleList(store, name, identifier,
+                                                   json_rule_list, completion);
+                          }];
+}
+
+}  // namespace
+
 WKContentRuleListProvider::WKContentRuleListProvider()
     : weak_ptr_factory_(this) {
   base::WeakPtr<WKContentRuleListProvider> weak_this =
       weak_ptr_factory_.GetWeakPtr();
-  [WKContentRuleListStore.defaultStore
-      compileContentRuleListForIdentifier:@"block-local"
-                   encodedContentRuleList:CreateLocalBlockingJsonRuleList()
-                        completionHandler:^(WKContentRuleList* rule_list,
-                                            NSError* error) {
-                          if (!weak_this.get()) {
-                            return;
-                          }
-                          block_local_rule_list_ = rule_list;
-                          InstallContentRuleLists();
-                        }];
+  LoadContentRuleList(WKContentRuleListStore.defaultStore,
+                      kBlockLocalRuleListName,
+                      CreateLocalBlockingJsonRuleList(),
+                      ^(WKContentRuleList* rule_list) {
+                        if (!weak_this.get()) {
+                          return;
+                        }
+                        block_local_rule_list_ = rule_list;
+                        InstallContentRuleLists();
+                      });
 }
 
 WKContentRuleListProvider::~WKContentRuleListProvider() {}
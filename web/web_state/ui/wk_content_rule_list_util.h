@@ -13,6 +13,17 @@ namespace web {
 // from file:// or application specific scheme:// pages.
 NSString* CreateLocalBlockingJsonRuleList();
 
+// Returns the identifier under which the rule list |name| is compiled from
+// |json_rule_list| in the WKContentRuleListStore. The identifier includes a
+// hash of the rules, so that a list compiled by a previous launch is only
+// reused if its rules did not change.
+NSString* GetContentRuleListIdentifier(NSString* name,
+                                       NSString* json_rule_list);
+
+// Returns whether |identifier| is an identifier of the rule list |name|,
+// compiled from any rules.
+bool IsContentRuleListIdentifierForName(NSString* identifier, NSString* name);
+
 }  // namespace web
 
 #endif  // IOS_WEB_WEB_STATE_UI_WK_CONTENT_RULE_LIST_UTIL_H_
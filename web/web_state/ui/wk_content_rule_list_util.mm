@@ -4,7 +4,11 @@
 
 #import "ios/web/web_state/ui/wk_content_rule_list_util.h"
 
+#include <string>
+
 #include "base/check.h"
+#include "base/hash/sha1.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/sys_string_conversions.h"
 #include "ios/web/public/web_client.h"
 
@@ -56,11 +60,30 @@ NSString* CreateLocalBlockingJsonRuleList() {
 
   NSData* json_data = [NSJSONSerialization
       dataWithJSONObject:@[ local_block, allow_crbug_block ]
-                 options:NSJSONWritingPrettyPrinted
+                 options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys
                    error:nil];
   NSString* json_string = [[NSString alloc] initWithData:json_data
                                                 encoding:NSUTF8StringEncoding];
   return json_string;
 }
 
+NSString* GetContentRuleListIdentifier(NSString* name,
+                                       NSString* json_rule_list) {
+  std::string hash =
+      base::SHA1HashString(base::SysNSStringToUTF8(json_rule_list));
+  return [NSString
+      stringWithFormat:@"%@-%s", name,
+                       base::HexEncode(hash.data(), hash.size()).c_str()];
+}
+
+bool IsContentRuleListIdentifierForName(NSString* identifier, NSString* name) {
+  // Lists compiled before the identifiers included a hash are named after
+  // their list.
+  if ([identifier isEqualToString:name])
+    return true;
+  NSString* prefix = [name stringByAppendingString:@"-"];
+  return [identifier hasPrefix:prefix] &&
+         identifier.length == prefix.length + 2 * base::kSHA1Length;
+}
+
 }  // namespace web
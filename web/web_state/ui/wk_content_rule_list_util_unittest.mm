@@ -48,5 +48,33 @@ TEST_F(WKContentRuleListUtilTest, LocalResourceJSONBlock) {
   ASSERT_NSEQ(@"block", block_rule[@"action"][@"type"]);
 }
 
+// Tests that the identifier of a rule list changes with its rules.
+TEST_F(WKContentRuleListUtilTest, ContentRuleListIdentifier) {
+  NSString* identifier =
+      GetContentRuleListIdentifier(@"block-local", @"[{\"a\": 1}]");
+  EXPECT_NSEQ(identifier,
+              GetContentRuleListIdentifier(@"block-local", @"[{\"a\": 1}]"));
+  EXPECT_NSNE(identifier,
+              GetContentRuleListIdentifier(@"block-local", @"[{\"a\": 2}]"));
+  EXPECT_NSNE(identifier,
+              GetContentRuleListIdentifier(@"block-other", @"[{\"a\": 1}]"));
+
+  EXPECT_TRUE(IsContentRuleListIdentifierForName(identifier, @"block-local"));
+  EXPECT_TRUE(IsContentRuleListIdentifierForName(@"block-local",
+                                                 @"block-local"));
+  EXPECT_FALSE(IsContentRuleListIdentifierForName(identifier, @"block"));
+  EXPECT_FALSE(IsContentRuleListIdentifierForName(
+      GetContentRuleListIdentifier(@"block-local-extra", @"[]"),
+      @"block-local"));
+}
+
+// Tests that the JSON created for block mode does not change between calls,
+// so that its compiled rule list can be reused.
+TEST_F(WKContentRuleListUtilTest, LocalResourceJSONIsStable) {
+  ScopedTestingWebClient web_client(std::make_unique<FakeWebClient>());
+  EXPECT_NSEQ(CreateLocalBlockingJsonRuleList(),
+              CreateLocalBlockingJsonRuleList());
+}
+
 }  // namespace
 }  // namespace web
@@ -17,6 +17,7 @@ namespace web {
 
 class BrowserState;
 class WKContentRuleListProvider;
+class WKWebViewPool;
 class WKWebViewConfigurationProviderObserver;
 
 // A provider class associated with a single web::BrowserState object. Manages
@@ -67,6 +68,10 @@ class WKWebViewConfigurationProvider : public base::SupportsUserData::Data {
   // Callers must not retain the returned object.
   WKContentRuleListProvider* GetContentRuleListProvider();
 
+  // Returns the pool of web views created ahead of time with the
+  // configuration of the browser state.
+  WKWebViewPool& GetWebViewPool();
+
   // Recreates and re-adds all injected Javascript into the current
   // configuration. This will only affect WebStates that are loaded after a call
   // to this function. All current WebStates will keep their existing Javascript
@@ -91,6 +96,7 @@ class WKWebViewConfigurationProvider : public base::SupportsUserData::Data {
   WKWebViewConfiguration* configuration_ = nil;
   BrowserState* browser_state_;
   std::unique_ptr<WKContentRuleListProvider> content_rule_list_provider_;
+  std::unique_ptr<WKWebViewPool> web_view_pool_;
 
   // A list of observers notified when WKWebViewConfiguration changes.
   // This observer list has its' check_empty flag set to false, because
@@ -24,6 +24,7 @@
 #include "ios/web/public/web_client.h"
 #import "ios/web/web_state/ui/wk_content_rule_list_provider.h"
 #import "ios/web/web_state/ui/wk_web_view_configuration_provider_observer.h"
+#import "ios/web/web_state/ui/wk_web_view_pool.h"
 #import "ios/web/webui/crw_web_ui_scheme_handler.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
@@ -77,7 +78,8 @@ WKWebViewConfigurationProvider::WKWebViewConfigurationProvider(
     BrowserState* browser_state)
     : browser_state_(browser_state),
       content_rule_list_provider_(
-          std::make_unique<WKContentRuleListProvider>()) {}
+          std::make_unique<WKContentRuleListProvider>()),
+      web_view_pool_(std::make_unique<WKWebViewPool>()) {}
 
 WKWebViewConfigurationProvider::~WKWebViewConfigurationProvider() = default;
 
@@ -184,6 +186,10 @@ WKWebViewConfigurationProvider::GetContentRuleListProvider() {
   return content_rule_list_provider_.get();
 }
 
+WKWebViewPool& WKWebViewConfigurationProvider::GetWebViewPool() {
+  return *web_view_pool_;
+}
+
 void WKWebViewConfigurationProvider::UpdateScripts() {
   [configuration_.userContentController removeAllUserScripts];
 
@@ -218,6 +224,8 @@ void WKWebViewConfigurationProvider::UpdateScripts() {
 
 void WKWebViewConfigurationProvider::Purge() {
   DCHECK([NSThread isMainThread]);
+  // The pooled web views retain the configuration and its process pool.
+  web_view_pool_->Clear();
   configuration_ = nil;
 }
 
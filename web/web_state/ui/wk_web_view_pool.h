@@ -0,0 +1,84 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_WEB_STATE_UI_WK_WEB_VIEW_POOL_H_
+#define IOS_WEB_WEB_STATE_UI_WK_WEB_VIEW_POOL_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <set>
+
+#include "base/memory/memory_pressure_listener.h"
+#include "base/timer/timer.h"
+#include "ios/web/common/user_agent.h"
+
+@class WKWebView;
+
+namespace web {
+
+// A small pool of WKWebViews created ahead of time for a browser state, so
+// that new tabs and prerenders do not wait for their web view to be created.
+// The pool holds one web view for each user agent type recently requested. It
+// is refilled once the web views stopped being requested for a while, but not
+// while the app is in background, and is emptied on memory pressure. Must be
+// used only on the main thread.
+class WKWebViewPool {
+ public:
+  // Block building a web view for |user_agent_type| with the current
+  // configuration of the browser state. Returns nil if no web view must be
+  // built now, e.g. while the web usage of the requester is disabled. It may
+  // be run after the requester is destroyed.
+  using WebViewBuilder = WKWebView* (^)(UserAgentType user_agent_type);
+
+  WKWebViewPool();
+
+  WKWebViewPool(const WKWebViewPool&) = delete;
+  WKWebViewPool& operator=(const WKWebViewPool&) = delete;
+
+  ~WKWebViewPool();
+
+  // Returns a pooled web view for |user_agent_type|, or nil if there is none.
+  // The pool is later refilled with web views built by |builder|.
+  WKWebView* DequeueWebView(UserAgentType user_agent_type,
+                            WebViewBuilder builder);
+
+  // Releases the pooled web views. Must be called when the configuration of
+  // the browser state changes, as the pooled web views use the previous one.
+  void Clear();
+
+  // Returns the number of pooled web views.
+  size_t size() const { return web_views_.size(); }
+
+ private:
+  // Schedules a refill of the pool, unless it is paused.
+  void ScheduleRefill();
+
+  // Builds a web view for one of the requested user agent types missing from
+  // the pool, and schedules the next refill if more are missing. Does nothing
+  // while the app is in background, the next request schedules a refill.
+  void Refill();
+
+  // Empties the pool and pauses the refills on memory pressure.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
+  // The pooled web views, by user agent type.
+  std::map<UserAgentType, WKWebView*> web_views_;
+
+  // The user agent types of the web views requested since the last memory
+  // pressure.
+  std::set<UserAgentType> requested_user_agent_types_;
+
+  // Block building the web views of the pool.
+  WebViewBuilder builder_;
+
+  base::OneShotTimer refill_timer_;
+  base::OneShotTimer memory_pressure_pause_timer_;
+  base::MemoryPressureListener memory_pressure_listener_;
+};
+
+}  // namespace web
+
+#endif  // IOS_WEB_WEB_STATE_UI_WK_WEB_VIEW_POOL_H_
@@ -0,0 +1,109 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/web_state/ui/wk_web_view_pool.h"
+
+#import <UIKit/UIKit.h>
+#import <WebKit/WebKit.h>
+
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/feature_list.h"
+#include "ios/web/common/features.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+
+namespace {
+
+// Delay after the last request before the pool is refilled, so that the web
+// views are not built while tabs are being opened.
+constexpr base::TimeDelta kRefillDelay = base::Seconds(2);
+
+// Delay during which the pool is not refilled after a memory pressure. iOS
+// does not report the end of memory pressure.
+constexpr base::TimeDelta kMemoryPressurePauseDelay = base::Seconds(60);
+
+}  // namespace
+
+WKWebViewPool::WKWebViewPool()
+    : memory_pressure_listener_(
+          FROM_HERE,
+          base::BindRepeating(&WKWebViewPool::OnMemoryPressure,
+                              base::Unretained(this))) {}
+
+WKWebViewPool::~WKWebViewPool() = default;
+
+WKWebView* WKWebViewPool::DequeueWebView(UserAgentType user_agent_type,
+                                         WebViewBuilder builder) {
+  DCHECK([NSThread isMainThread]);
+  DCHECK(builder);
+  if (!base::FeatureList::IsEnabled(features::kWebViewPool))
+    return nil;
+
+  builder_ = builder;
+  requested_user_agent_types_.insert(user_agent_type);
+
+  WKWebView* web_view = nil;
+  auto it = web_views_.find(user_agent_type);
+  if (it != web_views_.end()) {
+    web_view = it->second;
+    web_views_.erase(it);
+  }
+  ScheduleRefill();
+  return web_view;
+}
+
+void WKWebViewPool::Clear() {
+  DCHECK([NSThread isMainThread]);
+  web_views_.clear();
+}
+
+void WKWebViewPool::ScheduleRefill() {
+  if (memory_pressure_pause_timer_.IsRunning())
+    return;
+  // Restarting the timer delays the refill until the requests stop.
+  refill_timer_.Start(
+      FROM_HERE, kRefillDelay,
+      base::BindOnce(&WKWebViewPool::Refill, base::Unretained(this)));
+}
+
+void WKWebViewPool::Refill() {
+  DCHECK(builder_);
+  if (UIApplication.sharedApplication.applicationState ==
+      UIApplicationStateBackground) {
+    return;
+  }
+  for (UserAgentType user_agent_type : requested_user_agent_types_) {
+    if (web_views_.count(user_agent_type))
+      continue;
+    // Only one web view is built at a time, to avoid blocking the main thread
+    // for long.
+    WKWebView* web_view = builder_(user_agent_type);
+    if (!web_view)
+      return;
+    web_views_[user_agent_type] = web_view;
+    if (web_views_.size() < requested_user_agent_types_.size())
+      ScheduleRefill();
+    return;
+  }
+}
+
+void WKWebViewPool::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  if (memory_pressure_level ==
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+    return;
+  }
+  Clear();
+  requested_user_agent_types_.clear();
+  refill_timer_.Stop();
+  memory_pressure_pause_timer_.Start(FROM_HERE, kMemoryPressurePauseDelay,
+                                     base::DoNothing());
+}
+
+}  // namespace web
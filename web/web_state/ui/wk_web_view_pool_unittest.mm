@@ -0,0 +1,146 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/web_state/ui/wk_web_view_pool.h"
+
+#import <WebKit/WebKit.h>
+
+#include "base/memory/memory_pressure_listener.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/test/task_environment.h"
+#include "ios/web/common/features.h"
+#import "testing/gtest_mac.h"
+#include "testing/platform_test.h"
+#import "third_party/ocmock/OCMock/OCMock.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+namespace {
+
+// Long enough for the pool to be refilled.
+constexpr base::TimeDelta kRefillWait = base::Seconds(10);
+
+class WKWebViewPoolTest : public PlatformTest {
+ protected:
+  WKWebViewPoolTest() {
+    feature_list_.InitAndEnableFeature(features::kWebViewPool);
+    int* built_web_views = &built_web_views_;
+    builder_ = ^WKWebView*(UserAgentType user_agent_type) {
+      ++*built_web_views;
+      return [[WKWebView alloc] initWithFrame:CGRectZero];
+    };
+  }
+
+  base::test::ScopedFeatureList feature_list_;
+  base::test::SingleThreadTaskEnvironment task_environment_{
+      base::test::TaskEnvironment::MainThreadType::UI,
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  WKWebViewPool pool_;
+  WKWebViewPool::WebViewBuilder builder_;
+  int built_web_views_ = 0;
+};
+
+// Tests that the pool is refilled with web views of the requested user agent
+// types once they stop being requested.
+TEST_F(WKWebViewPoolTest, Refill) {
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+  EXPECT_EQ(0, built_web_views_);
+
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(1, built_web_views_);
+  EXPECT_EQ(1u, pool_.size());
+
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::DESKTOP, builder_));
+  WKWebView* web_view = pool_.DequeueWebView(UserAgentType::MOBILE, builder_);
+  EXPECT_TRUE(web_view);
+  EXPECT_EQ(0u, pool_.size());
+
+  // The pool is refilled with one web view of each type.
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(3, built_web_views_);
+  EXPECT_EQ(2u, pool_.size());
+  EXPECT_NSNE(web_view, pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+}
+
+// Tests that the pooled web views are released by Clear().
+TEST_F(WKWebViewPoolTest, Clear) {
+  pool_.DequeueWebView(UserAgentType::MOBILE, builder_);
+  task_environment_.FastForwardBy(kRefillWait);
+  ASSERT_EQ(1u, pool_.size());
+
+  pool_.Clear();
+  EXPECT_EQ(0u, pool_.size());
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+}
+
+// Tests that the pool is emptied on memory pressure, and not refilled for a
+// while.
+TEST_F(WKWebViewPoolTest, MemoryPressure) {
+  pool_.DequeueWebView(UserAgentType::MOBILE, builder_);
+  task_environment_.FastForwardBy(kRefillWait);
+  ASSERT_EQ(1u, pool_.size());
+
+  base::MemoryPressureListener::SimulatePressureNotification(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0u, pool_.size());
+
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(0u, pool_.size());
+
+  // The pool is refilled after the pause, once web views are requested again.
+  task_environment_.FastForwardBy(base::Minutes(2));
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(1u, pool_.size());
+}
+
+// Tests that the pool is not refilled while the builder declines to build web
+// views, e.g. while web usage is disabled.
+TEST_F(WKWebViewPoolTest, BuilderDeclines) {
+  WKWebViewPool::WebViewBuilder declining_builder =
+      ^WKWebView*(UserAgentType user_agent_type) {
+        return nil;
+      };
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, declining_builder));
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(0u, pool_.size());
+}
+
+// Tests that the pool is not refilled while the app is in background.
+TEST_F(WKWebViewPoolTest, NoRefillInBackground) {
+  id application = OCMClassMock([UIApplication class]);
+  OCMStub([application sharedApplication]).andReturn(application);
+  OCMStub([application applicationState])
+      .andReturn(UIApplicationStateBackground);
+
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(0, built_web_views_);
+  EXPECT_EQ(0u, pool_.size());
+  [application stopMocking];
+
+  // The next request refills the pool.
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(1u, pool_.size());
+}
+
+// Tests that no web view is pooled while the feature is disabled.
+TEST_F(WKWebViewPoolTest, FeatureDisabled) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndDisableFeature(features::kWebViewPool);
+
+  EXPECT_FALSE(pool_.DequeueWebView(UserAgentType::MOBILE, builder_));
+  task_environment_.FastForwardBy(kRefillWait);
+  EXPECT_EQ(0, built_web_views_);
+}
+
+}  // namespace
+}  // namespace web
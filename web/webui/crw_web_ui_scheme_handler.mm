@@ -5,9 +5,11 @@
 #import "ios/web/webui/crw_web_ui_scheme_handler.h"
 
 #include <map>
+#include <string>
 
 #include "base/files/file_path.h"
-#import "ios/web/webui/url_fetcher_block_adapter.h"
+#include "base/strings/sys_string_conversions.h"
+#import "ios/web/webui/url_fetcher_stream_adapter.h"
 #include "ios/web/webui/web_ui_ios_controller_factory_registry.h"
 #import "net/base/mac/url_conversions.h"
 #include "url/gurl.h"
@@ -24,13 +26,51 @@ NSInteger GetErrorCodeForUrl(const GURL& URL) {
   return factory ? factory->GetErrorCodeForWebUIURL(URL)
                  : NSURLErrorUnsupportedURL;
 }
+
+// Returns the MIME type guessed from the extension of |URL|, for the data
+// sources which do not provide one.
+NSString* GetMimeTypeForUrlExtension(const GURL& URL) {
+  base::FilePath filePath = base::FilePath(URL.ExtractFileName());
+  if (filePath.Extension() == ".js")
+    return @"text/javascript; charset=UTF-8";
+  if (filePath.Extension() == ".css")
+    return @"text/css; charset=UTF-8";
+  if (filePath.Extension() == ".svg")
+    return @"image/svg+xml";
+  return @"text/html";
+}
+
+// Returns the Content-Type of the response for |URL|, with the |mimeType| and
+// |charset| provided by its data source.
+NSString* GetContentType(const GURL& URL,
+                         const std::string& mimeType,
+                         const std::string& charset) {
+  if (mimeType.empty())
+    return GetMimeTypeForUrlExtension(URL);
+  std::string contentType = mimeType;
+  if (!charset.empty())
+    contentType += "; charset=" + charset;
+  return base::SysUTF8ToNSString(contentType);
+}
+
+// Returns the error reported to the scheme task for |request| when the
+// resource failed to load.
+NSError* GetLoadFailureError(NSURLRequest* request) {
+  return [NSError errorWithDomain:NSURLErrorDomain
+                             code:NSURLErrorResourceUnavailable
+                         userInfo:@{
+                           NSURLErrorFailingURLErrorKey : request.URL,
+                           NSURLErrorFailingURLStringErrorKey :
+                               request.URL.absoluteString
+                         }];
+}
 }  // namespace
 
 @implementation CRWWebUISchemeHandler {
   scoped_refptr<network::SharedURLLoaderFactory> _URLLoaderFactory;
 
   // Set of live WebUI fetchers for retrieving data.
-  std::map<id<WKURLSchemeTask>, std::unique_ptr<web::URLFetcherBlockAdapter>>
+  std::map<id<WKURLSchemeTask>, std::unique_ptr<web::URLFetcherStreamAdapter>>
       _map;
 }
 
@@ -63,38 +103,35 @@ NSInteger GetErrorCodeForUrl(const GURL& URL) {
     return;
   }
 
+  // The body is forwarded to |urlSchemeTask| chunk by chunk. The blocks are
+  // only called while the adapter is in |_map|, as stopping the task destroys
+  // the adapter, which cancels the fetch.
   __weak CRWWebUISchemeHandler* weakSelf = self;
-  std::unique_ptr<web::URLFetcherBlockAdapter> adapter =
-      std::make_unique<web::URLFetcherBlockAdapter>(
+  std::unique_ptr<web::URLFetcherStreamAdapter> adapter =
+      std::make_unique<web::URLFetcherStreamAdapter>(
           URL, _URLLoaderFactory,
-          ^(NSData* data, web::URLFetcherBlockAdapter* fetcher) {
-            CRWWebUISchemeHandler* strongSelf = weakSelf;
-            if (!strongSelf ||
-                strongSelf.map->find(urlSchemeTask) == strongSelf.map->end()) {
-              return;
-            }
-            NSString* mimeType = @"text/html";
-            base::FilePath filePath =
-                base::FilePath(fetcher->getUrl().ExtractFileName());
-            if (filePath.Extension() == ".js") {
-              mimeType = @"text/javascript; charset=UTF-8";
-            } else if (filePath.Extension() == ".css") {
-              mimeType = @"text/css; charset=UTF-8";
-            } else if (filePath.Extension() == ".svg") {
-              mimeType = @"image/svg+xml";
-            }
-            NSHTTPURLResponse* response =
-                [[NSHTTPURLResponse alloc] initWithURL:urlSchemeTask.request.URL
-                                            statusCode:200
-                                           HTTPVersion:@"HTTP/1.1"
-                                          headerFields:@{
-                                            @"Content-Type" : mimeType,
-                                            @"Access-Control-Allow-Origin" : @"*"
-                                          }];
+          ^(const std::string& mimeType, const std::string& charset) {
+            NSHTTPURLResponse* response = [[NSHTTPURLResponse alloc]
+                 initWithURL:urlSchemeTask.request.URL
+                  statusCode:200
+                 HTTPVersion:@"HTTP/1.1"
+                headerFields:@{
+                  @"Content-Type" : GetContentType(URL, mimeType, charset),
+                  @"Access-Control-Allow-Origin" : @"*"
+                }];
             [urlSchemeTask didReceiveResponse:response];
+          },
+          ^(NSData* data) {
             [urlSchemeTask didReceiveData:data];
-            [urlSchemeTask didFinish];
-            [weakSelf removeFetcher:fetcher];
+          },
+          ^(bool success) {
+            if (success) {
+              [urlSchemeTask didFinish];
+            } else {
+              [urlSchemeTask
+                  didFailWithError:GetLoadFailureError(urlSchemeTask.request)];
+            }
+            [weakSelf removeFetcherForTask:urlSchemeTask];
           });
   _map.insert(std::make_pair(urlSchemeTask, std::move(adapter)));
   _map.find(urlSchemeTask)->second->Start();
@@ -110,19 +147,9 @@ NSInteger GetErrorCodeForUrl(const GURL& URL) {
 
 #pragma mark - Private
 
-// Returns a pointer to the |_map| ivar for strongSelf.
-- (std::map<id<WKURLSchemeTask>, std::unique_ptr<web::URLFetcherBlockAdapter>>*)
-    map {
-  return &_map;
-}
-
-// Removes |fetcher| from map of active fetchers.
-- (void)removeFetcher:(web::URLFetcherBlockAdapter*)fetcher {
-  _map.erase(std::find_if(
-      _map.begin(), _map.end(),
-      [fetcher](const std::pair<const id<WKURLSchemeTask>,
-                                std::unique_ptr<web::URLFetcherBlockAdapter>>&
-                    entry) { return entry.second.get() == fetcher; }));
+// Removes the fetcher of |urlSchemeTask| from map of active fetchers.
+- (void)removeFetcherForTask:(id<WKURLSchemeTask>)urlSchemeTask {
+  _map.erase(urlSchemeTask);
 }
 
 @end
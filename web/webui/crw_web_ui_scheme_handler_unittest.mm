@@ -12,7 +12,11 @@
 #include "ios/web/public/webui/web_ui_ios_controller_factory.h"
 #include "ios/web/test/test_url_constants.h"
 #import "net/base/mac/url_conversions.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_response_headers.h"
+#include "services/network/public/cpp/url_loader_completion_status.h"
 #include "services/network/public/cpp/weak_wrapper_shared_url_loader_factory.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
 #include "services/network/test/test_url_loader_factory.h"
 #import "third_party/ocmock/OCMock/OCMock.h"
 
@@ -132,6 +136,21 @@ class CRWWebUISchemeManagerTest : public WebTest {
     base::RunLoop().RunUntilIdle();
   }
 
+  // Responds to the request for |url| with |data| of |mime_type|, as provided
+  // by the data source, or with |error| if it is not net::OK.
+  void RespondWithMimeType(const GURL& url,
+                           const std::string& data,
+                           const std::string& mime_type,
+                           net::Error error = net::OK) {
+    auto head = network::mojom::URLResponseHead::New();
+    head->headers =
+        base::MakeRefCounted<net::HttpResponseHeaders>("HTTP/1.1 200 OK");
+    head->mime_type = mime_type;
+    GetURLLoaderFactory()->AddResponse(
+        url, std::move(head), data, network::URLLoaderCompletionStatus(error));
+    base::RunLoop().RunUntilIdle();
+  }
+
   network::TestURLLoaderFactory test_url_loader_factory_;
   scoped_refptr<network::SharedURLLoaderFactory> test_shared_loader_factory_;
   FakeWebUIIOSControllerFactory factory_;
@@ -241,7 +260,29 @@ TEST_F(CRWWebUISchemeManagerTest, StopTask) {
   EXPECT_FALSE(url_scheme_task.receivedError);
 }
 
-// Tests that proper mime-type is returned for a given chrome:// request.
+// Tests that the mime-type provided by the data source is returned for a
+// given chrome:// request.
+TEST_F(CRWWebUISchemeManagerTest, MimetypeFromDataSource) {
+  CRWWebUISchemeHandler* scheme_handler = CreateSchemeHandler();
+  id web_view = OCMClassMock([WKWebView class]);
+  FakeSchemeTask* url_scheme_task = [[FakeSchemeTask alloc] init];
+
+  // The data source mime-type takes precedence over the extension.
+  NSMutableURLRequest* request = [NSMutableURLRequest
+      requestWithURL:[NSURL URLWithString:@"chrome://clown/res/clown.css"]];
+  request.mainDocumentURL = [NSURL URLWithString:@"chrome://clown/"];
+  url_scheme_task.request = request;
+  [scheme_handler webView:web_view startURLSchemeTask:url_scheme_task];
+  RespondWithMimeType(net::GURLWithNSURL(request.URL), "{}",
+                      "application/json");
+
+  EXPECT_TRUE([url_scheme_task responseHasMimetype:@"application/json"]);
+  EXPECT_TRUE(url_scheme_task.receivedData);
+  EXPECT_FALSE(url_scheme_task.receivedError);
+}
+
+// Tests that the mime-type is guessed from the extension of a given chrome://
+// request when the data source provides none.
 TEST_F(CRWWebUISchemeManagerTest, CheckMimetypeOfChromeScheme) {
   CRWWebUISchemeHandler* scheme_handler = CreateSchemeHandler();
   id web_view = OCMClassMock([WKWebView class]);
@@ -253,7 +294,7 @@ TEST_F(CRWWebUISchemeManagerTest, CheckMimetypeOfChromeScheme) {
   request.mainDocumentURL = [NSURL URLWithString:@"chrome://clown/"];
   url_scheme_task.request = request;
   [scheme_handler webView:web_view startURLSchemeTask:url_scheme_task];
-  RespondWithData(net::GURLWithNSURL(request.URL), "{}");
+  RespondWithMimeType(net::GURLWithNSURL(request.URL), "{}", "");
 
   EXPECT_TRUE([url_scheme_task responseHasMimetype:@"text/javascript"]);
   EXPECT_TRUE(url_scheme_task.receivedData);
@@ -265,7 +306,7 @@ TEST_F(CRWWebUISchemeManagerTest, CheckMimetypeOfChromeScheme) {
   request.mainDocumentURL = [NSURL URLWithString:@"chrome://clown/"];
   url_scheme_task.request = request;
   [scheme_handler webView:web_view startURLSchemeTask:url_scheme_task];
-  RespondWithData(net::GURLWithNSURL(request.URL), "{}");
+  RespondWithMimeType(net::GURLWithNSURL(request.URL), "{}", "");
 
   EXPECT_TRUE([url_scheme_task responseHasMimetype:@"text/css"]);
   EXPECT_TRUE(url_scheme_task.receivedData);
@@ -277,7 +318,7 @@ TEST_F(CRWWebUISchemeManagerTest, CheckMimetypeOfChromeScheme) {
   request.mainDocumentURL = [NSURL URLWithString:@"chrome://clown/"];
   url_scheme_task.request = request;
   [scheme_handler webView:web_view startURLSchemeTask:url_scheme_task];
-  RespondWithData(net::GURLWithNSURL(request.URL), "{}");
+  RespondWithMimeType(net::GURLWithNSURL(request.URL), "{}", "");
 
   EXPECT_TRUE([url_scheme_task responseHasMimetype:@"image/svg+xml"]);
   EXPECT_TRUE(url_scheme_task.receivedData);
@@ -290,11 +331,29 @@ TEST_F(CRWWebUISchemeManagerTest, CheckMimetypeOfChromeScheme) {
   request.mainDocumentURL = [NSURL URLWithString:@"chrome://clown/"];
   url_scheme_task.request = request;
   [scheme_handler webView:web_view startURLSchemeTask:url_scheme_task];
-  RespondWithData(net::GURLWithNSURL(request.URL), "{}");
+  RespondWithMimeType(net::GURLWithNSURL(request.URL), "{}", "");
 
   EXPECT_TRUE([url_scheme_task responseHasMimetype:@"text/html"]);
   EXPECT_TRUE(url_scheme_task.receivedData);
   EXPECT_FALSE(url_scheme_task.receivedError);
 }
 
+// Tests that a resource which fails to load makes the task fail.
+TEST_F(CRWWebUISchemeManagerTest, LoadFailure) {
+  CRWWebUISchemeHandler* scheme_handler = CreateSchemeHandler();
+  id web_view = OCMClassMock([WKWebView class]);
+  FakeSchemeTask* url_scheme_task = [[FakeSchemeTask alloc] init];
+  NSMutableURLRequest* request =
+      [NSMutableURLRequest requestWithURL:GetWebUIURL()];
+  request.mainDocumentURL = GetWebUIURL();
+  url_scheme_task.request = request;
+
+  [scheme_handler webView:web_view startURLSchemeTask:url_scheme_task];
+
+  RespondWithMimeType(net::GURLWithNSURL(request.URL), "", "text/html",
+                      net::ERR_FAILED);
+  EXPECT_TRUE(url_scheme_task.receivedError);
+  EXPECT_EQ(NSURLErrorResourceUnavailable, url_scheme_task.error.code);
+}
+
 }  // namespace web
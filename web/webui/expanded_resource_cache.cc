@@ -0,0 +1,105 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/webui/expanded_resource_cache.h"
+
+#include <tuple>
+#include <utility>
+
+#include "base/hash/hash.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/strings/string_piece.h"
+
+namespace web {
+
+ExpandedResourceKey::ExpandedResourceKey(const std::string& source_name,
+                                         const std::string& path,
+                                         const std::string& locale,
+                                         size_t replacements_hash)
+    : source_name(source_name),
+      path(path),
+      locale(locale),
+      replacements_hash(replacements_hash) {}
+
+ExpandedResourceKey::ExpandedResourceKey(const ExpandedResourceKey& other) =
+    default;
+
+ExpandedResourceKey& ExpandedResourceKey::operator=(
+    const ExpandedResourceKey& other) = default;
+
+ExpandedResourceKey::~ExpandedResourceKey() {}
+
+bool ExpandedResourceKey::operator<(const ExpandedResourceKey& other) const {
+  return std::tie(replacements_hash, source_name, path, locale) <
+         std::tie(other.replacements_hash, other.source_name, other.path,
+                  other.locale);
+}
+
+size_t HashTemplateReplacements(const ui::TemplateReplacements& replacements) {
+  size_t hash = replacements.size();
+  for (const auto& replacement : replacements) {
+    hash = base::HashInts(hash, base::FastHash(replacement.first));
+    hash = base::HashInts(hash, base::FastHash(replacement.second));
+  }
+  return hash;
+}
+
+scoped_refptr<base::RefCountedMemory> ExpandTemplateResource(
+    const base::RefCountedMemory& bytes,
+    const ui::TemplateReplacements& replacements) {
+  std::string expanded = ui::ReplaceTemplateExpressions(
+      base::StringPiece(bytes.front_as<char>(), bytes.size()), replacements);
+  return base::RefCountedString::TakeString(&expanded);
+}
+
+ExpandedResourceCache::Entry::Entry(
+    const std::string& mime_type,
+    scoped_refptr<base::RefCountedMemory> bytes)
+    : mime_type(mime_type), bytes(std::move(bytes)) {}
+
+ExpandedResourceCache::Entry::Entry(const Entry& other) = default;
+
+ExpandedResourceCache::Entry& ExpandedResourceCache::Entry::operator=(
+    const Entry& other) = default;
+
+ExpandedResourceCache::Entry::~Entry() {}
+
+ExpandedResourceCache::ExpandedResourceCache(size_t max_size,
+                                             size_t max_bytes)
+    : entries_(Cache::NO_AUTO_EVICT),
+      max_size_(max_size),
+      max_bytes_(max_bytes) {}
+
+ExpandedResourceCache::~ExpandedResourceCache() {}
+
+const ExpandedResourceCache::Entry* ExpandedResourceCache::Get(
+    const ExpandedResourceKey& key) {
+  auto it = entries_.Get(key);
+  return it == entries_.end() ? nullptr : &it->second;
+}
+
+void ExpandedResourceCache::Put(
+    const ExpandedResourceKey& key,
+    const std::string& mime_type,
+    scoped_refptr<base::RefCountedMemory> expanded_bytes) {
+  auto it = entries_.Peek(key);
+  if (it != entries_.end()) {
+    byte_size_ -= it->second.bytes->size();
+    entries_.Erase(it);
+  }
+
+  const size_t entry_size = expanded_bytes->size();
+  if (entry_size > max_bytes_)
+    return;
+
+  byte_size_ += entry_size;
+  entries_.Put(key, Entry(mime_type, std::move(expanded_bytes)));
+  while (entries_.size() > max_size_ || byte_size_ > max_bytes_) {
+    auto oldest = entries_.rbegin();
+    byte_size_ -= oldest->second.bytes->size();
+    entries_.Erase(oldest);
+  }
+}
+
+}  // namespace web
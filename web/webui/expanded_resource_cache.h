@@ -0,0 +1,108 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_WEBUI_EXPANDED_RESOURCE_CACHE_H_
+#define IOS_WEB_WEBUI_EXPANDED_RESOURCE_CACHE_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "base/containers/lru_cache.h"
+#include "base/memory/scoped_refptr.h"
+#include "ui/base/template_expressions.h"
+
+namespace base {
+class RefCountedMemory;
+}
+
+namespace web {
+
+// Identifies a resource of a data source expanded with the i18n replacements
+// of that source.
+struct ExpandedResourceKey {
+  ExpandedResourceKey(const std::string& source_name,
+                      const std::string& path,
+                      const std::string& locale,
+                      size_t replacements_hash);
+  ExpandedResourceKey(const ExpandedResourceKey& other);
+  ExpandedResourceKey& operator=(const ExpandedResourceKey& other);
+  ~ExpandedResourceKey();
+
+  bool operator<(const ExpandedResourceKey& other) const;
+
+  std::string source_name;
+  std::string path;
+  std::string locale;
+  // Hash of the replacements, see HashTemplateReplacements().
+  size_t replacements_hash;
+};
+
+// Returns a hash of |replacements|, which differs for replacements with
+// different names or values.
+size_t HashTemplateReplacements(const ui::TemplateReplacements& replacements);
+
+// Returns |bytes| with its template expressions replaced by |replacements|.
+scoped_refptr<base::RefCountedMemory> ExpandTemplateResource(
+    const base::RefCountedMemory& bytes,
+    const ui::TemplateReplacements& replacements);
+
+// Cache of the WebUI resources already expanded with the i18n replacements of
+// their data source, so that loading a WebUI page again serves its resources
+// from memory, instead of reading and expanding them on each request. The
+// least recently used resources are evicted once the cache holds too many
+// resources or too many bytes.
+//
+// ExpandedResourceCache must only be used on the IO thread.
+class ExpandedResourceCache {
+ public:
+  // An expanded resource, with the MIME type it is served with.
+  struct Entry {
+    Entry(const std::string& mime_type,
+          scoped_refptr<base::RefCountedMemory> bytes);
+    Entry(const Entry& other);
+    Entry& operator=(const Entry& other);
+    ~Entry();
+
+    std::string mime_type;
+    scoped_refptr<base::RefCountedMemory> bytes;
+  };
+
+  // Creates a cache holding at most |max_size| resources, and at most
+  // |max_bytes| bytes of expanded resources.
+  ExpandedResourceCache(size_t max_size, size_t max_bytes);
+
+  ExpandedResourceCache(const ExpandedResourceCache&) = delete;
+  ExpandedResourceCache& operator=(const ExpandedResourceCache&) = delete;
+
+  ~ExpandedResourceCache();
+
+  // Returns the resource cached for |key|, or null. The returned entry is
+  // valid until the next call to Put().
+  const Entry* Get(const ExpandedResourceKey& key);
+
+  // Caches the |expanded_bytes| of the resource identified by |key|. A
+  // resource larger than the whole byte budget is not cached.
+  void Put(const ExpandedResourceKey& key,
+           const std::string& mime_type,
+           scoped_refptr<base::RefCountedMemory> expanded_bytes);
+
+  // Returns the number of cached resources.
+  size_t size() const { return entries_.size(); }
+
+  // Returns the number of bytes of the cached resources.
+  size_t byte_size() const { return byte_size_; }
+
+ private:
+  using Cache = base::LRUCache<ExpandedResourceKey, Entry>;
+  Cache entries_;
+
+  const size_t max_size_;
+  const size_t max_bytes_;
+  size_t byte_size_ = 0;
+};
+
+}  // namespace web
+
+#endif  // IOS_WEB_WEBUI_EXPANDED_RESOURCE_CACHE_H_
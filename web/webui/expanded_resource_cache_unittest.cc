@@ -0,0 +1,181 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/webui/expanded_resource_cache.h"
+
+#include <string>
+
+#include "base/memory/ref_counted_memory.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "testing/platform_test.h"
+
+namespace web {
+
+namespace {
+
+// Returns the content of |bytes|.
+std::string ToString(const base::RefCountedMemory& bytes) {
+  return std::string(bytes.front_as<char>(), bytes.size());
+}
+
+// Returns a key of a resource of the "test" source.
+ExpandedResourceKey CreateKey(const std::string& path) {
+  return ExpandedResourceKey("test", path, "en", 1);
+}
+
+}  // namespace
+
+using ExpandedResourceCacheTest = PlatformTest;
+
+// Tests that the template expressions of a resource are replaced.
+TEST_F(ExpandedResourceCacheTest, ExpandTemplateResource) {
+  ui::TemplateReplacements replacements;
+  replacements["title"] = "Hello";
+  std::string resource("<h1>$i18n{title}</h1>");
+
+  scoped_refptr<base::RefCountedMemory> expanded = ExpandTemplateResource(
+      *base::RefCountedString::TakeString(&resource), replacements);
+  EXPECT_EQ("<h1>Hello</h1>", ToString(*expanded));
+}
+
+// Tests that the hash of the replacements changes with their names and
+// values.
+TEST_F(ExpandedResourceCacheTest, HashTemplateReplacements) {
+  ui::TemplateReplacements replacements;
+  replacements["title"] = "Hello";
+  const size_t hash = HashTemplateReplacements(replacements);
+  EXPECT_EQ(hash, HashTemplateReplacements(replacements));
+
+  ui::TemplateReplacements other_value = replacements;
+  other_value["title"] = "Bonjour";
+  EXPECT_NE(hash, HashTemplateReplacements(other_value));
+
+  ui::TemplateReplacements other_name;
+  other_name["heading"] = "Hello";
+  EXPECT_NE(hash, HashTemplateReplacements(other_name));
+
+  ui::TemplateReplacements more_replacements = replacements;
+  more_replacements["heading"] = "Hello";
+  EXPECT_NE(hash, HashTemplateReplacements(more_replacements));
+}
+
+// Tests that a cached resource is only served for its key.
+TEST_F(ExpandedResourceCacheTest, Get) {
+  ExpandedResourceCache cache(2, 1024);
+  scoped_refptr<base::RefCountedMemory> bytes =
+      base::MakeRefCounted<base::RefCountedStaticMemory>("<html>", 6);
+  cache.Put(CreateKey("index.html"), "text/html", bytes);
+
+  const ExpandedResourceCache::Entry* entry =
+      cache.Get(CreateKey("index.html"));
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("text/html", entry->mime_type);
+  EXPECT_EQ(bytes, entry->bytes);
+
+  EXPECT_FALSE(cache.Get(CreateKey("other.html")));
+  EXPECT_FALSE(cache.Get(ExpandedResourceKey("other", "index.html", "en", 1)));
+  EXPECT_FALSE(cache.Get(ExpandedResourceKey("test", "index.html", "fr", 1)));
+  EXPECT_FALSE(cache.Get(ExpandedResourceKey("test", "index.html", "en", 2)));
+}
+
+// Tests that the least recently used resource is evicted once the cache holds
+// too many resources.
+TEST_F(ExpandedResourceCacheTest, Eviction) {
+  ExpandedResourceCache cache(2, 1024);
+  scoped_refptr<base::RefCountedMemory> bytes =
+      base::MakeRefCounted<base::RefCountedStaticMemory>("<html>", 6);
+  cache.Put(CreateKey("a.html"), "text/html", bytes);
+  cache.Put(CreateKey("b.html"), "text/html", bytes);
+  EXPECT_TRUE(cache.Get(CreateKey("a.html")));
+
+  cache.Put(CreateKey("c.html"), "text/html", bytes);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.Get(CreateKey("a.html")));
+  EXPECT_FALSE(cache.Get(CreateKey("b.html")));
+  EXPECT_TRUE(cache.Get(CreateKey("c.html")));
+}
+
+// Tests that the least recently used resources are evicted once the cache
+// holds too many bytes, and that a resource over the budget is not cached.
+TEST_F(ExpandedResourceCacheTest, ByteBudget) {
+  ExpandedResourceCache cache(10, 10);
+  scoped_refptr<base::RefCountedMemory> bytes =
+      base::MakeRefCounted<base::RefCountedStaticMemory>("<html>", 6);
+  scoped_refptr<base::RefCountedMemory> small_bytes =
+      base::MakeRefCounted<base::RefCountedStaticMemory>("<p>", 3);
+  cache.Put(CreateKey("a.html"), "text/html", bytes);
+  cache.Put(CreateKey("b.html"), "text/html", small_bytes);
+  EXPECT_EQ(9u, cache.byte_size());
+
+  // Replacing a resource updates the byte size.
+  cache.Put(CreateKey("b.html"), "text/html", bytes);
+  EXPECT_EQ(6u, cache.byte_size());
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_FALSE(cache.Get(CreateKey("a.html")));
+  EXPECT_TRUE(cache.Get(CreateKey("b.html")));
+
+  cache.Put(CreateKey("c.html"), "text/html", small_bytes);
+  EXPECT_EQ(9u, cache.byte_size());
+  EXPECT_EQ(2u, cache.size());
+
+  scoped_refptr<base::RefCountedMemory> large_bytes =
+      base::MakeRefCounted<base::RefCountedStaticMemory>("<html></html>", 13);
+  cache.Put(CreateKey("d.html"), "text/html", large_bytes);
+  EXPECT_FALSE(cache.Get(CreateKey("d.html")));
+  EXPECT_EQ(9u, cache.byte_size());
+}
+
+// Compares the time to load a WebUI resource repeatedly when it is expanded on
+// each load, and when it is served from the cache.
+TEST_F(ExpandedResourceCacheTest, RepeatedLoadPerformance) {
+  // A resource of about 100kB, with 1000 replacements.
+  ui::TemplateReplacements replacements;
+  std::string resource;
+  for (int i = 0; i < 1000; ++i) {
+    const std::string name = base::StringPrintf("string%d", i);
+    replacements[name] = "Localized string";
+    resource += base::StringPrintf(
+        "<div class=\"item\" id=\"item%d\"><span>$i18n{%s}</span></div>\n"
+        "<!-- Padding to make the resource closer to a real page. -->\n",
+        i, name.c_str());
+  }
+  scoped_refptr<base::RefCountedMemory> bytes =
+      base::RefCountedString::TakeString(&resource);
+  const int kLoadCount = 200;
+
+  base::ElapsedTimer expand_timer;
+  for (int i = 0; i < kLoadCount; ++i) {
+    scoped_refptr<base::RefCountedMemory> expanded =
+        ExpandTemplateResource(*bytes, replacements);
+    ASSERT_TRUE(expanded->size());
+  }
+  const base::TimeDelta expand_time = expand_timer.Elapsed();
+
+  // The hash of the replacements is computed once by the data source.
+  const size_t replacements_hash = HashTemplateReplacements(replacements);
+  ExpandedResourceCache cache(64, 4 * 1024 * 1024);
+  base::ElapsedTimer cache_timer;
+  for (int i = 0; i < kLoadCount; ++i) {
+    const ExpandedResourceKey key("test", "index.html", "en",
+                                  replacements_hash);
+    if (!cache.Get(key))
+      cache.Put(key, "text/html", ExpandTemplateResource(*bytes, replacements));
+    ASSERT_TRUE(cache.Get(key));
+  }
+  const base::TimeDelta cache_time = cache_timer.Elapsed();
+
+  // Log the elapsed times for performance tracking.
+  perf_test::PrintResult("ExpandedResourceCache", "", "200 loads, expanded",
+                         expand_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+  perf_test::PrintResult("ExpandedResourceCache", "", "200 loads, cached",
+                         cache_time.InMillisecondsF(), "ms",
+                         true /* "important" */);
+}
+
+}  // namespace web
@@ -124,6 +124,8 @@ void URLDataManagerIOS::AddDataSource(BrowserState* browser_state,
 void URLDataManagerIOS::AddWebUIIOSDataSource(BrowserState* browser_state,
                                               WebUIIOSDataSource* source) {
   WebUIIOSDataSourceImpl* impl = static_cast<WebUIIOSDataSourceImpl*>(source);
+  // Completes the replacements before the source is used on the IO thread.
+  impl->EnsureLoadTimeDataDefaultsAdded();
   GetFromBrowserState(browser_state)->AddDataSource(impl);
 }
 
@@ -13,6 +13,7 @@
 #include "base/compiler_specific.h"
 #include "base/supports_user_data.h"
 #include "ios/web/public/webui/url_data_source_ios.h"
+#include "ios/web/webui/expanded_resource_cache.h"
 #include "ios/web/webui/url_data_manager_ios.h"
 #include "net/url_request/url_request_job_factory.h"
 
@@ -88,6 +89,10 @@ class URLDataManagerIOSBackend : public base::SupportsUserData::Data {
   // Custom sources of data, keyed by source path (e.g. "favicon").
   DataSourceMap data_sources_;
 
+  // The resources already expanded with the replacements of their source.
+  // They outlive the sources, as a WebUI adds its source again on each load.
+  ExpandedResourceCache expanded_resources_;
+
   // All pending URLRequestChromeJobs, keyed by ID of the request.
   // URLRequestChromeJob calls into this object when it's constructed and
   // destructed to ensure that the pointers in this map remain valid.
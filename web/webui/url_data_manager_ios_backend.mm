@@ -20,11 +20,11 @@
 #include "ios/web/public/thread/web_task_traits.h"
 #include "ios/web/public/thread/web_thread.h"
 #import "ios/web/public/web_client.h"
+#include "ios/web/webui/expanded_resource_cache.h"
 #include "ios/web/webui/shared_resources_data_source_ios.h"
 #include "ios/web/webui/url_data_source_ios_impl.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
-#include "net/filter/source_stream.h"
 #include "net/http/http_response_headers.h"
 #include "net/http/http_status_code.h"
 #include "net/url_request/url_request.h"
@@ -32,7 +32,6 @@
 #include "net/url_request/url_request_job.h"
 #include "net/url_request/url_request_job_factory.h"
 #include "ui/base/template_expressions.h"
-#include "ui/base/webui/i18n_source_stream.h"
 #include "url/url_util.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
@@ -45,6 +44,11 @@ namespace web {
 
 namespace {
 
+// Maximum number of expanded resources kept in memory, and maximum number of
+// bytes they may use.
+const size_t kMaxExpandedResources = 64;
+const size_t kMaxExpandedResourceBytes = 4 * 1024 * 1024;
+
 const char kContentSecurityPolicy[] = "Content-Security-Policy";
 const char kChromeURLContentSecurityPolicyHeaderBase[] =
     "script-src chrome://resources 'self'; ";
@@ -121,7 +125,6 @@ class URLRequestChromeJob : public net::URLRequestJob {
   int ReadRawData(net::IOBuffer* buf, int buf_size) override;
   bool GetMimeType(std::string* mime_type) const override;
   void GetResponseInfo(net::HttpResponseInfo* info) override;
-  std::unique_ptr<net::SourceStream> SetUpSourceStream() override;
 
   // Used to notify that the requested data's |mime_type| is ready.
   void MimeTypeAvailable(URLDataSourceIOSImpl* source,
@@ -131,6 +134,11 @@ class URLRequestChromeJob : public net::URLRequestJob {
   // for us.
   void DataAvailable(base::RefCountedMemory* bytes);
 
+  // Called by URLDataManagerIOSBackend to serve the expanded |bytes| of a
+  // cached resource, with its |mime_type|.
+  void ExpandedResourceAvailable(const std::string& mime_type,
+                                 scoped_refptr<base::RefCountedMemory> bytes);
+
   void set_mime_type(const std::string& mime_type) { mime_type_ = mime_type; }
 
   void set_allow_caching(bool allow_caching) { allow_caching_ = allow_caching; }
@@ -159,6 +167,10 @@ class URLRequestChromeJob : public net::URLRequestJob {
     send_content_type_header_ = send_content_type_header;
   }
 
+  void set_expanded_resource_key(const ExpandedResourceKey& key) {
+    expanded_resource_key_ = key;
+  }
+
   // Returns true when job was generated from an incognito profile.
   bool is_incognito() const { return is_incognito_; }
 
@@ -198,11 +210,15 @@ class URLRequestChromeJob : public net::URLRequestJob {
   // If true, sets  the "X-Frame-Options: DENY" header.
   bool deny_xframe_options_;
 
-  // The URLDataSourceIOSImpl that is servicing this request. This is a shared
-  // pointer so that the request can continue to be served even if the source is
+  // The URLDataSourceIOSImpl that is servicing this request, set when the
+  // response must be expanded with its replacements. This is a shared pointer
+  // so that the request can continue to be served even if the source is
   // detached from the backend that initially owned it.
   scoped_refptr<URLDataSourceIOSImpl> source_;
 
+  // The key under which the expanded response is cached, if it can be.
+  absl::optional<ExpandedResourceKey> expanded_resource_key_;
+
   // If true, sets the "Content-Type: <mime-type>" header.
   bool send_content_type_header_;
 
@@ -305,29 +321,6 @@ void URLRequestChromeJob::GetResponseInfo(net::HttpResponseInfo* info) {
     info->headers->AddHeader(net::HttpRequestHeaders::kContentType, mime_type_);
 }
 
-std::unique_ptr<net::SourceStream> URLRequestChromeJob::SetUpSourceStream() {
-  std::unique_ptr<net::SourceStream> source_stream =
-      net::URLRequestJob::SetUpSourceStream();
-
-  // The URLRequestJob and the SourceStreams we are creating are owned by the
-  // same parent URLRequest, thus it is safe to pass the replacements via a raw
-  // pointer.
-  const ui::TemplateReplacements* replacements = nullptr;
-  if (source_)
-    replacements = source_->GetReplacements();
-  if (replacements) {
-    // It is safe to pass the raw replacements directly to the source stream, as
-    // both this URLRequestChromeJob and the I18nSourceStream are owned by the
-    // same root URLRequest. The replacements are owned by the URLDataSourceImpl
-    // which we keep alive via |source_|, ensuring its lifetime is also bound
-    // to the safe URLRequest.
-    source_stream = ui::I18nSourceStream::Create(
-        std::move(source_stream), net::SourceStream::TYPE_NONE, replacements);
-  }
-
-  return source_stream;
-}
-
 void URLRequestChromeJob::MimeTypeAvailable(URLDataSourceIOSImpl* source,
                                             const std::string& mime_type) {
   set_mime_type(mime_type);
@@ -344,7 +337,19 @@ void URLRequestChromeJob::DataAvailable(base::RefCountedMemory* bytes) {
   TRACE_EVENT_NESTABLE_ASYNC_END0("browser", "DataManager:Request",
                                   TRACE_ID_LOCAL(this));
   if (bytes) {
-    data_ = bytes;
+    const ui::TemplateReplacements* replacements =
+        source_ ? source_->GetReplacements() : nullptr;
+    if (replacements) {
+      // The whole response is available, so it is expanded at once and kept
+      // for the next requests of the same resource.
+      data_ = ExpandTemplateResource(*bytes, *replacements);
+      if (expanded_resource_key_ && backend_) {
+        backend_->expanded_resources_.Put(*expanded_resource_key_, mime_type_,
+                                          data_);
+      }
+    } else {
+      data_ = bytes;
+    }
     if (pending_buf_.get()) {
       CHECK(pending_buf_->data());
       int rv = CompleteRead(pending_buf_.get(), pending_buf_size_);
@@ -356,6 +361,17 @@ void URLRequestChromeJob::DataAvailable(base::RefCountedMemory* bytes) {
   }
 }
 
+void URLRequestChromeJob::ExpandedResourceAvailable(
+    const std::string& mime_type,
+    scoped_refptr<base::RefCountedMemory> bytes) {
+  TRACE_EVENT_NESTABLE_ASYNC_END0("browser", "DataManager:Request",
+                                  TRACE_ID_LOCAL(this));
+  set_mime_type(mime_type);
+  // The data is set before the headers complete, so that no read is pending.
+  data_ = std::move(bytes);
+  NotifyHeadersComplete();
+}
+
 int URLRequestChromeJob::ReadRawData(net::IOBuffer* buf, int buf_size) {
   if (!data_.get()) {
     DCHECK(!pending_buf_.get());
@@ -443,7 +459,9 @@ class ChromeProtocolHandler
 
 }  // namespace
 
-URLDataManagerIOSBackend::URLDataManagerIOSBackend() : next_request_id_(0) {
+URLDataManagerIOSBackend::URLDataManagerIOSBackend()
+    : expanded_resources_(kMaxExpandedResources, kMaxExpandedResourceBytes),
+      next_request_id_(0) {
   URLDataSourceIOS* shared_source = new SharedResourcesDataSourceIOS();
   URLDataSourceIOSImpl* source_impl =
       new URLDataSourceIOSImpl(shared_source->GetSource(), shared_source);
@@ -504,10 +522,6 @@ bool URLDataManagerIOSBackend::StartRequest(const net::URLRequest* request,
   std::string path;
   URLToRequestPath(url, &path);
 
-  // Save this request so we know where to send the data.
-  RequestID request_id = next_request_id_++;
-  pending_requests_.insert(std::make_pair(request_id, job));
-
   job->set_allow_caching(source->source()->AllowCaching());
   job->set_add_content_security_policy(true);
   job->set_content_security_policy_object_source(
@@ -516,6 +530,28 @@ bool URLDataManagerIOSBackend::StartRequest(const net::URLRequest* request,
   job->set_deny_xframe_options(source->source()->ShouldDenyXFrameOptions());
   job->set_send_content_type_header(false);
 
+  // Serve the resource from memory if it was already expanded, without going
+  // through the data source.
+  absl::optional<ExpandedResourceKey> expanded_resource_key =
+      source->GetExpandedResourceKey(path);
+  if (expanded_resource_key) {
+    const ExpandedResourceCache::Entry* entry =
+        expanded_resources_.Get(*expanded_resource_key);
+    if (entry) {
+      base::ThreadTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE,
+          base::BindOnce(&URLRequestChromeJob::ExpandedResourceAvailable,
+                         job->weak_factory_.GetWeakPtr(), entry->mime_type,
+                         entry->bytes));
+      return true;
+    }
+    job->set_expanded_resource_key(*expanded_resource_key);
+  }
+
+  // Save this request so we know where to send the data.
+  RequestID request_id = next_request_id_++;
+  pending_requests_.insert(std::make_pair(request_id, job));
+
   // Forward along the request to the data source.
   // URLRequestChromeJob should receive mime type before data. This
   // is guaranteed because request for mime type is placed in the
@@ -62,4 +62,9 @@ bool URLDataSourceIOSImpl::ShouldReplaceI18nInJS() const {
   return false;
 }
 
+absl::optional<ExpandedResourceKey>
+URLDataSourceIOSImpl::GetExpandedResourceKey(const std::string& path) const {
+  return absl::nullopt;
+}
+
 }  // namespace web
@@ -9,7 +9,9 @@
 
 #include "base/memory/ref_counted.h"
 #include "base/task/sequenced_task_runner_helpers.h"
+#include "ios/web/webui/expanded_resource_cache.h"
 #include "ios/web/webui/url_data_manager_ios.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 #include "ui/base/template_expressions.h"
 
 namespace base {
@@ -72,6 +74,12 @@ class URLDataSourceIOSImpl
   // using Web Components).
   virtual bool ShouldReplaceI18nInJS() const;
 
+  // Returns the key identifying the resource at |path| expanded with
+  // GetReplacements(), or nullopt if that expansion can't be cached because it
+  // depends on more than the replacements. Called on the IO thread.
+  virtual absl::optional<ExpandedResourceKey> GetExpandedResourceKey(
+      const std::string& path) const;
+
  protected:
   virtual ~URLDataSourceIOSImpl();
 
@@ -0,0 +1,92 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_WEBUI_URL_FETCHER_STREAM_ADAPTER_H_
+#define IOS_WEB_WEBUI_URL_FETCHER_STREAM_ADAPTER_H_
+
+#import <Foundation/Foundation.h>
+
+#include <memory>
+#include <string>
+
+#include "base/callback_forward.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/strings/string_piece.h"
+#include "services/network/public/cpp/simple_url_loader_stream_consumer.h"
+#include "url/gurl.h"
+
+namespace network {
+class SharedURLLoaderFactory;
+class SimpleURLLoader;
+namespace mojom {
+class URLResponseHead;
+}  // namespace mojom
+}  // namespace network
+
+namespace web {
+
+// Block types for URLFetcherStreamAdapter callbacks.
+// Called once the response started, with its MIME type and charset, which are
+// empty if unknown.
+typedef void (^URLFetcherStreamAdapterResponse)(const std::string& mime_type,
+                                                const std::string& charset);
+// Called with each chunk of the response body, as it arrives.
+typedef void (^URLFetcherStreamAdapterData)(NSData* data);
+// Called once the whole body was received, or the fetch failed. The adapter
+// may be destroyed from this block.
+typedef void (^URLFetcherStreamAdapterCompletion)(bool success);
+
+// Class to manage retrieval of WebUI resources. The body is streamed: each
+// chunk is forwarded as soon as it is read, and the next one is only read
+// once the chunk was forwarded, so at most one chunk is buffered. Destroying
+// the adapter cancels the fetch and frees the data in flight.
+class URLFetcherStreamAdapter : public network::SimpleURLLoaderStreamConsumer {
+ public:
+  // Creates URLFetcherStreamAdapter for resource at |url| with
+  // |url_loader_factory|. The blocks are called with the results of the fetch,
+  // in order: |response_handler| once, |data_handler| for each chunk, and
+  // |completion_handler| once.
+  URLFetcherStreamAdapter(
+      const GURL& url,
+      scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory,
+      URLFetcherStreamAdapterResponse response_handler,
+      URLFetcherStreamAdapterData data_handler,
+      URLFetcherStreamAdapterCompletion completion_handler);
+
+  URLFetcherStreamAdapter(const URLFetcherStreamAdapter&) = delete;
+  URLFetcherStreamAdapter& operator=(const URLFetcherStreamAdapter&) = delete;
+
+  ~URLFetcherStreamAdapter() override;
+
+  // Starts the fetch.
+  void Start();
+
+  const GURL& url() const { return url_; }
+
+  // network::SimpleURLLoaderStreamConsumer:
+  void OnDataReceived(base::StringPiece string_piece,
+                      base::OnceClosure resume) override;
+  void OnComplete(bool success) override;
+  void OnRetry(base::OnceClosure start_retry) override;
+
+ private:
+  // Called by |url_loader_| when the response started.
+  void OnResponseStarted(const GURL& final_url,
+                         const network::mojom::URLResponseHead& response_head);
+
+  // The URL to fetch.
+  const GURL url_;
+  // The URL loader factory.
+  scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory_;
+  // Callbacks for the resource load.
+  __strong URLFetcherStreamAdapterResponse response_handler_;
+  __strong URLFetcherStreamAdapterData data_handler_;
+  __strong URLFetcherStreamAdapterCompletion completion_handler_;
+  // URLLoader for retrieving data from net stack.
+  std::unique_ptr<network::SimpleURLLoader> url_loader_;
+};
+
+}  // namespace web
+
+#endif  // IOS_WEB_WEBUI_URL_FETCHER_STREAM_ADAPTER_H_
@@ -0,0 +1,81 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/webui/url_fetcher_stream_adapter.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/logging.h"
+#include "base/notreached.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/shared_url_loader_factory.h"
+#include "services/network/public/cpp/simple_url_loader.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+
+URLFetcherStreamAdapter::URLFetcherStreamAdapter(
+    const GURL& url,
+    scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory,
+    URLFetcherStreamAdapterResponse response_handler,
+    URLFetcherStreamAdapterData data_handler,
+    URLFetcherStreamAdapterCompletion completion_handler)
+    : url_(url),
+      url_loader_factory_(std::move(url_loader_factory)),
+      response_handler_(response_handler),
+      data_handler_(data_handler),
+      completion_handler_(completion_handler) {}
+
+URLFetcherStreamAdapter::~URLFetcherStreamAdapter() {}
+
+void URLFetcherStreamAdapter::Start() {
+  auto resource_request = std::make_unique<network::ResourceRequest>();
+  resource_request->url = url_;
+
+  url_loader_ = network::SimpleURLLoader::Create(std::move(resource_request),
+                                                 NO_TRAFFIC_ANNOTATION_YET);
+  url_loader_->SetOnResponseStartedCallback(
+      base::BindOnce(&URLFetcherStreamAdapter::OnResponseStarted,
+                     base::Unretained(this)));
+  url_loader_->DownloadAsStream(url_loader_factory_.get(), this);
+}
+
+void URLFetcherStreamAdapter::OnDataReceived(base::StringPiece string_piece,
+                                             base::OnceClosure resume) {
+  // The chunk is copied, as the data handler may keep it after the loader
+  // reused its buffer.
+  data_handler_([NSData dataWithBytes:string_piece.data()
+                               length:string_piece.size()]);
+  std::move(resume).Run();
+}
+
+void URLFetcherStreamAdapter::OnComplete(bool success) {
+  if (!success) {
+    DLOG(WARNING) << "Failed to load resource URL " << url_
+                  << ", error: " << url_loader_->NetError();
+  }
+  url_loader_.reset();
+  // |this| may be destroyed by the completion handler.
+  URLFetcherStreamAdapterCompletion completion_handler = completion_handler_;
+  completion_handler(success);
+}
+
+void URLFetcherStreamAdapter::OnRetry(base::OnceClosure start_retry) {
+  // Retries are not enabled on the loader.
+  NOTREACHED();
+}
+
+void URLFetcherStreamAdapter::OnResponseStarted(
+    const GURL& final_url,
+    const network::mojom::URLResponseHead& response_head) {
+  response_handler_(response_head.mime_type, response_head.charset);
+}
+
+}  // namespace web
@@ -0,0 +1,149 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/webui/url_fetcher_stream_adapter.h"
+
+#include <memory>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/path_service.h"
+#include "base/run_loop.h"
+#include "base/strings/sys_string_conversions.h"
+#include "base/test/task_environment.h"
+#include "net/base/net_errors.h"
+#include "services/network/public/cpp/url_loader_completion_status.h"
+#include "services/network/public/cpp/weak_wrapper_shared_url_loader_factory.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+#include "services/network/test/test_url_loader_factory.h"
+#import "testing/gtest_mac.h"
+#include "testing/platform_test.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+
+// Test fixture for URLFetcherStreamAdapter.
+class URLFetcherStreamAdapterTest : public PlatformTest {
+ protected:
+  URLFetcherStreamAdapterTest()
+      : task_environment_(
+            base::test::SingleThreadTaskEnvironment::MainThreadType::UI),
+        test_shared_url_loader_factory_(
+            base::MakeRefCounted<network::WeakWrapperSharedURLLoaderFactory>(
+                &test_url_loader_factory_)),
+        received_data_([NSMutableData data]) {}
+
+  // Returns a new adapter fetching |url|, which records the results of the
+  // fetch in the members of the fixture.
+  std::unique_ptr<URLFetcherStreamAdapter> CreateAdapter(const GURL& url) {
+    std::string* mime_type = &mime_type_;
+    bool* completed = &completed_;
+    bool* success = &success_;
+    NSMutableData* received_data = received_data_;
+    return std::make_unique<URLFetcherStreamAdapter>(
+        url, test_shared_url_loader_factory_,
+        ^(const std::string& response_mime_type, const std::string& charset) {
+          EXPECT_FALSE(received_data.length);
+          *mime_type = response_mime_type;
+        },
+        ^(NSData* data) {
+          [received_data appendData:data];
+        },
+        ^(bool fetch_success) {
+          *completed = true;
+          *success = fetch_success;
+        });
+  }
+
+  // Required for base::CurrentThread::Get().
+  base::test::SingleThreadTaskEnvironment task_environment_;
+  network::TestURLLoaderFactory test_url_loader_factory_;
+  scoped_refptr<network::SharedURLLoaderFactory>
+      test_shared_url_loader_factory_;
+
+  // Results of the fetch.
+  std::string mime_type_;
+  NSMutableData* received_data_;
+  bool completed_ = false;
+  bool success_ = false;
+};
+
+// Tests that URLFetcherStreamAdapter streams the appropriate data for a text
+// resource, with its MIME type.
+TEST_F(URLFetcherStreamAdapterTest, FetchTextResource) {
+  GURL test_url("http://test");
+  std::string response("<html><body>Hello World!</body></html>");
+  NSData* expected_data =
+      [NSData dataWithBytes:response.c_str() length:response.size()];
+
+  std::unique_ptr<URLFetcherStreamAdapter> web_ui_fetcher =
+      CreateAdapter(test_url);
+  web_ui_fetcher->Start();
+  test_url_loader_factory_.AddResponse(test_url.spec(), response);
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_TRUE(completed_);
+  EXPECT_TRUE(success_);
+  EXPECT_EQ("text/html", mime_type_);
+  EXPECT_NSEQ(expected_data, received_data_);
+}
+
+// Tests that URLFetcherStreamAdapter streams the appropriate data for a png
+// resource.
+TEST_F(URLFetcherStreamAdapterTest, FetchPNGResource) {
+  GURL test_url("http://test");
+  base::FilePath favicon_path;
+  ASSERT_TRUE(base::PathService::Get(base::DIR_SOURCE_ROOT, &favicon_path));
+  favicon_path = favicon_path.AppendASCII("ios/web/test/data/testfavicon.png");
+  NSData* expected_data = [NSData
+      dataWithContentsOfFile:base::SysUTF8ToNSString(favicon_path.value())];
+
+  std::unique_ptr<URLFetcherStreamAdapter> web_ui_fetcher =
+      CreateAdapter(test_url);
+  std::string response;
+  EXPECT_TRUE(ReadFileToString(favicon_path, &response));
+  web_ui_fetcher->Start();
+  test_url_loader_factory_.AddResponse(test_url.spec(), response);
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_TRUE(completed_);
+  EXPECT_TRUE(success_);
+  EXPECT_NSEQ(expected_data, received_data_);
+}
+
+// Tests that URLFetcherStreamAdapter reports failed fetches.
+TEST_F(URLFetcherStreamAdapterTest, FetchFailure) {
+  GURL test_url("http://test");
+  std::unique_ptr<URLFetcherStreamAdapter> web_ui_fetcher =
+      CreateAdapter(test_url);
+  web_ui_fetcher->Start();
+  test_url_loader_factory_.AddResponse(
+      test_url, network::mojom::URLResponseHead::New(), std::string(),
+      network::URLLoaderCompletionStatus(net::ERR_FAILED));
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_TRUE(completed_);
+  EXPECT_FALSE(success_);
+}
+
+// Tests that destroying URLFetcherStreamAdapter cancels the fetch.
+TEST_F(URLFetcherStreamAdapterTest, Cancel) {
+  GURL test_url("http://test");
+  std::unique_ptr<URLFetcherStreamAdapter> web_ui_fetcher =
+      CreateAdapter(test_url);
+  web_ui_fetcher->Start();
+  web_ui_fetcher.reset();
+  test_url_loader_factory_.AddResponse(test_url.spec(), "data");
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_FALSE(completed_);
+  EXPECT_EQ(0u, received_data_.length);
+}
+
+}  // namespace web
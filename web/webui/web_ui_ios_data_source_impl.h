@@ -40,6 +40,8 @@ class WebUIIOSDataSourceImpl : public URLDataSourceIOSImpl,
   void SetDefaultResource(int resource_id) override;
   void DisableDenyXFrameOptions() override;
   const ui::TemplateReplacements* GetReplacements() const override;
+  absl::optional<ExpandedResourceKey> GetExpandedResourceKey(
+      const std::string& path) const override;
 
  protected:
   ~WebUIIOSDataSourceImpl() override;
@@ -53,10 +55,12 @@ class WebUIIOSDataSourceImpl : public URLDataSourceIOSImpl,
   friend class InternalDataSource;
   friend class WebUIIOSDataSourceTest;
   friend class WebUIIOSDataSource;
+  friend class URLDataManagerIOS;
 
   explicit WebUIIOSDataSourceImpl(const std::string& source_name);
 
-  // Adds the locale to the load time data defaults. May be called repeatedly.
+  // Adds the locale to the load time data defaults, which completes the
+  // replacements. May be called repeatedly.
   void EnsureLoadTimeDataDefaultsAdded();
 
   // Methods that match URLDataSource which are called by
@@ -81,6 +85,10 @@ class WebUIIOSDataSourceImpl : public URLDataSourceIOSImpl,
   ui::TemplateReplacements replacements_;
   // The |replacements_| is intended to replace |localized_strings_|.
   base::Value::Dict localized_strings_;
+  // The locale and the hash of |replacements_|, identifying the expanded
+  // resources of this source. Set with the load time data defaults.
+  std::string locale_;
+  size_t replacements_hash_ = 0;
   bool deny_xframe_options_;
   bool load_time_data_defaults_added_;
   bool replace_existing_source_;
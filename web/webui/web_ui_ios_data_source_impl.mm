@@ -141,6 +141,21 @@ const ui::TemplateReplacements* WebUIIOSDataSourceImpl::GetReplacements()
   return &replacements_;
 }
 
+absl::optional<ExpandedResourceKey>
+WebUIIOSDataSourceImpl::GetExpandedResourceKey(const std::string& path) const {
+  // The replacements are only complete once the load time data defaults were
+  // added.
+  if (!load_time_data_defaults_added_)
+    return absl::nullopt;
+
+  // The strings are generated from |localized_strings_|, which also holds the
+  // booleans.
+  if (use_strings_js_ && (path == "strings.js" || path == "strings.m.js"))
+    return absl::nullopt;
+
+  return ExpandedResourceKey(source_name_, path, locale_, replacements_hash_);
+}
+
 std::string WebUIIOSDataSourceImpl::GetSource() const {
   return source_name_;
 }
@@ -169,10 +184,11 @@ void WebUIIOSDataSourceImpl::EnsureLoadTimeDataDefaultsAdded() {
     return;
 
   load_time_data_defaults_added_ = true;
+  locale_ = web::GetWebClient()->GetApplicationLocale();
   base::Value::Dict defaults;
-  webui::SetLoadTimeDataDefaults(web::GetWebClient()->GetApplicationLocale(),
-                                 &defaults);
+  webui::SetLoadTimeDataDefaults(locale_, &defaults);
   AddLocalizedStrings(defaults);
+  replacements_hash_ = HashTemplateReplacements(replacements_);
 }
 
 void WebUIIOSDataSourceImpl::StartDataRequest(